@@ -0,0 +1,178 @@
+#include "AmbientOcclusion.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+    constexpr GLuint GroupSize = 8;     // local size of every ao_*.comp
+    constexpr GLuint OcclusionUnit = 11;
+
+    GLuint Groups(int size) {
+        return (static_cast<GLuint>(size) + GroupSize - 1) / GroupSize;
+    }
+
+    // Later passes fetch what the last one stored
+    void ImageBarrier() {
+        glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+    }
+}
+
+AmbientOcclusionSettings GetAmbientOcclusionPreset(AmbientOcclusionQuality quality) {
+    AmbientOcclusionSettings settings;
+    switch (quality) {
+        case AmbientOcclusionQuality::Low:
+            settings.downsample = 4;
+            settings.slices = 1;
+            settings.steps = 4;
+            settings.blurRadius = 2;
+            break;
+        case AmbientOcclusionQuality::Medium:
+            settings.downsample = 2;
+            settings.slices = 2;
+            settings.steps = 4;
+            settings.blurRadius = 3;
+            break;
+        case AmbientOcclusionQuality::High:
+            settings.downsample = 2;
+            settings.slices = 3;
+            settings.steps = 6;
+            settings.blurRadius = 4;
+            break;
+        case AmbientOcclusionQuality::Ultra:
+            settings.downsample = 1;
+            settings.slices = 4;
+            settings.steps = 8;
+            settings.blurRadius = 4;
+            break;
+    }
+    return settings;
+}
+
+AmbientOcclusion::AmbientOcclusion(AmbientOcclusionQuality quality)
+    : settings(GetAmbientOcclusionPreset(quality)), quality(quality)
+{
+    auto depthShader = CreateShader(ShaderStage::Compute, "Shader/ao_depth.comp");
+    auto horizonShader = CreateShader(ShaderStage::Compute, "Shader/ao_horizon.comp");
+    auto horizonNormalsShader = CreateShader(ShaderStage::Compute, "Shader/ao_horizon.comp",
+                                             ShaderDefines{{"AO_GBUFFER_NORMALS", "1"}});
+    auto blurShader = CreateShader(ShaderStage::Compute, "Shader/ao_blur.comp");
+    auto upsampleShader = CreateShader(ShaderStage::Compute, "Shader/ao_upsample.comp");
+    depthProgram = CreateShaderProgram(*depthShader);
+    horizonProgram = CreateShaderProgram(*horizonShader);
+    horizonNormalsProgram = CreateShaderProgram(*horizonNormalsShader);
+    blurProgram = CreateShaderProgram(*blurShader);
+    upsampleProgram = CreateShaderProgram(*upsampleShader);
+
+    white = CreateRenderTexture(1, 1, OcclusionFormat, 1, 1, TextureFilter::Nearest, TextureFilter::Nearest);
+    const GLubyte one = 255;
+    glClearTexImage(white->id, 0, GL_RED, GL_UNSIGNED_BYTE, &one);
+}
+
+void AmbientOcclusion::SetQuality(AmbientOcclusionQuality newQuality) {
+    const AmbientOcclusionSettings preset = GetAmbientOcclusionPreset(newQuality);
+    settings.downsample = preset.downsample;
+    settings.slices = preset.slices;
+    settings.steps = preset.steps;
+    settings.blurRadius = preset.blurRadius;
+    quality = newQuality;
+}
+
+glm::ivec2 AmbientOcclusion::GetLowSize(glm::ivec2 outputSize) const {
+    const int downsample = std::max(settings.downsample, 1);
+    return (outputSize + downsample - 1) / downsample;
+}
+
+void AmbientOcclusion::Bind(Texture* occlusion) {
+    if (settings.enabled && occlusion) {
+        occlusion->BindTextureForSampling(OcclusionUnit);
+    } else {
+        white->BindTextureForSampling(OcclusionUnit);
+    }
+}
+
+void AmbientOcclusion::begin(const char* name) {
+    if (timer) timer->Begin(name);
+}
+
+void AmbientOcclusion::end(const char* name) {
+    if (timer) timer->End(name);
+}
+
+void AmbientOcclusion::Render(Texture& depth, Texture* normals, glm::ivec2 renderSize,
+                              const AmbientOcclusionTargets& targets) {
+    if (!settings.enabled) return;
+    if (!targets.viewDepth || !targets.occlusion[0] || !targets.occlusion[1] || !targets.output) {
+        throw std::runtime_error("Ambient occlusion is missing a target texture");
+    }
+
+    const int downsample = std::max(settings.downsample, 1);
+    const glm::ivec2 lowSize = GetLowSize(renderSize);
+    if (lowSize.x > targets.viewDepth->width || lowSize.y > targets.viewDepth->height ||
+        renderSize.x > targets.output->width || renderSize.y > targets.output->height) {
+        throw std::runtime_error("Ambient occlusion targets are smaller than the render size");
+    }
+    Texture& lowDepth = *targets.viewDepth;
+    Texture& result = *targets.output;
+
+    begin("AO depth");
+    depthProgram->useShaderProgram();
+    depthProgram->SetUniform1i("u_downsample", downsample);
+    depthProgram->SetUniformVec2("u_lowSize", glm::vec2(lowSize));
+    depth.BindTextureForSampling(0);
+    lowDepth.BindTextureForImageAccess(0, lowDepth.id, TextureAccess::Write, ViewDepthFormat);
+    glDispatchCompute(Groups(lowSize.x), Groups(lowSize.y), 1);
+    ImageBarrier();
+    end("AO depth");
+
+    begin("AO horizons");
+    ShaderProgram& horizon = normals ? *horizonNormalsProgram : *horizonProgram;
+    Texture& raw = *targets.occlusion[0];
+    horizon.useShaderProgram();
+    horizon.SetUniform1i("u_downsample", downsample);
+    horizon.SetUniformVec2("u_lowSize", glm::vec2(lowSize));
+    horizon.SetUniform1i("u_slices", std::max(settings.slices, 1));
+    horizon.SetUniform1i("u_steps", std::max(settings.steps, 1));
+    horizon.SetUniform1f("u_radius", settings.radius);
+    horizon.SetUniform1f("u_falloff", settings.falloff);
+    horizon.SetUniform1f("u_maxPixelRadius", settings.maxPixelRadius);
+    horizon.SetUniform1f("u_intensity", settings.intensity);
+    horizon.SetUniform1ui("u_frameIndex", settings.temporalNoise ? frameIndex++ : 0u);
+    lowDepth.BindTextureForSampling(0);
+    if (normals) normals->BindTextureForSampling(1);
+    raw.BindTextureForImageAccess(0, raw.id, TextureAccess::Write, OcclusionFormat);
+    glDispatchCompute(Groups(lowSize.x), Groups(lowSize.y), 1);
+    ImageBarrier();
+    end("AO horizons");
+
+    // Horizontal into occlusion[1], vertical back into occlusion[0], so the upsample reads
+    // occlusion[0] either way
+    if (settings.blurRadius > 0) {
+        begin("AO blur");
+        blurProgram->useShaderProgram();
+        blurProgram->SetUniformVec2("u_lowSize", glm::vec2(lowSize));
+        blurProgram->SetUniform1i("u_blurRadius", settings.blurRadius);
+        blurProgram->SetUniform1f("u_sharpness", settings.sharpness);
+        lowDepth.BindTextureForSampling(1);
+        for (int axis = 0; axis < 2; ++axis) {
+            Texture& source = *targets.occlusion[axis];
+            Texture& target = *targets.occlusion[axis ^ 1];
+            blurProgram->SetUniformVec2("u_direction", axis == 0 ? glm::vec2(1.0f, 0.0f) : glm::vec2(0.0f, 1.0f));
+            source.BindTextureForSampling(0);
+            target.BindTextureForImageAccess(0, target.id, TextureAccess::Write, OcclusionFormat);
+            glDispatchCompute(Groups(lowSize.x), Groups(lowSize.y), 1);
+            ImageBarrier();
+        }
+        end("AO blur");
+    }
+
+    begin("AO upsample");
+    upsampleProgram->useShaderProgram();
+    upsampleProgram->SetUniform1i("u_downsample", downsample);
+    upsampleProgram->SetUniformVec2("u_lowSize", glm::vec2(lowSize));
+    upsampleProgram->SetUniform1f("u_sharpness", settings.sharpness);
+    raw.BindTextureForSampling(0);
+    lowDepth.BindTextureForSampling(1);
+    depth.BindTextureForSampling(2);
+    result.BindTextureForImageAccess(0, result.id, TextureAccess::Write, OcclusionFormat);
+    glDispatchCompute(Groups(renderSize.x), Groups(renderSize.y), 1);
+    end("AO upsample");
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "../Profiling/GpuTimer.h"
+#include "../Shader/ShaderProgram.h"
+#include "../Texture/Texture.h"
+
+// Cost presets; each sets the resolution, sample counts and blur of AmbientOcclusionSettings
+enum class AmbientOcclusionQuality {
+    Low,        // quarter resolution, 1 slice x 4 steps
+    Medium,     // half resolution, 2 slices x 4 steps
+    High,       // half resolution, 3 slices x 6 steps
+    Ultra       // full resolution, 4 slices x 8 steps
+};
+
+struct AmbientOcclusionSettings {
+    int downsample = 2;             // 1 full, 2 half, 4 quarter resolution per axis
+    int slices = 2;                 // directions around each pixel
+    int steps = 4;                  // depth samples per side of a slice
+    int blurRadius = 3;             // taps per side of each blur axis; 0 skips the blur
+    float radius = 0.5f;            // world units occluders are searched within
+    float falloff = 0.5f;           // share of the radius over which distant occluders fade out
+    float maxPixelRadius = 64.0f;   // low-resolution pixels; bounds the cost of close-ups
+    float intensity = 1.0f;         // exponent on the visibility
+    float sharpness = 16.0f;        // how strictly the blur and upsample respect depth edges
+    bool temporalNoise = true;      // rotates the sample pattern every frame, for TAA to average
+    bool enabled = true;
+};
+
+// Textures one Render() works in, e.g. transients of a frame graph. The intermediates are sized by
+// AmbientOcclusion::GetLowSize() for the output size; all use nearest filtering.
+struct AmbientOcclusionTargets {
+    Texture* viewDepth = nullptr;       // ViewDepthFormat, low resolution
+    Texture* occlusion[2] = {};         // OcclusionFormat, low resolution, blur ping-pong
+    Texture* output = nullptr;          // OcclusionFormat, at least the render size
+};
+
+// Screen-space ambient occlusion from the depth buffer (and G-buffer normals when there are any),
+// for shaders including ambient_occlusion.glsl. Four compute passes, each timed on its own: depth is
+// reduced to linear view depth at 1/downsample resolution, GTAO horizons are searched in it, the
+// result is blurred with a depth-aware separable filter and bilaterally upsampled to the render
+// resolution. Cost depends only on the resolution and the preset, never on the scene. The textures
+// come from the caller, so nothing is held between frames but the shaders.
+class AmbientOcclusion {
+    public:
+        static constexpr TextureInternalFormat ViewDepthFormat = TextureInternalFormat::R32F;
+        static constexpr TextureInternalFormat OcclusionFormat = TextureInternalFormat::R8;
+
+        explicit AmbientOcclusion(AmbientOcclusionQuality quality = AmbientOcclusionQuality::Medium);
+
+        // Applies the preset's cost settings; the radius and strength of the effect are left alone
+        void SetQuality(AmbientOcclusionQuality quality);
+        AmbientOcclusionQuality GetQuality() const { return quality; }
+
+        // Occlusion for the `renderSize` area of `depth` into `targets.output`, at the origin. `normals`
+        // are G-buffer normals (octahedral, world space) at the same size, or null to rebuild them from
+        // depth. Expects FrameUniforms uploaded for the frame `depth` was drawn with.
+        void Render(Texture& depth, Texture* normals, glm::ivec2 renderSize, const AmbientOcclusionTargets& targets);
+
+        // Binds `occlusion`, a Render() output, to unit 11; a white texture when null or disabled
+        void Bind(Texture* occlusion);
+
+        // Size of the low resolution intermediates for an output of `outputSize` at the current downsample
+        glm::ivec2 GetLowSize(glm::ivec2 outputSize) const;
+
+        // Times every sub-pass on `timer`, or none when null
+        void SetTimer(GpuTimer* gpuTimer) { timer = gpuTimer; }
+
+        AmbientOcclusionSettings settings;
+
+    private:
+        void begin(const char* name);
+        void end(const char* name);
+
+        AmbientOcclusionQuality quality;
+        GpuTimer* timer = nullptr;
+        uint32_t frameIndex = 0;
+
+        std::unique_ptr<Texture> white;
+
+        std::unique_ptr<ShaderProgram> depthProgram;
+        std::unique_ptr<ShaderProgram> horizonProgram;
+        std::unique_ptr<ShaderProgram> horizonNormalsProgram;
+        std::unique_ptr<ShaderProgram> blurProgram;
+        std::unique_ptr<ShaderProgram> upsampleProgram;
+};
+
+inline std::unique_ptr<AmbientOcclusion> CreateAmbientOcclusion(AmbientOcclusionQuality quality = AmbientOcclusionQuality::Medium) {
+    return std::make_unique<AmbientOcclusion>(quality);
+}
+
+// Settings with the preset's cost values and default everything else
+AmbientOcclusionSettings GetAmbientOcclusionPreset(AmbientOcclusionQuality quality);
@@ -2,12 +2,15 @@
 #include <iostream>
 
 Buffer::Buffer(BufferType type, size_t size, const void* data, BufferUsage usage, GLuint bindingPoint)
-    : target(
+    : bindingPoint(bindingPoint),
+      target(
         type == BufferType::Vertex  ? GL_ARRAY_BUFFER :
         type == BufferType::Index   ? GL_ELEMENT_ARRAY_BUFFER :
         type == BufferType::Uniform ? GL_UNIFORM_BUFFER :
         GL_SHADER_STORAGE_BUFFER
-      )
+      ),
+      size(size),
+      type(type)
 {
     glCreateBuffers(1, &id);
 
@@ -0,0 +1,71 @@
+#include "FrameUniforms.h"
+#include "../Camera/Camera.h"
+#include "../Shader/ShaderProgram.h"
+#include <iterator>
+#include <spdlog/spdlog.h>
+
+FrameUniforms::FrameUniforms()
+    : buffer(CreateBuffer(BufferType::Uniform, sizeof(FrameData), &data, BufferUsage::Dynamic, FrameData::Binding))
+{
+}
+
+void FrameUniforms::SetCamera(const Camera& camera, glm::ivec2 resolution) {
+    data.view = camera.GetViewMatrix();
+    data.projection = camera.GetProjectionMatrix();
+    data.viewProjection = data.projection * data.view;
+    data.inverseView = glm::inverse(data.view);
+    data.inverseProjection = glm::inverse(data.projection);
+    data.inverseViewProjection = glm::inverse(data.viewProjection);
+    data.cameraPosition = glm::vec4(camera.GetPosition(), 1.0f);
+    data.resolution = glm::vec2(resolution);
+
+    const glm::mat4 unjittered = camera.GetUnjitteredProjectionMatrix() * data.view;
+    data.previousViewProjection = hasCamera ? data.unjitteredViewProjection : unjittered;
+    data.unjitteredViewProjection = unjittered;
+    hasCamera = true;
+}
+
+void FrameUniforms::SetTime(float time, float deltaTime) {
+    data.time = time;
+    data.deltaTime = deltaTime;
+}
+
+void FrameUniforms::SetLight(const glm::vec3& direction, const glm::vec3& color, float intensity) {
+    data.lightDirection = glm::vec4(glm::normalize(direction), intensity);
+    data.lightColor = glm::vec4(color, 1.0f);
+}
+
+void FrameUniforms::SetAmbient(const glm::vec3& color) {
+    data.ambientColor = glm::vec4(color, 1.0f);
+}
+
+void FrameUniforms::Upload() {
+    // Rebinding is cheap and keeps the block at its slot even if something else used binding 0
+    glBindBufferBase(GL_UNIFORM_BUFFER, FrameData::Binding, buffer->id);
+    buffer->UpdateBuffer(&data, sizeof(FrameData));
+}
+
+bool FrameUniforms::Validate(const ShaderProgram& program) const {
+    for (const auto& block : UniformReflection::ReflectBlocks(program.program)) {
+        if (block.name != FrameData::BlockName) continue;
+
+        auto errors = UniformReflection::Compare(block, FrameDataFields, std::size(FrameDataFields), sizeof(FrameData));
+        if (block.binding != FrameData::Binding) {
+            errors.push_back("FrameData is bound to " + std::to_string(block.binding) + " instead of " +
+                             std::to_string(FrameData::Binding));
+        }
+        for (const auto& error : errors) {
+            spdlog::error("Program {}: {}", program.program, error);
+        }
+        return errors.empty();
+    }
+    return true;
+}
+
+size_t FrameUniforms::ValidateAll() const {
+    size_t failed = 0;
+    for (const ShaderProgram* program : ShaderProgram::GetPrograms()) {
+        if (!Validate(*program)) ++failed;
+    }
+    return failed;
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <glm/glm.hpp>
+#include "Buffer.h"
+#include "../Shader/UniformReflection.h"
+
+class Camera;
+class ShaderProgram;
+
+// C++ mirror of the std140 FrameData block in Shader/include/frame.glsl. The offsets below are
+// checked at compile time; Validate() checks the shader side against the same table as programs link.
+struct FrameData {
+    glm::mat4 view{1.0f};
+    glm::mat4 projection{1.0f};
+    glm::mat4 viewProjection{1.0f};
+    glm::mat4 inverseView{1.0f};
+    glm::mat4 inverseProjection{1.0f};
+    glm::mat4 inverseViewProjection{1.0f};
+    glm::vec4 cameraPosition{0.0f, 0.0f, 0.0f, 1.0f};
+    glm::vec2 resolution{0.0f};
+    float time = 0.0f;
+    float deltaTime = 0.0f;
+    glm::vec4 lightDirection{-1.0f, -1.0f, -1.0f, 1.0f};
+    glm::vec4 lightColor{1.0f};
+    glm::vec4 ambientColor{0.4f, 0.4f, 0.4f, 1.0f};
+    glm::mat4 unjitteredViewProjection{1.0f};
+    glm::mat4 previousViewProjection{1.0f};    // last frame's, unjittered
+
+    static constexpr GLuint Binding = 0;
+    static constexpr const char* BlockName = "FrameData";
+};
+
+static_assert(offsetof(FrameData, view) == 0);
+static_assert(offsetof(FrameData, projection) == 64);
+static_assert(offsetof(FrameData, viewProjection) == 128);
+static_assert(offsetof(FrameData, inverseView) == 192);
+static_assert(offsetof(FrameData, inverseProjection) == 256);
+static_assert(offsetof(FrameData, inverseViewProjection) == 320);
+static_assert(offsetof(FrameData, cameraPosition) == 384);
+static_assert(offsetof(FrameData, resolution) == 400);
+static_assert(offsetof(FrameData, time) == 408);
+static_assert(offsetof(FrameData, deltaTime) == 412);
+static_assert(offsetof(FrameData, lightDirection) == 416);
+static_assert(offsetof(FrameData, lightColor) == 432);
+static_assert(offsetof(FrameData, ambientColor) == 448);
+static_assert(offsetof(FrameData, unjitteredViewProjection) == 464);
+static_assert(offsetof(FrameData, previousViewProjection) == 528);
+static_assert(sizeof(FrameData) == 592, "FrameData must match the std140 size of the GLSL block");
+
+#define FRAME_DATA_FIELD(member) UniformField{#member, offsetof(FrameData, member), sizeof(FrameData::member)}
+
+inline constexpr UniformField FrameDataFields[] = {
+    FRAME_DATA_FIELD(view),
+    FRAME_DATA_FIELD(projection),
+    FRAME_DATA_FIELD(viewProjection),
+    FRAME_DATA_FIELD(inverseView),
+    FRAME_DATA_FIELD(inverseProjection),
+    FRAME_DATA_FIELD(inverseViewProjection),
+    FRAME_DATA_FIELD(cameraPosition),
+    FRAME_DATA_FIELD(resolution),
+    FRAME_DATA_FIELD(time),
+    FRAME_DATA_FIELD(deltaTime),
+    FRAME_DATA_FIELD(lightDirection),
+    FRAME_DATA_FIELD(lightColor),
+    FRAME_DATA_FIELD(ambientColor),
+    FRAME_DATA_FIELD(unjitteredViewProjection),
+    FRAME_DATA_FIELD(previousViewProjection),
+};
+
+#undef FRAME_DATA_FIELD
+
+// Owns the per-frame globals UBO. Fill `data` through the setters or directly, then Upload() once
+// per frame before drawing; every program including frame.glsl reads it from binding 0.
+class FrameUniforms {
+    public:
+        FrameUniforms();
+
+        // View, projection, their products and inverses, and the camera position. The previous
+        // view-projection is the one from the last call, so call once per frame.
+        void SetCamera(const Camera& camera, glm::ivec2 resolution);
+        void SetTime(float time, float deltaTime);
+        void SetLight(const glm::vec3& direction, const glm::vec3& color, float intensity = 1.0f);
+        void SetAmbient(const glm::vec3& color);
+
+        void Upload();
+
+        // Compares the program's FrameData block with the C++ layout, logging every mismatch.
+        // Programs that do not use the block pass.
+        bool Validate(const ShaderProgram& program) const;
+        // Validates every live program; returns the number that failed
+        size_t ValidateAll() const;
+
+        FrameData data;
+
+    private:
+        std::unique_ptr<Buffer> buffer;
+        bool hasCamera = false;
+};
+
+inline std::unique_ptr<FrameUniforms> CreateFrameUniforms() {
+    return std::make_unique<FrameUniforms>();
+}
@@ -4,7 +4,7 @@
 
 Camera::Camera(float fov, float aspect, float nearClip, float farClip)
     : m_FOV(fov), m_Aspect(aspect), m_Near(nearClip), m_Far(farClip),
-      m_Position(0.0f), m_Rotation(0.0f, -90.0f) {
+      m_Position(0.0f), m_Rotation(0.0f, -90.0f), m_Jitter(0.0f) {
     m_ProjectionMatrix = glm::perspective(glm::radians(fov), aspect, nearClip, farClip);
     RecalculateVectors();
     UpdateView();
@@ -23,7 +23,16 @@ const glm::vec2& Camera::GetRotation() const { return m_Rotation; }
 const glm::vec3& Camera::GetForward() const { return m_Forward; }
 const glm::vec3& Camera::GetRight() const { return m_Right; }
 glm::mat4 Camera::GetViewMatrix() const { return m_ViewMatrix; }
-glm::mat4 Camera::GetProjectionMatrix() const { return m_ProjectionMatrix; }
+glm::mat4 Camera::GetProjectionMatrix() const {
+    // Clip w is -z, so the third column moves NDC by minus its value
+    glm::mat4 projection = m_ProjectionMatrix;
+    projection[2][0] -= m_Jitter.x;
+    projection[2][1] -= m_Jitter.y;
+    return projection;
+}
+glm::mat4 Camera::GetUnjitteredProjectionMatrix() const { return m_ProjectionMatrix; }
+void Camera::SetJitter(const glm::vec2& ndcOffset) { m_Jitter = ndcOffset; }
+const glm::vec2& Camera::GetJitter() const { return m_Jitter; }
 
     void Camera::SetProjection(float fov, float aspectRatio, float nearClip, float farClip) {
     m_FOV = fov;
@@ -15,9 +15,20 @@ public:
     const glm::vec3& GetForward() const;
     const glm::vec3& GetRight() const;
     glm::mat4 GetViewMatrix() const;
+    // Includes the jitter; what geometry is rasterized with
     glm::mat4 GetProjectionMatrix() const;
+    glm::mat4 GetUnjitteredProjectionMatrix() const;
+
+    // Shifts the projected image by `ndcOffset` (2 / resolution per pixel), for temporal
+    // anti-aliasing; zero turns it off
+    void SetJitter(const glm::vec2& ndcOffset);
+    const glm::vec2& GetJitter() const;
 
     void SetProjection(float fov, float aspectRatio, float nearClip, float farClip);
+    float GetFOV() const { return m_FOV; }          // vertical, degrees
+    float GetAspectRatio() const { return m_Aspect; }
+    float GetNearClip() const { return m_Near; }
+    float GetFarClip() const { return m_Far; }
     void SetAspectRatio(float aspectRatio);
 
     void UpdateView();
@@ -30,6 +41,7 @@ public:
 
     glm::mat4 m_ViewMatrix;
     glm::mat4 m_ProjectionMatrix;
+    glm::vec2 m_Jitter;
 
     void RecalculateVectors();
 };
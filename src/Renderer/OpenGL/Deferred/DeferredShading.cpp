@@ -0,0 +1,68 @@
+#include "DeferredShading.h"
+#include <stdexcept>
+#include "../Material/Material.h"
+
+DeferredShading::DeferredShading()
+    : gbuffer(CreateGBuffer())
+{
+    gbufferVariants = CreateShaderVariantCache({{ShaderStage::Vertex, "Shader/model.vert.glsl"},
+                                                {ShaderStage::Fragment, "Shader/gbuffer.frag.glsl"}},
+                                               GetMaterialFeatureDefines());
+
+    auto vertex = CreateShader(ShaderStage::Vertex, "Shader/fullscreen.vert.glsl");
+    auto fragment = CreateShader(ShaderStage::Fragment, "Shader/deferred_lighting.frag.glsl");
+    lightingProgram = CreateShaderProgram({vertex.get(), fragment.get()});
+
+    fullscreenVao = CreateVertexArray();
+}
+
+void DeferredShading::Render(const std::vector<MeshDrawItem>& items, DepthPrepass& prepass,
+                             const GBuffer::Textures& textures, RenderTarget& output) {
+    FillGBuffer(items, prepass, textures, output);
+    Light(textures, output);
+}
+
+void DeferredShading::FillGBuffer(const std::vector<MeshDrawItem>& items, DepthPrepass& prepass,
+                                  const GBuffer::Textures& textures, const RenderTarget& output) {
+    gbuffer->Attach(textures);
+    if (gbuffer->GetSize() != output.GetSize()) {
+        throw std::runtime_error("G-buffer textures are not the size of the lighting output");
+    }
+    gbuffer->SetViewport(output.GetViewport());
+
+    const GLboolean blend = glIsEnabled(GL_BLEND);
+    const GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+    glDisable(GL_BLEND);
+    glEnable(GL_DEPTH_TEST);
+
+    gbuffer->Bind();
+
+    prepass.DrawOpaque(items, gbufferVariants.get());
+
+    if (blend) glEnable(GL_BLEND);
+    if (!depthTest) glDisable(GL_DEPTH_TEST);
+}
+
+void DeferredShading::Light(const GBuffer::Textures& textures, RenderTarget& output) {
+    gbuffer->Attach(textures);
+
+    GLint depthFunc;
+    glGetIntegerv(GL_DEPTH_FUNC, &depthFunc);
+    const GLboolean blend = glIsEnabled(GL_BLEND);
+    glDisable(GL_BLEND);
+
+    // Once per covered pixel
+    output.Bind();
+    glDisable(GL_DEPTH_TEST);
+
+    gbuffer->BindForSampling(0);
+    lightingProgram->useShaderProgram();
+    fullscreenVao->bind();
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    gbuffer->BlitDepth(output.id);
+
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(depthFunc);
+    if (blend) glEnable(GL_BLEND);
+}
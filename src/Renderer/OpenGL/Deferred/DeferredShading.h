@@ -0,0 +1,51 @@
+#pragma once
+
+#include <memory>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "GBuffer.h"
+#include "../DepthPrepass/DepthPrepass.h"
+#include "../Mesh/Mesh.h"
+#include "../Shader/ShaderProgram.h"
+#include "../Shader/ShaderVariants.h"
+#include "../Vertex/VertexArray.h"
+
+// Which path shades opaque geometry; both use the same lights and produce the same image
+enum class RenderPath {
+    Forward,
+    Deferred
+};
+
+// Deferred path: the opaque pass of DepthPrepass fills the G-buffer (at GL_EQUAL with depth writes
+// off when the prepass is on, so every pixel runs the material shader once), then a fullscreen
+// lighting pass shades each visible pixel once with the sun and the clustered lights. Expects
+// FrameUniforms uploaded and ClusteredLighting bound, exactly like the forward path.
+class DeferredShading {
+    public:
+        DeferredShading();
+
+        // Draws the opaque `items` through `prepass` into the G-buffer `textures`, sized like `output`
+        // and drawn over its viewport. Lighting goes to `output`, which the caller has cleared; its
+        // depth is replaced by the G-buffer's so forward passes drawn afterwards still depth test.
+        void Render(const std::vector<MeshDrawItem>& items, DepthPrepass& prepass, const GBuffer::Textures& textures,
+                    RenderTarget& output);
+
+        // Render() in two halves, for passes that read the G-buffer before lighting, e.g. ambient
+        // occlusion: FillGBuffer() draws the opaque `items`, Light() shades them into `output`
+        void FillGBuffer(const std::vector<MeshDrawItem>& items, DepthPrepass& prepass,
+                         const GBuffer::Textures& textures, const RenderTarget& output);
+        void Light(const GBuffer::Textures& textures, RenderTarget& output);
+
+        // Variants the G-buffer pass draws materials with, e.g. for Model::PrewarmShaderVariants
+        ShaderVariantCache& GetGBufferVariants() { return *gbufferVariants; }
+
+    private:
+        std::unique_ptr<GBuffer> gbuffer;
+        std::shared_ptr<ShaderVariantCache> gbufferVariants;
+        std::unique_ptr<ShaderProgram> lightingProgram;
+        std::unique_ptr<VertexArray> fullscreenVao;
+};
+
+inline std::unique_ptr<DeferredShading> CreateDeferredShading() {
+    return std::make_unique<DeferredShading>();
+}
@@ -0,0 +1,94 @@
+#include "GBuffer.h"
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "../Texture/Sampler.h"
+
+GBuffer::GBuffer() {
+    glCreateFramebuffers(1, &id);
+
+    std::vector<GLenum> drawBuffers;
+    for (size_t i = 0; i < ColorCount; ++i) drawBuffers.push_back(GL_COLOR_ATTACHMENT0 + static_cast<GLenum>(i));
+    glNamedFramebufferDrawBuffers(id, static_cast<GLsizei>(drawBuffers.size()), drawBuffers.data());
+}
+
+GBuffer::~GBuffer() {
+    glDeleteFramebuffers(1, &id);
+}
+
+RenderTargetDesc GBuffer::GetDesc() {
+    RenderTargetDesc desc;
+    desc.colorFormats = {TextureInternalFormat::RGBA8, TextureInternalFormat::RG16F,
+                         TextureInternalFormat::RGBA8, TextureInternalFormat::R11G11B10F,
+                         TextureInternalFormat::RG16F};
+    desc.depthFormat = TextureInternalFormat::Depth24;
+    desc.filter = TextureFilter::Nearest;
+    return desc;
+}
+
+void GBuffer::Attach(const Textures& newTextures) {
+    if (newTextures.colors == textures.colors && newTextures.depth == textures.depth) return;
+
+    if (!newTextures.depth) throw std::runtime_error("G-buffer needs a depth texture");
+    const glm::ivec2 size{newTextures.depth->width, newTextures.depth->height};
+    for (size_t i = 0; i < ColorCount; ++i) {
+        const Texture* color = newTextures.colors[i];
+        if (!color || color->width != size.x || color->height != size.y) {
+            throw std::runtime_error("G-buffer color attachment " + std::to_string(i) + " is missing or not " +
+                                     std::to_string(size.x) + "x" + std::to_string(size.y));
+        }
+        glNamedFramebufferTexture(id, GL_COLOR_ATTACHMENT0 + static_cast<GLenum>(i), color->id, 0);
+    }
+    glNamedFramebufferTexture(id, GL_DEPTH_ATTACHMENT, newTextures.depth->id, 0);
+
+    GLenum status = glCheckNamedFramebufferStatus(id, GL_FRAMEBUFFER);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        throw std::runtime_error("G-buffer incomplete, status " + std::to_string(status));
+    }
+    textures = newTextures;
+}
+
+glm::ivec2 GBuffer::GetSize() const {
+    return textures.depth ? glm::ivec2(textures.depth->width, textures.depth->height) : glm::ivec2(0);
+}
+
+void GBuffer::Bind() {
+    if (!textures.depth) throw std::runtime_error("G-buffer bound before its textures were attached");
+
+    glBindFramebuffer(GL_FRAMEBUFFER, id);
+    const glm::ivec2 area = viewport == glm::ivec2(0) ? GetSize() : glm::min(viewport, GetSize());
+    glViewport(0, 0, area.x, area.y);
+
+    // Clears honour the write masks
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    glDepthMask(GL_TRUE);
+
+    const glm::vec4 color(0.0f);
+    const float depth = 1.0f;
+    for (size_t i = 0; i < ColorCount; ++i) {
+        glClearNamedFramebufferfv(id, GL_COLOR, static_cast<GLint>(i), &color[0]);
+    }
+    glClearNamedFramebufferfv(id, GL_DEPTH, 0, &depth);
+}
+
+void GBuffer::BindForSampling(GLuint firstUnit) {
+    std::vector<GLuint> ids;
+    std::vector<GLuint> samplers;
+    for (Texture* color : textures.colors) {
+        if (!color) continue;
+        ids.push_back(color->id);
+        samplers.push_back(color->sampler->id);
+    }
+    if (textures.depth) {
+        ids.push_back(textures.depth->id);
+        samplers.push_back(textures.depth->sampler->id);
+    }
+    glBindTextures(firstUnit, static_cast<GLsizei>(ids.size()), ids.data());
+    glBindSamplers(firstUnit, static_cast<GLsizei>(samplers.size()), samplers.data());
+}
+
+void GBuffer::BlitDepth(GLuint framebuffer) {
+    const glm::ivec2 size = GetSize();
+    glBlitNamedFramebuffer(id, framebuffer, 0, 0, size.x, size.y, 0, 0, size.x, size.y, GL_DEPTH_BUFFER_BIT,
+                           GL_NEAREST);
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "../Framebuffer/RenderTarget.h"
+
+// Multi-render-target G-buffer, 24 bytes per pixel; layout documented in Shader/include/gbuffer.glsl.
+// Color attachments in order: albedo RGBA8 (albedo, occlusion), normal RG16F (octahedral),
+// material RGBA8 (metallic, roughness), emissive R11G11B10F, velocity RG16F; then DEPTH_COMPONENT24.
+// Only the framebuffer is owned; the textures are attached for each frame, e.g. as frame graph
+// transients allocated from GetDesc().
+class GBuffer {
+    public:
+        static constexpr size_t ColorCount = 5;
+
+        // One frame's attachments, all the same size, in the formats of GetDesc()
+        struct Textures {
+            std::array<Texture*, ColorCount> colors{};
+            Texture* depth = nullptr;
+        };
+
+        GBuffer();
+        ~GBuffer();
+
+        GBuffer(const GBuffer&) = delete;
+        GBuffer& operator=(const GBuffer&) = delete;
+
+        // Attaches `textures` to the framebuffer; nothing happens when they already are
+        void Attach(const Textures& textures);
+        // Part of the G-buffer drawn to, see RenderTarget::SetViewport
+        void SetViewport(glm::ivec2 viewport) { this->viewport = viewport; }
+
+        // Binds the framebuffer for writing and clears color and depth
+        void Bind();
+
+        // Albedo, normal, material, emissive, velocity and depth on consecutive texture units
+        void BindForSampling(GLuint firstUnit = 0);
+
+        // Copies depth into `framebuffer` so later forward passes test against the G-buffer geometry
+        void BlitDepth(GLuint framebuffer);
+
+        glm::ivec2 GetSize() const;
+
+        static RenderTargetDesc GetDesc();
+
+        GLuint id = 0;
+
+    private:
+        Textures textures;
+        glm::ivec2 viewport{0};
+};
+
+inline std::unique_ptr<GBuffer> CreateGBuffer() {
+    return std::make_unique<GBuffer>();
+}
@@ -0,0 +1,140 @@
+#include "DepthPrepass.h"
+
+DepthPrepass::DepthPrepass() {
+    // No fragment stage: depth is all the prepass produces
+    auto vertex = CreateShader(ShaderStage::Vertex, "Shader/depth_only.vert.glsl");
+    depthProgram = CreateShaderProgram({vertex.get()});
+}
+
+void DepthPrepass::DrawDepth(const std::vector<MeshDrawItem>& items) {
+    sorted = items;
+    SortMeshDrawItems(sorted, prepassOrder);
+    DrawMeshItemPositions(sorted, *depthProgram);
+}
+
+void DepthPrepass::DrawOpaque(const std::vector<MeshDrawItem>& items, ShaderVariantCache* passVariants) {
+    if (enabled) LayDepth(items);
+    DrawShaded(items, passVariants, enabled);
+}
+
+void DepthPrepass::LayDepth(const std::vector<MeshDrawItem>& items) {
+    GLint depthFunc;
+    GLboolean depthMask;
+    GLboolean colorMask[4];
+    glGetIntegerv(GL_DEPTH_FUNC, &depthFunc);
+    glGetBooleanv(GL_DEPTH_WRITEMASK, &depthMask);
+    glGetBooleanv(GL_COLOR_WRITEMASK, colorMask);
+
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    glDepthMask(GL_TRUE);
+    glDepthFunc(GL_LESS);
+    DrawDepth(items);
+
+    glColorMask(colorMask[0], colorMask[1], colorMask[2], colorMask[3]);
+    glDepthMask(depthMask);
+    glDepthFunc(depthFunc);
+}
+
+void DepthPrepass::DrawShaded(const std::vector<MeshDrawItem>& items, ShaderVariantCache* passVariants, bool depthLaid) {
+    GLint depthFunc;
+    GLboolean depthMask;
+    glGetIntegerv(GL_DEPTH_FUNC, &depthFunc);
+    glGetBooleanv(GL_DEPTH_WRITEMASK, &depthMask);
+
+    if (depthLaid) {
+        // Only the nearest surface passes, so hidden fragments are rejected before shading
+        glDepthMask(GL_FALSE);
+        glDepthFunc(GL_EQUAL);
+    } else {
+        glDepthMask(GL_TRUE);
+        glDepthFunc(GL_LESS);
+    }
+
+    sorted = items;
+    SortMeshDrawItems(sorted, mainOrder);
+    DrawMeshItems(sorted, passVariants);
+
+    glDepthMask(depthMask);
+    glDepthFunc(depthFunc);
+}
+
+DepthComplexity::DepthComplexity(int width, int height) {
+    RenderTargetDesc desc;
+    desc.colorFormats = {TextureInternalFormat::R16F};
+    desc.depthFormat = TextureInternalFormat::Depth24;
+    desc.filter = TextureFilter::Nearest;
+    target = CreateRenderTarget(desc, {width, height});
+
+    auto vertex = CreateShader(ShaderStage::Vertex, "Shader/depth_only.vert.glsl");
+    auto count = CreateShader(ShaderStage::Fragment, "Shader/depth_complexity_count.frag.glsl");
+    countProgram = CreateShaderProgram({vertex.get(), count.get()});
+
+    auto fullscreen = CreateShader(ShaderStage::Vertex, "Shader/fullscreen.vert.glsl");
+    auto heatMap = CreateShader(ShaderStage::Fragment, "Shader/depth_complexity.frag.glsl");
+    heatMapProgram = CreateShaderProgram({fullscreen.get(), heatMap.get()});
+
+    fullscreenVao = CreateVertexArray();
+}
+
+void DepthComplexity::Render(const std::vector<MeshDrawItem>& items, DepthPrepass& prepass, DepthComplexityView view,
+                             RenderTarget& output) {
+    if (view == DepthComplexityView::Off) return;
+
+    target->Resize(output.GetSize());
+    target->SetViewport(output.GetViewport());
+
+    GLint depthFunc, blendSrcRgb, blendDstRgb, blendSrcAlpha, blendDstAlpha;
+    GLboolean depthMask;
+    glGetIntegerv(GL_DEPTH_FUNC, &depthFunc);
+    glGetBooleanv(GL_DEPTH_WRITEMASK, &depthMask);
+    glGetIntegerv(GL_BLEND_SRC_RGB, &blendSrcRgb);
+    glGetIntegerv(GL_BLEND_DST_RGB, &blendDstRgb);
+    glGetIntegerv(GL_BLEND_SRC_ALPHA, &blendSrcAlpha);
+    glGetIntegerv(GL_BLEND_DST_ALPHA, &blendDstAlpha);
+    const GLboolean blend = glIsEnabled(GL_BLEND);
+    const GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+
+    target->Bind();
+    target->Clear(glm::vec4(0.0f), 1.0f);
+
+    if (view == DepthComplexityView::Rasterized) {
+        glDisable(GL_DEPTH_TEST);
+    } else {
+        // Replays exactly what DepthPrepass::DrawOpaque does, counting instead of shading
+        glEnable(GL_DEPTH_TEST);
+        if (prepass.enabled) {
+            glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+            glDepthFunc(GL_LESS);
+            prepass.DrawDepth(items);
+            glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+            glDepthMask(GL_FALSE);
+            glDepthFunc(GL_EQUAL);
+        } else {
+            glDepthFunc(GL_LESS);
+        }
+    }
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE);
+
+    std::vector<MeshDrawItem> sorted = items;
+    SortMeshDrawItems(sorted, prepass.mainOrder);
+    DrawMeshItemPositions(sorted, *countProgram);
+
+    // Heat map over the caller's target
+    glDisable(GL_BLEND);
+    glDisable(GL_DEPTH_TEST);
+    output.Bind();
+
+    target->GetColor(0).BindTextureForSampling(0);
+    heatMapProgram->useShaderProgram();
+    heatMapProgram->SetUniform1f("u_maxCount", maxCount);
+    fullscreenVao->bind();
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    glBlendFuncSeparate(blendSrcRgb, blendDstRgb, blendSrcAlpha, blendDstAlpha);
+    if (blend) glEnable(GL_BLEND);
+    if (depthTest) glEnable(GL_DEPTH_TEST);
+    glDepthFunc(depthFunc);
+    glDepthMask(depthMask);
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "../Mesh/Mesh.h"
+#include "../Shader/ShaderProgram.h"
+#include "../Shader/ShaderVariants.h"
+#include "../Framebuffer/RenderTarget.h"
+
+// Optional depth-only prepass for opaque geometry. The prepass draws each mesh's position stream
+// with a vertex-only program, so it costs no fragment shading and no attribute fetch beyond 12 bytes
+// per vertex; the shaded pass then runs at GL_EQUAL with depth writes off, so every pixel runs its
+// material shader exactly once whatever the overdraw. Worth it when the scene's depth complexity is
+// well above one; disable it for sparse views where the extra geometry pass costs more than it saves.
+class DepthPrepass {
+    public:
+        DepthPrepass();
+
+        // Lays down depth (if enabled) and shades `items` with their materials or their variants from
+        // `passVariants`, into the bound framebuffer. Leaves depth func and write mask as it found them.
+        void DrawOpaque(const std::vector<MeshDrawItem>& items, ShaderVariantCache* passVariants = nullptr);
+
+        // DrawOpaque() in two halves, for passes that read depth before shading, e.g. ambient
+        // occlusion. LayDepth() draws the prepass whether or not `enabled`; DrawShaded() then shades at
+        // GL_EQUAL when `depthLaid`, or with an ordinary depth test otherwise. Both leave the depth and
+        // color state as they found it.
+        void LayDepth(const std::vector<MeshDrawItem>& items);
+        void DrawShaded(const std::vector<MeshDrawItem>& items, ShaderVariantCache* passVariants, bool depthLaid);
+
+        // Depth only, in prepassOrder, with whatever depth state is set
+        void DrawDepth(const std::vector<MeshDrawItem>& items);
+
+        // Vertex-only position program, for other passes that rasterize the position streams
+        ShaderProgram& GetProgram() { return *depthProgram; }
+
+        bool enabled = true;
+        // Front to back lets the prepass itself reject early; once depth is resolved the shaded pass
+        // has no overdraw left to save, so it sorts to minimise state changes instead
+        DrawSortOrder prepassOrder = DrawSortOrder::FrontToBack;
+        DrawSortOrder mainOrder = DrawSortOrder::ByMaterial;
+
+    private:
+        std::unique_ptr<ShaderProgram> depthProgram;
+        std::vector<MeshDrawItem> sorted;
+};
+
+// What the depth-complexity view counts per pixel
+enum class DepthComplexityView {
+    Off,
+    Rasterized,     // every fragment rasterized, depth test off: the raw overdraw of the view
+    Shaded          // fragments that would run the material shader with the current prepass settings
+};
+
+// Debug view of the overdraw DepthPrepass removes: counts fragments per pixel into an R16F target
+// with additive blending and draws them as a heat map over the given target.
+class DepthComplexity {
+    public:
+        DepthComplexity(int width, int height);
+
+        // Counts at the size and viewport of `output`, then draws the heat map into it
+        void Render(const std::vector<MeshDrawItem>& items, DepthPrepass& prepass, DepthComplexityView view,
+                    RenderTarget& output);
+
+        // Count shown as full red
+        float maxCount = 8.0f;
+
+    private:
+        std::unique_ptr<RenderTarget> target;       // R16F counts, 24-bit depth
+        std::unique_ptr<ShaderProgram> countProgram;
+        std::unique_ptr<ShaderProgram> heatMapProgram;
+        std::unique_ptr<VertexArray> fullscreenVao;
+};
+
+inline std::unique_ptr<DepthPrepass> CreateDepthPrepass() {
+    return std::make_unique<DepthPrepass>();
+}
+
+inline std::unique_ptr<DepthComplexity> CreateDepthComplexity(int width, int height) {
+    return std::make_unique<DepthComplexity>(width, height);
+}
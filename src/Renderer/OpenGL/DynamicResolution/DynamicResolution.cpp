@@ -0,0 +1,92 @@
+#include "DynamicResolution.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+DynamicResolutionController::DynamicResolutionController(const DynamicResolutionSettings& settings)
+    : settings(settings)
+{
+    if (settings.budgetMs <= 0.0 || settings.minScale <= 0.0f || settings.minScale > settings.maxScale ||
+        settings.step <= 0.0f) {
+        throw std::runtime_error("Invalid dynamic resolution settings");
+    }
+    scale = quantize(settings.maxScale);
+}
+
+float DynamicResolutionController::Update(double gpuMilliseconds) {
+    if (settle > 0) {
+        --settle;
+        return scale;
+    }
+
+    // Clamped, so one hitch cannot drag the average over budget on its own
+    const double sample = std::min(gpuMilliseconds, settings.budgetMs * 1.25);
+    average = hasAverage ? average + settings.smoothing * (sample - average) : sample;
+    hasAverage = true;
+    if (average <= 0.0) return scale;
+
+    // Two frames in a row far over budget is a new load rather than a hitch; react to the lighter
+    // of the two without waiting for the average to catch up
+    const bool overloaded = gpuMilliseconds > settings.budgetMs * 1.5;
+    const double overload = overloaded ? std::min(gpuMilliseconds, previous) : 0.0;
+    previous = overloaded ? gpuMilliseconds : 0.0;
+    if (overloaded && overload > settings.budgetMs * 1.5) {
+        underBudgetFrames = 0;
+        setScale(std::min(quantize(estimate(overload, settings.headroom)), scale - settings.step));
+        return scale;
+    }
+
+    if (average > settings.budgetMs) {
+        // The average lags a rising load; the latest frame is the better guess of what comes next
+        underBudgetFrames = 0;
+        setScale(std::min(quantize(estimate(std::max(average, gpuMilliseconds), settings.headroom)), scale - settings.step));
+        return scale;
+    }
+
+    if (average > settings.budgetMs * settings.headroom || scale >= settings.maxScale) {
+        underBudgetFrames = 0;
+        return scale;
+    }
+
+    if (++underBudgetFrames >= settings.increaseDelay) {
+        underBudgetFrames = 0;
+        const float target = quantize(std::min(estimate(average, settings.headroom), scale + settings.maxIncrease));
+        if (target > scale) setScale(target);
+    }
+    return scale;
+}
+
+void DynamicResolutionController::Reset() {
+    scale = quantize(settings.maxScale);
+    average = 0.0;
+    previous = 0.0;
+    hasAverage = false;
+    settle = 0;
+    underBudgetFrames = 0;
+}
+
+glm::ivec2 DynamicResolutionController::GetRenderSize(glm::ivec2 outputSize) const {
+    return glm::max(glm::ivec2(glm::round(glm::vec2(outputSize) * scale)), glm::ivec2(1));
+}
+
+float DynamicResolutionController::estimate(double milliseconds, double budgetFraction) const {
+    // Time taken as proportional to pixel count, i.e. to the scale squared
+    return scale * static_cast<float>(std::sqrt(settings.budgetMs * budgetFraction / milliseconds));
+}
+
+float DynamicResolutionController::quantize(float value) const {
+    // Rounded down to a step, with a little slack so 0.85 / 0.05 does not floor to 16
+    const float steps = std::floor(value / settings.step + 1e-3f);
+    return std::clamp(steps * settings.step, settings.minScale, settings.maxScale);
+}
+
+void DynamicResolutionController::setScale(float newScale) {
+    newScale = std::clamp(newScale, settings.minScale, settings.maxScale);
+    if (newScale == scale) return;
+
+    scale = newScale;
+    settle = settings.settleFrames;
+    previous = 0.0;
+    // The average describes the old scale; the first result at the new one restarts it
+    hasAverage = false;
+}
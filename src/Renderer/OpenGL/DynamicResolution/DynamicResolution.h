@@ -0,0 +1,59 @@
+#pragma once
+
+#include <memory>
+#include <glm/glm.hpp>
+
+struct DynamicResolutionSettings {
+    double budgetMs = 8.3;          // GPU frame time to hold
+    double headroom = 0.85;         // scales up only while under this fraction of the budget
+    float minScale = 0.5f;          // per axis, of the output size
+    float maxScale = 1.0f;
+    float step = 0.05f;             // scales are multiples of this, so the viewport does not creep
+    float maxIncrease = 0.1f;       // per change; decreases jump straight to the estimate
+    int increaseDelay = 30;         // consecutive frames under headroom before scaling up
+    int settleFrames = 4;           // measurements skipped after a change, at least the timer latency
+    double smoothing = 0.25;        // weight of each new measurement in the running average
+};
+
+// Picks the scene's render scale from measured GPU frame times. Pure CPU and deterministic, so it can
+// be driven by recorded or synthetic traces. Cost is modelled as proportional to pixel count, i.e.
+// the scale squared: when the average goes over budget, or two frames in a row are far over it, the
+// scale drops at once to the estimate for the headroom; under the headroom for `increaseDelay` frames
+// it climbs by at most `maxIncrease`. Between the two it holds, and results from frames rendered
+// before a change are ignored, which keeps it from oscillating.
+class DynamicResolutionController {
+    public:
+        explicit DynamicResolutionController(const DynamicResolutionSettings& settings = {});
+
+        // Feeds one GPU frame time and returns the scale for the next frame
+        float Update(double gpuMilliseconds);
+
+        // Back to maxScale with no history
+        void Reset();
+
+        float GetScale() const { return scale; }
+        // `outputSize` scaled, rounded, at least 1x1
+        glm::ivec2 GetRenderSize(glm::ivec2 outputSize) const;
+
+        double GetAverageMilliseconds() const { return average; }
+        const DynamicResolutionSettings& GetSettings() const { return settings; }
+
+    private:
+        // Scale at which `milliseconds` measured at the current scale would become that fraction of the budget
+        float estimate(double milliseconds, double budgetFraction) const;
+        float quantize(float value) const;
+        void setScale(float newScale);
+
+        DynamicResolutionSettings settings;
+        float scale;
+        double average = 0.0;
+        double previous = 0.0;          // last measurement if it was far over budget
+        bool hasAverage = false;
+        int settle = 0;
+        int underBudgetFrames = 0;
+};
+
+inline std::unique_ptr<DynamicResolutionController> CreateDynamicResolutionController(
+    const DynamicResolutionSettings& settings = {}) {
+    return std::make_unique<DynamicResolutionController>(settings);
+}
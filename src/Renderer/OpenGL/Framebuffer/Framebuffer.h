@@ -2,39 +2,35 @@
 
 #include <memory>
 #include <glad/glad.h>
+#include "RenderTarget.h"
 #include "../Texture/Texture.h"
 #include "../Window/Window.h"
-#include "../Vertex/VertexArray.h"
-#include "../Vertex/FBOVertex.h"
-#include "../Buffer/Buffer.h"
-#include "../Shader/ShaderProgram.h"
 
 extern GLuint selectedFramebuffer;
 
-extern float fboVertices[];
-extern unsigned int fboIndices[];
-
+// Offscreen HDR scene target: color, velocity (Shader/include/velocity.glsl) and depth. Follows the
+// window size; the attachments are recreated lazily by the RenderTarget underneath. Getting it onto
+// the window is the post stack's job.
 class Framebuffer {
     public:
-        Framebuffer(ShaderProgram& program);
-        ~Framebuffer();
+        explicit Framebuffer(const RenderTargetDesc& desc = GetDefaultDesc());
+        ~Framebuffer() = default;
 
         void BindFramebuffer(GLuint fbo);
         void UnbindFramebuffer(GLuint fbo);
 
+        RenderTarget& GetTarget() { return *target; }
+        Texture& GetColor() { return target->GetColor(0); }
+        Texture& GetVelocity() { return target->GetColor(1); }
+
+        // RGBA16F color, RG16F velocity and 24-bit depth
+        static RenderTargetDesc GetDefaultDesc();
+
         GLuint id;
-        GLuint rbo;
     private:
-        void CreateFramebufferTex();
-        void DrawFramebuffer();
-
-        ShaderProgram& fboShaderProgram;
-        std::unique_ptr<VertexArray> vaoFBO;
-        std::unique_ptr<Buffer> vboFBO;
-        std::unique_ptr<Buffer> eboFBO;
-        std::unique_ptr<Texture> texFBO;
+        std::unique_ptr<RenderTarget> target;
 };
 
-inline std::unique_ptr<Framebuffer> CreateFramebuffer(ShaderProgram& program) {
-    return std::make_unique<Framebuffer>(program);
-}
\ No newline at end of file
+inline std::unique_ptr<Framebuffer> CreateFramebuffer(const RenderTargetDesc& desc = Framebuffer::GetDefaultDesc()) {
+    return std::make_unique<Framebuffer>(desc);
+}
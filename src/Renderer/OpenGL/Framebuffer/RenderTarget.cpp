@@ -0,0 +1,111 @@
+#include "RenderTarget.h"
+#include "../Texture/Sampler.h"
+#include <stdexcept>
+#include <string>
+#include <spdlog/spdlog.h>
+
+RenderTarget::RenderTarget(const RenderTargetDesc& desc, glm::ivec2 size)
+    : desc(desc),
+      size(size)
+{
+    if (desc.colorFormats.empty() && !desc.depthFormat) {
+        throw std::runtime_error("Render target needs at least one attachment");
+    }
+    glCreateFramebuffers(1, &id);
+}
+
+RenderTarget::~RenderTarget() {
+    GetRenderTargetPool().Release(std::move(attachments));
+    glDeleteFramebuffers(1, &id);
+}
+
+void RenderTarget::ensureAllocated() {
+    if (attachments && attachments->size == size) return;
+
+    GetRenderTargetPool().Release(std::move(attachments));
+    attachments = GetRenderTargetPool().Acquire(desc, size);
+
+    std::vector<GLenum> drawBuffers;
+    for (size_t i = 0; i < attachments->colors.size(); ++i) {
+        glNamedFramebufferTexture(id, GL_COLOR_ATTACHMENT0 + static_cast<GLenum>(i), attachments->colors[i]->id, 0);
+        drawBuffers.push_back(GL_COLOR_ATTACHMENT0 + static_cast<GLenum>(i));
+    }
+    if (attachments->depth) {
+        glNamedFramebufferTexture(id, GL_DEPTH_ATTACHMENT, attachments->depth->id, 0);
+    }
+
+    if (drawBuffers.empty()) {
+        glNamedFramebufferDrawBuffer(id, GL_NONE);
+        glNamedFramebufferReadBuffer(id, GL_NONE);
+    } else {
+        glNamedFramebufferDrawBuffers(id, static_cast<GLsizei>(drawBuffers.size()), drawBuffers.data());
+        glNamedFramebufferReadBuffer(id, GL_COLOR_ATTACHMENT0);
+    }
+
+    GLenum status = glCheckNamedFramebufferStatus(id, GL_FRAMEBUFFER);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        throw std::runtime_error("Render target incomplete, status " + std::to_string(status));
+    }
+    spdlog::debug("Render target {} now {}x{}", id, size.x, size.y);
+}
+
+void RenderTarget::Bind() {
+    ensureAllocated();
+    glBindFramebuffer(GL_FRAMEBUFFER, id);
+    const glm::ivec2 area = GetViewport();
+    glViewport(0, 0, area.x, area.y);
+}
+
+void RenderTarget::Clear(const glm::vec4& color, float depth) {
+    ensureAllocated();
+
+    // Clears honour the write masks
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    glDepthMask(GL_TRUE);
+
+    for (size_t i = 0; i < attachments->colors.size(); ++i) {
+        glClearNamedFramebufferfv(id, GL_COLOR, static_cast<GLint>(i), &color[0]);
+    }
+    if (attachments->depth) {
+        glClearNamedFramebufferfv(id, GL_DEPTH, 0, &depth);
+    }
+}
+
+Texture& RenderTarget::GetColor(size_t index) {
+    ensureAllocated();
+    return *attachments->colors.at(index);
+}
+
+Texture* RenderTarget::GetDepth() {
+    ensureAllocated();
+    return attachments->depth.get();
+}
+
+void RenderTarget::BindForSampling(GLuint firstUnit) {
+    ensureAllocated();
+
+    std::vector<GLuint> textures;
+    std::vector<GLuint> samplers;
+    for (const auto& color : attachments->colors) {
+        textures.push_back(color->id);
+        samplers.push_back(color->sampler->id);
+    }
+    if (attachments->depth) {
+        textures.push_back(attachments->depth->id);
+        samplers.push_back(attachments->depth->sampler->id);
+    }
+    glBindTextures(firstUnit, static_cast<GLsizei>(textures.size()), textures.data());
+    glBindSamplers(firstUnit, static_cast<GLsizei>(samplers.size()), samplers.data());
+}
+
+void RenderTarget::BlitTo(GLuint framebuffer, GLbitfield mask, GLenum filter) {
+    ensureAllocated();
+    glBlitNamedFramebuffer(id, framebuffer, 0, 0, size.x, size.y, 0, 0, size.x, size.y, mask, filter);
+}
+
+void RenderTarget::GenerateMips() {
+    ensureAllocated();
+    if (desc.mipLevels <= 1 || desc.samples > 1) return;
+
+    for (const auto& color : attachments->colors) glGenerateTextureMipmap(color->id);
+}
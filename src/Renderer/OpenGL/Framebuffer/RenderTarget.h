@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "RenderTargetPool.h"
+#include "../Texture/Texture.h"
+
+// Framebuffer object over N color attachments and an optional depth attachment, built from a
+// RenderTargetDesc. Resize() only records the new size; the attachments are swapped for pooled
+// ones of that size the next time the target is bound or its textures are asked for, so targets
+// nobody draws to after a window resize cost nothing. The framebuffer name stays the same.
+class RenderTarget {
+    public:
+        RenderTarget(const RenderTargetDesc& desc, glm::ivec2 size);
+        ~RenderTarget();
+
+        RenderTarget(const RenderTarget&) = delete;
+        RenderTarget& operator=(const RenderTarget&) = delete;
+
+        void Resize(glm::ivec2 newSize) { size = newSize; }
+
+        // Area Bind() renders to, from the origin; the whole target unless set smaller. A target
+        // allocated at the output size can render at a lower, changing resolution this way without
+        // ever reallocating. (0, 0) means the whole target.
+        void SetViewport(glm::ivec2 newViewport) { viewport = newViewport; }
+        glm::ivec2 GetViewport() const { return viewport == glm::ivec2(0) ? size : glm::min(viewport, size); }
+
+        // Binds for drawing into every color attachment and sets the viewport
+        void Bind();
+        // Clears every color attachment to `color` and the depth attachment to `depth`
+        void Clear(const glm::vec4& color = glm::vec4(0.0f), float depth = 1.0f);
+
+        Texture& GetColor(size_t index = 0);
+        Texture* GetDepth();
+        size_t GetColorCount() const { return desc.colorFormats.size(); }
+
+        // Colors, then depth, on consecutive texture units with their own samplers
+        void BindForSampling(GLuint firstUnit = 0);
+
+        // Copies into `framebuffer` at the same size, resolving multisampled attachments
+        void BlitTo(GLuint framebuffer, GLbitfield mask, GLenum filter = GL_NEAREST);
+
+        // Rebuilds levels 1.. of every color attachment from level 0
+        void GenerateMips();
+
+        glm::ivec2 GetSize() const { return size; }
+        const RenderTargetDesc& GetDesc() const { return desc; }
+
+        GLuint id = 0;
+
+    private:
+        void ensureAllocated();
+
+        RenderTargetDesc desc;
+        glm::ivec2 size;
+        glm::ivec2 viewport{0};
+        std::unique_ptr<RenderTargetAttachments> attachments;
+};
+
+inline std::unique_ptr<RenderTarget> CreateRenderTarget(const RenderTargetDesc& desc, glm::ivec2 size) {
+    return std::make_unique<RenderTarget>(desc, size);
+}
@@ -0,0 +1,161 @@
+#include "RenderTargetPool.h"
+#include <algorithm>
+#include <spdlog/spdlog.h>
+
+size_t RenderTargetDesc::GetMemorySize(glm::ivec2 size) const {
+    size_t colorTexels = 0;
+    const int levels = samples > 1 ? 1 : std::max(1, mipLevels);
+    for (int level = 0; level < levels; ++level) {
+        colorTexels += static_cast<size_t>(std::max(1, size.x >> level)) * std::max(1, size.y >> level);
+    }
+
+    size_t bytes = 0;
+    for (TextureInternalFormat format : colorFormats) bytes += colorTexels * GetBytesPerPixel(format);
+    // Depth never has mips
+    if (depthFormat) bytes += static_cast<size_t>(size.x) * size.y * GetBytesPerPixel(*depthFormat);
+    return bytes * std::max(1, samples);
+}
+
+std::unique_ptr<RenderTargetAttachments> GLRenderTargetDevice::Allocate(const RenderTargetDesc& desc, glm::ivec2 size) {
+    auto attachments = std::make_unique<RenderTargetAttachments>();
+    attachments->desc = desc;
+    attachments->size = size;
+
+    const TextureFilter minFilter = desc.mipLevels > 1
+        ? (desc.filter == TextureFilter::Nearest ? TextureFilter::NearestMipmapNearest : TextureFilter::LinearMipmapLinear)
+        : desc.filter;
+    for (TextureInternalFormat format : desc.colorFormats) {
+        attachments->colors.push_back(CreateRenderTexture(size.x, size.y, format, desc.mipLevels, desc.samples,
+                                                          minFilter, desc.filter));
+        attachments->bytes += attachments->colors.back()->GetMemorySize();
+    }
+    if (desc.depthFormat) {
+        attachments->depth = CreateRenderTexture(size.x, size.y, *desc.depthFormat, 1, desc.samples,
+                                                 TextureFilter::Nearest, TextureFilter::Nearest);
+        attachments->bytes += attachments->depth->GetMemorySize();
+    }
+    return attachments;
+}
+
+RenderTargetPool::RenderTargetPool(std::unique_ptr<RenderTargetDevice> device, uint32_t maxIdleFrames,
+                                   size_t idleBudgetBytes)
+    : device(std::move(device)),
+      maxIdleFrames(maxIdleFrames),
+      idleBudget(idleBudgetBytes)
+{
+}
+
+RenderTargetPool::~RenderTargetPool() {
+    // Whatever is left goes through the device, so a mock sees every allocation freed
+    for (auto& attachments : transients) freeAttachments(std::move(attachments));
+    Clear();
+}
+
+std::unique_ptr<RenderTargetAttachments> RenderTargetPool::Acquire(const RenderTargetDesc& desc, glm::ivec2 size) {
+    // Most recently used first: it is the likeliest to still be resident in caches and memory
+    for (auto it = idle.rbegin(); it != idle.rend(); ++it) {
+        if (it->attachments->size == size && it->attachments->desc == desc) {
+            auto attachments = std::move(it->attachments);
+            idle.erase(std::next(it).base());
+            stats.idleBytes -= attachments->bytes;
+            ++stats.reuses;
+            return attachments;
+        }
+    }
+
+    auto attachments = device->Allocate(desc, size);
+    ++stats.allocations;
+    stats.allocatedBytes += attachments->bytes;
+    stats.peakBytes = std::max(stats.peakBytes, stats.allocatedBytes);
+    frameHighWater = std::max(frameHighWater, stats.allocatedBytes);
+    return attachments;
+}
+
+void RenderTargetPool::Release(std::unique_ptr<RenderTargetAttachments> attachments) {
+    if (!attachments) return;
+
+    stats.idleBytes += attachments->bytes;
+    idle.push_back({std::move(attachments), frame});
+    enforceBudget();
+}
+
+RenderTargetAttachments* RenderTargetPool::AcquireTransient(const RenderTargetDesc& desc, glm::ivec2 size) {
+    transients.push_back(Acquire(desc, size));
+    return transients.back().get();
+}
+
+void RenderTargetPool::ReleaseTransient(RenderTargetAttachments* attachments) {
+    auto it = std::find_if(transients.begin(), transients.end(),
+                           [&](const auto& transient) { return transient.get() == attachments; });
+    if (it == transients.end()) return;
+
+    auto released = std::move(*it);
+    transients.erase(it);
+    Release(std::move(released));
+}
+
+void RenderTargetPool::BeginFrame() {
+    while (!transients.empty()) {
+        auto attachments = std::move(transients.back());
+        transients.pop_back();
+        Release(std::move(attachments));
+    }
+
+    if (frame > 0) {
+        highWaterSum += static_cast<double>(frameHighWater);
+        ++stats.frames;
+        stats.averageBytes = highWaterSum / static_cast<double>(stats.frames);
+    }
+    ++frame;
+
+    size_t expired = 0;
+    while (expired < idle.size() && frame - idle[expired].lastUsedFrame > maxIdleFrames) ++expired;
+    for (size_t i = 0; i < expired; ++i) {
+        stats.idleBytes -= idle[i].attachments->bytes;
+        freeAttachments(std::move(idle[i].attachments));
+    }
+    idle.erase(idle.begin(), idle.begin() + expired);
+
+    frameHighWater = stats.allocatedBytes;
+}
+
+void RenderTargetPool::SetIdleBudget(size_t bytes) {
+    idleBudget = bytes;
+    enforceBudget();
+}
+
+void RenderTargetPool::Clear() {
+    for (auto& entry : idle) freeAttachments(std::move(entry.attachments));
+    idle.clear();
+    stats.idleBytes = 0;
+}
+
+void RenderTargetPool::freeAttachments(std::unique_ptr<RenderTargetAttachments> attachments) {
+    stats.allocatedBytes -= attachments->bytes;
+    ++stats.frees;
+    device->Free(std::move(attachments));
+}
+
+void RenderTargetPool::enforceBudget() {
+    size_t dropped = 0;
+    while (stats.idleBytes > idleBudget && dropped < idle.size()) {
+        stats.idleBytes -= idle[dropped].attachments->bytes;
+        freeAttachments(std::move(idle[dropped].attachments));
+        ++dropped;
+    }
+    idle.erase(idle.begin(), idle.begin() + dropped);
+}
+
+void RenderTargetPool::LogStats() const {
+    const size_t requests = stats.allocations + stats.reuses;
+    spdlog::info("Render target pool: {} allocations / {} reuses ({:.0f}% reused), {} frees, "
+                 "{:.1f} MB allocated ({:.1f} MB idle), peak {:.1f} MB, average {:.1f} MB over {} frames",
+                 stats.allocations, stats.reuses, requests ? 100.0 * stats.reuses / requests : 0.0, stats.frees,
+                 stats.allocatedBytes / (1024.0 * 1024.0), stats.idleBytes / (1024.0 * 1024.0),
+                 stats.peakBytes / (1024.0 * 1024.0), stats.averageBytes / (1024.0 * 1024.0), stats.frames);
+}
+
+RenderTargetPool& GetRenderTargetPool() {
+    static RenderTargetPool pool;
+    return pool;
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+#include <glm/glm.hpp>
+#include "../Texture/Texture.h"
+
+// Everything that determines a render target's storage except its size
+struct RenderTargetDesc {
+    std::vector<TextureInternalFormat> colorFormats;
+    std::optional<TextureInternalFormat> depthFormat;
+    int samples = 1;                // > 1 allocates multisampled attachments without mips
+    int mipLevels = 1;
+    TextureFilter filter = TextureFilter::Linear;
+
+    bool operator==(const RenderTargetDesc& other) const {
+        return colorFormats == other.colorFormats && depthFormat == other.depthFormat &&
+               samples == other.samples && mipLevels == other.mipLevels && filter == other.filter;
+    }
+    bool operator!=(const RenderTargetDesc& other) const { return !(*this == other); }
+
+    // Bytes of storage at `size`, ignoring driver padding
+    size_t GetMemorySize(glm::ivec2 size) const;
+};
+
+// The textures of one render target at one size; what the pool recycles
+struct RenderTargetAttachments {
+    RenderTargetDesc desc;
+    glm::ivec2 size{0};
+    size_t bytes = 0;
+    std::vector<std::unique_ptr<Texture>> colors;
+    std::unique_ptr<Texture> depth;
+};
+
+// Where the pool gets storage from. The GL device creates textures; a device that only fills in
+// desc, size and bytes lets the pooling policy run without a GL context.
+class RenderTargetDevice {
+    public:
+        virtual ~RenderTargetDevice() = default;
+
+        virtual std::unique_ptr<RenderTargetAttachments> Allocate(const RenderTargetDesc& desc, glm::ivec2 size) = 0;
+        virtual void Free(std::unique_ptr<RenderTargetAttachments> attachments) = 0;
+};
+
+class GLRenderTargetDevice : public RenderTargetDevice {
+    public:
+        std::unique_ptr<RenderTargetAttachments> Allocate(const RenderTargetDesc& desc, glm::ivec2 size) override;
+        void Free(std::unique_ptr<RenderTargetAttachments> attachments) override { attachments.reset(); }
+};
+
+struct RenderTargetPoolStats {
+    size_t allocations = 0;
+    size_t reuses = 0;
+    size_t frees = 0;
+    size_t allocatedBytes = 0;          // in use and idle
+    size_t idleBytes = 0;
+    size_t peakBytes = 0;               // highest allocatedBytes ever
+    double averageBytes = 0.0;          // mean over completed frames of each frame's highest allocatedBytes
+    uint64_t frames = 0;
+};
+
+// Render target storage keyed by (description, size). Released attachments go idle and are handed
+// to the next request for the same key, whichever pass or frame it comes from; idle attachments
+// nobody asked for in `maxIdleFrames` frames, or beyond the idle budget, are freed oldest first.
+//
+// Acquire()/Release() suit targets that live across frames. Transient targets for one frame come
+// from AcquireTransient(); ReleaseTransient() hands one back as soon as its last reader ran so a
+// later pass can recycle it, and BeginFrame() returns whatever the previous frame still held.
+class RenderTargetPool {
+    public:
+        explicit RenderTargetPool(std::unique_ptr<RenderTargetDevice> device = std::make_unique<GLRenderTargetDevice>(),
+                                  uint32_t maxIdleFrames = 3, size_t idleBudgetBytes = size_t(256) * 1024 * 1024);
+        ~RenderTargetPool();
+
+        RenderTargetPool(const RenderTargetPool&) = delete;
+        RenderTargetPool& operator=(const RenderTargetPool&) = delete;
+
+        // Idle attachments matching exactly, or newly allocated ones
+        std::unique_ptr<RenderTargetAttachments> Acquire(const RenderTargetDesc& desc, glm::ivec2 size);
+        void Release(std::unique_ptr<RenderTargetAttachments> attachments);
+
+        // Owned by the pool until ReleaseTransient() or the next BeginFrame()
+        RenderTargetAttachments* AcquireTransient(const RenderTargetDesc& desc, glm::ivec2 size);
+        void ReleaseTransient(RenderTargetAttachments* attachments);
+
+        // Returns last frame's transients, frees idle attachments past their frame limit and closes
+        // the VRAM statistics of the previous frame. Call once at the start of every frame.
+        void BeginFrame();
+
+        void SetMaxIdleFrames(uint32_t frames) { maxIdleFrames = frames; }
+        void SetIdleBudget(size_t bytes);
+        // Frees every idle attachment; call while the GL context is still current
+        void Clear();
+
+        const RenderTargetPoolStats& GetStats() const { return stats; }
+        void LogStats() const;
+
+    private:
+        struct IdleEntry {
+            std::unique_ptr<RenderTargetAttachments> attachments;
+            uint64_t lastUsedFrame = 0;
+        };
+
+        void freeAttachments(std::unique_ptr<RenderTargetAttachments> attachments);
+        void enforceBudget();
+
+        std::unique_ptr<RenderTargetDevice> device;
+        std::vector<IdleEntry> idle;                                        // oldest first
+        std::vector<std::unique_ptr<RenderTargetAttachments>> transients;   // checked out this frame
+        uint32_t maxIdleFrames;
+        size_t idleBudget;
+        uint64_t frame = 0;
+        size_t frameHighWater = 0;
+        double highWaterSum = 0.0;
+        RenderTargetPoolStats stats;
+};
+
+RenderTargetPool& GetRenderTargetPool();
@@ -0,0 +1,118 @@
+#include "FileWatcher.h"
+#include <algorithm>
+#include <spdlog/spdlog.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+FileWatcher::FileWatcher(std::chrono::milliseconds pollInterval)
+    : pollInterval(pollInterval)
+{
+#ifdef __linux__
+    inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify < 0) spdlog::warn("inotify unavailable, falling back to polling modification times");
+#endif
+}
+
+FileWatcher::~FileWatcher() {
+#ifdef __linux__
+    if (inotify >= 0) close(inotify);
+#endif
+}
+
+std::string FileWatcher::Normalize(const std::string& path) {
+    std::error_code error;
+    std::filesystem::path absolute = std::filesystem::weakly_canonical(path, error);
+    if (error) absolute = std::filesystem::absolute(path, error);
+    return absolute.lexically_normal().generic_string();
+}
+
+void FileWatcher::addDirectory(const std::filesystem::path& directory) {
+#ifdef __linux__
+    if (inotify >= 0) {
+        int descriptor = inotify_add_watch(inotify, directory.c_str(),
+                                           IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+        if (descriptor >= 0) watches[descriptor] = directory;
+        return;
+    }
+#endif
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+        if (entry.is_regular_file(error)) {
+            timestamps[Normalize(entry.path().string())] = entry.last_write_time(error);
+        }
+    }
+}
+
+void FileWatcher::Watch(const std::string& directory) {
+    std::error_code error;
+    if (!std::filesystem::is_directory(directory, error)) return;
+
+    std::filesystem::path root(Normalize(directory));
+    roots.push_back(root);
+    addDirectory(root);
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(root, error)) {
+        if (entry.is_directory(error)) addDirectory(entry.path());
+    }
+}
+
+void FileWatcher::scan(std::vector<std::string>& changed) {
+    std::error_code error;
+    for (const auto& root : roots) {
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(root, error)) {
+            if (!entry.is_regular_file(error)) continue;
+
+            auto time = entry.last_write_time(error);
+            auto [it, inserted] = timestamps.try_emplace(Normalize(entry.path().string()), time);
+            if (inserted || it->second != time) {
+                it->second = time;
+                changed.push_back(it->first);
+            }
+        }
+    }
+}
+
+std::vector<std::string> FileWatcher::Poll() {
+    std::vector<std::string> changed;
+
+#ifdef __linux__
+    if (inotify >= 0) {
+        alignas(inotify_event) char buffer[16 * 1024];
+        for (;;) {
+            ssize_t length = read(inotify, buffer, sizeof(buffer));
+            if (length <= 0) break;
+
+            for (ssize_t offset = 0; offset < length;) {
+                const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+                offset += sizeof(inotify_event) + event->len;
+
+                auto watch = watches.find(event->wd);
+                if (watch == watches.end() || event->len == 0) continue;
+
+                std::filesystem::path path = watch->second / event->name;
+                if (event->mask & IN_ISDIR) {
+                    if (event->mask & (IN_CREATE | IN_MOVED_TO)) addDirectory(path);
+                    continue;
+                }
+                // IN_CREATE alone is followed by IN_CLOSE_WRITE once the writer is done.
+                if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+                    changed.push_back(Normalize(path.string()));
+                }
+            }
+        }
+    } else
+#endif
+    {
+        auto now = std::chrono::steady_clock::now();
+        if (now - lastScan >= pollInterval) {
+            lastScan = now;
+            scan(changed);
+        }
+    }
+
+    std::sort(changed.begin(), changed.end());
+    changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+    return changed;
+}
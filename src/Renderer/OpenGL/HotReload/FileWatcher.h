@@ -0,0 +1,41 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Reports files that were written, created or moved into watched directories (recursively).
+// Uses inotify on Linux; elsewhere it falls back to comparing modification times, scanning at most
+// once per `pollInterval`. Poll() never blocks and returns each changed path once per batch.
+
+class FileWatcher {
+    public:
+        explicit FileWatcher(std::chrono::milliseconds pollInterval = std::chrono::milliseconds(250));
+        ~FileWatcher();
+
+        FileWatcher(const FileWatcher&) = delete;
+        FileWatcher& operator=(const FileWatcher&) = delete;
+
+        // Watches `directory` and its subdirectories; missing directories are ignored.
+        void Watch(const std::string& directory);
+
+        // Changed files as normalized absolute paths.
+        std::vector<std::string> Poll();
+
+        // Key used to compare watcher paths with paths recorded elsewhere.
+        static std::string Normalize(const std::string& path);
+
+    private:
+        void addDirectory(const std::filesystem::path& directory);
+        void scan(std::vector<std::string>& changed);
+
+        std::vector<std::filesystem::path> roots;
+        std::chrono::milliseconds pollInterval;
+        std::chrono::steady_clock::time_point lastScan;
+
+        int inotify = -1;
+        std::unordered_map<int, std::filesystem::path> watches;                      // inotify descriptor -> directory
+        std::unordered_map<std::string, std::filesystem::file_time_type> timestamps; // fallback scanning
+};
@@ -0,0 +1,153 @@
+#include "HotReload.h"
+#include "../Shader/ShaderProgram.h"
+#include "../Texture/TextureCache.h"
+#include "../../../Utils/ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <spdlog/spdlog.h>
+
+namespace {
+    bool Contains(const std::vector<std::string>& sorted, const std::string& path) {
+        return std::binary_search(sorted.begin(), sorted.end(), FileWatcher::Normalize(path));
+    }
+
+    bool IsAlive(const Texture* texture) {
+        const auto& textures = Texture::GetFileTextures();
+        return std::find(textures.begin(), textures.end(), texture) != textures.end();
+    }
+}
+
+void HotReloader::WatchFile(const std::string& path, std::function<void()> callback) {
+    callbacks[FileWatcher::Normalize(path)].push_back(std::move(callback));
+}
+
+void HotReloader::OnTextureReloaded(const Texture* texture, std::function<void()> callback) {
+    textureCallbacks[texture].push_back(std::move(callback));
+}
+
+void HotReloader::Update() {
+    finishTextures();
+
+    std::vector<std::string> changed = watcher.Poll();
+    if (changed.empty()) return;
+
+    reloadPrograms(changed);
+    reloadTextures(changed);
+
+    for (const auto& path : changed) {
+        auto it = callbacks.find(path);
+        if (it == callbacks.end()) continue;
+
+        for (const auto& callback : it->second) {
+            try {
+                callback();
+                ++stats.callbacksRun;
+            } catch (const std::exception& error) {
+                spdlog::error("Hot reload of {} failed: {}", path, error.what());
+            }
+        }
+    }
+}
+
+void HotReloader::reloadPrograms(const std::vector<std::string>& changed) {
+    for (ShaderProgram* program : std::vector<ShaderProgram*>(ShaderProgram::GetPrograms())) {
+        const auto& dependencies = program->GetDependencies();
+        auto touched = std::find_if(dependencies.begin(), dependencies.end(),
+                                    [&](const std::string& file) { return Contains(changed, file); });
+        if (touched == dependencies.end()) continue;
+
+        const std::string name = dependencies.empty() ? std::string() : dependencies.front();
+        auto start = std::chrono::high_resolution_clock::now();
+        try {
+            program->Rebuild();
+            ++stats.programsRebuilt;
+            double milliseconds = std::chrono::duration<double, std::milli>(
+                std::chrono::high_resolution_clock::now() - start).count();
+            stats.rebuildMilliseconds += milliseconds;
+            spdlog::info("Hot reload: rebuilt program {} in {:.1f} ms", name, milliseconds);
+        } catch (const std::exception& error) {
+            ++stats.programsFailed;
+            spdlog::error("Hot reload: keeping previous program {}:\n{}", name, error.what());
+        }
+    }
+}
+
+void HotReloader::reloadTextures(const std::vector<std::string>& changed) {
+    for (Texture* texture : std::vector<Texture*>(Texture::GetFileTextures())) {
+        const auto& files = texture->sourceFiles;
+        if (std::none_of(files.begin(), files.end(), [&](const std::string& file) { return Contains(changed, file); })) {
+            continue;
+        }
+
+        if (texture->type == TextureType::CubeMap) {
+            try {
+                Texture reloaded(files.front(), &files, texture->type, texture->format, texture->internalFormat, 0,
+                                 texture->minFilter, texture->magFilter, texture->wrapS, texture->wrapT, texture->wrapR);
+                texture->SwapStorage(reloaded);
+                GetTextureCache().UpdateSize(texture);
+                ++stats.texturesReloaded;
+                spdlog::info("Hot reload: reloaded cube map {}", files.front());
+                textureReloaded(texture);
+            } catch (const std::exception& error) {
+                ++stats.texturesFailed;
+                spdlog::error("Hot reload: keeping previous cube map {}: {}", files.front(), error.what());
+            }
+            continue;
+        }
+
+        // A texture already decoding picks up the newer file on its next change event
+        bool pending = std::any_of(pendingTextures.begin(), pendingTextures.end(),
+                                   [&](const PendingTexture& entry) { return entry.texture == texture; });
+        if (pending) continue;
+
+        std::string path = files.front();
+        int channels = texture->nrChannels;
+        auto image = GetThreadPool().Submit([path, channels] { return TextureLoader::Decode(path, channels, true); });
+        pendingTextures.push_back({texture, path, std::move(image)});
+    }
+}
+
+void HotReloader::finishTextures() {
+    for (auto it = pendingTextures.begin(); it != pendingTextures.end();) {
+        if (it->image.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            ++it;
+            continue;
+        }
+
+        DecodedImage image = it->image.get();
+        Texture* texture = it->texture;
+        const bool alive = IsAlive(texture) && !texture->sourceFiles.empty() && texture->sourceFiles.front() == it->path;
+
+        if (!alive) {
+            // Owner released the texture while it was decoding
+        } else if (!image.Valid()) {
+            ++stats.texturesFailed;
+            spdlog::error("Hot reload: keeping previous texture {}, decode failed", it->path);
+        } else {
+            Texture reloaded(image.width, image.height, 1, texture->type, texture->format, texture->internalFormat,
+                             image.pixels.data(), 0, texture->minFilter, texture->magFilter,
+                             texture->wrapS, texture->wrapT, texture->wrapR);
+            texture->SwapStorage(reloaded);
+            GetTextureCache().UpdateSize(texture);
+            ++stats.texturesReloaded;
+            spdlog::info("Hot reload: reloaded texture {} ({}x{})", it->path, image.width, image.height);
+            textureReloaded(texture);
+        }
+        it = pendingTextures.erase(it);
+    }
+}
+
+void HotReloader::textureReloaded(const Texture* texture) {
+    auto it = textureCallbacks.find(texture);
+    if (it == textureCallbacks.end()) return;
+
+    for (const auto& callback : it->second) {
+        try {
+            callback();
+            ++stats.callbacksRun;
+        } catch (const std::exception& error) {
+            spdlog::error("Hot reload callback for texture {} failed: {}",
+                          texture->sourceFiles.empty() ? std::string() : texture->sourceFiles.front(), error.what());
+        }
+    }
+}
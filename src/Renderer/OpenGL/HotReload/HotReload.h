@@ -0,0 +1,63 @@
+#pragma once
+
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "FileWatcher.h"
+#include "../Texture/TextureLoader.h"
+
+// Development-time reloading of shaders, textures and arbitrary files, driven by a FileWatcher.
+// Call Update() once per frame between frames, on the GL thread:
+//   - programs whose stage files or includes changed are rebuilt in place (ShaderProgram::Rebuild);
+//     a broken edit logs the compile error and keeps the last good program.
+//   - 2D file textures are re-decoded on the worker pool and swapped in once decoded; cube maps are
+//     reloaded synchronously. Owners keep their Texture pointers either way.
+//   - callbacks registered with WatchFile run for their file, e.g. to reload a model.
+//   - callbacks registered with OnTextureReloaded run once a texture's new storage is swapped in,
+//     e.g. to rebuild data derived from it. A failed reload keeps the old texture and runs none.
+
+struct HotReloadStats {
+    size_t programsRebuilt = 0;
+    size_t programsFailed = 0;
+    size_t texturesReloaded = 0;
+    size_t texturesFailed = 0;
+    size_t callbacksRun = 0;
+    double rebuildMilliseconds = 0.0;      // GL thread time spent rebuilding programs
+};
+
+class HotReloader {
+    public:
+        // Directory changes are coalesced by the watcher; everything else happens in Update()
+        void Watch(const std::string& directory) { watcher.Watch(directory); }
+        void WatchFile(const std::string& path, std::function<void()> callback);
+        void OnTextureReloaded(const Texture* texture, std::function<void()> callback);
+
+        void Update();
+
+        const HotReloadStats& GetStats() const { return stats; }
+
+    private:
+        void reloadPrograms(const std::vector<std::string>& changed);
+        void reloadTextures(const std::vector<std::string>& changed);
+        void finishTextures();
+        void textureReloaded(const Texture* texture);
+
+        struct PendingTexture {
+            Texture* texture;
+            std::string path;
+            std::future<DecodedImage> image;
+        };
+
+        FileWatcher watcher;
+        std::unordered_map<std::string, std::vector<std::function<void()>>> callbacks;
+        std::unordered_map<const Texture*, std::vector<std::function<void()>>> textureCallbacks;
+        std::vector<PendingTexture> pendingTextures;
+        HotReloadStats stats;
+};
+
+inline std::unique_ptr<HotReloader> CreateHotReloader() {
+    return std::make_unique<HotReloader>();
+}
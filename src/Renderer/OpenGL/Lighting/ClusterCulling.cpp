@@ -0,0 +1,161 @@
+#include "ClusterCulling.h"
+#include <algorithm>
+#include <cmath>
+#include "../../../Utils/ThreadPool.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CLUSTER_CULLING_SSE2 1
+#endif
+
+namespace {
+    // Light spheres as structure-of-arrays, padded to a multiple of four with spheres that never hit
+    struct SphereBatch {
+        std::vector<float> x, y, z, radiusSquared;
+        std::vector<uint32_t> index;
+
+        void push(const ClusterLightSphere& sphere, uint32_t lightIndex) {
+            x.push_back(sphere.center.x);
+            y.push_back(sphere.center.y);
+            z.push_back(sphere.center.z);
+            radiusSquared.push_back(sphere.radius * sphere.radius);
+            index.push_back(lightIndex);
+        }
+
+        void pad() {
+            while (x.size() % 4 != 0) push({glm::vec3(1e30f), 0.0f}, 0);
+        }
+    };
+
+    // Appends the lights of `batch` touching `box` to `out`; returns the new count
+    uint32_t CullCluster(const ClusterBounds& box, const SphereBatch& batch, size_t realCount,
+                         uint32_t* out, uint32_t capacity) {
+        uint32_t count = 0;
+
+#ifdef CLUSTER_CULLING_SSE2
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 minX = _mm_set1_ps(box.min.x), maxX = _mm_set1_ps(box.max.x);
+        const __m128 minY = _mm_set1_ps(box.min.y), maxY = _mm_set1_ps(box.max.y);
+        const __m128 minZ = _mm_set1_ps(box.min.z), maxZ = _mm_set1_ps(box.max.z);
+
+        for (size_t i = 0; i < realCount && count < capacity; i += 4) {
+            __m128 x = _mm_loadu_ps(&batch.x[i]);
+            __m128 y = _mm_loadu_ps(&batch.y[i]);
+            __m128 z = _mm_loadu_ps(&batch.z[i]);
+
+            // Distance from the centre to the box, per axis: zero inside, else to the nearer face
+            __m128 dx = _mm_add_ps(_mm_max_ps(_mm_sub_ps(minX, x), zero), _mm_max_ps(_mm_sub_ps(x, maxX), zero));
+            __m128 dy = _mm_add_ps(_mm_max_ps(_mm_sub_ps(minY, y), zero), _mm_max_ps(_mm_sub_ps(y, maxY), zero));
+            __m128 dz = _mm_add_ps(_mm_max_ps(_mm_sub_ps(minZ, z), zero), _mm_max_ps(_mm_sub_ps(z, maxZ), zero));
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+
+            int mask = _mm_movemask_ps(_mm_cmple_ps(distance, _mm_loadu_ps(&batch.radiusSquared[i])));
+            for (int lane = 0; mask != 0 && count < capacity; ++lane, mask >>= 1) {
+                if (mask & 1) out[count++] = batch.index[i + lane];
+            }
+        }
+#else
+        for (size_t i = 0; i < realCount && count < capacity; ++i) {
+            float dx = std::max(box.min.x - batch.x[i], 0.0f) + std::max(batch.x[i] - box.max.x, 0.0f);
+            float dy = std::max(box.min.y - batch.y[i], 0.0f) + std::max(batch.y[i] - box.max.y, 0.0f);
+            float dz = std::max(box.min.z - batch.z[i], 0.0f) + std::max(batch.z[i] - box.max.z, 0.0f);
+            if (dx * dx + dy * dy + dz * dz <= batch.radiusSquared[i]) out[count++] = batch.index[i];
+        }
+#endif
+        return count;
+    }
+}
+
+namespace ClusterCulling {
+
+glm::vec2 GetDepthRange(const glm::mat4& projection) {
+    // glm::perspective: [2][2] = -(f + n) / (f - n), [3][2] = -2fn / (f - n)
+    float a = projection[2][2];
+    float b = projection[3][2];
+    return {b / (a - 1.0f), b / (a + 1.0f)};
+}
+
+float GetSliceDepth(const ClusterConfig& config, glm::vec2 depthRange, uint32_t slice) {
+    return depthRange.x * std::pow(depthRange.y / depthRange.x, static_cast<float>(slice) / config.slices);
+}
+
+glm::vec2 GetSliceParameters(const ClusterConfig& config, glm::vec2 depthRange) {
+    const float slices = static_cast<float>(config.slices);
+    const float logRange = std::log(depthRange.y / depthRange.x);
+    return {slices / logRange, -slices * std::log(depthRange.x) / logRange};
+}
+
+std::vector<ClusterBounds> ComputeBounds(const ClusterConfig& config, const glm::mat4& projection,
+                                         glm::ivec2 resolution) {
+    const glm::mat4 inverseProjection = glm::inverse(projection);
+    const glm::vec2 depthRange = GetDepthRange(projection);
+    const glm::vec2 tileSize = glm::ceil(glm::vec2(resolution) / glm::vec2(config.tilesX, config.tilesY));
+
+    // Point on the near plane seen through pixel `pixel`
+    auto unproject = [&](glm::vec2 pixel) {
+        glm::vec2 ndc = glm::min(pixel / glm::vec2(resolution), glm::vec2(1.0f)) * 2.0f - 1.0f;
+        glm::vec4 view = inverseProjection * glm::vec4(ndc, -1.0f, 1.0f);
+        return glm::vec3(view) / view.w;
+    };
+
+    std::vector<ClusterBounds> bounds(config.GetClusterCount());
+    for (uint32_t slice = 0; slice < config.slices; ++slice) {
+        float nearDepth = GetSliceDepth(config, depthRange, slice);
+        float farDepth = GetSliceDepth(config, depthRange, slice + 1);
+
+        for (uint32_t y = 0; y < config.tilesY; ++y) {
+            for (uint32_t x = 0; x < config.tilesX; ++x) {
+                glm::vec3 low = unproject(glm::vec2(x, y) * tileSize);
+                glm::vec3 high = unproject(glm::vec2(x + 1, y + 1) * tileSize);
+
+                // The eye rays through the tile corners, cut at both slice planes
+                glm::vec3 corners[4] = {
+                    low * (nearDepth / -low.z), low * (farDepth / -low.z),
+                    high * (nearDepth / -high.z), high * (farDepth / -high.z)
+                };
+
+                glm::vec3 minimum = corners[0], maximum = corners[0];
+                for (const auto& corner : corners) {
+                    minimum = glm::min(minimum, corner);
+                    maximum = glm::max(maximum, corner);
+                }
+
+                auto& box = bounds[x + config.tilesX * (y + config.tilesY * slice)];
+                box.min = glm::vec4(minimum, 0.0f);
+                box.max = glm::vec4(maximum, 0.0f);
+            }
+        }
+    }
+    return bounds;
+}
+
+void AssignLights(const ClusterConfig& config, const std::vector<ClusterBounds>& bounds,
+                  const std::vector<ClusterLightSphere>& lights, ClusterLightLists& result) {
+    const uint32_t clustersPerSlice = config.tilesX * config.tilesY;
+    result.counts.assign(config.GetClusterCount(), 0);
+    result.indices.resize(static_cast<size_t>(config.GetClusterCount()) * config.maxLightsPerCluster);
+
+    GetThreadPool().ParallelFor(config.slices, [&](size_t slice) {
+        const uint32_t first = static_cast<uint32_t>(slice) * clustersPerSlice;
+
+        // Every cluster of a slice spans the same depth range; keep only the lights reaching it
+        const float sliceMin = bounds[first].min.z;
+        const float sliceMax = bounds[first].max.z;
+        SphereBatch batch;
+        for (uint32_t i = 0; i < lights.size(); ++i) {
+            const auto& light = lights[i];
+            if (light.center.z - light.radius <= sliceMax && light.center.z + light.radius >= sliceMin) {
+                batch.push(light, i);
+            }
+        }
+        const size_t realCount = batch.x.size();
+        batch.pad();
+
+        for (uint32_t cluster = first; cluster < first + clustersPerSlice; ++cluster) {
+            uint32_t* out = result.indices.data() + static_cast<size_t>(cluster) * config.maxLightsPerCluster;
+            result.counts[cluster] = CullCluster(bounds[cluster], batch, realCount, out, config.maxLightsPerCluster);
+        }
+    });
+}
+
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+// CPU side of clustered light assignment: the view frustum is split into tilesX * tilesY screen
+// tiles and `slices` exponentially spaced depth slices, and every cluster gets the list of lights
+// whose bounding sphere touches its view-space AABB. AssignLights() is the SIMD reference for
+// Shader/cluster_assign.comp and produces the same layout, so the two can be compared directly.
+
+struct ClusterConfig {
+    uint32_t tilesX = 16;
+    uint32_t tilesY = 9;
+    uint32_t slices = 24;
+    uint32_t maxLightsPerCluster = 128;     // lights beyond this are dropped from the cluster
+
+    uint32_t GetClusterCount() const { return tilesX * tilesY * slices; }
+};
+
+// View-space box of one cluster; w is padding so the array uploads as std430 vec4 pairs
+struct ClusterBounds {
+    glm::vec4 min;
+    glm::vec4 max;
+};
+
+// Cluster i owns indices[i * maxLightsPerCluster, + counts[i])
+struct ClusterLightLists {
+    std::vector<uint32_t> counts;
+    std::vector<uint32_t> indices;
+};
+
+// Light sphere in view space
+struct ClusterLightSphere {
+    glm::vec3 center;
+    float radius;
+};
+
+namespace ClusterCulling {
+    // Near and far plane distances of a perspective projection
+    glm::vec2 GetDepthRange(const glm::mat4& projection);
+
+    // Depth slice boundary `slice` of `config.slices`, as a positive view-space distance
+    float GetSliceDepth(const ClusterConfig& config, glm::vec2 depthRange, uint32_t slice);
+
+    // Scale and bias turning log(depth) into a slice index, as used by clusters.glsl
+    glm::vec2 GetSliceParameters(const ClusterConfig& config, glm::vec2 depthRange);
+
+    // Cluster boxes for a projection and render size; index = x + tilesX * (y + tilesY * slice)
+    std::vector<ClusterBounds> ComputeBounds(const ClusterConfig& config, const glm::mat4& projection,
+                                             glm::ivec2 resolution);
+
+    // Bins the spheres into the clusters. Depth slices are processed on the worker pool, and lights
+    // are first reduced to the ones overlapping each slice, so cost follows local light density.
+    void AssignLights(const ClusterConfig& config, const std::vector<ClusterBounds>& bounds,
+                      const std::vector<ClusterLightSphere>& lights, ClusterLightLists& result);
+}
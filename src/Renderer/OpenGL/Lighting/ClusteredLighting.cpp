@@ -0,0 +1,185 @@
+#include "ClusteredLighting.h"
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <spdlog/spdlog.h>
+
+namespace {
+    // Shader storage bindings shared by cluster_assign.comp and clusters.glsl
+    constexpr GLuint LightBinding = 0;
+    constexpr GLuint BoundsBinding = 1;
+    constexpr GLuint CountBinding = 2;
+    constexpr GLuint IndexBinding = 3;
+
+    constexpr uint32_t AssignGroupSize = 128;
+}
+
+ClusteredLighting::ClusteredLighting(const ClusterConfig& config)
+    : config(config)
+{
+    const size_t clusters = config.GetClusterCount();
+    lightBuffer = CreateBuffer(BufferType::Storage, sizeof(GpuLight), nullptr, BufferUsage::Dynamic, LightBinding);
+    boundsBuffer = CreateBuffer(BufferType::Storage, clusters * sizeof(ClusterBounds), nullptr, BufferUsage::Static, BoundsBinding);
+    countBuffer = CreateBuffer(BufferType::Storage, clusters * sizeof(uint32_t), nullptr, BufferUsage::Dynamic, CountBinding);
+    indexBuffer = CreateBuffer(BufferType::Storage, clusters * config.maxLightsPerCluster * sizeof(uint32_t), nullptr,
+                               BufferUsage::Dynamic, IndexBinding);
+    dataBuffer = CreateBuffer(BufferType::Uniform, sizeof(ClusterData), nullptr, BufferUsage::Dynamic, ClusterData::Binding);
+
+    auto shader = CreateShader(ShaderStage::Compute, "Shader/cluster_assign.comp");
+    assignProgram = CreateShaderProgram(*shader);
+
+    data.grid = glm::uvec4(config.tilesX, config.tilesY, config.slices, config.maxLightsPerCluster);
+}
+
+void ClusteredLighting::SetLights(const std::vector<Light>& sceneLights) {
+    lights = sceneLights;
+
+    std::vector<GpuLight> gpuLights;
+    gpuLights.reserve(lights.size());
+    for (const auto& light : lights) gpuLights.push_back(ToGpuLight(light));
+
+    const size_t bytes = std::max<size_t>(gpuLights.size(), 1) * sizeof(GpuLight);
+    if (bytes > lightBuffer->size) {
+        lightBuffer = CreateBuffer(BufferType::Storage, bytes, nullptr, BufferUsage::Dynamic, LightBinding);
+    }
+    if (!gpuLights.empty()) {
+        lightBuffer->UpdateBuffer(gpuLights.data(), gpuLights.size() * sizeof(GpuLight));
+    }
+    data.lightCount = static_cast<uint32_t>(lights.size());
+}
+
+void ClusteredLighting::rebuildBounds(const glm::mat4& projection, glm::ivec2 resolution) {
+    bounds = ClusterCulling::ComputeBounds(config, projection, resolution);
+    boundsBuffer->UpdateBuffer(bounds.data(), bounds.size() * sizeof(ClusterBounds));
+    boundsProjection = projection;
+    boundsResolution = resolution;
+
+    const glm::vec2 depthRange = ClusterCulling::GetDepthRange(projection);
+    const glm::vec2 slice = ClusterCulling::GetSliceParameters(config, depthRange);
+    data.depth = glm::vec4(depthRange, slice);
+    data.tileSize = glm::ceil(glm::vec2(resolution) / glm::vec2(config.tilesX, config.tilesY));
+}
+
+void ClusteredLighting::Update(const glm::mat4& view, const glm::mat4& projection, glm::ivec2 resolution) {
+    if (projection != boundsProjection || resolution != boundsResolution) {
+        rebuildBounds(projection, resolution);
+    }
+    dataBuffer->UpdateBuffer(&data, sizeof(ClusterData));
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, LightBinding, lightBuffer->id);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, BoundsBinding, boundsBuffer->id);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CountBinding, countBuffer->id);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, IndexBinding, indexBuffer->id);
+
+    const uint32_t clusters = config.GetClusterCount();
+    assignProgram->SetUniformMat4("u_view", view);
+    assignProgram->SetUniform1ui("u_lightCount", data.lightCount);
+    assignProgram->SetUniform1ui("u_clusterCount", clusters);
+    assignProgram->SetUniform1ui("u_maxLightsPerCluster", config.maxLightsPerCluster);
+    assignProgram->useShaderProgram();
+    glDispatchCompute((clusters + AssignGroupSize - 1) / AssignGroupSize, 1, 1);
+}
+
+void ClusteredLighting::Bind() const {
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, LightBinding, lightBuffer->id);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CountBinding, countBuffer->id);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, IndexBinding, indexBuffer->id);
+    glBindBufferBase(GL_UNIFORM_BUFFER, ClusterData::Binding, dataBuffer->id);
+}
+
+ClusterLightLists ClusteredLighting::AssignOnCpu(const glm::mat4& view) const {
+    std::vector<ClusterLightSphere> spheres;
+    spheres.reserve(lights.size());
+    for (const auto& light : lights) {
+        spheres.push_back({glm::vec3(view * glm::vec4(light.position, 1.0f)), light.range});
+    }
+
+    ClusterLightLists result;
+    ClusterCulling::AssignLights(config, bounds, spheres, result);
+    return result;
+}
+
+ClusterLightLists ClusteredLighting::ReadBack() const {
+    ClusterLightLists result;
+    result.counts.resize(config.GetClusterCount());
+    result.indices.resize(static_cast<size_t>(config.GetClusterCount()) * config.maxLightsPerCluster);
+
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    countBuffer->ReadBuffer(result.counts.data(), result.counts.size() * sizeof(uint32_t));
+    indexBuffer->ReadBuffer(result.indices.data(), result.indices.size() * sizeof(uint32_t));
+    return result;
+}
+
+void ClusteredLighting::Benchmark(const std::vector<size_t>& lightCounts, const glm::mat4& view,
+                                  const glm::mat4& projection, glm::ivec2 resolution) {
+    constexpr int Iterations = 8;
+
+    const std::vector<Light> sceneLights = lights;
+    const glm::mat4 inverseView = glm::inverse(view);
+    const glm::vec2 depthRange = ClusterCulling::GetDepthRange(projection);
+    const float maxDepth = std::min(depthRange.y, depthRange.x * 1000.0f);
+    const glm::mat4 inverseProjection = glm::inverse(projection);
+
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    GLuint query;
+    glGenQueries(1, &query);
+
+    for (size_t count : lightCounts) {
+        // Uniform in screen space, log-uniform in depth, so every cluster slice sees some lights
+        std::vector<Light> generated(count);
+        for (auto& light : generated) {
+            glm::vec2 ndc(unit(random) * 2.0f - 1.0f, unit(random) * 2.0f - 1.0f);
+            float depth = depthRange.x * std::pow(maxDepth / depthRange.x, unit(random));
+            glm::vec4 nearPoint = inverseProjection * glm::vec4(ndc, -1.0f, 1.0f);
+            glm::vec3 direction = glm::vec3(nearPoint) / nearPoint.w;
+
+            light.position = glm::vec3(inverseView * glm::vec4(direction * (depth / -direction.z), 1.0f));
+            light.range = 0.02f * depth + 0.5f * unit(random);
+            light.color = glm::vec3(unit(random), unit(random), unit(random));
+        }
+        SetLights(generated);
+        Update(view, projection, resolution);
+
+        double cpuMilliseconds = 0.0;
+        ClusterLightLists reference;
+        for (int i = 0; i < Iterations; ++i) {
+            auto start = std::chrono::high_resolution_clock::now();
+            reference = AssignOnCpu(view);
+            cpuMilliseconds += std::chrono::duration<double, std::milli>(
+                std::chrono::high_resolution_clock::now() - start).count();
+        }
+
+        GLuint64 gpuNanoseconds = 0;
+        for (int i = 0; i < Iterations; ++i) {
+            GLuint64 elapsed = 0;
+            glBeginQuery(GL_TIME_ELAPSED, query);
+            Update(view, projection, resolution);
+            glEndQuery(GL_TIME_ELAPSED);
+            glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+            gpuNanoseconds += elapsed;
+        }
+
+        ClusterLightLists gpu = ReadBack();
+        size_t differing = 0, total = 0;
+        uint32_t densest = 0;
+        for (size_t cluster = 0; cluster < reference.counts.size(); ++cluster) {
+            const size_t base = cluster * config.maxLightsPerCluster;
+            const uint32_t lightsInCluster = reference.counts[cluster];
+            bool same = gpu.counts[cluster] == lightsInCluster &&
+                        std::equal(reference.indices.begin() + base, reference.indices.begin() + base + lightsInCluster,
+                                   gpu.indices.begin() + base);
+            if (!same) ++differing;
+            total += lightsInCluster;
+            densest = std::max(densest, lightsInCluster);
+        }
+
+        spdlog::info("Clustered lights {:>6}: CPU {:.3f} ms, GPU {:.3f} ms, {:.1f} average / {} max lights per cluster, "
+                     "{} clusters differ", count, cpuMilliseconds / Iterations, gpuNanoseconds / 1e6 / Iterations,
+                     static_cast<double>(total) / reference.counts.size(), densest, differing);
+    }
+
+    glDeleteQueries(1, &query);
+    SetLights(sceneLights);
+}
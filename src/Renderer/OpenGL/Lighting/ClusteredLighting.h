@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+#include "glad/glad.h"
+#include "Light.h"
+#include "ClusterCulling.h"
+#include "../Buffer/Buffer.h"
+#include "../Shader/ShaderProgram.h"
+
+// std140 mirror of ClusterData in Shader/include/clusters.glsl
+struct ClusterData {
+    glm::uvec4 grid{0u};            // tiles x, tiles y, depth slices, max lights per cluster
+    glm::vec4 depth{0.0f};          // near, far, slice scale, slice bias
+    glm::vec2 tileSize{0.0f};
+    uint32_t lightCount = 0;
+    uint32_t padding = 0;
+
+    static constexpr GLuint Binding = 1;
+};
+
+static_assert(offsetof(ClusterData, depth) == 16);
+static_assert(offsetof(ClusterData, tileSize) == 32);
+static_assert(offsetof(ClusterData, lightCount) == 40);
+static_assert(sizeof(ClusterData) == 48, "ClusterData must match the std140 size of the GLSL block");
+
+// Clustered forward lighting: every frame cluster_assign.comp bins the lights into a 3D grid over the
+// view frustum, and fragment shaders including clusters.glsl only loop over their cluster's list,
+// so shading cost follows the number of lights near each pixel rather than the scene total.
+class ClusteredLighting {
+    public:
+        explicit ClusteredLighting(const ClusterConfig& config = {});
+
+        // Replaces the scene's lights and uploads them
+        void SetLights(const std::vector<Light>& lights);
+        const std::vector<Light>& GetLights() const { return lights; }
+
+        // Rebuilds the cluster boxes when the projection or render size changed, then bins the
+        // lights on the GPU. Call once per frame after the camera moved, before shading. Shaders
+        // reading the lists need a GL_SHADER_STORAGE_BARRIER_BIT in between; a render graph pass
+        // declaring StorageWrite on the count and index buffers gets it inserted.
+        void Update(const glm::mat4& view, const glm::mat4& projection, glm::ivec2 resolution);
+
+        // Binds the light lists and ClusterData for shaders including clusters.glsl
+        void Bind() const;
+
+        // CPU reference of Update() for the same view, in the GPU layout
+        ClusterLightLists AssignOnCpu(const glm::mat4& view) const;
+        // Lists written by the last Update(); stalls on the GPU
+        ClusterLightLists ReadBack() const;
+
+        // Times CPU and GPU binning for each light count with random lights in the view frustum and
+        // logs the results along with any disagreement between the two. Restores the scene's lights.
+        void Benchmark(const std::vector<size_t>& lightCounts, const glm::mat4& view, const glm::mat4& projection,
+                       glm::ivec2 resolution);
+
+        const ClusterConfig& GetConfig() const { return config; }
+
+        // For declaring the binning pass in a render graph
+        Buffer& GetLightBuffer() { return *lightBuffer; }
+        Buffer& GetCountBuffer() { return *countBuffer; }
+        Buffer& GetIndexBuffer() { return *indexBuffer; }
+
+    private:
+        void rebuildBounds(const glm::mat4& projection, glm::ivec2 resolution);
+
+        ClusterConfig config;
+        std::vector<Light> lights;
+        std::vector<ClusterBounds> bounds;
+        glm::mat4 boundsProjection{0.0f};
+        glm::ivec2 boundsResolution{0};
+        ClusterData data;
+
+        std::unique_ptr<Buffer> lightBuffer;
+        std::unique_ptr<Buffer> boundsBuffer;
+        std::unique_ptr<Buffer> countBuffer;
+        std::unique_ptr<Buffer> indexBuffer;
+        std::unique_ptr<Buffer> dataBuffer;
+        std::unique_ptr<ShaderProgram> assignProgram;
+};
+
+inline std::unique_ptr<ClusteredLighting> CreateClusteredLighting(const ClusterConfig& config = {}) {
+    return std::make_unique<ClusteredLighting>(config);
+}
@@ -0,0 +1,281 @@
+#include "EnvironmentLighting.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+#include <spdlog/spdlog.h>
+
+#include "../Shader/ShaderProgram.h"
+#include "../../../Utils/AtomicFile.h"
+#include "../../../Utils/Hash.h"
+
+namespace {
+    constexpr GLuint GroupSize = 8;             // local size of the ibl_*.comp image passes
+    constexpr uint32_t CacheVersion = 1;
+
+    struct EnvironmentCacheHeader {
+        char magic[4] = {'E', 'N', 'V', 'C'};
+        uint32_t version = CacheVersion;
+        uint64_t key = 0;
+        uint64_t size = 0;                      // payload bytes after the header
+    };
+
+    // Payload of a cache entry for `key`, or empty when it is missing, stale or truncated
+    std::vector<char> ReadCacheFile(const std::string& path, uint64_t key, size_t expectedSize) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) return {};
+
+        EnvironmentCacheHeader header;
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if (!file || std::memcmp(header.magic, "ENVC", 4) != 0 || header.version != CacheVersion ||
+            header.key != key || header.size != expectedSize) {
+            return {};
+        }
+
+        std::vector<char> payload(expectedSize);
+        file.read(payload.data(), static_cast<std::streamsize>(payload.size()));
+        if (!file) return {};
+        return payload;
+    }
+
+    void WriteCacheFile(const std::string& path, uint64_t key, const std::vector<char>& payload) {
+        EnvironmentCacheHeader header;
+        header.key = key;
+        header.size = payload.size();
+
+        if (!WriteFileAtomic(path, {{&header, sizeof(header)}, {payload.data(), payload.size()}})) {
+            spdlog::warn("Failed to write environment cache {}", path);
+        }
+    }
+
+    size_t GetCubeLevelSize(int size, int level, size_t bytesPerTexel) {
+        const size_t levelSize = static_cast<size_t>(std::max(1, size >> level));
+        return levelSize * levelSize * 6 * bytesPerTexel;
+    }
+
+    GLuint GetGroupCount(int size) {
+        return (static_cast<GLuint>(size) + GroupSize - 1) / GroupSize;
+    }
+}
+
+EnvironmentLighting::EnvironmentLighting(const EnvironmentLightingSettings& settings)
+    : settings(settings)
+{
+    specular = CreateEmptyTexture(settings.specularSize, settings.specularSize, 1, TextureType::CubeMap,
+                                  TextureInternalFormat::RGBA16F, 0, TextureFilter::LinearMipmapLinear,
+                                  TextureFilter::Linear, TextureWrap::ClampToEdge, TextureWrap::ClampToEdge,
+                                  TextureWrap::ClampToEdge);
+    brdfLut = CreateRenderTexture(settings.brdfSize, settings.brdfSize, TextureInternalFormat::RG16F);
+    dataBuffer = CreateBuffer(BufferType::Uniform, sizeof(EnvironmentData), &data, BufferUsage::Dynamic,
+                              EnvironmentData::Binding);
+}
+
+uint64_t EnvironmentLighting::makeKey(const Texture& sky) const {
+    uint64_t key = HashCombine(CacheVersion, static_cast<uint64_t>(settings.environmentSize));
+    key = HashCombine(key, static_cast<uint64_t>(settings.specularSize));
+    key = HashCombine(key, static_cast<uint64_t>(settings.specularLevels));
+    key = HashCombine(key, settings.specularSamples);
+    key = HashCombine(key, static_cast<uint64_t>(settings.irradianceSize));
+    key = HashCombine(key, settings.srgbSource ? 1 : 0);
+
+    if (!sky.sourceFiles.empty()) {
+        for (const std::string& path : sky.sourceFiles) {
+            std::ifstream file(path, std::ios::binary);
+            std::vector<char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            key = HashCombine(key, HashBytes(bytes.data(), bytes.size()));
+        }
+        return key;
+    }
+
+    // Generated on the GPU: the pixels are the only identity it has
+    std::vector<float> pixels(static_cast<size_t>(sky.width) * sky.height * 6 * 4);
+    glGetTextureImage(sky.id, 0, GL_RGBA, GL_FLOAT, static_cast<GLsizei>(pixels.size() * sizeof(float)), pixels.data());
+    return HashCombine(key, HashBytes(pixels.data(), pixels.size() * sizeof(float)));
+}
+
+std::string EnvironmentLighting::pathFor(uint64_t key, const char* extension) const {
+    return (std::filesystem::path(settings.cacheDirectory) / (HashToString(key) + extension)).string();
+}
+
+void EnvironmentLighting::Load(const Texture& sky) {
+    if (sky.type != TextureType::CubeMap) {
+        throw std::runtime_error("Environment lighting needs a cube map");
+    }
+
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    const uint64_t brdfKey = HashCombine(HashCombine(CacheVersion, static_cast<uint64_t>(settings.brdfSize)),
+                                         settings.brdfSamples);
+    if (!readBrdfCache(brdfKey)) {
+        bakeBrdfLut();
+        writeBrdfCache(brdfKey);
+    }
+
+    const uint64_t key = makeKey(sky);
+    const bool cached = readCache(key);
+    if (!cached) {
+        bake(sky);
+        writeCache(key);
+    }
+
+    loaded = true;
+    data.params = glm::vec4(settings.intensity, static_cast<float>(std::max(settings.specularLevels - 1, 1)), 1.0f, 0.0f);
+    dataBuffer->UpdateBuffer(&data, sizeof(EnvironmentData));
+
+    const double milliseconds = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - start).count();
+    spdlog::info("Environment lighting {} in {:.1f} ms", cached ? "loaded from cache" : "filtered", milliseconds);
+}
+
+void EnvironmentLighting::bake(const Texture& sky) {
+    auto environmentShader = CreateShader(ShaderStage::Compute, "Shader/ibl_environment.comp");
+    auto specularShader = CreateShader(ShaderStage::Compute, "Shader/ibl_specular.comp");
+    auto irradianceShader = CreateShader(ShaderStage::Compute, "Shader/ibl_irradiance.comp");
+    auto environmentProgram = CreateShaderProgram(*environmentShader);
+    auto specularProgram = CreateShaderProgram(*specularShader);
+    auto irradianceProgram = CreateShaderProgram(*irradianceShader);
+
+    // Linear copy with a full mip chain; filtered importance sampling reads its small mips
+    const int environmentSize = std::min(settings.environmentSize, sky.width);
+    auto environment = CreateEmptyTexture(environmentSize, environmentSize, 1, TextureType::CubeMap,
+                                          TextureInternalFormat::RGBA16F, 0, TextureFilter::LinearMipmapLinear,
+                                          TextureFilter::Linear, TextureWrap::ClampToEdge, TextureWrap::ClampToEdge,
+                                          TextureWrap::ClampToEdge);
+
+    // Each bilinear tap already averages 2x2 source texels
+    const int taps = std::clamp(sky.width / environmentSize / 2, 1, 8);
+    environmentProgram->useShaderProgram();
+    environmentProgram->SetUniform1i("u_size", environmentSize);
+    environmentProgram->SetUniform1i("u_taps", taps);
+    environmentProgram->SetUniform1i("u_linearize", settings.srgbSource ? 1 : 0);
+    sky.BindTextureForSampling(0);
+    glBindImageTexture(0, environment->id, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+    glDispatchCompute(GetGroupCount(environmentSize), GetGroupCount(environmentSize), 6);
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT);
+    glGenerateTextureMipmap(environment->id);
+
+    specularProgram->useShaderProgram();
+    specularProgram->SetUniform1ui("u_sampleCount", settings.specularSamples);
+    specularProgram->SetUniform1f("u_environmentSize", static_cast<float>(environmentSize));
+    environment->BindTextureForSampling(0);
+    const int roughLevel = std::max(settings.specularLevels - 1, 1);
+    for (int level = 0; level < specular->levels; ++level) {
+        const int size = std::max(1, specular->width >> level);
+        specularProgram->SetUniform1i("u_size", size);
+        specularProgram->SetUniform1f("u_roughness", std::min(static_cast<float>(level) / roughLevel, 1.0f));
+        glBindImageTexture(0, specular->id, level, GL_TRUE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+        glDispatchCompute(GetGroupCount(size), GetGroupCount(size), 6);
+    }
+
+    // The mip whose faces are irradianceSize wide, or the smallest there is
+    const int irradianceLevel = std::clamp(static_cast<int>(std::round(std::log2(
+        static_cast<float>(environmentSize) / std::max(settings.irradianceSize, 1)))), 0, environment->levels - 1);
+    irradianceProgram->useShaderProgram();
+    irradianceProgram->SetUniform1i("u_size", std::max(1, environmentSize >> irradianceLevel));
+    irradianceProgram->SetUniform1f("u_lod", static_cast<float>(irradianceLevel));
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, dataBuffer->id);
+    glDispatchCompute(1, 1, 1);
+
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT | GL_UNIFORM_BARRIER_BIT |
+                    GL_BUFFER_UPDATE_BARRIER_BIT);
+    dataBuffer->ReadBuffer(data.irradiance, sizeof(data.irradiance));
+
+    validateIrradiance(*environment, irradianceLevel);
+}
+
+void EnvironmentLighting::bakeBrdfLut() {
+    auto shader = CreateShader(ShaderStage::Compute, "Shader/ibl_brdf.comp");
+    auto program = CreateShaderProgram(*shader);
+
+    program->useShaderProgram();
+    program->SetUniform1i("u_size", brdfLut->width);
+    program->SetUniform1ui("u_sampleCount", settings.brdfSamples);
+    glBindImageTexture(0, brdfLut->id, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RG16F);
+    glDispatchCompute(GetGroupCount(brdfLut->width), GetGroupCount(brdfLut->height), 1);
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT);
+}
+
+void EnvironmentLighting::validateIrradiance(const Texture& environment, int level) {
+    const int size = std::max(1, environment.width >> level);
+    const size_t faceFloats = static_cast<size_t>(size) * size * 4;
+    std::vector<float> pixels(faceFloats * 6);
+    glGetTextureImage(environment.id, level, GL_RGBA, GL_FLOAT, static_cast<GLsizei>(pixels.size() * sizeof(float)),
+                      pixels.data());
+
+    CubemapFaces faces;
+    faces.size = size;
+    for (int face = 0; face < 6; ++face) faces.faces[face] = pixels.data() + faceFloats * face;
+
+    const SH9Color cpu = SphericalHarmonics::ConvolveIrradiance(SphericalHarmonics::ProjectCubemap(faces));
+    const SH9Color gpu = GetIrradiance();
+    float difference = 0.0f;
+    for (int k = 0; k < 9; ++k) {
+        difference = std::max(difference, glm::length(cpu.coefficients[k] - gpu.coefficients[k]));
+    }
+    spdlog::info("Environment irradiance: GPU and CPU SH9 differ by at most {:.2e}", difference);
+}
+
+SH9Color EnvironmentLighting::GetIrradiance() const {
+    SH9Color result;
+    for (int k = 0; k < 9; ++k) result.coefficients[k] = glm::vec3(data.irradiance[k]);
+    return result;
+}
+
+bool EnvironmentLighting::readCache(uint64_t key) {
+    size_t expected = sizeof(data.irradiance);
+    for (int level = 0; level < specular->levels; ++level) expected += GetCubeLevelSize(specular->width, level, 8);
+
+    std::vector<char> payload = ReadCacheFile(pathFor(key, ".env"), key, expected);
+    if (payload.empty()) return false;
+
+    std::memcpy(data.irradiance, payload.data(), sizeof(data.irradiance));
+    size_t offset = sizeof(data.irradiance);
+    for (int level = 0; level < specular->levels; ++level) {
+        const int size = std::max(1, specular->width >> level);
+        glTextureSubImage3D(specular->id, level, 0, 0, 0, size, size, 6, GL_RGBA, GL_HALF_FLOAT, payload.data() + offset);
+        offset += GetCubeLevelSize(specular->width, level, 8);
+    }
+    return true;
+}
+
+void EnvironmentLighting::writeCache(uint64_t key) {
+    std::vector<char> payload(sizeof(data.irradiance));
+    std::memcpy(payload.data(), data.irradiance, sizeof(data.irradiance));
+    for (int level = 0; level < specular->levels; ++level) {
+        const size_t offset = payload.size();
+        const size_t levelSize = GetCubeLevelSize(specular->width, level, 8);
+        payload.resize(offset + levelSize);
+        glGetTextureImage(specular->id, level, GL_RGBA, GL_HALF_FLOAT, static_cast<GLsizei>(levelSize), payload.data() + offset);
+    }
+    WriteCacheFile(pathFor(key, ".env"), key, payload);
+}
+
+bool EnvironmentLighting::readBrdfCache(uint64_t key) {
+    const size_t expected = static_cast<size_t>(brdfLut->width) * brdfLut->height * 4;
+    std::vector<char> payload = ReadCacheFile(pathFor(key, ".brdf"), key, expected);
+    if (payload.empty()) return false;
+
+    glTextureSubImage2D(brdfLut->id, 0, 0, 0, brdfLut->width, brdfLut->height, GL_RG, GL_HALF_FLOAT, payload.data());
+    return true;
+}
+
+void EnvironmentLighting::writeBrdfCache(uint64_t key) {
+    std::vector<char> payload(static_cast<size_t>(brdfLut->width) * brdfLut->height * 4);
+    glGetTextureImage(brdfLut->id, 0, GL_RG, GL_HALF_FLOAT, static_cast<GLsizei>(payload.size()), payload.data());
+    WriteCacheFile(pathFor(key, ".brdf"), key, payload);
+}
+
+void EnvironmentLighting::Bind() {
+    if (loaded && data.params.x != settings.intensity) {
+        data.params.x = settings.intensity;
+        dataBuffer->UpdateBuffer(&data.params, sizeof(data.params), offsetof(EnvironmentData, params));
+    }
+    glBindBufferBase(GL_UNIFORM_BUFFER, EnvironmentData::Binding, dataBuffer->id);
+    specular->BindTextureForSampling(9);
+    brdfLut->BindTextureForSampling(10);
+}
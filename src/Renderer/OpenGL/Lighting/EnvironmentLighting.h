@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <glm/glm.hpp>
+#include "glad/glad.h"
+#include "SphericalHarmonics.h"
+#include "../Buffer/Buffer.h"
+#include "../Texture/Texture.h"
+
+// std140 mirror of EnvironmentData in Shader/include/environment.glsl
+struct EnvironmentData {
+    glm::vec4 irradiance[9];            // rgb SH9, cosine-convolved and divided by pi
+    glm::vec4 params{0.0f};             // intensity, last specular mip, 1 when loaded
+
+    static constexpr GLuint Binding = 3;
+};
+
+static_assert(offsetof(EnvironmentData, params) == 144);
+static_assert(sizeof(EnvironmentData) == 160, "EnvironmentData must match the std140 size of the GLSL block");
+
+struct EnvironmentLightingSettings {
+    int environmentSize = 256;          // linear copy of the sky the filters read, full mip chain
+    int specularSize = 128;             // prefiltered level 0
+    int specularLevels = 6;             // mips from roughness 0 to 1; smaller ones repeat roughness 1
+    uint32_t specularSamples = 64;
+    int irradianceSize = 32;            // face size of the environment mip projected onto SH9
+    int brdfSize = 128;
+    uint32_t brdfSamples = 512;
+    bool srgbSource = true;             // the sky is 8-bit sRGB and is linearized on the way in
+    float intensity = 1.0f;
+    std::string cacheDirectory = "EnvironmentCache";
+};
+
+// Image-based ambient light from a sky cube map, for shaders including environment.glsl. Load() runs
+// compute passes that turn the sky into a linear environment, a nine-coefficient irradiance SH, a
+// GGX-prefiltered specular mip chain and a split-sum BRDF table, and stores the results on disk keyed
+// by the sky's files and these settings, so each environment is filtered once rather than per launch.
+class EnvironmentLighting {
+    public:
+        explicit EnvironmentLighting(const EnvironmentLightingSettings& settings = {});
+
+        // Filters `sky` or loads its cached results. Stalls for the readback when it has to filter.
+        void Load(const Texture& sky);
+
+        // Binds EnvironmentData, the specular cube map and the BRDF table. Until Load() succeeds
+        // shaders fall back to the flat FrameData ambient.
+        void Bind();
+
+        bool IsLoaded() const { return loaded; }
+        SH9Color GetIrradiance() const;
+        Texture& GetSpecular() { return *specular; }
+        Texture& GetBrdfLut() { return *brdfLut; }
+
+        EnvironmentLightingSettings settings;
+
+    private:
+        uint64_t makeKey(const Texture& sky) const;
+        std::string pathFor(uint64_t key, const char* extension) const;
+
+        void bake(const Texture& sky);
+        void bakeBrdfLut();
+        // CPU projection of the environment mip the GPU projected; logs how far the two differ
+        void validateIrradiance(const Texture& environment, int level);
+
+        bool readCache(uint64_t key);
+        void writeCache(uint64_t key);
+        bool readBrdfCache(uint64_t key);
+        void writeBrdfCache(uint64_t key);
+
+        EnvironmentData data;
+        bool loaded = false;
+
+        std::unique_ptr<Texture> specular;
+        std::unique_ptr<Texture> brdfLut;
+        std::unique_ptr<Buffer> dataBuffer;
+};
+
+inline std::unique_ptr<EnvironmentLighting> CreateEnvironmentLighting(const EnvironmentLightingSettings& settings = {}) {
+    return std::make_unique<EnvironmentLighting>(settings);
+}
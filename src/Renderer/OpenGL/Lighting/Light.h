@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cmath>
+#include <glm/glm.hpp>
+
+enum class LightType : int {
+    Point = 0,
+    Spot = 1
+};
+
+// A local light as the scene describes it. Lights only reach `range` units; the clustered pass
+// culls with that sphere, so keep it tight.
+struct Light {
+    LightType type = LightType::Point;
+    glm::vec3 position{0.0f};
+    float range = 10.0f;
+    glm::vec3 color{1.0f};
+    float intensity = 1.0f;
+    glm::vec3 direction{0.0f, -1.0f, 0.0f};     // spot lights only
+    float innerAngle = 0.4f;                     // radians, full intensity inside
+    float outerAngle = 0.6f;                     // radians, no light outside
+};
+
+// std430 layout of `lights[]` in Shader/include/clusters.glsl
+struct GpuLight {
+    glm::vec4 positionRange;        // xyz world position, w range
+    glm::vec4 colorIntensity;       // rgb color, w intensity
+    glm::vec4 directionType;        // xyz spot direction, w LightType
+    glm::vec4 spotAngles;           // x cos(inner), y cos(outer)
+};
+
+static_assert(sizeof(GpuLight) == 64, "GpuLight must match the std430 Light struct");
+
+inline GpuLight ToGpuLight(const Light& light) {
+    return {
+        glm::vec4(light.position, light.range),
+        glm::vec4(light.color, light.intensity),
+        glm::vec4(glm::normalize(light.direction), static_cast<float>(light.type)),
+        glm::vec4(std::cos(light.innerAngle), std::cos(light.outerAngle), 0.0f, 0.0f)
+    };
+}
@@ -0,0 +1,223 @@
+#include "SphericalHarmonics.h"
+#include <cmath>
+#include "../../../Utils/ThreadPool.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SPHERICAL_HARMONICS_SSE2 1
+#endif
+
+namespace {
+    // Face direction = u * uAxis + v * vAxis + normal, in GL face order
+    struct FaceAxes {
+        glm::vec3 uAxis;
+        glm::vec3 vAxis;
+        glm::vec3 normal;
+    };
+
+    constexpr FaceAxes Faces[6] = {
+        {{0.0f, 0.0f, -1.0f}, {0.0f, -1.0f, 0.0f}, {1.0f, 0.0f, 0.0f}},
+        {{0.0f, 0.0f, 1.0f}, {0.0f, -1.0f, 0.0f}, {-1.0f, 0.0f, 0.0f}},
+        {{1.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 1.0f}, {0.0f, 1.0f, 0.0f}},
+        {{1.0f, 0.0f, 0.0f}, {0.0f, 0.0f, -1.0f}, {0.0f, -1.0f, 0.0f}},
+        {{1.0f, 0.0f, 0.0f}, {0.0f, -1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}},
+        {{-1.0f, 0.0f, 0.0f}, {0.0f, -1.0f, 0.0f}, {0.0f, 0.0f, -1.0f}},
+    };
+
+    constexpr float Pi = 3.14159265358979f;
+
+    // Weighted radiance sums: 9 coefficients x RGB, then the total weight
+    struct Accumulator {
+        double sums[28] = {};
+
+        void add(const Accumulator& other) {
+            for (int i = 0; i < 28; ++i) sums[i] += other.sums[i];
+        }
+    };
+
+    // Texel at face coordinates u, v with its solid angle up to a constant factor, which the final
+    // normalization by the total weight removes
+    void AccumulateTexel(int face, float u, float v, const float* rgba, Accumulator& accumulator) {
+        const float lengthSquared = 1.0f + u * u + v * v;
+        const float inverseLength = 1.0f / std::sqrt(lengthSquared);
+        const float weight = inverseLength * inverseLength * inverseLength;
+        const glm::vec3 direction = SphericalHarmonics::GetFaceDirection(face, u, v) * inverseLength;
+        const std::array<float, 9> basis = SphericalHarmonics::EvaluateBasis(direction);
+
+        for (int k = 0; k < 9; ++k) {
+            const float scale = basis[k] * weight;
+            accumulator.sums[k * 3 + 0] += rgba[0] * scale;
+            accumulator.sums[k * 3 + 1] += rgba[1] * scale;
+            accumulator.sums[k * 3 + 2] += rgba[2] * scale;
+        }
+        accumulator.sums[27] += weight;
+    }
+
+    void ProjectRowScalar(const CubemapFaces& cubemap, int face, int row, int firstColumn, Accumulator& accumulator) {
+        const int size = cubemap.size;
+        const float texel = 2.0f / static_cast<float>(size);
+        const float v = (static_cast<float>(row) + 0.5f) * texel - 1.0f;
+        const float* pixels = cubemap.faces[face] + static_cast<size_t>(row) * size * 4;
+
+        for (int x = firstColumn; x < size; ++x) {
+            const float u = (static_cast<float>(x) + 0.5f) * texel - 1.0f;
+            AccumulateTexel(face, u, v, pixels + static_cast<size_t>(x) * 4, accumulator);
+        }
+    }
+
+#ifdef SPHERICAL_HARMONICS_SSE2
+    float HorizontalSum(__m128 value) {
+        __m128 shuffled = _mm_shuffle_ps(value, value, _MM_SHUFFLE(2, 3, 0, 1));
+        __m128 sums = _mm_add_ps(value, shuffled);
+        shuffled = _mm_movehl_ps(shuffled, sums);
+        return _mm_cvtss_f32(_mm_add_ss(sums, shuffled));
+    }
+
+    // Four texels per step across the row; returns the first column left for the scalar tail
+    int ProjectRowSimd(const CubemapFaces& cubemap, int face, int row, Accumulator& accumulator) {
+        const int size = cubemap.size;
+        const int end = size & ~3;
+        const float texel = 2.0f / static_cast<float>(size);
+        const float v = (static_cast<float>(row) + 0.5f) * texel - 1.0f;
+        const float* pixels = cubemap.faces[face] + static_cast<size_t>(row) * size * 4;
+        const FaceAxes& axes = Faces[face];
+
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 vSquared = _mm_set1_ps(v * v);
+        // Per axis, the part of the direction that does not depend on u
+        const __m128 baseX = _mm_set1_ps(axes.vAxis.x * v + axes.normal.x);
+        const __m128 baseY = _mm_set1_ps(axes.vAxis.y * v + axes.normal.y);
+        const __m128 baseZ = _mm_set1_ps(axes.vAxis.z * v + axes.normal.z);
+        const __m128 uAxisX = _mm_set1_ps(axes.uAxis.x);
+        const __m128 uAxisY = _mm_set1_ps(axes.uAxis.y);
+        const __m128 uAxisZ = _mm_set1_ps(axes.uAxis.z);
+
+        __m128 sums[28];
+        for (__m128& sum : sums) sum = _mm_setzero_ps();
+
+        for (int x = 0; x < end; x += 4) {
+            const float u0 = (static_cast<float>(x) + 0.5f) * texel - 1.0f;
+            const __m128 u = _mm_add_ps(_mm_set1_ps(u0), _mm_set_ps(3.0f * texel, 2.0f * texel, texel, 0.0f));
+
+            const __m128 lengthSquared = _mm_add_ps(_mm_add_ps(one, _mm_mul_ps(u, u)), vSquared);
+            const __m128 inverseLength = _mm_div_ps(one, _mm_sqrt_ps(lengthSquared));
+            const __m128 weight = _mm_mul_ps(_mm_mul_ps(inverseLength, inverseLength), inverseLength);
+
+            const __m128 dx = _mm_mul_ps(_mm_add_ps(baseX, _mm_mul_ps(uAxisX, u)), inverseLength);
+            const __m128 dy = _mm_mul_ps(_mm_add_ps(baseY, _mm_mul_ps(uAxisY, u)), inverseLength);
+            const __m128 dz = _mm_mul_ps(_mm_add_ps(baseZ, _mm_mul_ps(uAxisZ, u)), inverseLength);
+
+            __m128 basis[9];
+            basis[0] = _mm_set1_ps(0.282095f);
+            basis[1] = _mm_mul_ps(_mm_set1_ps(0.488603f), dy);
+            basis[2] = _mm_mul_ps(_mm_set1_ps(0.488603f), dz);
+            basis[3] = _mm_mul_ps(_mm_set1_ps(0.488603f), dx);
+            basis[4] = _mm_mul_ps(_mm_set1_ps(1.092548f), _mm_mul_ps(dx, dy));
+            basis[5] = _mm_mul_ps(_mm_set1_ps(1.092548f), _mm_mul_ps(dy, dz));
+            basis[6] = _mm_mul_ps(_mm_set1_ps(0.315392f), _mm_sub_ps(_mm_mul_ps(_mm_set1_ps(3.0f), _mm_mul_ps(dz, dz)), one));
+            basis[7] = _mm_mul_ps(_mm_set1_ps(1.092548f), _mm_mul_ps(dx, dz));
+            basis[8] = _mm_mul_ps(_mm_set1_ps(0.546274f), _mm_sub_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+
+            // RGBA texels to one register per channel
+            __m128 r = _mm_loadu_ps(pixels + static_cast<size_t>(x) * 4);
+            __m128 g = _mm_loadu_ps(pixels + static_cast<size_t>(x + 1) * 4);
+            __m128 b = _mm_loadu_ps(pixels + static_cast<size_t>(x + 2) * 4);
+            __m128 a = _mm_loadu_ps(pixels + static_cast<size_t>(x + 3) * 4);
+            _MM_TRANSPOSE4_PS(r, g, b, a);
+            r = _mm_mul_ps(r, weight);
+            g = _mm_mul_ps(g, weight);
+            b = _mm_mul_ps(b, weight);
+
+            for (int k = 0; k < 9; ++k) {
+                sums[k * 3 + 0] = _mm_add_ps(sums[k * 3 + 0], _mm_mul_ps(basis[k], r));
+                sums[k * 3 + 1] = _mm_add_ps(sums[k * 3 + 1], _mm_mul_ps(basis[k], g));
+                sums[k * 3 + 2] = _mm_add_ps(sums[k * 3 + 2], _mm_mul_ps(basis[k], b));
+            }
+            sums[27] = _mm_add_ps(sums[27], weight);
+        }
+
+        for (int i = 0; i < 28; ++i) accumulator.sums[i] += HorizontalSum(sums[i]);
+        return end;
+    }
+#endif
+
+    SH9Color Normalize(const Accumulator& accumulator) {
+        // Scaled so the weights integrate to the full sphere
+        SH9Color result;
+        if (accumulator.sums[27] <= 0.0) return result;
+
+        const double scale = 4.0 * Pi / accumulator.sums[27];
+        for (int k = 0; k < 9; ++k) {
+            result.coefficients[k] = glm::vec3(static_cast<float>(accumulator.sums[k * 3 + 0] * scale),
+                                               static_cast<float>(accumulator.sums[k * 3 + 1] * scale),
+                                               static_cast<float>(accumulator.sums[k * 3 + 2] * scale));
+        }
+        return result;
+    }
+}
+
+namespace SphericalHarmonics {
+
+glm::vec3 GetFaceDirection(int face, float u, float v) {
+    const FaceAxes& axes = Faces[face];
+    return axes.uAxis * u + axes.vAxis * v + axes.normal;
+}
+
+std::array<float, 9> EvaluateBasis(const glm::vec3& d) {
+    return {
+        0.282095f,
+        0.488603f * d.y,
+        0.488603f * d.z,
+        0.488603f * d.x,
+        1.092548f * d.x * d.y,
+        1.092548f * d.y * d.z,
+        0.315392f * (3.0f * d.z * d.z - 1.0f),
+        1.092548f * d.x * d.z,
+        0.546274f * (d.x * d.x - d.y * d.y),
+    };
+}
+
+SH9Color ProjectCubemap(const CubemapFaces& cubemap) {
+    Accumulator faces[6];
+    GetThreadPool().ParallelFor(6, [&](size_t face) {
+        for (int row = 0; row < cubemap.size; ++row) {
+#ifdef SPHERICAL_HARMONICS_SSE2
+            const int tail = ProjectRowSimd(cubemap, static_cast<int>(face), row, faces[face]);
+#else
+            const int tail = 0;
+#endif
+            ProjectRowScalar(cubemap, static_cast<int>(face), row, tail, faces[face]);
+        }
+    });
+
+    Accumulator total;
+    for (const Accumulator& face : faces) total.add(face);
+    return Normalize(total);
+}
+
+SH9Color ProjectCubemapScalar(const CubemapFaces& cubemap) {
+    Accumulator total;
+    for (int face = 0; face < 6; ++face) {
+        for (int row = 0; row < cubemap.size; ++row) {
+            ProjectRowScalar(cubemap, face, row, 0, total);
+        }
+    }
+    return Normalize(total);
+}
+
+SH9Color ConvolveIrradiance(const SH9Color& radiance) {
+    // Clamped cosine lobe per band (pi, 2pi/3, pi/4), divided by pi
+    constexpr float band[9] = {1.0f, 2.0f / 3.0f, 2.0f / 3.0f, 2.0f / 3.0f, 0.25f, 0.25f, 0.25f, 0.25f, 0.25f};
+    SH9Color result;
+    for (int k = 0; k < 9; ++k) result.coefficients[k] = radiance.coefficients[k] * band[k];
+    return result;
+}
+
+glm::vec3 Evaluate(const SH9Color& sh, const glm::vec3& direction) {
+    const std::array<float, 9> basis = EvaluateBasis(direction);
+    glm::vec3 result(0.0f);
+    for (int k = 0; k < 9; ++k) result += sh.coefficients[k] * basis[k];
+    return result;
+}
+
+}
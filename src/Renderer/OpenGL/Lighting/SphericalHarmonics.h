@@ -0,0 +1,40 @@
+#pragma once
+
+#include <array>
+#include <glm/glm.hpp>
+
+// Order-2 real spherical harmonics (nine coefficients per channel) of cube map radiance, the CPU side
+// of Shader/ibl_irradiance.comp. Both use the same face directions, texel weights and basis, so a
+// projection computed here can be compared directly with the one the GPU wrote.
+
+// RGB coefficients, band-major: Y00, Y1-1, Y10, Y11, Y2-2, Y2-1, Y20, Y21, Y22
+struct SH9Color {
+    std::array<glm::vec3, 9> coefficients{};
+};
+
+// Six square faces of linear RGBA float texels in GL face order (+X, -X, +Y, -Y, +Z, -Z), each
+// tightly packed and in GL texel order (row 0 at t = 0), as glGetTextureImage returns them
+struct CubemapFaces {
+    int size = 0;
+    std::array<const float*, 6> faces{};
+};
+
+namespace SphericalHarmonics {
+    // Unnormalized direction through face coordinates `u`, `v` in [-1, 1]
+    glm::vec3 GetFaceDirection(int face, float u, float v);
+
+    // The nine basis functions at unit `direction`
+    std::array<float, 9> EvaluateBasis(const glm::vec3& direction);
+
+    // Radiance projection weighted by each texel's solid angle. Faces and rows are spread over the
+    // worker pool, and four texels go through the basis at once with SSE2 where it is available.
+    SH9Color ProjectCubemap(const CubemapFaces& cubemap);
+    // One texel at a time on the calling thread; the reference for ProjectCubemap
+    SH9Color ProjectCubemapScalar(const CubemapFaces& cubemap);
+
+    // Convolves radiance with the clamped cosine lobe and divides by pi, so Evaluate() of the result
+    // times albedo is the diffuse light a Lambertian surface with that normal reflects
+    SH9Color ConvolveIrradiance(const SH9Color& radiance);
+
+    glm::vec3 Evaluate(const SH9Color& sh, const glm::vec3& direction);
+}
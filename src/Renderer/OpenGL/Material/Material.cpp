@@ -1,4 +1,5 @@
 #include "Material.h"
+#include "../Texture/TextureCache.h"
 #include <iostream>
 #include <stdexcept>
 
@@ -15,6 +16,12 @@ Material::Material(const std::string& name) : m_name(name) {
     SetBool("u_hasNormalTexture", false);
     SetBool("u_hasEmissiveTexture", false);
     SetBool("u_hasOcclusionTexture", false);
+
+    SetTextureTransform("u_baseColorTexture", glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
+    SetTextureTransform("u_metallicRoughnessTexture", glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
+    SetTextureTransform("u_normalTexture", glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
+    SetTextureTransform("u_emissiveTexture", glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
+    SetTextureTransform("u_occlusionTexture", glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
 }
 
 void Material::SetFloat(const std::string& name, float value) {
@@ -41,8 +48,8 @@ void Material::SetBool(const std::string& name, bool value) {
     m_parameters[name] = MaterialUniform(value);
 }
 
-void Material::SetTexture(const std::string& name, std::shared_ptr<Texture> texture) {
-    m_parameters[name] = MaterialUniform(texture);
+void Material::SetTexture(const std::string& name, std::shared_ptr<Texture> texture, std::shared_ptr<const Sampler> sampler) {
+    m_parameters[name] = MaterialUniform(texture, sampler);
     
     if (name == "u_baseColorTexture") {
         SetBool("u_hasBaseColorTexture", texture != nullptr);
@@ -105,6 +112,14 @@ bool Material::GetBool(const std::string& name) const {
     return false;
 }
 
+std::shared_ptr<const Sampler> Material::GetSampler(const std::string& name) const {
+    auto it = m_parameters.find(name);
+    if (it != m_parameters.end() && it->second.type == MaterialParameter::Texture) {
+        return it->second.samplerValue;
+    }
+    return nullptr;
+}
+
 std::shared_ptr<Texture> Material::GetTexture(const std::string& name) const {
     auto it = m_parameters.find(name);
     if (it != m_parameters.end() && it->second.type == MaterialParameter::Texture) {
@@ -113,43 +128,76 @@ std::shared_ptr<Texture> Material::GetTexture(const std::string& name) const {
     return nullptr;
 }
 
-void Material::Bind() {
-    if (!m_shader) {
+const std::vector<std::string>& GetMaterialFeatureDefines() {
+    static const std::vector<std::string> defines = {
+        "HAS_BASE_COLOR_TEXTURE",
+        "HAS_METALLIC_ROUGHNESS_TEXTURE",
+        "HAS_NORMAL_TEXTURE",
+        "HAS_EMISSIVE_TEXTURE",
+        "HAS_OCCLUSION_TEXTURE"
+    };
+    return defines;
+}
+
+uint32_t Material::GetFeatures() const {
+    static const std::pair<const char*, MaterialFeature> textures[] = {
+        {"u_baseColorTexture", MaterialFeatureBaseColorTexture},
+        {"u_metallicRoughnessTexture", MaterialFeatureMetallicRoughnessTexture},
+        {"u_normalTexture", MaterialFeatureNormalTexture},
+        {"u_emissiveTexture", MaterialFeatureEmissiveTexture},
+        {"u_occlusionTexture", MaterialFeatureOcclusionTexture}
+    };
+
+    uint32_t features = 0;
+    for (const auto& [name, feature] : textures) {
+        if (GetTexture(name)) features |= feature;
+    }
+    return features;
+}
+
+void Material::Bind(ShaderProgram* program) {
+    ShaderProgram* shader = program ? program : m_shader.get();
+    if (!shader) {
         std::cerr << "Warning: Material '" << m_name << "' has no shader assigned!" << std::endl;
         return;
     }
 
-    m_shader->useShaderProgram();
+    shader->useShaderProgram();
 
     m_nextTextureUnit = 0;
+    m_textureBindings.Clear();
 
     for (const auto& [name, uniform] : m_parameters) {
         switch (uniform.type) {
             case MaterialParameter::Float:
-                m_shader->SetUniform1f(name, uniform.floatValue);
+                shader->SetUniform1f(name, uniform.floatValue);
                 break;
             case MaterialParameter::Vec2:
-                m_shader->SetUniformVec2(name, uniform.vec2Value);
+                shader->SetUniformVec2(name, uniform.vec2Value);
                 break;
             case MaterialParameter::Vec3:
-                m_shader->SetUniformVec3(name, uniform.vec3Value);
+                shader->SetUniformVec3(name, uniform.vec3Value);
                 break;
             case MaterialParameter::Vec4:
-                m_shader->SetUniformVec4(name, uniform.vec4Value);
+                shader->SetUniformVec4(name, uniform.vec4Value);
                 break;
             case MaterialParameter::Int:
-                m_shader->SetUniform1i(name, uniform.intValue);
+                shader->SetUniform1i(name, uniform.intValue);
                 break;
             case MaterialParameter::Bool:
-                m_shader->SetUniform1i(name, uniform.boolValue ? 1 : 0);
+                shader->SetUniform1i(name, uniform.boolValue ? 1 : 0);
                 break;
             case MaterialParameter::Texture:
                 if (uniform.textureValue) {
-                    GLuint textureUnit = m_nextTextureUnit++;
-                    uniform.textureValue->BindTextureForSampling(textureUnit);
-                    m_shader->SetUniform1i(name, textureUnit);
+                    GLuint textureUnit = m_textureBindings.Add(*uniform.textureValue, uniform.samplerValue.get());
+                    m_nextTextureUnit = textureUnit + 1;
+                    GetTextureCache().Touch(uniform.textureValue.get());
+                    shader->SetUniform1i(name, textureUnit);
                 }
                 break;
         }
     }
+
+    // All textures and samplers go out in two calls instead of two per texture.
+    m_textureBindings.Bind(0);
 }
\ No newline at end of file
@@ -5,8 +5,11 @@
 #include <string>
 #include <unordered_map>
 #include <memory>
+#include <vector>
 #include "../Shader/ShaderProgram.h"
+#include "../Shader/ShaderVariants.h"
 #include "../Texture/Texture.h"
+#include "../Texture/Sampler.h"
 
 enum class MaterialParameter {
     Float,
@@ -29,6 +32,7 @@ struct MaterialUniform {
         bool boolValue;
     };
     std::shared_ptr<Texture> textureValue;
+    std::shared_ptr<const Sampler> samplerValue;    // null samples with the texture's default sampler
     
     MaterialUniform() = default;
     MaterialUniform(float value) : type(MaterialParameter::Float), floatValue(value) {}
@@ -37,9 +41,22 @@ struct MaterialUniform {
     MaterialUniform(const glm::vec4& value) : type(MaterialParameter::Vec4), vec4Value(value) {}
     MaterialUniform(int value) : type(MaterialParameter::Int), intValue(value) {}
     MaterialUniform(bool value) : type(MaterialParameter::Bool), boolValue(value) {}
-    MaterialUniform(std::shared_ptr<Texture> texture) : type(MaterialParameter::Texture), textureValue(texture) {}
+    MaterialUniform(std::shared_ptr<Texture> texture, std::shared_ptr<const Sampler> sampler = nullptr)
+        : type(MaterialParameter::Texture), textureValue(texture), samplerValue(sampler) {}
 };
 
+// Features a material's shader variant is specialized on; bit i maps to GetMaterialFeatureDefines()[i].
+enum MaterialFeature : uint32_t {
+    MaterialFeatureBaseColorTexture = 1u << 0,
+    MaterialFeatureMetallicRoughnessTexture = 1u << 1,
+    MaterialFeatureNormalTexture = 1u << 2,
+    MaterialFeatureEmissiveTexture = 1u << 3,
+    MaterialFeatureOcclusionTexture = 1u << 4
+};
+
+// HAS_* define names used by include/material_features.glsl, in MaterialFeature bit order
+const std::vector<std::string>& GetMaterialFeatureDefines();
+
 class Material {
 public:
     Material(const std::string& name = "DefaultMaterial");
@@ -54,7 +71,7 @@ public:
     void SetVec4(const std::string& name, const glm::vec4& value);
     void SetInt(const std::string& name, int value);
     void SetBool(const std::string& name, bool value);
-    void SetTexture(const std::string& name, std::shared_ptr<Texture> texture);
+    void SetTexture(const std::string& name, std::shared_ptr<Texture> texture, std::shared_ptr<const Sampler> sampler = nullptr);
 
     float GetFloat(const std::string& name) const;
     glm::vec2 GetVec2(const std::string& name) const;
@@ -63,20 +80,34 @@ public:
     int GetInt(const std::string& name) const;
     bool GetBool(const std::string& name) const;
     std::shared_ptr<Texture> GetTexture(const std::string& name) const;
+    std::shared_ptr<const Sampler> GetSampler(const std::string& name) const;
 
-    void Bind();
+    // Binds the parameters to the material's own program, or to `program` when a pass draws the
+    // material with a different shader (depth prepass, G-buffer)
+    void Bind(ShaderProgram* program = nullptr);
+
+    // Program drawing this material: its own, or the variant for its features from `passVariants`
+    std::shared_ptr<ShaderProgram> GetShader(ShaderVariantCache* passVariants) const {
+        return passVariants ? passVariants->Get(GetFeatures()) : m_shader;
+    }
+
+    // MaterialFeature bits for the textures currently set
+    uint32_t GetFeatures() const;
 
     const std::string& GetName() const { return m_name; }
     void SetName(const std::string& name) { m_name = name; }
 
     void SetBaseColor(const glm::vec4& color) { SetVec4("u_baseColorFactor", color); }
-    void SetBaseColorTexture(std::shared_ptr<Texture> texture) { SetTexture("u_baseColorTexture", texture); }
+    void SetBaseColorTexture(std::shared_ptr<Texture> texture, std::shared_ptr<const Sampler> sampler = nullptr) { SetTexture("u_baseColorTexture", texture, sampler); }
     void SetMetallicFactor(float metallic) { SetFloat("u_metallicFactor", metallic); }
     void SetRoughnessFactor(float roughness) { SetFloat("u_roughnessFactor", roughness); }
-    void SetMetallicRoughnessTexture(std::shared_ptr<Texture> texture) { SetTexture("u_metallicRoughnessTexture", texture); }
-    void SetNormalTexture(std::shared_ptr<Texture> texture) { SetTexture("u_normalTexture", texture); }
+    void SetMetallicRoughnessTexture(std::shared_ptr<Texture> texture, std::shared_ptr<const Sampler> sampler = nullptr) { SetTexture("u_metallicRoughnessTexture", texture, sampler); }
+    void SetNormalTexture(std::shared_ptr<Texture> texture, std::shared_ptr<const Sampler> sampler = nullptr) { SetTexture("u_normalTexture", texture, sampler); }
     void SetEmissiveFactor(const glm::vec3& emissive) { SetVec3("u_emissiveFactor", emissive); }
-    void SetEmissiveTexture(std::shared_ptr<Texture> texture) { SetTexture("u_emissiveTexture", texture); }
+    void SetEmissiveTexture(std::shared_ptr<Texture> texture, std::shared_ptr<const Sampler> sampler = nullptr) { SetTexture("u_emissiveTexture", texture, sampler); }
+
+    // Sub-rectangle of an atlas the texture lives in: offset.xy, scale.zw
+    void SetTextureTransform(const std::string& name, const glm::vec4& transform) { SetVec4(name + "Transform", transform); }
 
 private:
     std::string m_name;
@@ -84,6 +115,7 @@ private:
     std::unordered_map<std::string, MaterialUniform> m_parameters;
     mutable std::unordered_map<std::string, GLuint> m_textureUnits;
     mutable GLuint m_nextTextureUnit = 0;
+    TextureBindingBatch m_textureBindings;
 };
 
 inline std::shared_ptr<Material> CreateMaterial(const std::string& name = "DefaultMaterial") {
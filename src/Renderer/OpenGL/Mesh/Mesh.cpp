@@ -23,6 +23,8 @@ Mesh::Mesh(Mesh&& other) noexcept
       m_vao(std::move(other.m_vao)),
       m_vbo(std::move(other.m_vbo)),
       m_ebo(std::move(other.m_ebo)),
+      m_positionVao(std::move(other.m_positionVao)),
+      m_positionVbo(std::move(other.m_positionVbo)),
       m_defaultMaterial(std::move(other.m_defaultMaterial)),
       m_subMeshes(std::move(other.m_subMeshes)),
       m_boundingBoxMin(other.m_boundingBoxMin),
@@ -37,6 +39,8 @@ Mesh& Mesh::operator=(Mesh&& other) noexcept {
         m_vao = std::move(other.m_vao);
         m_vbo = std::move(other.m_vbo);
         m_ebo = std::move(other.m_ebo);
+        m_positionVao = std::move(other.m_positionVao);
+        m_positionVbo = std::move(other.m_positionVbo);
         m_defaultMaterial = std::move(other.m_defaultMaterial);
         m_subMeshes = std::move(other.m_subMeshes);
         m_boundingBoxMin = other.m_boundingBoxMin;
@@ -93,6 +97,21 @@ void Mesh::SetupMesh() {
         m_vao->bind();
         m_ebo->bind();
     }
+
+    SetupPositionStream();
+}
+
+void Mesh::SetupPositionStream() {
+    std::vector<glm::vec3> positions;
+    positions.reserve(m_vertices.size());
+    for (const auto& vertex : m_vertices) positions.push_back(vertex.position);
+
+    m_positionVao = CreateVertexArray();
+    m_positionVao->desc = VertexDescription{sizeof(glm::vec3), {{0, 3, GL_FLOAT, 0, false}}};
+    m_positionVbo = CreateBuffer(BufferType::Vertex, positions.size() * sizeof(glm::vec3), positions.data(),
+                                 BufferUsage::Static);
+    m_positionVao->ApplyLayout(m_positionVbo->id);
+    if (m_ebo) glVertexArrayElementBuffer(m_positionVao->id, m_ebo->id);
 }
 
 void Mesh::UpdateBuffers() {
@@ -126,6 +145,8 @@ void Mesh::UpdateBuffers() {
             m_ebo->UpdateBuffer(m_indices.data(), m_indices.size() * sizeof(uint32_t));
         }
     }
+
+    if (!m_vertices.empty()) SetupPositionStream();
 }
 
 void Mesh::AddSubmesh(uint32_t indexOffset, uint32_t indexCount, std::shared_ptr<Material> material, const std::string& name) {
@@ -140,7 +161,7 @@ void Mesh::AddSubmesh(uint32_t indexOffset, uint32_t indexCount, std::shared_ptr
                   name, indexOffset, indexCount, material ? "yes" : "no");
 }
 
-void Mesh::Draw() const {
+void Mesh::Draw(ShaderVariantCache* passVariants) const {
     if (!m_vao) {
         spdlog::error("Mesh VAO is not initialized!");
         return;
@@ -155,7 +176,7 @@ void Mesh::Draw() const {
 
     if (m_subMeshes.empty()) {
         if (m_defaultMaterial) {
-            m_defaultMaterial->Bind();
+            m_defaultMaterial->Bind(m_defaultMaterial->GetShader(passVariants).get());
         }
         
         if (!m_indices.empty()) {
@@ -169,7 +190,7 @@ void Mesh::Draw() const {
 
             auto material = submesh.material ? submesh.material : m_defaultMaterial;
             if (material) {
-                material->Bind();
+                material->Bind(material->GetShader(passVariants).get());
             }
 
             if (!m_indices.empty()) {
@@ -186,6 +207,17 @@ void Mesh::Draw() const {
     }
 }
 
+void Mesh::DrawPositions(GLsizei instances) const {
+    if (!m_positionVao) return;
+
+    m_positionVao->bind();
+    if (!m_indices.empty()) {
+        glDrawElementsInstanced(GL_TRIANGLES, static_cast<GLsizei>(m_indices.size()), GL_UNSIGNED_INT, 0, instances);
+    } else {
+        glDrawArraysInstanced(GL_TRIANGLES, 0, static_cast<GLsizei>(m_vertices.size()), instances);
+    }
+}
+
 void Mesh::CalculateTangents() {
     if (m_vertices.empty() || m_indices.empty()) {
         spdlog::warn("Cannot calculate tangents: mesh has no vertices or indices");
@@ -452,4 +484,68 @@ std::unique_ptr<Mesh> CreateQuad() {
     return mesh;
 }
 
-} 
\ No newline at end of file
+} 
+
+void SortMeshDrawItems(std::vector<MeshDrawItem>& items, DrawSortOrder order) {
+    auto materialOf = [](const MeshDrawItem& item) {
+        const Mesh& mesh = *item.mesh;
+        if (!mesh.m_subMeshes.empty() && mesh.m_subMeshes[0].material) return mesh.m_subMeshes[0].material.get();
+        return mesh.GetDefaultMaterial().get();
+    };
+
+    switch (order) {
+        case DrawSortOrder::None:
+            break;
+        case DrawSortOrder::FrontToBack:
+            std::stable_sort(items.begin(), items.end(),
+                             [](const MeshDrawItem& a, const MeshDrawItem& b) { return a.viewDepth < b.viewDepth; });
+            break;
+        case DrawSortOrder::BackToFront:
+            std::stable_sort(items.begin(), items.end(),
+                             [](const MeshDrawItem& a, const MeshDrawItem& b) { return a.viewDepth > b.viewDepth; });
+            break;
+        case DrawSortOrder::ByMaterial:
+            std::stable_sort(items.begin(), items.end(), [&](const MeshDrawItem& a, const MeshDrawItem& b) {
+                const Material* materialA = materialOf(a);
+                const Material* materialB = materialOf(b);
+                if (materialA != materialB) return std::less<const Material*>()(materialA, materialB);
+                return a.viewDepth < b.viewDepth;
+            });
+            break;
+    }
+}
+
+void DrawMeshItems(const std::vector<MeshDrawItem>& items, ShaderVariantCache* passVariants) {
+    for (const auto& item : items) {
+        const Mesh& mesh = *item.mesh;
+        const glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(item.transform)));
+
+        // Every program the submeshes draw with needs this instance's transform
+        std::vector<std::shared_ptr<Material>> materials;
+        for (const auto& submesh : mesh.m_subMeshes) {
+            if (submesh.material) materials.push_back(submesh.material);
+        }
+        if (materials.size() < mesh.m_subMeshes.size() || materials.empty()) {
+            materials.push_back(mesh.GetDefaultMaterial());
+        }
+
+        for (const auto& material : materials) {
+            auto shader = material ? material->GetShader(passVariants) : nullptr;
+            if (shader) {
+                shader->SetUniformMat4("u_modelMatrix", item.transform);
+                shader->SetUniformMat3("u_normalMatrix", normalMatrix);
+                shader->SetUniformMat4("u_previousModelMatrix", item.previousTransform);
+            }
+        }
+
+        mesh.Draw(passVariants);
+    }
+}
+
+void DrawMeshItemPositions(const std::vector<MeshDrawItem>& items, ShaderProgram& program) {
+    program.useShaderProgram();
+    for (const auto& item : items) {
+        program.SetUniformMat4("u_modelMatrix", item.transform);
+        item.mesh->DrawPositions();
+    }
+}
@@ -79,7 +79,13 @@ public:
     void SetDefaultMaterial(std::shared_ptr<Material> material) { m_defaultMaterial = material; }
     std::shared_ptr<Material> GetDefaultMaterial() const { return m_defaultMaterial; }
 
-    void Draw() const;
+    // `passVariants` draws every material with its variant from that cache instead of its own program
+    void Draw(ShaderVariantCache* passVariants = nullptr) const;
+
+    // Every submesh in one draw from the tightly packed position stream; for depth-only passes whose
+    // program reads location 0 and needs no material. `instances` > 1 draws it that many times in one
+    // call, for programs that pick a layer or transform from gl_InstanceID.
+    void DrawPositions(GLsizei instances = 1) const;
     
     const std::vector<Vertex3D>& GetVertices() const { return m_vertices; }
     const std::vector<uint32_t>& GetIndices() const { return m_indices; }
@@ -106,6 +112,10 @@ private:
     std::unique_ptr<VertexArray> m_vao;
     std::unique_ptr<Buffer> m_vbo;
     std::unique_ptr<Buffer> m_ebo;
+
+    // Positions only, 12 bytes per vertex, sharing m_ebo
+    std::unique_ptr<VertexArray> m_positionVao;
+    std::unique_ptr<Buffer> m_positionVbo;
     
     std::shared_ptr<Material> m_defaultMaterial;
     
@@ -114,10 +124,36 @@ private:
     bool m_boundingBoxCalculated;
 
     void SetupMesh();
+    void SetupPositionStream();
     void UpdateBuffers();
     void UpdateBoundingBox(const glm::vec3& point);
 };
 
+// One mesh placed in the world, for passes that sort or filter draws before issuing them
+struct MeshDrawItem {
+    const Mesh* mesh = nullptr;
+    glm::mat4 transform{1.0f};
+    glm::mat4 previousTransform{1.0f};     // last frame's, for motion vectors
+    float viewDepth = 0.0f;         // view-space depth of the mesh bounds' centre
+    bool dynamic = false;           // moves or animates; static items let shadow cascades be cached
+};
+
+enum class DrawSortOrder {
+    None,           // scene graph order
+    FrontToBack,    // best early-Z rejection when depth is not laid down yet
+    BackToFront,
+    ByMaterial      // fewest program and texture switches; ideal once a prepass resolved visibility
+};
+
+void SortMeshDrawItems(std::vector<MeshDrawItem>& items, DrawSortOrder order);
+
+// Draws with each submesh's material, or its variant from `passVariants`; programs get u_modelMatrix,
+// u_normalMatrix and u_previousModelMatrix
+void DrawMeshItems(const std::vector<MeshDrawItem>& items, ShaderVariantCache* passVariants = nullptr);
+
+// Draws the position streams with `program`, which must take u_modelMatrix
+void DrawMeshItemPositions(const std::vector<MeshDrawItem>& items, ShaderProgram& program);
+
 inline std::unique_ptr<Mesh> CreateMesh() {
     return std::make_unique<Mesh>();
 }
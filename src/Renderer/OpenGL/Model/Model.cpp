@@ -1,11 +1,13 @@
 #include "Model.h"
+#include "../Texture/TextureLoader.h"
+#include "../../../Utils/Hash.h"
 #include <iostream>
 #include <spdlog/spdlog.h>
 #include <filesystem>
 #include <algorithm>
 
-Model::Model(const std::string& filepath) 
-    : m_filepath(filepath), m_boundingBoxMin(FLT_MAX), m_boundingBoxMax(-FLT_MAX) {
+Model::Model(const std::string& filepath, const ModelImportSettings& settings) 
+    : m_filepath(filepath), m_boundingBoxMin(FLT_MAX), m_boundingBoxMax(-FLT_MAX), m_settings(settings) {
     if (!LoadModel(filepath)) {
         throw std::runtime_error("Failed to load model: " + filepath);
     }
@@ -20,7 +22,10 @@ Model::Model(Model&& other) noexcept
       m_rootNode(std::move(other.m_rootNode)),
       m_boundingBoxMin(other.m_boundingBoxMin),
       m_boundingBoxMax(other.m_boundingBoxMax),
-      m_textureCache(std::move(other.m_textureCache)) {
+      m_textureCache(std::move(other.m_textureCache)),
+      m_settings(std::move(other.m_settings)),
+      m_textureTransforms(std::move(other.m_textureTransforms)),
+      m_imageHashes(std::move(other.m_imageHashes)) {
 }
 
 Model& Model::operator=(Model&& other) noexcept {
@@ -34,12 +39,26 @@ Model& Model::operator=(Model&& other) noexcept {
         m_boundingBoxMin = other.m_boundingBoxMin;
         m_boundingBoxMax = other.m_boundingBoxMax;
         m_textureCache = std::move(other.m_textureCache);
+        m_settings = std::move(other.m_settings);
+        m_textureTransforms = std::move(other.m_textureTransforms);
+        m_imageHashes = std::move(other.m_imageHashes);
     }
     return *this;
 }
 
+// Keeps the encoded bytes while parsing; DecodeImages() decodes them all on the worker pool afterwards.
+static bool DeferImageDecode(tinygltf::Image* image, const int, std::string*, std::string*, int, int,
+                             const unsigned char* bytes, int size, void*) {
+    image->image.assign(bytes, bytes + size);
+    image->as_is = true;
+    return true;
+}
+
 bool Model::LoadModel(const std::string& filepath) {
+    const TextureLoadStats baseline = TextureLoader::GetStats();
+
     tinygltf::TinyGLTF loader;
+    loader.SetImageLoader(DeferImageDecode, nullptr);
     std::string error, warning;
 
     std::filesystem::path path(filepath);
@@ -76,6 +95,12 @@ bool Model::LoadModel(const std::string& filepath) {
     spdlog::info("  Textures: {}", m_gltfModel.textures.size());
     spdlog::info("  Images: {}", m_gltfModel.images.size());
 
+    DecodeImages();
+
+    if (m_settings.packTextures) {
+        PackSmallTextures();
+    }
+
     for (const auto& gltfMaterial : m_gltfModel.materials) {
         m_materials.push_back(ProcessMaterial(gltfMaterial));
     }
@@ -98,9 +123,84 @@ bool Model::LoadModel(const std::string& filepath) {
     }
 
     CalculateBoundingBox();
+
+    TextureLoader::GetStagingRing().Flush();
+    TextureLoader::LogStats("Model textures", baseline);
+    GetTextureCache().LogStats();
     return true;
 }
 
+void Model::DecodeImages() {
+    const size_t imageCount = m_gltfModel.images.size();
+
+    m_imageHashes.assign(imageCount, 0);
+    for (size_t i = 0; i < imageCount; ++i) {
+        const auto& image = m_gltfModel.images[i];
+        if (image.as_is && !image.image.empty()) {
+            m_imageHashes[i] = HashBytes(image.image.data(), image.image.size());
+        }
+    }
+
+    // An image is only decoded if one of its textures misses the shared cache, or if it may end
+    // up in an atlas (atlas pages are looked up by their packed pixels).
+    std::vector<bool> needed(imageCount, false);
+    for (const auto& [textureIndex, usage] : CollectTextureUsages()) {
+        int source = m_gltfModel.textures[textureIndex].source;
+        if (!GetTextureCache().Contains(GetTextureCacheKey(textureIndex, usage))) needed[source] = true;
+    }
+
+    if (m_settings.packTextures) {
+        const int maxPackedSize = TexturePackerSettings{}.maxImageSize;
+        for (size_t i = 0; i < imageCount; ++i) {
+            const auto& image = m_gltfModel.images[i];
+            int width = 0, height = 0, channels = 0;
+            if (image.as_is && TextureLoader::ReadInfo(image.image.data(), image.image.size(), width, height, channels) &&
+                width <= maxPackedSize && height <= maxPackedSize) {
+                needed[i] = true;
+            }
+        }
+    }
+
+    std::vector<TextureLoader::EncodedImage> encoded(imageCount);
+    size_t skipped = 0;
+    for (size_t i = 0; i < imageCount; ++i) {
+        auto& image = m_gltfModel.images[i];
+        if (!image.as_is || image.image.empty()) continue;
+
+        if (needed[i]) {
+            encoded[i] = {image.image.data(), image.image.size()};
+        } else {
+            image.image.clear();
+            ++skipped;
+        }
+    }
+    if (skipped > 0) {
+        spdlog::info("  {} images already resident in the texture cache, skipping decode", skipped);
+    }
+
+    // glTF images are stored top row first, matching the UV convention, so they are not flipped.
+    auto decoded = TextureLoader::DecodeAllMemory(encoded, 4, false);
+
+    for (size_t i = 0; i < m_gltfModel.images.size(); ++i) {
+        auto& image = m_gltfModel.images[i];
+        if (!encoded[i].bytes) continue;
+
+        if (!decoded[i].Valid()) {
+            spdlog::error("Failed to decode image {}", image.name.empty() ? std::to_string(i) : image.name);
+            image.image.clear();
+            continue;
+        }
+
+        image.width = decoded[i].width;
+        image.height = decoded[i].height;
+        image.component = decoded[i].channels;
+        image.bits = 8;
+        image.pixel_type = TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE;
+        image.image = std::move(decoded[i].pixels);
+        image.as_is = false;
+    }
+}
+
 void Model::ProcessNode(const tinygltf::Node& gltfNode, ModelNode& node) {
     node.name = gltfNode.name;
     node.transform = GetNodeTransform(gltfNode);
@@ -178,21 +278,24 @@ std::shared_ptr<Material> Model::ProcessMaterial(const tinygltf::Material& gltfM
     if (gltfMaterial.pbrMetallicRoughness.baseColorTexture.index >= 0) {
         auto texture = LoadTextureFromGLTF(gltfMaterial.pbrMetallicRoughness.baseColorTexture.index);
         if (texture) {
-            material->SetBaseColorTexture(texture);
+            material->SetBaseColorTexture(texture, GetSampler(gltfMaterial.pbrMetallicRoughness.baseColorTexture.index));
+            material->SetTextureTransform("u_baseColorTexture", GetTextureTransform(gltfMaterial.pbrMetallicRoughness.baseColorTexture.index));
         }
     }
 
     if (gltfMaterial.pbrMetallicRoughness.metallicRoughnessTexture.index >= 0) {
-        auto texture = LoadTextureFromGLTF(gltfMaterial.pbrMetallicRoughness.metallicRoughnessTexture.index);
+        auto texture = LoadTextureFromGLTF(gltfMaterial.pbrMetallicRoughness.metallicRoughnessTexture.index, TextureUsage::Data);
         if (texture) {
-            material->SetMetallicRoughnessTexture(texture);
+            material->SetMetallicRoughnessTexture(texture, GetSampler(gltfMaterial.pbrMetallicRoughness.metallicRoughnessTexture.index));
+            material->SetTextureTransform("u_metallicRoughnessTexture", GetTextureTransform(gltfMaterial.pbrMetallicRoughness.metallicRoughnessTexture.index));
         }
     }
 
     if (gltfMaterial.normalTexture.index >= 0) {
-        auto texture = LoadTextureFromGLTF(gltfMaterial.normalTexture.index);
+        auto texture = LoadTextureFromGLTF(gltfMaterial.normalTexture.index, TextureUsage::Normal);
         if (texture) {
-            material->SetNormalTexture(texture);
+            material->SetNormalTexture(texture, GetSampler(gltfMaterial.normalTexture.index));
+            material->SetTextureTransform("u_normalTexture", GetTextureTransform(gltfMaterial.normalTexture.index));
             material->SetFloat("u_normalScale", gltfMaterial.normalTexture.scale);
         }
     }
@@ -208,14 +311,16 @@ std::shared_ptr<Material> Model::ProcessMaterial(const tinygltf::Material& gltfM
     if (gltfMaterial.emissiveTexture.index >= 0) {
         auto texture = LoadTextureFromGLTF(gltfMaterial.emissiveTexture.index);
         if (texture) {
-            material->SetEmissiveTexture(texture);
+            material->SetEmissiveTexture(texture, GetSampler(gltfMaterial.emissiveTexture.index));
+            material->SetTextureTransform("u_emissiveTexture", GetTextureTransform(gltfMaterial.emissiveTexture.index));
         }
     }
 
     if (gltfMaterial.occlusionTexture.index >= 0) {
-        auto texture = LoadTextureFromGLTF(gltfMaterial.occlusionTexture.index);
+        auto texture = LoadTextureFromGLTF(gltfMaterial.occlusionTexture.index, TextureUsage::Data);
         if (texture) {
-            material->SetTexture("u_occlusionTexture", texture);
+            material->SetTexture("u_occlusionTexture", texture, GetSampler(gltfMaterial.occlusionTexture.index));
+            material->SetTextureTransform("u_occlusionTexture", GetTextureTransform(gltfMaterial.occlusionTexture.index));
             material->SetFloat("u_occlusionStrength", gltfMaterial.occlusionTexture.strength);
         }
     }
@@ -223,12 +328,12 @@ std::shared_ptr<Material> Model::ProcessMaterial(const tinygltf::Material& gltfM
     return material;
 }
 
-std::shared_ptr<Texture> Model::LoadTextureFromGLTF(int textureIndex) {
+std::shared_ptr<Texture> Model::LoadTextureFromGLTF(int textureIndex, TextureUsage usage) {
     if (textureIndex < 0 || textureIndex >= m_gltfModel.textures.size()) {
         return nullptr;
     }
 
-    auto cacheIt = m_textureCache.find(textureIndex);
+    auto cacheIt = m_textureCache.find({textureIndex, usage});
     if (cacheIt != m_textureCache.end()) {
         return cacheIt->second;
     }
@@ -239,11 +344,24 @@ std::shared_ptr<Texture> Model::LoadTextureFromGLTF(int textureIndex) {
     }
 
     const auto& image = m_gltfModel.images[gltfTexture.source];
+
+    TextureCacheKey cacheKey = GetTextureCacheKey(textureIndex, usage);
+    if (cacheKey.content != 0) {
+        if (auto cached = GetTextureCache().Find(cacheKey)) {
+            m_textureCache[{textureIndex, usage}] = cached;
+            m_textures.push_back(cached);
+            return cached;
+        }
+    }
     
     try {
         std::shared_ptr<Texture> texture;
         
-        if (!image.image.empty()) {
+        if (!image.image.empty() && m_settings.compressTextures && image.bits == 8) {
+            texture = CreateCompressedTexture(image, usage);
+        } else if (!image.image.empty() && image.bits == 8 && (image.component == 3 || image.component == 4)) {
+            texture = CreateMipmappedTexture(image, usage);
+        } else if (!image.image.empty()) {
             texture = CreateTextureFromData(
                 image.width, image.height, 1,
                 TextureType::Tex2D,
@@ -258,37 +376,9 @@ std::shared_ptr<Texture> Model::LoadTextureFromGLTF(int textureIndex) {
         }
 
         if (texture) {
-            if (gltfTexture.sampler >= 0 && gltfTexture.sampler < m_gltfModel.samplers.size()) {
-                const auto& sampler = m_gltfModel.samplers[gltfTexture.sampler];
-                if (sampler.minFilter == TINYGLTF_TEXTURE_FILTER_NEAREST) {
-                    texture->minFilter = TextureFilter::Nearest;
-                } else if (sampler.minFilter == TINYGLTF_TEXTURE_FILTER_LINEAR) {
-                    texture->minFilter = TextureFilter::Linear;
-                }
-                
-                if (sampler.magFilter == TINYGLTF_TEXTURE_FILTER_NEAREST) {
-                    texture->magFilter = TextureFilter::Nearest;
-                } else if (sampler.magFilter == TINYGLTF_TEXTURE_FILTER_LINEAR) {
-                    texture->magFilter = TextureFilter::Linear;
-                }
-
-                if (sampler.wrapS == TINYGLTF_TEXTURE_WRAP_CLAMP_TO_EDGE) {
-                    texture->wrapS = TextureWrap::ClampToEdge;
-                } else if (sampler.wrapS == TINYGLTF_TEXTURE_WRAP_REPEAT) {
-                    texture->wrapS = TextureWrap::Repeat;
-                }
-                
-                if (sampler.wrapT == TINYGLTF_TEXTURE_WRAP_CLAMP_TO_EDGE) {
-                    texture->wrapT = TextureWrap::ClampToEdge;
-                } else if (sampler.wrapT == TINYGLTF_TEXTURE_WRAP_REPEAT) {
-                    texture->wrapT = TextureWrap::Repeat;
-                }
-                
-                texture->applyParameters();
-            }
-            
-            m_textureCache[textureIndex] = texture;
+            m_textureCache[{textureIndex, usage}] = texture;
             m_textures.push_back(texture);
+            if (cacheKey.content != 0) GetTextureCache().Insert(cacheKey, texture);
         }
         
         return texture;
@@ -298,6 +388,221 @@ std::shared_ptr<Texture> Model::LoadTextureFromGLTF(int textureIndex) {
     }
 }
 
+std::shared_ptr<Texture> Model::CreateCompressedTexture(const tinygltf::Image& image, TextureUsage usage) {
+    const unsigned char* rgba = image.image.data();
+    std::vector<unsigned char> expanded;
+
+    if (image.component != 4) {
+        size_t pixelCount = static_cast<size_t>(image.width) * image.height;
+        expanded.resize(pixelCount * 4);
+        for (size_t i = 0; i < pixelCount; ++i) {
+            const unsigned char* src = image.image.data() + i * image.component;
+            bool grey = image.component < 3;
+            expanded[i * 4 + 0] = src[0];
+            expanded[i * 4 + 1] = grey ? src[0] : src[1];
+            expanded[i * 4 + 2] = grey ? src[0] : src[2];
+            expanded[i * 4 + 3] = image.component == 2 ? src[1] : 255;
+        }
+        rgba = expanded.data();
+    }
+
+    bool normalMap = usage == TextureUsage::Normal;
+    auto format = TextureCompression::ChooseFormat(rgba, image.width, image.height, normalMap, m_settings.compression);
+
+    MipSettings mips;
+    mips.srgb = usage == TextureUsage::Color;
+    auto compressed = TextureCompression::TranscodeCached(rgba, image.width, image.height, format,
+                                                          m_settings.compression.cacheDirectory, mips);
+
+    return CreateTextureFromMips(TextureFormat::RGBA, compressed.format, compressed.GetMipData());
+}
+
+std::shared_ptr<Texture> Model::CreateMipmappedTexture(const tinygltf::Image& image, TextureUsage usage) {
+    MipSettings mips;
+    mips.srgb = usage == TextureUsage::Color;
+    auto chain = MipGeneration::Generate(image.image.data(), image.width, image.height, image.component, mips);
+
+    bool rgba = image.component == 4;
+    return CreateTextureFromMips(rgba ? TextureFormat::RGBA : TextureFormat::RGB,
+                                 rgba ? TextureInternalFormat::RGBA8 : TextureInternalFormat::RGB8,
+                                 chain.GetMipData());
+}
+
+std::vector<std::pair<int, TextureUsage>> Model::CollectTextureUsages() const {
+    std::vector<std::pair<int, TextureUsage>> usages;
+    auto add = [&](int textureIndex, TextureUsage usage) {
+        if (textureIndex < 0 || textureIndex >= static_cast<int>(m_gltfModel.textures.size())) return;
+        int source = m_gltfModel.textures[textureIndex].source;
+        if (source < 0 || source >= static_cast<int>(m_gltfModel.images.size())) return;
+        usages.push_back({textureIndex, usage});
+    };
+
+    for (const auto& material : m_gltfModel.materials) {
+        add(material.pbrMetallicRoughness.baseColorTexture.index, TextureUsage::Color);
+        add(material.pbrMetallicRoughness.metallicRoughnessTexture.index, TextureUsage::Data);
+        add(material.normalTexture.index, TextureUsage::Normal);
+        add(material.emissiveTexture.index, TextureUsage::Color);
+        add(material.occlusionTexture.index, TextureUsage::Data);
+    }
+    return usages;
+}
+
+TextureCacheKey Model::GetTextureCacheKey(int textureIndex, TextureUsage usage) const {
+    const auto& gltfTexture = m_gltfModel.textures[textureIndex];
+
+    TextureCacheKey key;
+    if (gltfTexture.source < 0 || gltfTexture.source >= static_cast<int>(m_imageHashes.size())) return key;
+    key.content = m_imageHashes[gltfTexture.source];
+
+    uint64_t parameters = HashCombine(static_cast<uint64_t>(usage), m_settings.compressTextures ? 1 : 0);
+    if (m_settings.compressTextures) {
+        parameters = HashCombine(parameters, static_cast<uint64_t>(m_settings.compression.opaqueFormat));
+        parameters = HashCombine(parameters, static_cast<uint64_t>(m_settings.compression.alphaFormat));
+        parameters = HashCombine(parameters, static_cast<uint64_t>(m_settings.compression.normalFormat));
+    }
+
+    key.parameters = parameters;
+    return key;
+}
+
+static TextureFilter ToTextureFilter(int filter, TextureFilter fallback) {
+    switch (filter) {
+        case TINYGLTF_TEXTURE_FILTER_NEAREST: return TextureFilter::Nearest;
+        case TINYGLTF_TEXTURE_FILTER_LINEAR: return TextureFilter::Linear;
+        case TINYGLTF_TEXTURE_FILTER_NEAREST_MIPMAP_NEAREST: return TextureFilter::NearestMipmapNearest;
+        case TINYGLTF_TEXTURE_FILTER_LINEAR_MIPMAP_NEAREST: return TextureFilter::LinearMipmapNearest;
+        case TINYGLTF_TEXTURE_FILTER_NEAREST_MIPMAP_LINEAR: return TextureFilter::NearestMipmapLinear;
+        case TINYGLTF_TEXTURE_FILTER_LINEAR_MIPMAP_LINEAR: return TextureFilter::LinearMipmapLinear;
+        default: return fallback;
+    }
+}
+
+static TextureWrap ToTextureWrap(int wrap) {
+    switch (wrap) {
+        case TINYGLTF_TEXTURE_WRAP_CLAMP_TO_EDGE: return TextureWrap::ClampToEdge;
+        case TINYGLTF_TEXTURE_WRAP_MIRRORED_REPEAT: return TextureWrap::MirroredRepeat;
+        default: return TextureWrap::Repeat;
+    }
+}
+
+std::shared_ptr<const Sampler> Model::GetSampler(int textureIndex) const {
+    // Atlas regions are addressed by the shader and keep the atlas' own sampler.
+    if (m_textureTransforms.count(textureIndex)) return nullptr;
+
+    SamplerDesc desc;
+    desc.maxAnisotropy = m_settings.maxAnisotropy;
+
+    const auto& gltfTexture = m_gltfModel.textures[textureIndex];
+    if (gltfTexture.sampler >= 0 && gltfTexture.sampler < static_cast<int>(m_gltfModel.samplers.size())) {
+        const auto& sampler = m_gltfModel.samplers[gltfTexture.sampler];
+        desc.minFilter = ToTextureFilter(sampler.minFilter, TextureFilter::LinearMipmapLinear);
+        desc.magFilter = ToTextureFilter(sampler.magFilter, TextureFilter::Linear);
+        desc.wrapS = ToTextureWrap(sampler.wrapS);
+        desc.wrapT = ToTextureWrap(sampler.wrapT);
+    }
+
+    return GetSamplerCache().Get(desc);
+}
+
+glm::vec4 Model::GetTextureTransform(int textureIndex) const {
+    auto it = m_textureTransforms.find(textureIndex);
+    if (it != m_textureTransforms.end()) {
+        return it->second;
+    }
+    return glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+}
+
+void Model::PackSmallTextures() {
+    // Each usage gets its own pages so their mips are filtered the way the material samples them.
+    // A texture bound to slots of different usages is left unpacked.
+    std::unordered_map<int, TextureUsage> textureUsages;
+    std::unordered_map<int, bool> conflicting;
+    for (const auto& [textureIndex, usage] : CollectTextureUsages()) {
+        auto [it, inserted] = textureUsages.emplace(textureIndex, usage);
+        if (!inserted && it->second != usage) conflicting[textureIndex] = true;
+    }
+
+    for (TextureUsage usage : {TextureUsage::Color, TextureUsage::Data, TextureUsage::Normal}) {
+        std::vector<int> textureIndices;
+        for (int i = 0; i < static_cast<int>(m_gltfModel.textures.size()); ++i) {
+            auto it = textureUsages.find(i);
+            if (it != textureUsages.end() && it->second == usage && !conflicting.count(i)) textureIndices.push_back(i);
+        }
+        PackSmallTextures(usage, textureIndices);
+    }
+}
+
+void Model::PackSmallTextures(TextureUsage usage, const std::vector<int>& textureIndices) {
+    TexturePackerSettings settings;
+    settings.srgb = usage == TextureUsage::Color;
+
+    auto packer = CreateTexturePacker(settings);
+    std::vector<std::pair<int, int>> handles;
+    std::unordered_map<int, int> imageHandles;    // one packed copy per image, shared by every texture using it
+
+    for (int i : textureIndices) {
+        const auto& gltfTexture = m_gltfModel.textures[i];
+        if (gltfTexture.source < 0 || gltfTexture.source >= m_gltfModel.images.size()) continue;
+
+        const auto& image = m_gltfModel.images[gltfTexture.source];
+        if (image.image.empty() || image.bits != 8) continue;
+
+        // Atlas regions emulate GL_REPEAT in the shader; other wrap modes keep their own texture.
+        if (gltfTexture.sampler >= 0 && gltfTexture.sampler < m_gltfModel.samplers.size()) {
+            const auto& sampler = m_gltfModel.samplers[gltfTexture.sampler];
+            if (sampler.wrapS != TINYGLTF_TEXTURE_WRAP_REPEAT || sampler.wrapT != TINYGLTF_TEXTURE_WRAP_REPEAT) continue;
+        }
+
+        auto it = imageHandles.find(gltfTexture.source);
+        if (it == imageHandles.end()) {
+            PackerImage packerImage;
+            packerImage.width = image.width;
+            packerImage.height = image.height;
+            packerImage.channels = image.component;
+            packerImage.pixels = image.image.data();
+            it = imageHandles.emplace(gltfTexture.source, packer->AddImage(packerImage)).first;
+        }
+        handles.push_back({i, it->second});
+    }
+
+    // A single image gains nothing from an atlas.
+    if (imageHandles.size() < 2) return;
+
+    packer->Pack();
+
+    // Pages are shared through the texture cache by their packed pixels, so loading the same
+    // set of small images again reuses the atlas.
+    std::vector<std::shared_ptr<Texture>> atlases;
+    const auto& pages = packer->GetPages();
+    for (size_t i = 0; i < pages.size(); ++i) {
+        TextureCacheKey key;
+        key.content = HashBytes(pages[i].pixels.data(), pages[i].pixels.size());
+        key.parameters = HashCombine(HashString("atlas"), static_cast<uint64_t>(usage));
+        for (int value : {pages[i].width, pages[i].height}) {
+            key.parameters = HashCombine(key.parameters, static_cast<uint64_t>(value));
+        }
+
+        auto atlas = GetTextureCache().Find(key);
+        if (!atlas) {
+            atlas = packer->CreateTexture(i);
+            GetTextureCache().Insert(key, atlas);
+        }
+        atlases.push_back(atlas);
+    }
+
+    for (const auto& [textureIndex, handle] : handles) {
+        const auto& region = packer->GetRegion(handle);
+        if (region.page < 0) continue;
+
+        m_textureCache[{textureIndex, usage}] = atlases[region.page];
+        m_textureTransforms[textureIndex] = region.uvTransform;
+    }
+
+    for (auto& atlas : atlases) {
+        m_textures.push_back(atlas);
+    }
+}
+
 glm::mat4 Model::GetNodeTransform(const tinygltf::Node& node) {
     glm::mat4 transform(1.0f);
     
@@ -437,45 +742,59 @@ void Model::CalculateBoundingBox() {
                  m_boundingBoxMax.x, m_boundingBoxMax.y, m_boundingBoxMax.z);
 }
 
-void Model::Draw(const glm::mat4& modelMatrix) const {
-    DrawNode(*m_rootNode, modelMatrix);
+void Model::Draw(const glm::mat4& modelMatrix, ShaderVariantCache* passVariants) const {
+    std::vector<MeshDrawItem> items;
+    CollectDrawItems(items, glm::mat4(1.0f), modelMatrix);
+    DrawMeshItems(items, passVariants);
+}
+
+void Model::CollectDrawItems(std::vector<MeshDrawItem>& items, const glm::mat4& view, const glm::mat4& modelMatrix) const {
+    CollectDrawItems(items, view, modelMatrix, modelMatrix);
 }
 
-void Model::DrawNode(const ModelNode& node, const glm::mat4& parentTransform) const {
+void Model::CollectDrawItems(std::vector<MeshDrawItem>& items, const glm::mat4& view, const glm::mat4& modelMatrix,
+                             const glm::mat4& previousModelMatrix) const {
+    if (m_rootNode) CollectNode(*m_rootNode, modelMatrix, previousModelMatrix, view, items);
+}
+
+void Model::CollectNode(const ModelNode& node, const glm::mat4& parentTransform, const glm::mat4& previousParentTransform,
+                        const glm::mat4& view, std::vector<MeshDrawItem>& items) const {
     glm::mat4 nodeTransform = parentTransform * node.transform;
+    glm::mat4 previousNodeTransform = previousParentTransform * node.transform;
     
     for (int meshIndex : node.meshIndices) {
         if (meshIndex >= 0 && meshIndex < m_meshes.size()) {
-            const auto& mesh = m_meshes[meshIndex];
-            
-            std::shared_ptr<Material> material = nullptr;
-            if (!mesh->m_subMeshes.empty() && mesh->m_subMeshes[0].material) {
-                material = mesh->m_subMeshes[0].material;
-            } else {
-                material = mesh->GetDefaultMaterial();
-            }
-            
-            if (material && material->GetShader()) {
-                material->GetShader()->SetUniformMat4("u_modelMatrix", nodeTransform);
-            }
-            
-            mesh->Draw();
+            const Mesh* mesh = m_meshes[meshIndex].get();
+            glm::vec4 center = view * nodeTransform * glm::vec4(mesh->GetBoundingBoxCenter(), 1.0f);
+            // Anything that moved since last frame counts as dynamic for shadow caching
+            items.push_back({mesh, nodeTransform, previousNodeTransform, -center.z, nodeTransform != previousNodeTransform});
         }
     }
     
     for (const auto& child : node.children) {
-        DrawNode(*child, nodeTransform);
+        CollectNode(*child, nodeTransform, previousNodeTransform, view, items);
     }
 }
 
-void Model::SetShaderForAllMaterials(std::shared_ptr<ShaderProgram> shader) {
-    for (auto& material : m_materials) {
-        material->SetShader(shader);
-    }
-    
+std::vector<std::shared_ptr<Material>> Model::GetAllMaterials() const {
+    std::vector<std::shared_ptr<Material>> materials = m_materials;
     for (auto& mesh : m_meshes) {
-        if (auto defaultMat = mesh->GetDefaultMaterial()) {
-            defaultMat->SetShader(shader);
-        }
+        if (auto defaultMat = mesh->GetDefaultMaterial()) materials.push_back(defaultMat);
     }
-}
\ No newline at end of file
+    return materials;
+}
+
+void Model::PrewarmShaderVariants(ShaderVariantCache& variants) const {
+    // Compile every needed permutation in one batch before anything draws with them.
+    std::vector<uint32_t> featureSets;
+    for (const auto& material : GetAllMaterials()) featureSets.push_back(material->GetFeatures());
+    variants.Prewarm(featureSets);
+}
+
+void Model::SetShaderVariantsForAllMaterials(ShaderVariantCache& variants) {
+    PrewarmShaderVariants(variants);
+
+    for (auto& material : GetAllMaterials()) {
+        material->SetShader(variants.Get(material->GetFeatures()));
+    }
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <map>
 #include <string>
 #include <vector>
 #include <memory>
@@ -9,6 +10,25 @@
 #include "../Mesh/Mesh.h"
 #include "../Material/Material.h"
 #include "../Texture/Texture.h"
+#include "../Texture/Sampler.h"
+#include "../Shader/ShaderVariants.h"
+#include "../Texture/TexturePacker.h"
+#include "../Texture/TextureCompression.h"
+#include "../Texture/TextureCache.h"
+
+// How a glTF texture slot is sampled; decides compression format and whether mips filter in linear space.
+enum class TextureUsage {
+    Color,      // sRGB-encoded color (base color, emissive)
+    Data,       // linear values (metallic-roughness, occlusion)
+    Normal
+};
+
+struct ModelImportSettings {
+    bool packTextures = true;
+    bool compressTextures = true;
+    float maxAnisotropy = 8.0f;     // for the per-texture samplers; clamped to the device limit
+    TextureCompressionSettings compression;
+};
 
 struct ModelNode {
     std::string name;
@@ -21,7 +41,7 @@ struct ModelNode {
 
 class Model {
 public:
-    explicit Model(const std::string& filepath);
+    explicit Model(const std::string& filepath, const ModelImportSettings& settings = {});
     ~Model() = default;
 
     Model(const Model&) = delete;
@@ -30,9 +50,22 @@ public:
     Model(Model&& other) noexcept;
     Model& operator=(Model&& other) noexcept;
 
-    void Draw(const glm::mat4& modelMatrix = glm::mat4(1.0f)) const;
+    // `passVariants` replaces each material's program with its variant from that cache, so passes such
+    // as the depth prepass or the G-buffer fill draw the same meshes with their own shaders
+    void Draw(const glm::mat4& modelMatrix = glm::mat4(1.0f), ShaderVariantCache* passVariants = nullptr) const;
+
+    // Appends every mesh instance with its world transform and depth under `view`, for sorted passes
+    void CollectDrawItems(std::vector<MeshDrawItem>& items, const glm::mat4& view,
+                          const glm::mat4& modelMatrix = glm::mat4(1.0f)) const;
+    // Same, with where the model was last frame for motion vectors
+    void CollectDrawItems(std::vector<MeshDrawItem>& items, const glm::mat4& view, const glm::mat4& modelMatrix,
+                          const glm::mat4& previousModelMatrix) const;
     
     void SetShaderForAllMaterials(std::shared_ptr<ShaderProgram> shader);
+    // Gives every material the variant specialized on its MaterialFeature bits
+    void SetShaderVariantsForAllMaterials(ShaderVariantCache& variants);
+    // Compiles the variants this model's materials need, for caches passed to Draw()
+    void PrewarmShaderVariants(ShaderVariantCache& variants) const;
 
     const std::string& GetFilePath() const { return m_filepath; }
     size_t GetMeshCount() const { return m_meshes.size(); }
@@ -60,18 +93,35 @@ private:
     std::unique_ptr<Mesh> ProcessMesh(const tinygltf::Mesh& gltfMesh);
     std::shared_ptr<Material> ProcessMaterial(const tinygltf::Material& gltfMaterial);
     std::shared_ptr<Texture> LoadTexture(const tinygltf::Image& image, const std::string& directory);
-    std::shared_ptr<Texture> LoadTextureFromGLTF(int textureIndex);
+    std::shared_ptr<Texture> LoadTextureFromGLTF(int textureIndex, TextureUsage usage = TextureUsage::Color);
+    std::shared_ptr<Texture> CreateCompressedTexture(const tinygltf::Image& image, TextureUsage usage);
+    std::shared_ptr<Texture> CreateMipmappedTexture(const tinygltf::Image& image, TextureUsage usage);
+    glm::vec4 GetTextureTransform(int textureIndex) const;
+    std::shared_ptr<const Sampler> GetSampler(int textureIndex) const;
+    void DecodeImages();
+    void PackSmallTextures();
+    void PackSmallTextures(TextureUsage usage, const std::vector<int>& textureIndices);
+    std::vector<std::pair<int, TextureUsage>> CollectTextureUsages() const;
+    TextureCacheKey GetTextureCacheKey(int textureIndex, TextureUsage usage) const;
     
     glm::mat4 GetNodeTransform(const tinygltf::Node& node);
     void ExtractVertexData(const tinygltf::Primitive& primitive, std::vector<Vertex3D>& vertices, std::vector<uint32_t>& indices);
     void UpdateBoundingBox(const glm::vec3& point);
     void CalculateBoundingBox();
 
-    void DrawNode(const ModelNode& node, const glm::mat4& parentTransform) const;
+    // Model materials plus every mesh's default material
+    std::vector<std::shared_ptr<Material>> GetAllMaterials() const;
+    void CollectNode(const ModelNode& node, const glm::mat4& parentTransform, const glm::mat4& previousParentTransform,
+                     const glm::mat4& view, std::vector<MeshDrawItem>& items) const;
+
+    // Keyed by usage too: one glTF texture sampled as color and as data needs two GPU textures
+    std::map<std::pair<int, TextureUsage>, std::shared_ptr<Texture>> m_textureCache;
 
-    std::unordered_map<int, std::shared_ptr<Texture>> m_textureCache;
+    ModelImportSettings m_settings;
+    std::unordered_map<int, glm::vec4> m_textureTransforms;
+    std::vector<uint64_t> m_imageHashes;      // per glTF image, hash of the encoded bytes; 0 if unknown
 };
 
-inline std::unique_ptr<Model> CreateModel(const std::string& filepath) {
-    return std::make_unique<Model>(filepath);
+inline std::unique_ptr<Model> CreateModel(const std::string& filepath, const ModelImportSettings& settings = {}) {
+    return std::make_unique<Model>(filepath, settings);
 }
\ No newline at end of file
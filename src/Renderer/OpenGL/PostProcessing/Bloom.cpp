@@ -0,0 +1,75 @@
+#include "Bloom.h"
+#include <algorithm>
+#include <vector>
+
+namespace {
+    constexpr GLuint GroupSize = 8;     // local size of bloom_downsample.comp and bloom_upsample.comp
+
+    void Dispatch(glm::ivec2 size) {
+        glDispatchCompute((size.x + GroupSize - 1) / GroupSize, (size.y + GroupSize - 1) / GroupSize, 1);
+        // The next level samples what this one stored
+        glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+    }
+}
+
+Bloom::Bloom() {
+    auto downsample = CreateShader(ShaderStage::Compute, "Shader/bloom_downsample.comp");
+    auto upsample = CreateShader(ShaderStage::Compute, "Shader/bloom_upsample.comp");
+    downsampleProgram = CreateShaderProgram(*downsample);
+    upsampleProgram = CreateShaderProgram(*upsample);
+}
+
+glm::ivec2 Bloom::GetChainSize(glm::ivec2 sceneSize) {
+    return glm::max(sceneSize / 2, glm::ivec2(1 << (MaxLevels - 1)));
+}
+
+glm::vec4 Bloom::GetThresholdCurve() const {
+    const float threshold = std::max(settings.threshold, 0.0f);
+    const float knee = std::max(threshold * settings.softKnee, 1e-5f);
+    return {threshold, threshold - knee, 2.0f * knee, 0.25f / knee};
+}
+
+int Bloom::getLevelCount(const Texture& chain) const {
+    return std::clamp(settings.levels, 1, chain.levels);
+}
+
+void Bloom::Render(Texture& scene, Texture& chain, glm::ivec2 area) {
+    if (area == glm::ivec2(0)) area = {scene.width, scene.height};
+
+    const int levels = getLevelCount(chain);
+
+    // Rounded down level by level like the mip sizes, so each area fits inside its level
+    std::vector<glm::ivec2> areas(levels);
+    areas[0] = glm::clamp(area / 2, glm::ivec2(1), glm::ivec2(chain.width, chain.height));
+    for (int level = 1; level < levels; ++level) areas[level] = glm::max(areas[level - 1] / 2, glm::ivec2(1));
+
+    downsampleProgram->useShaderProgram();
+    downsampleProgram->SetUniformVec4("u_bloomCurve", GetThresholdCurve());
+    for (int level = 0; level < levels; ++level) {
+        const bool first = level == 0;
+        Texture& source = first ? scene : chain;
+        downsampleProgram->SetUniform1f("u_sourceLevel", first ? 0.0f : static_cast<float>(level - 1));
+        downsampleProgram->SetUniformVec2("u_sourceArea", glm::vec2(first ? area : areas[level - 1]));
+        downsampleProgram->SetUniformVec2("u_targetArea", glm::vec2(areas[level]));
+        downsampleProgram->SetUniform1i("u_firstLevel", first ? 1 : 0);
+        source.BindTextureForSampling(0);
+        chain.BindTextureForImageAccess(0, chain.id, TextureAccess::Write, ChainFormat,
+                                         level, false, 0);
+        Dispatch(areas[level]);
+    }
+
+    upsampleProgram->useShaderProgram();
+    upsampleProgram->SetUniform1f("u_radius", settings.radius);
+    chain.BindTextureForSampling(0);
+    for (int level = levels - 2; level >= 0; --level) {
+        upsampleProgram->SetUniform1f("u_sourceLevel", static_cast<float>(level + 1));
+        upsampleProgram->SetUniformVec2("u_sourceArea", glm::vec2(areas[level + 1]));
+        upsampleProgram->SetUniformVec2("u_targetArea", glm::vec2(areas[level]));
+        upsampleProgram->SetUniform1f("u_outputScale", level == 0 ? 1.0f / static_cast<float>(levels) : 1.0f);
+        chain.BindTextureForImageAccess(0, chain.id, TextureAccess::ReadWrite, ChainFormat,
+                                         level, false, 0);
+        Dispatch(areas[level]);
+    }
+
+    outputArea = areas[0];
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <memory>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "../Shader/ShaderProgram.h"
+#include "../Texture/Texture.h"
+
+struct BloomSettings {
+    int levels = 6;                 // chain length from half resolution down; bounds the cost and the reach
+    float intensity = 0.04f;        // share of the thresholded light that is scattered
+    float threshold = 0.0f;         // 0 scatters all light, the physically based setting; above it only highlights
+    float softKnee = 0.5f;          // share of the threshold over which light fades into the bloom
+    float radius = 1.0f;            // tent half-width of the upsample, in texels of the smaller level
+    bool enabled = true;
+};
+
+// Bloom from the linear HDR scene as a chain of compute passes over one R11G11B10F mip chain at half
+// resolution: bloom_downsample.comp halves the image level by level with a 13-tap filter, then
+// bloom_upsample.comp walks back up adding a tent-filtered copy of each smaller level to the one above.
+// Every level is a wider blur at a quarter of the cost of the last, so the cost is set by `levels`
+// rather than by the width of the blur. PostProcessing composites level 0. The chain comes from the
+// caller, e.g. as a frame graph transient of GetChainSize(), ChainFormat and MaxLevels mips.
+class Bloom {
+    public:
+        static constexpr int MaxLevels = 8;
+        static constexpr TextureInternalFormat ChainFormat = TextureInternalFormat::R11G11B10F;
+
+        Bloom();
+
+        // Runs the chain over the `area` region of `scene`, from the origin; (0, 0) means all of it.
+        // The result is level 0 of `chain`, over GetOutputArea().
+        void Render(Texture& scene, Texture& chain, glm::ivec2 area = glm::ivec2(0));
+
+        // Level 0 size of a chain for scenes up to `sceneSize`, large enough that every level keeps
+        // at least one texel
+        static glm::ivec2 GetChainSize(glm::ivec2 sceneSize);
+
+        glm::ivec2 GetOutputArea() const { return outputArea; }
+
+        // Threshold, threshold - knee, 2 * knee and 0.25 / knee, for bloom.glsl
+        glm::vec4 GetThresholdCurve() const;
+
+        BloomSettings settings;
+
+    private:
+        int getLevelCount(const Texture& chain) const;
+
+        std::unique_ptr<ShaderProgram> downsampleProgram;
+        std::unique_ptr<ShaderProgram> upsampleProgram;
+        glm::ivec2 outputArea{0};
+};
+
+inline std::unique_ptr<Bloom> CreateBloom() {
+    return std::make_unique<Bloom>();
+}
@@ -0,0 +1,159 @@
+#include "PostProcessing.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include <spdlog/spdlog.h>
+
+namespace {
+    constexpr GLuint TileSize = 16;     // local size of post_process.comp
+
+    enum PostFeature : uint32_t {
+        TonemapACES = 1u << 0,
+        Lut = 1u << 1,
+        Dither = 1u << 2,
+        Fxaa = 1u << 3,
+        BloomComposite = 1u << 4
+    };
+
+    std::unique_ptr<Texture> createLut(int size, const std::vector<uint8_t>& texels) {
+        return CreateTextureFromData(size, size, size, TextureType::Tex3D, TextureFormat::RGBA,
+                                     TextureInternalFormat::RGBA8, texels.data(), 0,
+                                     TextureFilter::Linear, TextureFilter::Linear,
+                                     TextureWrap::ClampToEdge, TextureWrap::ClampToEdge, TextureWrap::ClampToEdge);
+    }
+
+    uint8_t toUnorm8(float value) {
+        return static_cast<uint8_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+    }
+}
+
+PostProcessing::PostProcessing() {
+    variants = CreateShaderVariantCache({{ShaderStage::Compute, "Shader/post_process.comp"}},
+                                        {"POST_TONEMAP_ACES", "POST_LUT", "POST_DITHER", "POST_FXAA", "POST_BLOOM"});
+    glCreateFramebuffers(1, &presentFramebuffer);
+}
+
+PostProcessing::~PostProcessing() {
+    glDeleteFramebuffers(1, &presentFramebuffer);
+}
+
+void PostProcessing::Apply(Texture& scene, Texture& output, glm::ivec2 sceneSize, Bloom* bloom, Texture* bloomChain) {
+    if (sceneSize == glm::ivec2(0)) sceneSize = {scene.width, scene.height};
+    if (sceneSize.x > scene.width || sceneSize.y > scene.height) {
+        throw std::runtime_error("Post processing scene area " + std::to_string(sceneSize.x) + "x" +
+                                 std::to_string(sceneSize.y) + " is larger than the scene texture");
+    }
+
+    const uint32_t features = getFeatures(bloom && bloomChain && bloom->settings.enabled);
+    auto program = variants->Get(features);
+    program->useShaderProgram();
+    program->SetUniformVec2("u_sceneSize", glm::vec2(sceneSize));
+    program->SetUniform1f("u_exposure", settings.exposure);
+    program->SetUniform1f("u_gamma", settings.gamma);
+    program->SetUniform1f("u_lutStrength", settings.lutStrength);
+
+    scene.BindTextureForSampling(0);
+    if (features & Lut) lut->BindTextureForSampling(1);
+    if (features & BloomComposite) {
+        program->SetUniformVec4("u_bloomCurve", bloom->GetThresholdCurve());
+        program->SetUniformVec2("u_bloomArea", glm::vec2(bloom->GetOutputArea()));
+        program->SetUniform1f("u_bloomIntensity", bloom->settings.intensity);
+        bloomChain->BindTextureForSampling(2);
+    }
+    output.BindTextureForImageAccess(0, output.id, TextureAccess::Write, OutputFormat);
+
+    glDispatchCompute((output.width + TileSize - 1) / TileSize, (output.height + TileSize - 1) / TileSize, 1);
+}
+
+void PostProcessing::Present(Texture& output, GLuint framebuffer) {
+    glNamedFramebufferTexture(presentFramebuffer, GL_COLOR_ATTACHMENT0, output.id, 0);
+    glNamedFramebufferReadBuffer(presentFramebuffer, GL_COLOR_ATTACHMENT0);
+    glBlitNamedFramebuffer(presentFramebuffer, framebuffer, 0, 0, output.width, output.height,
+                           0, 0, output.width, output.height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+}
+
+uint32_t PostProcessing::getFeatures(bool bloom) const {
+    uint32_t features = 0;
+    if (settings.tonemapper == Tonemapper::ACES) features |= TonemapACES;
+    if (settings.colorGrading && lut && settings.lutStrength > 0.0f) features |= Lut;
+    if (settings.dither) features |= Dither;
+    if (settings.fxaa) features |= Fxaa;
+    if (bloom) features |= BloomComposite;
+    return features;
+}
+
+namespace ColorGrading {
+    std::unique_ptr<Texture> CreateIdentityLut(int size) {
+        std::vector<uint8_t> texels(static_cast<size_t>(size) * size * size * 4);
+        const float scale = 1.0f / static_cast<float>(size - 1);
+
+        uint8_t* texel = texels.data();
+        for (int b = 0; b < size; ++b) {
+            for (int g = 0; g < size; ++g) {
+                for (int r = 0; r < size; ++r) {
+                    *texel++ = toUnorm8(r * scale);
+                    *texel++ = toUnorm8(g * scale);
+                    *texel++ = toUnorm8(b * scale);
+                    *texel++ = 255;
+                }
+            }
+        }
+        return createLut(size, texels);
+    }
+
+    std::unique_ptr<Texture> LoadCubeLut(const std::string& path) {
+        std::ifstream file(path);
+        if (!file) throw std::runtime_error("Failed to open LUT " + path);
+
+        int size = 0;
+        std::vector<uint8_t> texels;
+        size_t entries = 0;
+        std::string line;
+        while (std::getline(file, line)) {
+            if (line.empty() || line[0] == '#') continue;
+
+            std::istringstream stream(line);
+            if (std::isalpha(static_cast<unsigned char>(line[0]))) {
+                std::string keyword;
+                stream >> keyword;
+                if (keyword == "LUT_3D_SIZE") {
+                    stream >> size;
+                    if (size < 2 || size > 256) throw std::runtime_error("LUT " + path + " has unsupported size");
+                    texels.resize(static_cast<size_t>(size) * size * size * 4);
+                } else if (keyword == "LUT_1D_SIZE") {
+                    throw std::runtime_error("LUT " + path + " is 1D; only 3D LUTs are supported");
+                } else if (keyword == "DOMAIN_MIN" || keyword == "DOMAIN_MAX") {
+                    float x, y, z;
+                    stream >> x >> y >> z;
+                    if ((keyword == "DOMAIN_MIN" && (x != 0.0f || y != 0.0f || z != 0.0f)) ||
+                        (keyword == "DOMAIN_MAX" && (x != 1.0f || y != 1.0f || z != 1.0f))) {
+                        throw std::runtime_error("LUT " + path + " has a domain other than 0..1");
+                    }
+                }
+                continue;
+            }
+
+            float r, g, b;
+            if (!(stream >> r >> g >> b)) continue;
+            if (size == 0) throw std::runtime_error("LUT " + path + " has entries before LUT_3D_SIZE");
+            if (entries == texels.size() / 4) throw std::runtime_error("LUT " + path + " has too many entries");
+
+            // Red varies fastest, matching the texel order of a 3D texture indexed (r, g, b)
+            uint8_t* texel = &texels[entries++ * 4];
+            texel[0] = toUnorm8(r);
+            texel[1] = toUnorm8(g);
+            texel[2] = toUnorm8(b);
+            texel[3] = 255;
+        }
+
+        if (size == 0 || entries != texels.size() / 4) {
+            throw std::runtime_error("LUT " + path + " is incomplete");
+        }
+        spdlog::info("Loaded {}^3 color grading LUT {}", size, path);
+        return createLut(size, texels);
+    }
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "Bloom.h"
+#include "../Shader/ShaderVariants.h"
+#include "../Texture/Texture.h"
+
+enum class Tonemapper {
+    Reinhard,
+    ACES
+};
+
+struct PostProcessSettings {
+    float exposure = 1.0f;              // linear scale on the HDR scene before tonemapping
+    Tonemapper tonemapper = Tonemapper::Reinhard;
+    float gamma = 2.2f;
+    float lutStrength = 1.0f;           // 0 leaves the grade out, 1 applies it fully
+    bool colorGrading = true;           // only with a LUT set
+    bool dither = true;
+    bool fxaa = true;
+};
+
+// Post stack from the linear HDR scene to the displayable image: bloom composite, exposure,
+// tonemapping, gamma, a 3D color grading LUT, FXAA and dithering, all fused into one compute dispatch (post_process.comp)
+// that reads each scene texel once. Stages that are off compile out of the variant that runs. Also the
+// upscale of a scene rendered below output resolution. The output texture comes from the caller.
+class PostProcessing {
+    public:
+        // Display-ready output, at the size of the image presented
+        static constexpr TextureInternalFormat OutputFormat = TextureInternalFormat::RGBA8;
+
+        PostProcessing();
+        ~PostProcessing();
+
+        PostProcessing(const PostProcessing&) = delete;
+        PostProcessing& operator=(const PostProcessing&) = delete;
+
+        // Runs the stack on the `sceneSize` area of `scene`, from the origin, into `output`, upscaling
+        // when that area is smaller than the output. (0, 0) means all of `scene`. `bloom`, rendered
+        // from the same area into `bloomChain`, is composited first when both are given and enabled.
+        void Apply(Texture& scene, Texture& output, glm::ivec2 sceneSize = glm::ivec2(0), Bloom* bloom = nullptr,
+                   Texture* bloomChain = nullptr);
+
+        // Copies `output` into `framebuffer` (0 for the window). Needs GL_FRAMEBUFFER_BARRIER_BIT
+        // after Apply(); a render graph pass reading the output as CopyRead gets it inserted.
+        void Present(Texture& output, GLuint framebuffer = 0);
+
+        // 3D LUT indexed by display-space color; nullptr turns grading off
+        void SetLut(std::shared_ptr<Texture> lut) { this->lut = std::move(lut); }
+
+        PostProcessSettings settings;
+
+    private:
+        uint32_t getFeatures(bool bloom) const;
+
+        std::shared_ptr<ShaderVariantCache> variants;
+        GLuint presentFramebuffer = 0;                  // reads the output for Present()
+        std::shared_ptr<Texture> lut;
+};
+
+inline std::unique_ptr<PostProcessing> CreatePostProcessing() {
+    return std::make_unique<PostProcessing>();
+}
+
+namespace ColorGrading {
+    // `size`^3 LUT that maps every color to itself, a starting point for grades baked into a copy
+    std::unique_ptr<Texture> CreateIdentityLut(int size = 32);
+
+    // Adobe/Resolve .cube file (LUT_3D_SIZE, inputs in 0..1); throws when the file is unusable
+    std::unique_ptr<Texture> LoadCubeLut(const std::string& path);
+}
@@ -0,0 +1,134 @@
+#include "GpuTimer.h"
+#include <algorithm>
+#include <spdlog/spdlog.h>
+
+namespace {
+    constexpr double Smoothing = 0.1;
+}
+
+GpuTimer::GpuTimer(uint32_t latency)
+    : frames(std::max(2u, latency))
+{
+}
+
+GpuTimer::~GpuTimer() {
+    for (auto& frame : frames) {
+        if (!frame.queries.empty()) glDeleteQueries(static_cast<GLsizei>(frame.queries.size()), frame.queries.data());
+    }
+}
+
+bool GpuTimer::BeginFrame() {
+    current = (current + 1) % frames.size();
+    Frame& frame = frames[current];
+
+    // Scopes left open last frame are dropped rather than timed against an unrelated End()
+    open.clear();
+
+    bool available = !frame.scopes.empty();
+    for (const Scope& scope : frame.scopes) {
+        if (scope.end == 0) {
+            available = false;
+            break;
+        }
+    }
+    if (available) {
+        // Queries complete in the order they were issued, so the last one answers for the whole
+        // frame. That is not the last scope's end: an enclosing scope ends after its children.
+        GLint ready = 0;
+        glGetQueryObjectiv(frame.lastQuery, GL_QUERY_RESULT_AVAILABLE, &ready);
+        available = ready != 0;
+    }
+
+    // Still in flight means the GPU is more than `latency` frames behind; skip rather than wait
+    if (available) {
+        for (const Scope& scope : frame.scopes) {
+            GLuint64 begin = 0;
+            GLuint64 end = 0;
+            glGetQueryObjectui64v(scope.begin, GL_QUERY_RESULT, &begin);
+            glGetQueryObjectui64v(scope.end, GL_QUERY_RESULT, &end);
+
+            Timing& timing = timings[scope.name];
+            timing.latest = static_cast<double>(end - begin) / 1.0e6;
+            timing.smoothed = timing.measured ? timing.smoothed + Smoothing * (timing.latest - timing.smoothed)
+                                              : timing.latest;
+            timing.measured = true;
+        }
+    }
+
+    frame.scopes.clear();
+    frame.usedQueries = 0;
+    frame.lastQuery = 0;
+    return available;
+}
+
+void GpuTimer::Begin(const std::string& name) {
+    Scope scope{findOrAddName(name), nextQuery(), 0};
+    glQueryCounter(scope.begin, GL_TIMESTAMP);
+    frames[current].lastQuery = scope.begin;
+
+    frames[current].scopes.push_back(scope);
+    open.push_back(frames[current].scopes.size() - 1);
+}
+
+void GpuTimer::End(const std::string& name) {
+    const uint32_t id = findOrAddName(name);
+    auto& scopes = frames[current].scopes;
+
+    for (auto it = open.rbegin(); it != open.rend(); ++it) {
+        if (scopes[*it].name != id) continue;
+
+        scopes[*it].end = nextQuery();
+        glQueryCounter(scopes[*it].end, GL_TIMESTAMP);
+        frames[current].lastQuery = scopes[*it].end;
+        open.erase(std::next(it).base());
+        return;
+    }
+    spdlog::warn("GPU timer: End(\"{}\") without Begin()", name);
+}
+
+double GpuTimer::GetMilliseconds(const std::string& name) const {
+    const Timing* timing = find(name);
+    return timing ? timing->smoothed : 0.0;
+}
+
+double GpuTimer::GetLatestMilliseconds(const std::string& name) const {
+    const Timing* timing = find(name);
+    return timing ? timing->latest : 0.0;
+}
+
+std::vector<std::pair<std::string, double>> GpuTimer::GetTimings() const {
+    std::vector<std::pair<std::string, double>> result;
+    for (const Timing& timing : timings) result.emplace_back(timing.name, timing.smoothed);
+    return result;
+}
+
+void GpuTimer::LogTimings() const {
+    for (const Timing& timing : timings) {
+        spdlog::info("GPU {:<24} {:7.3f} ms", timing.name, timing.smoothed);
+    }
+}
+
+uint32_t GpuTimer::findOrAddName(const std::string& name) {
+    for (uint32_t i = 0; i < timings.size(); ++i) {
+        if (timings[i].name == name) return i;
+    }
+    timings.push_back({name});
+    return static_cast<uint32_t>(timings.size() - 1);
+}
+
+GLuint GpuTimer::nextQuery() {
+    Frame& frame = frames[current];
+    if (frame.usedQueries == frame.queries.size()) {
+        GLuint query = 0;
+        glCreateQueries(GL_TIMESTAMP, 1, &query);
+        frame.queries.push_back(query);
+    }
+    return frame.queries[frame.usedQueries++];
+}
+
+const GpuTimer::Timing* GpuTimer::find(const std::string& name) const {
+    for (const Timing& timing : timings) {
+        if (timing.name == name) return &timing;
+    }
+    return nullptr;
+}
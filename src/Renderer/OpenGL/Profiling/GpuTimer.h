@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <glad/glad.h>
+
+// Named GPU timings that never stall: every Begin()/End() pair writes two timestamp queries into the
+// current frame's slot, and slots are read back `latency` frames later, when the GPU has long
+// finished them. Results are smoothed per name. Scopes may nest; each name is one scope per frame.
+class GpuTimer {
+    public:
+        explicit GpuTimer(uint32_t latency = 4);
+        ~GpuTimer();
+
+        GpuTimer(const GpuTimer&) = delete;
+        GpuTimer& operator=(const GpuTimer&) = delete;
+
+        // Collects the oldest slot's results and starts recording into it. True when new results came
+        // in, false when that frame recorded nothing or is still in flight.
+        bool BeginFrame();
+
+        void Begin(const std::string& name);
+        void End(const std::string& name);
+
+        // Smoothed milliseconds of the last results for `name`; 0 until the first one arrives
+        double GetMilliseconds(const std::string& name) const;
+        // Last raw result for `name`, `latency` frames old
+        double GetLatestMilliseconds(const std::string& name) const;
+
+        // Every name in first-seen order with its smoothed milliseconds
+        std::vector<std::pair<std::string, double>> GetTimings() const;
+        void LogTimings() const;
+
+        uint32_t GetLatency() const { return static_cast<uint32_t>(frames.size()); }
+
+    private:
+        struct Scope {
+            uint32_t name;
+            GLuint begin;
+            GLuint end;
+        };
+
+        struct Frame {
+            std::vector<Scope> scopes;
+            std::vector<GLuint> queries;    // owned by this slot, reused every time it comes round
+            size_t usedQueries = 0;
+            GLuint lastQuery = 0;           // issued last, so it completes after every other query here
+        };
+
+        struct Timing {
+            std::string name;
+            double smoothed = 0.0;
+            double latest = 0.0;
+            bool measured = false;
+        };
+
+        uint32_t findOrAddName(const std::string& name);
+        GLuint nextQuery();
+        const Timing* find(const std::string& name) const;
+
+        std::vector<Frame> frames;
+        std::vector<Timing> timings;
+        std::vector<size_t> open;           // indices of scopes in the current frame awaiting End()
+        size_t current = 0;
+};
+
+inline std::unique_ptr<GpuTimer> CreateGpuTimer(uint32_t latency = 4) {
+    return std::make_unique<GpuTimer>(latency);
+}
@@ -0,0 +1,378 @@
+#include "RenderGraph.h"
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <sstream>
+#include <stdexcept>
+
+bool RenderGraphAccessInfo::IsWrite(RenderGraphAccess access) {
+    switch (access) {
+        case RenderGraphAccess::ImageWrite:
+        case RenderGraphAccess::StorageWrite:
+        case RenderGraphAccess::CopyWrite:
+        case RenderGraphAccess::ColorAttachment:
+        case RenderGraphAccess::DepthAttachment:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool RenderGraphAccessInfo::IsIncoherentWrite(RenderGraphAccess access) {
+    return access == RenderGraphAccess::ImageWrite || access == RenderGraphAccess::StorageWrite;
+}
+
+GLbitfield RenderGraphAccessInfo::GetBarrierBit(RenderGraphAccess access, bool isBuffer) {
+    switch (access) {
+        case RenderGraphAccess::Sampled:            return GL_TEXTURE_FETCH_BARRIER_BIT;
+        case RenderGraphAccess::ImageRead:
+        case RenderGraphAccess::ImageWrite:         return GL_SHADER_IMAGE_ACCESS_BARRIER_BIT;
+        case RenderGraphAccess::StorageRead:
+        case RenderGraphAccess::StorageWrite:       return GL_SHADER_STORAGE_BARRIER_BIT;
+        case RenderGraphAccess::UniformRead:        return GL_UNIFORM_BARRIER_BIT;
+        case RenderGraphAccess::IndirectRead:       return GL_COMMAND_BARRIER_BIT;
+        case RenderGraphAccess::VertexRead:         return GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_ELEMENT_ARRAY_BARRIER_BIT;
+        case RenderGraphAccess::CopyRead:
+        case RenderGraphAccess::CopyWrite:
+            // Texture copies are either uploads and readbacks or blits, which go through framebuffers
+            return isBuffer ? GL_BUFFER_UPDATE_BARRIER_BIT : GL_TEXTURE_UPDATE_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT;
+        case RenderGraphAccess::ColorAttachment:
+        case RenderGraphAccess::DepthAttachment:
+        case RenderGraphAccess::DepthRead:          return GL_FRAMEBUFFER_BARRIER_BIT;
+    }
+    return GL_ALL_BARRIER_BITS;
+}
+
+size_t RenderGraphTextureDesc::GetMemorySize() const {
+    size_t bytes = 0;
+    for (int level = 0; level < std::max(1, mipLevels); ++level) {
+        bytes += static_cast<size_t>(std::max(1, size.x >> level)) * std::max(1, size.y >> level) *
+                 GetBytesPerPixel(format);
+    }
+    return bytes * std::max(1, samples);
+}
+
+RenderGraphResource RenderGraphPassBuilder::Read(RenderGraphResource resource, RenderGraphAccess access) {
+    if (RenderGraphAccessInfo::IsWrite(access)) {
+        throw std::runtime_error("Render graph pass '" + graph.passes[pass].name + "' reads with a write access");
+    }
+    graph.passes[pass].accesses.push_back({resource, access});
+    return resource;
+}
+
+RenderGraphResource RenderGraphPassBuilder::Write(RenderGraphResource resource, RenderGraphAccess access) {
+    if (!RenderGraphAccessInfo::IsWrite(access)) {
+        throw std::runtime_error("Render graph pass '" + graph.passes[pass].name + "' writes with a read access");
+    }
+    graph.passes[pass].accesses.push_back({resource, access});
+    return resource;
+}
+
+void RenderGraphPassBuilder::SetSideEffect() {
+    graph.passes[pass].sideEffect = true;
+}
+
+void RenderGraph::Reset() {
+    resources.clear();
+    passes.clear();
+    compiled = RenderGraphCompiled();
+}
+
+RenderGraphResource RenderGraph::CreateTexture(const std::string& name, const RenderGraphTextureDesc& desc) {
+    ResourceNode node;
+    node.name = name;
+    node.textureDesc = desc;
+    resources.push_back(node);
+    return {static_cast<uint32_t>(resources.size() - 1)};
+}
+
+RenderGraphResource RenderGraph::CreateBuffer(const std::string& name, const RenderGraphBufferDesc& desc) {
+    ResourceNode node;
+    node.name = name;
+    node.isBuffer = true;
+    node.bufferDesc = desc;
+    resources.push_back(node);
+    return {static_cast<uint32_t>(resources.size() - 1)};
+}
+
+RenderGraphResource RenderGraph::ImportTexture(const std::string& name, Texture* texture) {
+    ResourceNode node;
+    node.name = name;
+    node.imported = true;
+    node.importedTexture = texture;
+    if (texture) node.textureDesc = {{texture->width, texture->height}, texture->internalFormat, texture->samples, texture->levels};
+    resources.push_back(node);
+    return {static_cast<uint32_t>(resources.size() - 1)};
+}
+
+RenderGraphResource RenderGraph::ImportBuffer(const std::string& name, Buffer* buffer) {
+    ResourceNode node;
+    node.name = name;
+    node.isBuffer = true;
+    node.imported = true;
+    node.importedBuffer = buffer;
+    if (buffer) node.bufferDesc.size = buffer->size;
+    resources.push_back(node);
+    return {static_cast<uint32_t>(resources.size() - 1)};
+}
+
+void RenderGraph::AddPass(const std::string& name, const std::function<void(RenderGraphPassBuilder&)>& setup,
+                          ExecuteFunction execute) {
+    passes.push_back({name, {}, std::move(execute), false});
+    RenderGraphPassBuilder builder(*this, static_cast<uint32_t>(passes.size() - 1));
+    setup(builder);
+
+    for (const auto& access : passes.back().accesses) {
+        if (access.resource.index >= resources.size()) {
+            throw std::runtime_error("Render graph pass '" + name + "' uses an undeclared resource");
+        }
+    }
+}
+
+namespace {
+    // Dependencies between passes, per pass: the passes it must run after
+    struct PassDependencies {
+        std::vector<std::vector<uint32_t>> producers;   // read-after-write and write-after-write
+        std::vector<std::vector<uint32_t>> readers;     // write-after-read: earlier readers of the old contents
+    };
+
+    void AddEdge(std::vector<uint32_t>& edges, uint32_t pass) {
+        if (std::find(edges.begin(), edges.end(), pass) == edges.end()) edges.push_back(pass);
+    }
+}
+
+std::vector<bool> RenderGraph::findLivePasses(const std::vector<std::vector<uint32_t>>& producers) const {
+    std::vector<bool> live(passes.size(), false);
+    std::vector<uint32_t> stack;
+
+    for (uint32_t pass = 0; pass < passes.size(); ++pass) {
+        bool root = passes[pass].sideEffect;
+        for (const auto& access : passes[pass].accesses) {
+            root = root || (resources[access.resource.index].imported && RenderGraphAccessInfo::IsWrite(access.access));
+        }
+        if (root) {
+            live[pass] = true;
+            stack.push_back(pass);
+        }
+    }
+
+    while (!stack.empty()) {
+        uint32_t pass = stack.back();
+        stack.pop_back();
+        for (uint32_t producer : producers[pass]) {
+            if (!live[producer]) {
+                live[producer] = true;
+                stack.push_back(producer);
+            }
+        }
+    }
+    return live;
+}
+
+const RenderGraphCompiled& RenderGraph::Compile() {
+    compiled = RenderGraphCompiled();
+    const uint32_t passCount = static_cast<uint32_t>(passes.size());
+
+    // Versions: every write starts a new version of the resource; a read sees the last version
+    // written by a pass declared before it, or the first version if its producer is declared later
+    PassDependencies dependencies;
+    dependencies.producers.resize(passCount);
+    dependencies.readers.resize(passCount);
+
+    for (uint32_t resource = 0; resource < resources.size(); ++resource) {
+        std::vector<uint32_t> writers;
+        std::vector<std::pair<uint32_t, bool>> uses;    // pass, writes
+        for (uint32_t pass = 0; pass < passCount; ++pass) {
+            bool reads = false;
+            bool writes = false;
+            for (const auto& access : passes[pass].accesses) {
+                if (access.resource.index != resource) continue;
+                (RenderGraphAccessInfo::IsWrite(access.access) ? writes : reads) = true;
+            }
+            if (writes) writers.push_back(pass);
+            if (reads || writes) uses.push_back({pass, writes});
+        }
+        if (uses.empty()) continue;
+
+        if (writers.empty()) {
+            if (!resources[resource].imported) {
+                throw std::runtime_error("Render graph resource '" + resources[resource].name + "' is read but never written");
+            }
+            continue;
+        }
+
+        // readersOf[k]: readers of the version writers[k] produced
+        std::vector<std::vector<uint32_t>> readersOf(writers.size());
+        size_t version = 0;
+        bool written = false;
+        for (const auto& [pass, writes] : uses) {
+            if (writes) {
+                if (written) {
+                    AddEdge(dependencies.producers[pass], writers[version]);
+                    for (uint32_t reader : readersOf[version]) {
+                        if (reader != pass) AddEdge(dependencies.readers[pass], reader);
+                    }
+                    ++version;
+                }
+                written = true;
+            } else {
+                AddEdge(dependencies.producers[pass], writers[version]);
+                readersOf[version].push_back(pass);
+            }
+        }
+    }
+
+    const std::vector<bool> live = findLivePasses(dependencies.producers);
+
+    // Kahn's algorithm over the live passes, lowest declaration index first so independent passes
+    // keep the order they were declared in
+    std::vector<std::vector<uint32_t>> dependents(passCount);
+    std::vector<uint32_t> pending(passCount, 0);
+    for (uint32_t pass = 0; pass < passCount; ++pass) {
+        if (!live[pass]) {
+            compiled.culledPasses.push_back(pass);
+            continue;
+        }
+        for (const auto* edges : {&dependencies.producers[pass], &dependencies.readers[pass]}) {
+            for (uint32_t before : *edges) {
+                if (!live[before]) continue;
+                dependents[before].push_back(pass);
+                ++pending[pass];
+            }
+        }
+    }
+
+    std::priority_queue<uint32_t, std::vector<uint32_t>, std::greater<uint32_t>> ready;
+    for (uint32_t pass = 0; pass < passCount; ++pass) {
+        if (live[pass] && pending[pass] == 0) ready.push(pass);
+    }
+    while (!ready.empty()) {
+        uint32_t pass = ready.top();
+        ready.pop();
+        compiled.order.push_back({pass, 0});
+        for (uint32_t dependent : dependents[pass]) {
+            if (--pending[dependent] == 0) ready.push(dependent);
+        }
+    }
+    if (compiled.order.size() + compiled.culledPasses.size() != passCount) {
+        throw std::runtime_error("Render graph has a dependency cycle");
+    }
+
+    assignPhysicalResources();
+    insertBarriers();
+    return compiled;
+}
+
+void RenderGraph::assignPhysicalResources() {
+    compiled.lifetimes.assign(resources.size(), glm::ivec2(-1));
+    compiled.physical.assign(resources.size(), -1);
+
+    for (int position = 0; position < static_cast<int>(compiled.order.size()); ++position) {
+        for (const auto& access : passes[compiled.order[position].pass].accesses) {
+            glm::ivec2& lifetime = compiled.lifetimes[access.resource.index];
+            if (lifetime.x < 0) lifetime.x = position;
+            lifetime.y = position;
+        }
+    }
+
+    std::vector<uint32_t> transients;
+    for (uint32_t resource = 0; resource < resources.size(); ++resource) {
+        if (!resources[resource].imported && compiled.lifetimes[resource].x >= 0) transients.push_back(resource);
+    }
+    std::stable_sort(transients.begin(), transients.end(), [&](uint32_t a, uint32_t b) {
+        return compiled.lifetimes[a].x < compiled.lifetimes[b].x;
+    });
+
+    // Greedy interval assignment: reuse the first compatible physical resource that is free again.
+    // GL cannot place different formats in one allocation, so textures share only with identical
+    // descriptions; buffers share with anything and grow to the largest user.
+    std::vector<int> physicalLastUse;
+    for (uint32_t resource : transients) {
+        const ResourceNode& node = resources[resource];
+        const glm::ivec2 lifetime = compiled.lifetimes[resource];
+
+        int chosen = -1;
+        for (int physical = 0; physical < static_cast<int>(compiled.physicalResources.size()); ++physical) {
+            const auto& candidate = compiled.physicalResources[physical];
+            if (physicalLastUse[physical] >= lifetime.x || candidate.isBuffer != node.isBuffer) continue;
+            if (!node.isBuffer && !(candidate.textureDesc == node.textureDesc)) continue;
+            chosen = physical;
+            break;
+        }
+        if (chosen < 0) {
+            RenderGraphPhysicalResource physical;
+            physical.isBuffer = node.isBuffer;
+            physical.textureDesc = node.textureDesc;
+            compiled.physicalResources.push_back(physical);
+            physicalLastUse.push_back(-1);
+            chosen = static_cast<int>(compiled.physicalResources.size() - 1);
+        }
+
+        auto& physical = compiled.physicalResources[chosen];
+        if (node.isBuffer) physical.bufferSize = std::max(physical.bufferSize, node.bufferDesc.size);
+        physicalLastUse[chosen] = lifetime.y;
+        compiled.physical[resource] = chosen;
+        compiled.transientBytes += node.isBuffer ? node.bufferDesc.size : node.textureDesc.GetMemorySize();
+    }
+
+    for (const auto& physical : compiled.physicalResources) {
+        compiled.aliasedBytes += physical.isBuffer ? physical.bufferSize : physical.textureDesc.GetMemorySize();
+    }
+}
+
+void RenderGraph::insertBarriers() {
+    // glMemoryBarrier is global: one bit issued after a write covers every later access of that
+    // kind to anything written before it. So a pass needs a bit only if some resource it touches
+    // had an incoherent write after the last time that bit was issued.
+    constexpr int BitCount = 32;
+    int lastBarrier[BitCount];
+    std::fill(std::begin(lastBarrier), std::end(lastBarrier), -1);
+
+    // Keyed by memory: imported resources by index, transients by the physical resource they alias
+    auto memoryOf = [&](uint32_t resource) {
+        return resources[resource].imported ? resource
+                                             : static_cast<uint32_t>(resources.size()) + compiled.physical[resource];
+    };
+    std::vector<int> lastIncoherentWrite(resources.size() + compiled.physicalResources.size(), -1);
+
+    for (int position = 0; position < static_cast<int>(compiled.order.size()); ++position) {
+        auto& step = compiled.order[position];
+        const PassNode& pass = passes[step.pass];
+
+        for (const auto& access : pass.accesses) {
+            const int written = lastIncoherentWrite[memoryOf(access.resource.index)];
+            if (written < 0) continue;
+
+            const GLbitfield bits = RenderGraphAccessInfo::GetBarrierBit(access.access, resources[access.resource.index].isBuffer);
+            for (int bit = 0; bit < BitCount; ++bit) {
+                if ((bits & (1u << bit)) && lastBarrier[bit] <= written) step.barrierBits |= (1u << bit);
+            }
+        }
+
+        for (int bit = 0; bit < BitCount; ++bit) {
+            if (step.barrierBits & (1u << bit)) lastBarrier[bit] = position;
+        }
+        if (step.barrierBits) ++compiled.barrierCount;
+
+        for (const auto& access : pass.accesses) {
+            if (RenderGraphAccessInfo::IsIncoherentWrite(access.access)) {
+                lastIncoherentWrite[memoryOf(access.resource.index)] = position;
+            }
+        }
+    }
+}
+
+std::string RenderGraph::Describe() const {
+    std::ostringstream out;
+    for (const auto& step : compiled.order) {
+        out << passes[step.pass].name;
+        if (step.barrierBits) out << " (barrier 0x" << std::hex << step.barrierBits << std::dec << ")";
+        out << "\n";
+    }
+    for (uint32_t pass : compiled.culledPasses) {
+        out << passes[pass].name << " (culled)\n";
+    }
+    out << compiled.physicalResources.size() << " physical resources, " << compiled.aliasedBytes / 1024 << " KiB of "
+        << compiled.transientBytes / 1024 << " KiB transient, " << compiled.barrierCount << " barriers\n";
+    return out.str();
+}
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "../Texture/Texture.h"
+#include "../Buffer/Buffer.h"
+
+// Frame render graph. Passes declare every texture and buffer they touch and how; Compile() orders
+// them by their data dependencies, culls passes nothing consumes, maps transient resources whose
+// lifetimes do not overlap onto shared physical resources, and works out the glMemoryBarrier bits
+// each pass needs. Compilation is CPU only; RenderGraphExecutor creates the GL objects and runs it.
+// The graph is rebuilt every frame: Reset(), declare, Compile(), execute.
+
+struct RenderGraphResource {
+    uint32_t index = UINT32_MAX;
+
+    bool IsValid() const { return index != UINT32_MAX; }
+    bool operator==(const RenderGraphResource& other) const { return index == other.index; }
+};
+
+enum class RenderGraphAccess : uint8_t {
+    Sampled,            // texture fetch
+    ImageRead,          // imageLoad
+    ImageWrite,         // imageStore or image atomics
+    StorageRead,        // SSBO reads
+    StorageWrite,       // SSBO writes or atomics
+    UniformRead,
+    IndirectRead,       // draw or dispatch arguments
+    VertexRead,         // vertex or index fetch
+    CopyRead,           // blit source, readback
+    CopyWrite,          // blit or upload destination
+    ColorAttachment,
+    DepthAttachment,    // depth test with writes
+    DepthRead           // depth test without writes
+};
+
+namespace RenderGraphAccessInfo {
+    bool IsWrite(RenderGraphAccess access);
+    // Writes that GL does not order against later reads without glMemoryBarrier
+    bool IsIncoherentWrite(RenderGraphAccess access);
+    // Barrier bit that makes incoherent writes visible to a later access of this kind
+    GLbitfield GetBarrierBit(RenderGraphAccess access, bool isBuffer);
+}
+
+struct RenderGraphTextureDesc {
+    glm::ivec2 size{0};
+    TextureInternalFormat format = TextureInternalFormat::RGBA8;
+    int samples = 1;
+    int mipLevels = 1;
+    TextureFilter filter = TextureFilter::Linear;   // of the sampler the texture is created with
+
+    bool operator==(const RenderGraphTextureDesc& other) const {
+        return size == other.size && format == other.format && samples == other.samples &&
+               mipLevels == other.mipLevels && filter == other.filter;
+    }
+
+    size_t GetMemorySize() const;
+};
+
+struct RenderGraphBufferDesc {
+    size_t size = 0;
+};
+
+class RenderGraphContext;
+
+class RenderGraphPassBuilder {
+    public:
+        // Declares an access; a pass may touch a resource several ways (e.g. sampled and written)
+        RenderGraphResource Read(RenderGraphResource resource, RenderGraphAccess access = RenderGraphAccess::Sampled);
+        RenderGraphResource Write(RenderGraphResource resource, RenderGraphAccess access = RenderGraphAccess::ColorAttachment);
+        // Keeps the pass even if nothing reads what it writes (readbacks, presentation, timers)
+        void SetSideEffect();
+
+    private:
+        friend class RenderGraph;
+        RenderGraphPassBuilder(class RenderGraph& graph, uint32_t pass) : graph(graph), pass(pass) {}
+
+        class RenderGraph& graph;
+        uint32_t pass;
+};
+
+struct RenderGraphCompiledPass {
+    uint32_t pass = 0;                  // index into the declared passes
+    GLbitfield barrierBits = 0;         // for glMemoryBarrier before the pass; 0 for none
+};
+
+struct RenderGraphPhysicalResource {
+    bool isBuffer = false;
+    RenderGraphTextureDesc textureDesc;
+    size_t bufferSize = 0;              // largest of the buffers sharing it
+};
+
+struct RenderGraphCompiled {
+    std::vector<RenderGraphCompiledPass> order;
+    std::vector<uint32_t> culledPasses;
+    // Per declared resource: index into physicalResources, or -1 for imported and unused resources
+    std::vector<int32_t> physical;
+    std::vector<RenderGraphPhysicalResource> physicalResources;
+    // Per declared resource: first and last position in `order` that touches it
+    std::vector<glm::ivec2> lifetimes;
+
+    size_t transientBytes = 0;          // what every transient resource would take on its own
+    size_t aliasedBytes = 0;            // what the physical resources take
+    size_t barrierCount = 0;
+};
+
+class RenderGraph {
+    public:
+        using ExecuteFunction = std::function<void(RenderGraphContext&)>;
+
+        struct ResourceNode {
+            std::string name;
+            bool isBuffer = false;
+            bool imported = false;
+            RenderGraphTextureDesc textureDesc;
+            RenderGraphBufferDesc bufferDesc;
+            Texture* importedTexture = nullptr;
+            Buffer* importedBuffer = nullptr;
+        };
+
+        struct Access {
+            RenderGraphResource resource;
+            RenderGraphAccess access;
+        };
+
+        struct PassNode {
+            std::string name;
+            std::vector<Access> accesses;
+            ExecuteFunction execute;
+            bool sideEffect = false;
+        };
+
+        void Reset();
+
+        // Transient resources live only between their first and last use this frame
+        RenderGraphResource CreateTexture(const std::string& name, const RenderGraphTextureDesc& desc);
+        RenderGraphResource CreateBuffer(const std::string& name, const RenderGraphBufferDesc& desc);
+        // Imported resources outlive the frame; passes writing them are never culled
+        RenderGraphResource ImportTexture(const std::string& name, Texture* texture);
+        RenderGraphResource ImportBuffer(const std::string& name, Buffer* buffer);
+
+        void AddPass(const std::string& name, const std::function<void(RenderGraphPassBuilder&)>& setup,
+                     ExecuteFunction execute);
+
+        // Throws std::runtime_error on dependency cycles or accesses to undeclared resources
+        const RenderGraphCompiled& Compile();
+
+        const RenderGraphCompiled& GetCompiled() const { return compiled; }
+        const std::vector<ResourceNode>& GetResources() const { return resources; }
+        const std::vector<PassNode>& GetPasses() const { return passes; }
+
+        // Passes in execution order with their barriers and the culled ones, for debugging
+        std::string Describe() const;
+
+    private:
+        friend class RenderGraphPassBuilder;
+
+        // Passes with side effects or writes to imported resources, and everything they consume
+        std::vector<bool> findLivePasses(const std::vector<std::vector<uint32_t>>& producers) const;
+        void assignPhysicalResources();
+        void insertBarriers();
+
+        std::vector<ResourceNode> resources;
+        std::vector<PassNode> passes;
+        RenderGraphCompiled compiled;
+};
+
+inline std::unique_ptr<RenderGraph> CreateRenderGraph() {
+    return std::make_unique<RenderGraph>();
+}
@@ -0,0 +1,154 @@
+#include "RenderGraphExecutor.h"
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+namespace {
+    constexpr GLenum MaxColorAttachments = 8;
+}
+
+Texture& RenderGraphContext::GetTexture(RenderGraphResource resource) {
+    const auto& node = graph.GetResources().at(resource.index);
+    if (node.isBuffer) throw std::runtime_error("Render graph resource '" + node.name + "' is not a texture");
+    if (node.imported) return *node.importedTexture;
+
+    const RenderTargetAttachments* attachments = executor.textures.at(graph.GetCompiled().physical[resource.index]);
+    if (!attachments) throw std::runtime_error("Render graph resource '" + node.name + "' is not in use by this pass");
+    return attachments->depth ? *attachments->depth : *attachments->colors[0];
+}
+
+Buffer& RenderGraphContext::GetBuffer(RenderGraphResource resource) {
+    const auto& node = graph.GetResources().at(resource.index);
+    if (!node.isBuffer) throw std::runtime_error("Render graph resource '" + node.name + "' is not a buffer");
+    if (node.imported) return *node.importedBuffer;
+
+    return *executor.buffers.at(graph.GetCompiled().physical[resource.index]);
+}
+
+void RenderGraphContext::BindFramebuffer() {
+    if (executor.framebuffers.size() <= position) executor.framebuffers.resize(position + 1, 0);
+    GLuint& framebuffer = executor.framebuffers[position];
+    if (!framebuffer) glCreateFramebuffers(1, &framebuffer);
+
+    std::vector<GLenum> drawBuffers;
+    GLuint depth = 0;
+    glm::ivec2 size(0);
+    for (const auto& access : graph.GetPasses()[pass].accesses) {
+        const bool color = access.access == RenderGraphAccess::ColorAttachment;
+        const bool depthAccess = access.access == RenderGraphAccess::DepthAttachment ||
+                                 access.access == RenderGraphAccess::DepthRead;
+        if (!color && !depthAccess) continue;
+
+        Texture& texture = GetTexture(access.resource);
+        if (size == glm::ivec2(0)) size = {texture.width, texture.height};
+        if (depthAccess) {
+            depth = texture.id;
+        } else if (drawBuffers.size() < MaxColorAttachments) {
+            const GLenum attachment = GL_COLOR_ATTACHMENT0 + static_cast<GLenum>(drawBuffers.size());
+            glNamedFramebufferTexture(framebuffer, attachment, texture.id, 0);
+            drawBuffers.push_back(attachment);
+        }
+    }
+
+    // Attachments left over from the pass that used this framebuffer last frame
+    for (GLenum i = static_cast<GLenum>(drawBuffers.size()); i < MaxColorAttachments; ++i) {
+        glNamedFramebufferTexture(framebuffer, GL_COLOR_ATTACHMENT0 + i, 0, 0);
+    }
+    glNamedFramebufferTexture(framebuffer, GL_DEPTH_ATTACHMENT, depth, 0);
+
+    if (drawBuffers.empty()) {
+        glNamedFramebufferDrawBuffer(framebuffer, GL_NONE);
+    } else {
+        glNamedFramebufferDrawBuffers(framebuffer, static_cast<GLsizei>(drawBuffers.size()), drawBuffers.data());
+    }
+
+    GLenum status = glCheckNamedFramebufferStatus(framebuffer, GL_FRAMEBUFFER);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        throw std::runtime_error("Render graph pass '" + GetPassName() + "' framebuffer incomplete, status " +
+                                 std::to_string(status));
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glViewport(0, 0, size.x, size.y);
+}
+
+RenderGraphExecutor::~RenderGraphExecutor() {
+    releaseTextures();
+    for (GLuint framebuffer : framebuffers) {
+        if (framebuffer) glDeleteFramebuffers(1, &framebuffer);
+    }
+}
+
+void RenderGraphExecutor::releaseTextures() {
+    for (RenderTargetAttachments*& attachments : textures) {
+        if (attachments) GetRenderTargetPool().ReleaseTransient(attachments);
+        attachments = nullptr;
+    }
+}
+
+void RenderGraphExecutor::Execute(RenderGraph& graph) {
+    const RenderGraphCompiled& compiled = graph.Compile();
+
+    // Left over only if a pass threw last frame
+    releaseTextures();
+    textures.assign(compiled.physicalResources.size(), nullptr);
+    if (buffers.size() < compiled.physicalResources.size()) buffers.resize(compiled.physicalResources.size());
+
+    // Every resource aliased onto a physical resource lies within its span
+    std::vector<glm::ivec2> spans(compiled.physicalResources.size(), glm::ivec2(INT32_MAX, -1));
+    for (size_t resource = 0; resource < compiled.physical.size(); ++resource) {
+        const int32_t physical = compiled.physical[resource];
+        if (physical < 0) continue;
+        spans[physical].x = std::min(spans[physical].x, compiled.lifetimes[resource].x);
+        spans[physical].y = std::max(spans[physical].y, compiled.lifetimes[resource].y);
+    }
+
+    std::vector<RenderTargetDesc> descs(compiled.physicalResources.size());
+    for (size_t i = 0; i < compiled.physicalResources.size(); ++i) {
+        const auto& physical = compiled.physicalResources[i];
+        if (physical.isBuffer) {
+            if (!buffers[i] || buffers[i]->size < physical.bufferSize) {
+                buffers[i] = CreateBuffer(BufferType::Storage, physical.bufferSize, nullptr, BufferUsage::Dynamic);
+            }
+            continue;
+        }
+
+        RenderTargetDesc& desc = descs[i];
+        if (IsDepthFormat(physical.textureDesc.format)) {
+            desc.depthFormat = physical.textureDesc.format;
+        } else {
+            desc.colorFormats = {physical.textureDesc.format};
+        }
+        desc.samples = physical.textureDesc.samples;
+        desc.mipLevels = physical.textureDesc.mipLevels;
+        desc.filter = physical.textureDesc.filter;
+    }
+
+    for (size_t position = 0; position < compiled.order.size(); ++position) {
+        const int current = static_cast<int>(position);
+        for (size_t i = 0; i < textures.size(); ++i) {
+            if (compiled.physicalResources[i].isBuffer || spans[i].x != current) continue;
+            textures[i] = GetRenderTargetPool().AcquireTransient(descs[i], compiled.physicalResources[i].textureDesc.size);
+        }
+
+        const auto& step = compiled.order[position];
+        if (step.barrierBits) glMemoryBarrier(step.barrierBits);
+
+        RenderGraphContext context(*this, graph, step.pass, position);
+        const auto& pass = graph.GetPasses()[step.pass];
+        if (pass.execute) {
+            if (timer) timer->Begin(pass.name);
+            pass.execute(context);
+            if (timer) timer->End(pass.name);
+        }
+
+        // Back to the pool as soon as the last pass is done with them, so whatever asks next, this
+        // frame or the next, gets them again
+        for (size_t i = 0; i < textures.size(); ++i) {
+            if (!textures[i] || spans[i].y != current) continue;
+            GetRenderTargetPool().ReleaseTransient(textures[i]);
+            textures[i] = nullptr;
+        }
+    }
+}
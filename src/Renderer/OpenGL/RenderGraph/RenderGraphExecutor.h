@@ -0,0 +1,66 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+#include "RenderGraph.h"
+#include "../Framebuffer/RenderTarget.h"
+#include "../Profiling/GpuTimer.h"
+
+class RenderGraphExecutor;
+
+// What a pass sees while it runs: the GL objects behind its declared resources
+class RenderGraphContext {
+    public:
+        Texture& GetTexture(RenderGraphResource resource);
+        Buffer& GetBuffer(RenderGraphResource resource);
+
+        // Binds a framebuffer with the pass's ColorAttachment writes as attachments 0.. in declaration
+        // order and its depth access as depth, and sets the viewport to the first attachment's size
+        void BindFramebuffer();
+
+        const std::string& GetPassName() const { return graph.GetPasses()[pass].name; }
+
+    private:
+        friend class RenderGraphExecutor;
+        RenderGraphContext(RenderGraphExecutor& executor, const RenderGraph& graph, uint32_t pass, size_t position)
+            : executor(executor), graph(graph), pass(pass), position(position) {}
+
+        RenderGraphExecutor& executor;
+        const RenderGraph& graph;
+        uint32_t pass;
+        size_t position;
+};
+
+// Runs a compiled RenderGraph: backs each transient texture with a transient from the render target
+// pool, taken just before the first pass that uses it and handed back right after the last one, keeps
+// transient buffers across frames, and issues each pass's glMemoryBarrier.
+class RenderGraphExecutor {
+    public:
+        RenderGraphExecutor() = default;
+        ~RenderGraphExecutor();
+
+        RenderGraphExecutor(const RenderGraphExecutor&) = delete;
+        RenderGraphExecutor& operator=(const RenderGraphExecutor&) = delete;
+
+        // Compiles `graph` and runs its passes in order
+        void Execute(RenderGraph& graph);
+
+        // Times every executed pass under its name; nullptr stops timing
+        void SetTimer(GpuTimer* timer) { this->timer = timer; }
+
+    private:
+        friend class RenderGraphContext;
+
+        void releaseTextures();
+
+        std::vector<RenderTargetAttachments*> textures;                     // per physical resource, while in use
+        std::vector<std::unique_ptr<Buffer>> buffers;                       // per physical resource
+        std::vector<GLuint> framebuffers;                                   // per execution position
+        GpuTimer* timer = nullptr;
+};
+
+inline std::unique_ptr<RenderGraphExecutor> CreateRenderGraphExecutor() {
+    return std::make_unique<RenderGraphExecutor>();
+}
@@ -4,11 +4,47 @@
 #include "Vertex/VertexArray.h"
 #include "Vertex/VertexFormat.h"
 #include "Texture/Texture.h"
+#include "Texture/TexturePacker.h"
+#include "Texture/TextureCompression.h"
+#include "Texture/TextureMips.h"
+#include "Texture/TextureLoader.h"
+#include "Texture/TextureCache.h"
+#include "Texture/Sampler.h"
+#include "VirtualTexture/TileCache.h"
+#include "VirtualTexture/VirtualTextureFile.h"
+#include "VirtualTexture/VirtualTexture.h"
 #include "Shader/Shader.h"
 #include "Shader/ShaderProgram.h"
+#include "Shader/ProgramCache.h"
+#include "Shader/ShaderCompiler.h"
+#include "Shader/ShaderPreprocessor.h"
+#include "Shader/ShaderVariants.h"
+#include "Shader/UniformReflection.h"
+#include "HotReload/FileWatcher.h"
+#include "HotReload/HotReload.h"
+#include "Lighting/Light.h"
+#include "Lighting/ClusterCulling.h"
+#include "Lighting/ClusteredLighting.h"
+#include "Lighting/SphericalHarmonics.h"
+#include "Lighting/EnvironmentLighting.h"
+#include "Deferred/GBuffer.h"
+#include "Deferred/DeferredShading.h"
+#include "DepthPrepass/DepthPrepass.h"
+#include "RenderGraph/RenderGraph.h"
+#include "RenderGraph/RenderGraphExecutor.h"
+#include "PostProcessing/PostProcessing.h"
+#include "PostProcessing/Bloom.h"
+#include "Profiling/GpuTimer.h"
+#include "DynamicResolution/DynamicResolution.h"
+#include "TemporalAA/TemporalAA.h"
+#include "Shadows/CascadedShadows.h"
+#include "AmbientOcclusion/AmbientOcclusion.h"
 #include "Model/Model.h"
 #include "Mesh/Mesh.h"
 #include "Material/Material.h"
+#include "Framebuffer/RenderTargetPool.h"
+#include "Framebuffer/RenderTarget.h"
 #include "Framebuffer/Framebuffer.h"
 #include "Camera/Camera.h"
-#include "Buffer/Buffer.h"
\ No newline at end of file
+#include "Buffer/Buffer.h"
+#include "Buffer/FrameUniforms.h"
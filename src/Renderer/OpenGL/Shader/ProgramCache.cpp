@@ -0,0 +1,140 @@
+#include "ProgramCache.h"
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <spdlog/spdlog.h>
+
+#include "Shader.h"
+#include "../../../Utils/AtomicFile.h"
+#include "../../../Utils/Hash.h"
+
+namespace {
+    struct ProgramBinaryHeader {
+        char magic[4] = {'P', 'B', 'I', 'N'};
+        uint32_t version = 1;
+        uint64_t key = 0;
+        uint32_t format = 0;
+        uint32_t size = 0;
+        double buildMilliseconds = 0.0;
+    };
+}
+
+ProgramBinaryCache::ProgramBinaryCache(const std::string& directory)
+    : directory(directory)
+{
+}
+
+bool ProgramBinaryCache::IsSupported() {
+    if (supported < 0) {
+        GLint formats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        supported = formats > 0 ? 1 : 0;
+        if (!supported) spdlog::info("Driver exposes no program binary formats; shaders are always compiled");
+    }
+    return enabled && supported == 1;
+}
+
+uint64_t ProgramBinaryCache::driverHash() {
+    if (driver == 0) {
+        for (GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION}) {
+            const char* text = reinterpret_cast<const char*>(glGetString(name));
+            driver = HashCombine(driver, text ? HashBytes(text, std::strlen(text)) : 0);
+        }
+    }
+    return driver;
+}
+
+uint64_t ProgramBinaryCache::MakeKey(const std::vector<const Shader*>& shaders) {
+    uint64_t key = driverHash();
+    for (const Shader* shader : shaders) {
+        key = HashCombine(key, shader->target);
+        key = HashCombine(key, HashString(shader->source));
+    }
+    return key;
+}
+
+std::string ProgramBinaryCache::pathFor(uint64_t key) const {
+    return (std::filesystem::path(directory) / (HashToString(key) + ".bin")).string();
+}
+
+bool ProgramBinaryCache::Load(GLuint program, uint64_t key) {
+    if (!IsSupported()) return false;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    const std::string path = pathFor(key);
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        ++stats.misses;
+        return false;
+    }
+
+    ProgramBinaryHeader header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+    std::vector<char> binary;
+    bool valid = file && std::memcmp(header.magic, "PBIN", 4) == 0 && header.version == 1 && header.key == key;
+    if (valid) {
+        binary.resize(header.size);
+        file.read(binary.data(), static_cast<std::streamsize>(binary.size()));
+        valid = static_cast<bool>(file);
+    }
+    file.close();
+
+    GLint linked = GL_FALSE;
+    if (valid) {
+        glProgramBinary(program, header.format, binary.data(), static_cast<GLsizei>(binary.size()));
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    }
+
+    if (linked != GL_TRUE) {
+        ++stats.rejected;
+        ++stats.misses;
+        std::error_code error;
+        std::filesystem::remove(path, error);
+        return false;
+    }
+
+    double milliseconds = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - start).count();
+    ++stats.hits;
+    stats.loadMilliseconds += milliseconds;
+    stats.savedMilliseconds += std::max(0.0, header.buildMilliseconds - milliseconds);
+    return true;
+}
+
+void ProgramBinaryCache::Store(GLuint program, uint64_t key, double buildMilliseconds) {
+    stats.buildMilliseconds += buildMilliseconds;
+    if (!IsSupported()) return;
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &length, &format, binary.data());
+
+    ProgramBinaryHeader header;
+    header.key = key;
+    header.format = format;
+    header.size = static_cast<uint32_t>(length);
+    header.buildMilliseconds = buildMilliseconds;
+
+    const std::string path = pathFor(key);
+    if (!WriteFileAtomic(path, {{&header, sizeof(header)}, {binary.data(), static_cast<size_t>(length)}})) {
+        spdlog::warn("Failed to write program binary {}", path);
+    }
+}
+
+void ProgramBinaryCache::LogStats() const {
+    spdlog::info("Program binary cache: {} hits ({:.1f} ms to load, ~{:.1f} ms saved), {} misses ({:.1f} ms to build), {} rejected",
+                 stats.hits, stats.loadMilliseconds, stats.savedMilliseconds,
+                 stats.misses, stats.buildMilliseconds, stats.rejected);
+}
+
+ProgramBinaryCache& GetProgramBinaryCache() {
+    static ProgramBinaryCache cache;
+    return cache;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+
+class Shader;
+
+// On-disk cache of linked program binaries. Entries are keyed by the stage and source text of every
+// attached shader plus the GL vendor, renderer and version strings, so a driver update or a source
+// edit simply misses. A binary the driver rejects is deleted and the program is compiled again.
+
+struct ProgramCacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t rejected = 0;                // binaries the driver refused, e.g. after an update
+    double loadMilliseconds = 0.0;      // time spent in glProgramBinary on hits
+    double buildMilliseconds = 0.0;     // compile + link time on misses
+    double savedMilliseconds = 0.0;     // recorded build time of every hit minus its load time
+};
+
+class ProgramBinaryCache {
+    public:
+        explicit ProgramBinaryCache(const std::string& directory = "ShaderCache");
+
+        uint64_t MakeKey(const std::vector<const Shader*>& shaders);
+
+        // Loads the cached binary for `key` into `program`; false if there is none or it was rejected.
+        bool Load(GLuint program, uint64_t key);
+        // Stores the binary of a freshly linked program along with how long it took to build;
+        // 0 when the build time is unknown, which then counts as nothing saved on later hits.
+        void Store(GLuint program, uint64_t key, double buildMilliseconds);
+
+        // False when the driver exposes no binary formats; every program is then compiled.
+        bool IsSupported();
+        void SetEnabled(bool value) { enabled = value; }
+
+        const ProgramCacheStats& GetStats() const { return stats; }
+        void LogStats() const;
+
+    private:
+        std::string pathFor(uint64_t key) const;
+        uint64_t driverHash();
+
+        std::string directory;
+        ProgramCacheStats stats;
+        uint64_t driver = 0;
+        int supported = -1;
+        bool enabled = true;
+};
+
+ProgramBinaryCache& GetProgramBinaryCache();
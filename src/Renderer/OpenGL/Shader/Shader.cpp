@@ -2,21 +2,44 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <stdexcept>
+#include <algorithm>
 
-Shader::Shader(ShaderStage shdaerType, const std::string &shaderSource) : target(
+Shader::Shader(ShaderStage shdaerType, const std::string &shaderSource, const ShaderDefines& defines) : stage(shdaerType), target(
     shdaerType == ShaderStage::Vertex ? GL_VERTEX_SHADER :
     shdaerType == ShaderStage::Fragment ? GL_FRAGMENT_SHADER :
     shdaerType == ShaderStage::TessEval ? GL_TESS_EVALUATION_SHADER :
     shdaerType == ShaderStage::TessControl ? GL_TESS_CONTROL_SHADER :
     shdaerType == ShaderStage::Geometry ? GL_GEOMETRY_SHADER :
     GL_COMPUTE_SHADER
-)
+),
+    path(shaderSource),
+    defines(defines)
 {
-    std::string shaderString = ReadFile(shaderSource);
-    const char* src = shaderString.c_str();
+    PreprocessedShader preprocessed = ShaderPreprocessor::Process(shaderSource, defines);
+    source = std::move(preprocessed.source);
+    files = std::move(preprocessed.files);
+}
+
+void Shader::Compile()
+{
+    BeginCompile();
+    FinishCompile();
+}
+
+void Shader::BeginCompile()
+{
+    if (id != 0) return;
+
+    const char* src = source.c_str();
     id = glCreateShader(target);
     glShaderSource(id, 1, &src, nullptr);
     glCompileShader(id);
+}
+
+void Shader::FinishCompile()
+{
+    if (id == 0 || compiled) return;
 
     GLint isCompiled = 0;
     glGetShaderiv(id, GL_COMPILE_STATUS, &isCompiled);
@@ -25,12 +48,14 @@ Shader::Shader(ShaderStage shdaerType, const std::string &shaderSource) : target
         GLint maxLength = 0;
         glGetShaderiv(id, GL_INFO_LOG_LENGTH, &maxLength);
 
-        std::vector<GLchar> errorLog(maxLength);
+        std::vector<GLchar> errorLog(std::max(maxLength, 1));
         glGetShaderInfoLog(id, maxLength, &maxLength, &errorLog[0]);
 
         glDeleteShader(id);
-        return;
+        id = 0;
+        throw std::runtime_error("Shader compilation failed (" + path + "):\n" + std::string(errorLog.data()));
     }
+    compiled = true;
 }
 
 Shader::~Shader()
@@ -42,17 +67,14 @@ Shader::~Shader()
 
 std::string Shader::ReadFile(const std::string& filepath)
 {
-    std::ifstream stream(filepath);
+    std::ifstream stream(filepath, std::ios::binary);
     if (!stream) {
         fprintf(stderr, "Could not open file: %s\n", filepath.c_str());
         return "";
     }
-    std::string line;
-    std::stringstream ss;
 
-    while (getline(stream, line))
-    {
-        ss << line << "\n";
-    }
+    // One read of the whole file instead of a getline per line
+    std::ostringstream ss;
+    ss << stream.rdbuf();
     return ss.str();
-}
\ No newline at end of file
+}
@@ -4,21 +4,40 @@
 #include <cstdint>
 #include <vector>
 #include <memory>
+#include "ShaderPreprocessor.h"
 
 enum class ShaderStage { Vertex, Fragment, Geometry, TessControl, TessEval, Compute };
 
 
 class Shader {
     public:
-        Shader(ShaderStage shaderType, const std::string &shaderSource);
+        // Reads and preprocesses the source (includes, injected defines); compilation is deferred until
+        // a program actually needs it, so programs restored from the binary cache never compile.
+        Shader(ShaderStage shaderType, const std::string &shaderSource, const ShaderDefines& defines = {});
         ~Shader();
 
         std::string ReadFile(const std::string& filepath);
 
-        uint32_t id;
+        // Compiles once; throws with the info log on failure.
+        void Compile();
+        // Split form of Compile() for ShaderCompiler: BeginCompile() only submits the source so the
+        // driver can compile in the background, FinishCompile() queries the status (and may block).
+        void BeginCompile();
+        void FinishCompile();
+        bool IsCompiled() const { return compiled; }
+
+        uint32_t id = 0;
+        const ShaderStage stage;
         const GLenum target;
+        std::string path;
+        std::string source;             // preprocessed
+        ShaderDefines defines;
+        std::vector<std::string> files;  // the shader and everything it includes
+
+    private:
+        bool compiled = false;
 };
 
-inline std::unique_ptr<Shader> CreateShader (ShaderStage shaderType, const std::string &shaderSource) {
-    return std::make_unique<Shader>(shaderType, shaderSource);
-}
\ No newline at end of file
+inline std::unique_ptr<Shader> CreateShader (ShaderStage shaderType, const std::string &shaderSource, const ShaderDefines& defines = {}) {
+    return std::make_unique<Shader>(shaderType, shaderSource, defines);
+}
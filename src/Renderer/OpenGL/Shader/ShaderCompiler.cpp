@@ -0,0 +1,115 @@
+#include "ShaderCompiler.h"
+#include <stdexcept>
+#include <SDL3/SDL.h>
+#include <spdlog/spdlog.h>
+
+using MaxShaderCompilerThreadsFunction = void (APIENTRYP)(GLuint count);
+
+bool ParallelShaderCompileSupported() {
+    static const bool supported = [] {
+        bool available = SDL_GL_ExtensionSupported("GL_KHR_parallel_shader_compile") ||
+                         SDL_GL_ExtensionSupported("GL_ARB_parallel_shader_compile");
+        if (!available) spdlog::info("Parallel shader compile is not supported; programs finish on the first poll");
+        return available;
+    }();
+    return supported;
+}
+
+ShaderCompiler::ShaderCompiler(unsigned int threads) {
+    if (!ParallelShaderCompileSupported()) return;
+
+    auto maxThreads = reinterpret_cast<MaxShaderCompilerThreadsFunction>(SDL_GL_GetProcAddress("glMaxShaderCompilerThreadsKHR"));
+    if (!maxThreads) {
+        maxThreads = reinterpret_cast<MaxShaderCompilerThreadsFunction>(SDL_GL_GetProcAddress("glMaxShaderCompilerThreadsARB"));
+    }
+    if (maxThreads) maxThreads(threads);
+
+    parallel = true;
+}
+
+ShaderCompiler::Handle ShaderCompiler::Submit(const StageList& stages, const ShaderDefines& defines) {
+    Job job;
+    for (const auto& [stage, path] : stages) {
+        job.shaders.push_back(CreateShader(stage, path, defines));
+        job.name += (job.name.empty() ? "" : " + ") + path;
+    }
+
+    std::vector<Shader*> shaders;
+    for (const auto& shader : job.shaders) shaders.push_back(shader.get());
+
+    job.program = std::make_unique<ShaderProgram>(shaders, ShaderProgram::DeferredLink{});
+
+    // Cache hits are finished already. Without the extension there is nothing to overlap, so the
+    // status query is left to the first Poll() to keep Submit() itself from blocking.
+    if (parallel && job.program->IsLinkComplete()) finish(job);
+
+    jobs.push_back(std::move(job));
+    return jobs.size() - 1;
+}
+
+void ShaderCompiler::finish(Job& job) {
+    try {
+        job.program->FinishLink();
+    } catch (const std::exception& e) {
+        job.error = e.what();
+        job.program.reset();
+        spdlog::error("Shader program {} failed: {}", job.name, job.error);
+    }
+    job.shaders.clear();
+    job.ready = true;
+}
+
+size_t ShaderCompiler::Poll() {
+    size_t finished = 0;
+    for (auto& job : jobs) {
+        if (job.ready || !job.program->IsLinkComplete()) continue;
+        finish(job);
+        ++finished;
+    }
+    return finished;
+}
+
+bool ShaderCompiler::IsReady(Handle handle) const {
+    return handle < jobs.size() && jobs[handle].ready;
+}
+
+bool ShaderCompiler::HasFailed(Handle handle) const {
+    return handle < jobs.size() && !jobs[handle].error.empty();
+}
+
+std::unique_ptr<ShaderProgram> ShaderCompiler::Take(Handle handle) {
+    if (!IsReady(handle)) return nullptr;
+
+    Job& job = jobs[handle];
+    if (job.taken) {
+        spdlog::warn("Shader program {} was already taken", job.name);
+        return nullptr;
+    }
+    job.taken = true;
+    return std::move(job.program);
+}
+
+std::unique_ptr<ShaderProgram> ShaderCompiler::Wait(Handle handle) {
+    if (handle >= jobs.size()) throw std::runtime_error("Invalid shader compiler handle");
+
+    Job& job = jobs[handle];
+    if (job.taken) throw std::runtime_error("Shader program " + job.name + " was already taken");
+    if (!job.ready) finish(job);
+    if (!job.error.empty()) throw std::runtime_error("Shader program " + job.name + " failed: " + job.error);
+    job.taken = true;
+    return std::move(job.program);
+}
+
+void ShaderCompiler::WaitAll() {
+    for (auto& job : jobs) {
+        if (!job.ready) finish(job);
+    }
+}
+
+size_t ShaderCompiler::GetPendingCount() const {
+    size_t pending = 0;
+    for (const auto& job : jobs) {
+        if (!job.ready) ++pending;
+    }
+    return pending;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <glad/glad.h>
+#include "Shader.h"
+#include "ShaderProgram.h"
+
+// KHR_parallel_shader_compile is not part of the core 4.6 glad loader
+#ifndef GL_MAX_SHADER_COMPILER_THREADS_KHR
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#endif
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+// True when KHR_ or ARB_parallel_shader_compile is available (checked once, needs a current context).
+bool ParallelShaderCompileSupported();
+
+// Submits every program up front and hands them out as the driver finishes them.
+//
+// Submit() reads the sources and issues compile and link without querying any status, so with
+// parallel shader compile the driver works on all of them on its own threads. Poll() checks
+// GL_COMPLETION_STATUS_KHR, which never blocks, and finalizes finished programs; call it once per
+// frame or between loading steps. Without the extension programs complete on the first Poll().
+// Programs restored from the binary cache are ready immediately.
+
+class ShaderCompiler {
+    public:
+        using Handle = size_t;
+        using StageList = std::vector<std::pair<ShaderStage, std::string>>;
+
+        // `threads` is passed to glMaxShaderCompilerThreadsKHR; 0xFFFFFFFF lets the driver decide.
+        explicit ShaderCompiler(unsigned int threads = 0xFFFFFFFFu);
+
+        // `defines` are injected into every stage.
+        Handle Submit(const StageList& stages, const ShaderDefines& defines = {});
+
+        // Finalizes every finished program; returns how many became ready.
+        size_t Poll();
+
+        bool IsReady(Handle handle) const;
+        // True when the program failed to compile or link; the error has been logged.
+        bool HasFailed(Handle handle) const;
+
+        // Returns the program once ready, nullptr before that or on failure. Each handle yields once;
+        // taking it again logs a warning and returns nullptr.
+        std::unique_ptr<ShaderProgram> Take(Handle handle);
+        // Blocks until the program is finished; throws if it failed, or if the handle is invalid or
+        // was already taken.
+        std::unique_ptr<ShaderProgram> Wait(Handle handle);
+        void WaitAll();
+
+        size_t GetPendingCount() const;
+        bool IsParallel() const { return parallel; }
+
+    private:
+        struct Job {
+            std::vector<std::unique_ptr<Shader>> shaders;
+            std::unique_ptr<ShaderProgram> program;
+            std::string name;
+            std::string error;
+            bool ready = false;
+            bool taken = false;         // the program has been handed out by Take() or Wait()
+        };
+
+        void finish(Job& job);
+
+        std::vector<Job> jobs;
+        bool parallel = false;
+};
+
+inline std::unique_ptr<ShaderCompiler> CreateShaderCompiler(unsigned int threads = 0xFFFFFFFFu) {
+    return std::make_unique<ShaderCompiler>(threads);
+}
@@ -0,0 +1,104 @@
+#include "ShaderPreprocessor.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+    std::string ReadText(const std::string& path) {
+        std::ifstream stream(path, std::ios::binary);
+        if (!stream) throw std::runtime_error("Could not open shader file: " + path);
+
+        std::ostringstream text;
+        text << stream.rdbuf();
+        return text.str();
+    }
+
+    std::string Normalize(const std::filesystem::path& path) {
+        return path.lexically_normal().generic_string();
+    }
+
+    // Returns the quoted file name of an `#include "..."` line, or an empty string.
+    std::string ParseInclude(const std::string& line) {
+        size_t position = line.find_first_not_of(" \t");
+        if (position == std::string::npos || line[position] != '#') return {};
+
+        position = line.find_first_not_of(" \t", position + 1);
+        if (position == std::string::npos || line.compare(position, 7, "include") != 0) return {};
+
+        size_t open = line.find('"', position + 7);
+        size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+        if (close == std::string::npos) {
+            throw std::runtime_error("Malformed #include: " + line);
+        }
+        return line.substr(open + 1, close - open - 1);
+    }
+
+    bool IsVersion(const std::string& line) {
+        size_t position = line.find_first_not_of(" \t");
+        return position != std::string::npos && line.compare(position, 8, "#version") == 0;
+    }
+
+    struct Expander {
+        PreprocessedShader& result;
+
+        int fileIndex(const std::string& path) {
+            auto it = std::find(result.files.begin(), result.files.end(), path);
+            if (it != result.files.end()) return static_cast<int>(it - result.files.begin());
+            result.files.push_back(path);
+            return static_cast<int>(result.files.size() - 1);
+        }
+
+        void expand(const std::string& text, const std::string& path, const ShaderDefines* defines) {
+            const int index = fileIndex(path);
+            const std::filesystem::path directory = std::filesystem::path(path).parent_path();
+
+            std::istringstream lines(text);
+            std::string line;
+            int lineNumber = 0;
+            while (std::getline(lines, line)) {
+                ++lineNumber;
+                if (!line.empty() && line.back() == '\r') line.pop_back();
+
+                if (defines && IsVersion(line)) {
+                    result.source += line + "\n";
+                    for (const auto& [name, value] : *defines) {
+                        result.source += "#define " + name + (value.empty() ? "" : " " + value) + "\n";
+                    }
+                    result.source += "#line " + std::to_string(lineNumber + 1) + " " + std::to_string(index) + "\n";
+                    continue;
+                }
+
+                std::string include = ParseInclude(line);
+                if (include.empty()) {
+                    result.source += line + "\n";
+                    continue;
+                }
+
+                const std::string includePath = Normalize(directory / include);
+                const bool seen = std::find(result.files.begin(), result.files.end(), includePath) != result.files.end();
+                if (!seen) {
+                    result.source += "#line 1 " + std::to_string(result.files.size()) + "\n";
+                    expand(ReadText(includePath), includePath, nullptr);
+                }
+                result.source += "#line " + std::to_string(lineNumber + 1) + " " + std::to_string(index) + "\n";
+            }
+        }
+    };
+}
+
+namespace ShaderPreprocessor {
+
+PreprocessedShader ProcessSource(const std::string& source, const std::string& path, const ShaderDefines& defines) {
+    PreprocessedShader result;
+    Expander expander{result};
+    expander.expand(source, Normalize(path), &defines);
+    return result;
+}
+
+PreprocessedShader Process(const std::string& path, const ShaderDefines& defines) {
+    return ProcessSource(ReadText(path), path, defines);
+}
+
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+// Minimal GLSL preprocessing done before the source reaches the driver:
+//   - `#include "file"` is resolved relative to the including file; every file is pasted at most
+//     once per shader, so shared headers need no guards and cycles are harmless. Missing files throw.
+//   - defines are injected right after `#version` as `#define NAME VALUE`.
+//   - `#line` directives keep driver error messages pointing at the original file and line; the
+//     source-string number is the file's index in `files`.
+
+using ShaderDefines = std::vector<std::pair<std::string, std::string>>;
+
+struct PreprocessedShader {
+    std::string source;
+    std::vector<std::string> files;     // the shader itself first, then every included file
+};
+
+namespace ShaderPreprocessor {
+    PreprocessedShader Process(const std::string& path, const ShaderDefines& defines = {});
+
+    // Same as Process(), for source that is already in memory; includes resolve relative to `path`.
+    PreprocessedShader ProcessSource(const std::string& source, const std::string& path,
+                                     const ShaderDefines& defines = {});
+}
@@ -1,43 +1,108 @@
 #include "ShaderProgram.h"
+#include "ProgramCache.h"
+#include "ShaderCompiler.h"
+#include <algorithm>
+#include <chrono>
 #include <iostream>
+#include <stdexcept>
+#include <utility>
 
-ShaderProgram::ShaderProgram(const std::vector<Shader*>& shaders) {
-    program = glCreateProgram();
+static std::vector<ShaderProgram*> programs;
+static ShaderProgram::LinkCallback linkCallback;
 
-    for (const auto& shader : shaders)
-        glAttachShader(program, shader->id);
+static void Unregister(ShaderProgram* program) {
+    programs.erase(std::remove(programs.begin(), programs.end(), program), programs.end());
+}
 
+ShaderProgram::ShaderProgram(const std::vector<Shader*>& shaders) {
+    beginLink(shaders);
+    try {
+        FinishLink();
+    } catch (...) {
+        // No destructor runs for a throwing constructor
+        Unregister(this);
+        throw;
+    }
+}
 
-    glLinkProgram(program);
+ShaderProgram::ShaderProgram(Shader& shader) : ShaderProgram(std::vector<Shader*>{&shader}) {
+}
 
-    GLint success;
-    glGetProgramiv(program, GL_LINK_STATUS, &success);
-    if (success == GL_FALSE) {
-        GLint logLength;
-        glGetProgramiv(program, GL_INFO_LOG_LENGTH, &logLength);
+ShaderProgram::ShaderProgram(const std::vector<Shader*>& shaders, DeferredLink) : deferred(true) {
+    beginLink(shaders);
+}
 
-        std::vector<GLchar> log(logLength);
-        glGetProgramInfoLog(program, logLength, nullptr, log.data());
+void ShaderProgram::beginLink(const std::vector<Shader*>& shaders) {
+    program = glCreateProgram();
+    programs.push_back(this);
 
-        glDeleteProgram(program);
-        throw std::runtime_error("Program linking failed:\n" + std::string(log.begin(), log.end()));
+    for (const auto& shader : shaders) {
+        sources.push_back({shader->stage, shader->path, shader->defines});
+        for (const auto& file : shader->files) {
+            if (std::find(dependencies.begin(), dependencies.end(), file) == dependencies.end()) {
+                dependencies.push_back(file);
+            }
+        }
     }
 
+    auto& cache = GetProgramBinaryCache();
+    cacheKey = cache.MakeKey(std::vector<const Shader*>(shaders.begin(), shaders.end()));
+    if (cache.Load(program, cacheKey)) {
+        if (linkCallback) linkCallback(*this);
+        return;
+    }
+
+    linkStart = std::chrono::high_resolution_clock::now();
+
+    // Nothing here queries status, so with KHR_parallel_shader_compile the driver compiles and links
+    // every stage in the background until FinishLink() or IsLinkComplete() asks.
     for (const auto& shader : shaders) {
-        glDetachShader(program, shader->id);
+        shader->BeginCompile();
+        glAttachShader(program, shader->id);
     }
+
+    glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glLinkProgram(program);
+
+    pendingShaders = shaders;
 }
 
-ShaderProgram::ShaderProgram(const Shader& shader) {
-    program = glCreateProgram();
+bool ShaderProgram::IsLinkComplete() const {
+    if (pendingShaders.empty()) return true;
+    if (!ParallelShaderCompileSupported()) return true;
 
-    glAttachShader(program, shader.id);
+    GLint complete = GL_FALSE;
+    glGetProgramiv(program, GL_COMPLETION_STATUS_KHR, &complete);
+    if (complete == GL_TRUE && !linkTimed) stopLinkClock();
+    return complete == GL_TRUE;
+}
 
-    glLinkProgram(program);
+void ShaderProgram::stopLinkClock() const {
+    linkMilliseconds = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - linkStart).count();
+    linkTimed = true;
+}
+
+void ShaderProgram::FinishLink() {
+    if (pendingShaders.empty()) return;
+
+    std::vector<Shader*> shaders;
+    shaders.swap(pendingShaders);
 
     GLint success;
     glGetProgramiv(program, GL_LINK_STATUS, &success);
     if (success == GL_FALSE) {
+        // A failed compile surfaces as a failed link; report the stage's own log when there is one.
+        for (const auto& shader : shaders) {
+            try {
+                shader->FinishCompile();
+            } catch (const std::exception&) {
+                glDeleteProgram(program);
+                program = 0;
+                throw;
+            }
+        }
+
         GLint logLength;
         glGetProgramiv(program, GL_INFO_LOG_LENGTH, &logLength);
 
@@ -45,23 +110,62 @@ ShaderProgram::ShaderProgram(const Shader& shader) {
         glGetProgramInfoLog(program, logLength, nullptr, log.data());
 
         glDeleteProgram(program);
+        program = 0;
         throw std::runtime_error("Program linking failed:\n" + std::string(log.begin(), log.end()));
     }
 
-    glDetachShader(program, shader.id);
+    for (const auto& shader : shaders) {
+        glDetachShader(program, shader->id);
+    }
+
+    // A deferred link only has a build time if a completion query saw it finish; otherwise the
+    // clock would also count whatever the caller did before waiting, so none is recorded.
+    if (!linkTimed && !deferred) stopLinkClock();
+    GetProgramBinaryCache().Store(program, cacheKey, linkMilliseconds);
+
+    if (linkCallback) linkCallback(*this);
 }
 
 ShaderProgram::~ShaderProgram() {
+    Unregister(this);
     if (program != 0) {
         glDeleteProgram(program);
     }
 }
 
+const std::vector<ShaderProgram*>& ShaderProgram::GetPrograms() {
+    return programs;
+}
+
+void ShaderProgram::SetLinkCallback(LinkCallback callback) {
+    linkCallback = std::move(callback);
+}
+
+void ShaderProgram::Rebuild() {
+    FinishLink();
+
+    std::vector<std::unique_ptr<Shader>> shaders;
+    std::vector<Shader*> stages;
+    for (const auto& source : sources) {
+        shaders.push_back(CreateShader(source.stage, source.path, source.defines));
+        stages.push_back(shaders.back().get());
+    }
+
+    ShaderProgram rebuilt(stages);
+    std::swap(program, rebuilt.program);
+    std::swap(dependencies, rebuilt.dependencies);
+}
+
 void ShaderProgram::SetUniform1i(const std::string& name, int value) {
     GLint loc = glGetUniformLocation(program, name.c_str());
     glProgramUniform1i(program, loc, value);
 }
 
+void ShaderProgram::SetUniform1ui(const std::string& name, unsigned int value) {
+    GLint loc = glGetUniformLocation(program, name.c_str());
+    glProgramUniform1ui(program, loc, value);
+}
+
 void ShaderProgram::SetUniform1f(const std::string& name, float value) {
     GLint loc = glGetUniformLocation(program, name.c_str());
     glProgramUniform1f(program, loc, value);
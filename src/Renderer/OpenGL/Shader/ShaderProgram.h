@@ -3,21 +3,54 @@
 #include "Shader.h"
 #include "glm/glm.hpp"
 #include "glm/gtc/type_ptr.hpp"
+#include <chrono>
 #include <cstdint>
+#include <functional>
 #include <vector>
 #include <memory>
 
 class ShaderProgram {
     public:
     ShaderProgram(const std::vector<Shader*>& shaders);
-    ShaderProgram(const Shader& shader);
+    ShaderProgram(Shader& shader);
+
+    // Submits compile and link without waiting; the shaders must stay alive until FinishLink().
+    struct DeferredLink {};
+    ShaderProgram(const std::vector<Shader*>& shaders, DeferredLink);
     ~ShaderProgram();
 
+    ShaderProgram(const ShaderProgram&) = delete;
+    ShaderProgram& operator=(const ShaderProgram&) = delete;
+
+    // True once the driver has finished a deferred link; never blocks. The first query that sees
+    // the link finish stops its build clock.
+    bool IsLinkComplete() const;
+    // Checks the link status (blocking if the driver is still busy), throws on failure and stores
+    // the binary in the program cache. No-op for programs that are already finished.
+    void FinishLink();
+
+    // Recompiles every stage from its file and swaps the new program in under the same object, so
+    // materials and other owners keep their pointers. Throws and leaves the current program
+    // untouched on failure. Uniforms set once outside Material::Bind must be set again afterwards.
+    void Rebuild();
+
+    // Files the stages were built from, includes included
+    const std::vector<std::string>& GetDependencies() const { return dependencies; }
+
+    // Every live program, for hot reload; maintained by the constructors and destructor
+    static const std::vector<ShaderProgram*>& GetPrograms();
+
+    // Called with every program once it is linked, whether restored from the binary cache, linked
+    // from source or rebuilt by hot reload, e.g. to check its block layouts. Empty to disable.
+    using LinkCallback = std::function<void(const ShaderProgram&)>;
+    static void SetLinkCallback(LinkCallback callback);
+
     void useShaderProgram() const { glUseProgram(program); }
 
     void DispatchCompute() { glDispatchCompute(groupsX, groupsY, groupsZ); };
 
     void SetUniform1i(const std::string& name, int value);
+    void SetUniform1ui(const std::string& name, unsigned int value);
     void SetUniform1f(const std::string& name, float value);
     void SetUniform2f(const std::string& name, float v0, float v1);
     void SetUniform3f(const std::string& name, float v0, float v1, float v2);
@@ -29,17 +62,37 @@ class ShaderProgram {
     void SetUniformMat4(const std::string& name, const glm::mat4& matrix);
 
 
-    uint32_t program;
+    uint32_t program = 0;
 
     GLuint groupsX = 0;
     GLuint groupsY = 0;
     GLuint groupsZ = 0;
+
+    private:
+    // Restores the program from the binary cache, or submits compile and link of the stages
+    void beginLink(const std::vector<Shader*>& shaders);
+    void stopLinkClock() const;
+
+    struct StageSource {
+        ShaderStage stage;
+        std::string path;
+        ShaderDefines defines;
+    };
+    std::vector<StageSource> sources;
+    std::vector<std::string> dependencies;
+
+    std::vector<Shader*> pendingShaders;
+    uint64_t cacheKey = 0;
+    std::chrono::high_resolution_clock::time_point linkStart;
+    bool deferred = false;
+    mutable bool linkTimed = false;
+    mutable double linkMilliseconds = 0.0;
 };
 
 inline std::unique_ptr<ShaderProgram> CreateShaderProgram(const std::vector<Shader*>& shaders) {
     return std::make_unique<ShaderProgram>(shaders);
 }
 
-inline std::unique_ptr<ShaderProgram> CreateShaderProgram(const Shader& shader) {
+inline std::unique_ptr<ShaderProgram> CreateShaderProgram(Shader& shader) {
     return std::make_unique<ShaderProgram>(shader);
 }
\ No newline at end of file
@@ -0,0 +1,57 @@
+#include "ShaderVariants.h"
+#include <algorithm>
+#include <stdexcept>
+#include <spdlog/spdlog.h>
+
+ShaderVariantCache::ShaderVariantCache(const ShaderCompiler::StageList& stages, const std::vector<std::string>& features,
+                                       const ShaderDefines& defines)
+    : stages(stages),
+      features(features),
+      defines(defines)
+{
+    if (features.size() > 32) {
+        throw std::runtime_error("Shader variants support at most 32 feature bits");
+    }
+}
+
+ShaderDefines ShaderVariantCache::GetDefines(uint32_t mask) const {
+    ShaderDefines result = defines;
+    for (size_t i = 0; i < features.size(); ++i) {
+        result.push_back({features[i], (mask >> i) & 1 ? "1" : "0"});
+    }
+    return result;
+}
+
+std::shared_ptr<ShaderProgram> ShaderVariantCache::Get(uint32_t mask) {
+    // Bits without a feature make no difference to the source; share one program for them
+    if (features.size() < 32) mask &= (1u << features.size()) - 1;
+
+    auto it = variants.find(mask);
+    if (it != variants.end()) {
+        return it->second;
+    }
+
+    Prewarm({mask});
+    return variants.at(mask);
+}
+
+void ShaderVariantCache::Prewarm(const std::vector<uint32_t>& featureSets) {
+    ShaderCompiler compiler;
+    std::vector<std::pair<uint32_t, ShaderCompiler::Handle>> handles;
+
+    for (uint32_t mask : featureSets) {
+        if (features.size() < 32) mask &= (1u << features.size()) - 1;
+        if (variants.count(mask)) continue;
+        if (std::any_of(handles.begin(), handles.end(), [&](const auto& handle) { return handle.first == mask; })) continue;
+        handles.push_back({mask, compiler.Submit(stages, GetDefines(mask))});
+    }
+
+    for (const auto& [mask, handle] : handles) {
+        variants[mask] = std::shared_ptr<ShaderProgram>(compiler.Wait(handle).release());
+    }
+
+    if (!handles.empty()) {
+        spdlog::info("Shader variants: built {}, {} cached for {}", handles.size(), variants.size(),
+                     stages.empty() ? std::string("<none>") : stages.back().second);
+    }
+}
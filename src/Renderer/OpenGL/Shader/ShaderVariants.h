@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ShaderCompiler.h"
+#include "ShaderProgram.h"
+#include "ShaderPreprocessor.h"
+
+// Permutations of one program specialized on a set of feature bits. Bit i of a feature mask turns
+// into `#define <features[i]> 1` (or 0), so a shader can replace runtime feature uniforms with
+// constants and let the compiler drop the dead branches. Every variant is compiled once and shared;
+// the program binary cache makes later launches skip compilation entirely.
+
+class ShaderVariantCache {
+    public:
+        ShaderVariantCache(const ShaderCompiler::StageList& stages, const std::vector<std::string>& features,
+                           const ShaderDefines& defines = {});
+
+        // Returns the variant for `features`, compiling it on first use. Bits past the feature list
+        // are ignored, so a cache without features serves every mask with one program.
+        std::shared_ptr<ShaderProgram> Get(uint32_t features);
+
+        // Compiles every missing variant in `featureSets` at once through a ShaderCompiler.
+        void Prewarm(const std::vector<uint32_t>& featureSets);
+
+        ShaderDefines GetDefines(uint32_t features) const;
+        size_t GetVariantCount() const { return variants.size(); }
+
+    private:
+        ShaderCompiler::StageList stages;
+        std::vector<std::string> features;
+        ShaderDefines defines;
+        std::unordered_map<uint32_t, std::shared_ptr<ShaderProgram>> variants;
+};
+
+inline std::shared_ptr<ShaderVariantCache> CreateShaderVariantCache(const ShaderCompiler::StageList& stages,
+                                                                    const std::vector<std::string>& features,
+                                                                    const ShaderDefines& defines = {}) {
+    return std::make_shared<ShaderVariantCache>(stages, features, defines);
+}
@@ -0,0 +1,137 @@
+#include "UniformReflection.h"
+#include <algorithm>
+
+const UniformBlockMember* UniformBlockLayout::Find(const std::string& member) const {
+    auto it = std::find_if(members.begin(), members.end(),
+                           [&](const UniformBlockMember& entry) { return entry.name == member; });
+    return it == members.end() ? nullptr : &*it;
+}
+
+namespace {
+    std::string GetResourceName(GLuint program, GLenum interface, GLuint index) {
+        GLenum property = GL_NAME_LENGTH;
+        GLint length = 0;
+        glGetProgramResourceiv(program, interface, index, 1, &property, 1, nullptr, &length);
+
+        std::string name(std::max(length, 1), '\0');
+        glGetProgramResourceName(program, interface, index, length, nullptr, name.data());
+        name.resize(std::max(length - 1, 0));
+        return name;
+    }
+
+    // "Block.member[0]" -> "member"
+    std::string StripName(std::string name, const std::string& block) {
+        if (name.compare(0, block.size() + 1, block + ".") == 0) name.erase(0, block.size() + 1);
+        if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0) name.resize(name.size() - 3);
+        return name;
+    }
+
+    // Columns and rows of a uniform type; scalars are 1x1
+    void GetShape(GLenum type, int& columns, int& rows) {
+        columns = 1;
+        rows = 1;
+        switch (type) {
+            case GL_FLOAT_VEC2: case GL_INT_VEC2: case GL_UNSIGNED_INT_VEC2: case GL_BOOL_VEC2: rows = 2; break;
+            case GL_FLOAT_VEC3: case GL_INT_VEC3: case GL_UNSIGNED_INT_VEC3: case GL_BOOL_VEC3: rows = 3; break;
+            case GL_FLOAT_VEC4: case GL_INT_VEC4: case GL_UNSIGNED_INT_VEC4: case GL_BOOL_VEC4: rows = 4; break;
+            case GL_FLOAT_MAT2: columns = 2; rows = 2; break;
+            case GL_FLOAT_MAT3: columns = 3; rows = 3; break;
+            case GL_FLOAT_MAT4: columns = 4; rows = 4; break;
+            case GL_FLOAT_MAT2x3: columns = 2; rows = 3; break;
+            case GL_FLOAT_MAT2x4: columns = 2; rows = 4; break;
+            case GL_FLOAT_MAT3x2: columns = 3; rows = 2; break;
+            case GL_FLOAT_MAT3x4: columns = 3; rows = 4; break;
+            case GL_FLOAT_MAT4x2: columns = 4; rows = 2; break;
+            case GL_FLOAT_MAT4x3: columns = 4; rows = 3; break;
+            default: break;
+        }
+    }
+}
+
+namespace UniformReflection {
+
+std::vector<UniformBlockLayout> ReflectBlocks(GLuint program) {
+    std::vector<UniformBlockLayout> blocks;
+
+    GLint blockCount = 0;
+    glGetProgramInterfaceiv(program, GL_UNIFORM_BLOCK, GL_ACTIVE_RESOURCES, &blockCount);
+
+    for (GLint blockIndex = 0; blockIndex < blockCount; ++blockIndex) {
+        UniformBlockLayout block;
+        block.name = GetResourceName(program, GL_UNIFORM_BLOCK, blockIndex);
+
+        const GLenum blockProperties[] = {GL_BUFFER_BINDING, GL_BUFFER_DATA_SIZE, GL_NUM_ACTIVE_VARIABLES};
+        GLint blockValues[3] = {};
+        glGetProgramResourceiv(program, GL_UNIFORM_BLOCK, blockIndex, 3, blockProperties, 3, nullptr, blockValues);
+        block.binding = static_cast<GLuint>(blockValues[0]);
+        block.dataSize = blockValues[1];
+
+        std::vector<GLint> indices(blockValues[2]);
+        if (!indices.empty()) {
+            const GLenum property = GL_ACTIVE_VARIABLES;
+            glGetProgramResourceiv(program, GL_UNIFORM_BLOCK, blockIndex, 1, &property,
+                                   static_cast<GLsizei>(indices.size()), nullptr, indices.data());
+        }
+
+        for (GLint index : indices) {
+            const GLenum properties[] = {GL_TYPE, GL_OFFSET, GL_ARRAY_SIZE, GL_ARRAY_STRIDE, GL_MATRIX_STRIDE};
+            GLint values[5] = {};
+            glGetProgramResourceiv(program, GL_UNIFORM, index, 5, properties, 5, nullptr, values);
+
+            UniformBlockMember member;
+            member.name = StripName(GetResourceName(program, GL_UNIFORM, index), block.name);
+            member.type = static_cast<GLenum>(values[0]);
+            member.offset = values[1];
+            member.arraySize = values[2];
+            member.arrayStride = values[3];
+            member.matrixStride = values[4];
+            block.members.push_back(member);
+        }
+
+        std::sort(block.members.begin(), block.members.end(),
+                  [](const UniformBlockMember& a, const UniformBlockMember& b) { return a.offset < b.offset; });
+        blocks.push_back(std::move(block));
+    }
+    return blocks;
+}
+
+size_t GetMemberSize(const UniformBlockMember& member) {
+    int columns, rows;
+    GetShape(member.type, columns, rows);
+
+    size_t element = columns > 1 ? static_cast<size_t>(columns * member.matrixStride) : rows * 4u;
+    if (member.arraySize > 1) {
+        return static_cast<size_t>(member.arrayStride) * (member.arraySize - 1) + element;
+    }
+    return element;
+}
+
+std::vector<std::string> Compare(const UniformBlockLayout& layout, const UniformField* fields, size_t count,
+                                 size_t size) {
+    std::vector<std::string> errors;
+
+    for (const auto& member : layout.members) {
+        const UniformField* field = std::find_if(fields, fields + count,
+                                                 [&](const UniformField& entry) { return member.name == entry.name; });
+        if (field == fields + count) {
+            errors.push_back(layout.name + "." + member.name + " has no C++ counterpart");
+            continue;
+        }
+        if (static_cast<size_t>(member.offset) != field->offset) {
+            errors.push_back(layout.name + "." + member.name + " is at offset " + std::to_string(member.offset) +
+                             " in the shader but " + std::to_string(field->offset) + " in C++");
+        }
+        if (GetMemberSize(member) > field->size) {
+            errors.push_back(layout.name + "." + member.name + " needs " + std::to_string(GetMemberSize(member)) +
+                             " bytes but the C++ field has " + std::to_string(field->size));
+        }
+    }
+
+    if (static_cast<size_t>(layout.dataSize) > size) {
+        errors.push_back(layout.name + " is " + std::to_string(layout.dataSize) + " bytes in the shader but " +
+                         std::to_string(size) + " in C++");
+    }
+    return errors;
+}
+
+}
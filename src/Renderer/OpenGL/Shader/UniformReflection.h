@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "glad/glad.h"
+
+// Reads the std140/std430 layout the driver assigned to a linked program's uniform blocks, so C++
+// mirrors of those blocks can be checked against what the shader actually declares.
+
+struct UniformBlockMember {
+    std::string name;               // without the block instance prefix
+    GLenum type = 0;
+    GLint offset = 0;
+    GLint arraySize = 1;
+    GLint arrayStride = 0;
+    GLint matrixStride = 0;
+};
+
+struct UniformBlockLayout {
+    std::string name;
+    GLuint binding = 0;
+    GLint dataSize = 0;
+    std::vector<UniformBlockMember> members;   // sorted by offset
+
+    const UniformBlockMember* Find(const std::string& member) const;
+};
+
+// One member of a C++ block mirror, see FRAME_DATA_FIELD in Buffer/FrameUniforms.h
+struct UniformField {
+    const char* name;
+    size_t offset;
+    size_t size;
+};
+
+namespace UniformReflection {
+    std::vector<UniformBlockLayout> ReflectBlocks(GLuint program);
+
+    // Bytes a member of `type` occupies in a block, matrices padded to their stride
+    size_t GetMemberSize(const UniformBlockMember& member);
+
+    // Describes every difference between a reflected block and its C++ mirror; empty when the
+    // mirror can be uploaded as is. Members the shader optimized away are not an error.
+    std::vector<std::string> Compare(const UniformBlockLayout& layout, const UniformField* fields, size_t count,
+                                     size_t size);
+}
@@ -0,0 +1,70 @@
+#include "CascadeMath.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace CascadeMath {
+    std::vector<float> ComputeSplits(float nearClip, float farClip, int count, float lambda) {
+        if (count < 1 || nearClip <= 0.0f || farClip <= nearClip) {
+            throw std::runtime_error("Invalid cascade split range");
+        }
+
+        std::vector<float> splits(count + 1);
+        for (int i = 0; i <= count; ++i) {
+            const float t = static_cast<float>(i) / static_cast<float>(count);
+            const float logarithmic = nearClip * std::pow(farClip / nearClip, t);
+            const float uniform = nearClip + (farClip - nearClip) * t;
+            splits[i] = lambda * logarithmic + (1.0f - lambda) * uniform;
+        }
+        // Exact ends, whatever rounding did to them
+        splits.front() = nearClip;
+        splits.back() = farClip;
+        return splits;
+    }
+
+    Sphere FitSlice(const glm::mat4& inverseView, float fovY, float aspect, float sliceNear, float sliceFar) {
+        // A corner at view distance d is d * k off the axis. The centre sits on the axis at the
+        // distance equidistant from the near and far corners, or at the far plane if that is closer.
+        const float tanHalf = std::tan(fovY * 0.5f);
+        const float k2 = tanHalf * tanHalf * (1.0f + aspect * aspect);
+        const float centerDistance = std::min(0.5f * (sliceNear + sliceFar) * (1.0f + k2), sliceFar);
+        const float farOffset = sliceFar - centerDistance;
+        float radius = std::sqrt(farOffset * farOffset + sliceFar * sliceFar * k2);
+
+        // Rounded up so float noise cannot change the texel size from frame to frame
+        radius = std::ceil(radius * 16.0f) / 16.0f;
+
+        Sphere sphere;
+        sphere.center = glm::vec3(inverseView * glm::vec4(0.0f, 0.0f, -centerDistance, 1.0f));
+        sphere.radius = radius;
+        return sphere;
+    }
+
+    glm::mat4 GetLightRotation(const glm::vec3& lightDirection) {
+        const glm::vec3 direction = glm::normalize(lightDirection);
+        const glm::vec3 up = std::abs(direction.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+        return glm::lookAt(glm::vec3(0.0f), direction, up);
+    }
+
+    glm::vec3 SnapToTexel(const glm::vec3& center, const glm::mat4& lightRotation, float radius, int resolution) {
+        const float texel = 2.0f * radius / static_cast<float>(resolution);
+        glm::vec3 lightSpace = glm::vec3(lightRotation * glm::vec4(center, 1.0f));
+        lightSpace.x = std::floor(lightSpace.x / texel) * texel;
+        lightSpace.y = std::floor(lightSpace.y / texel) * texel;
+        return glm::vec3(glm::inverse(lightRotation) * glm::vec4(lightSpace, 1.0f));
+    }
+
+    glm::mat4 GetViewProjection(const Sphere& sphere, const glm::mat4& lightRotation, float depthExtent) {
+        const glm::vec3 lightSpace = glm::vec3(lightRotation * glm::vec4(sphere.center, 1.0f));
+        // Light space looks down -z, so the near plane is at -(z + extent)
+        const glm::mat4 projection = glm::ortho(lightSpace.x - sphere.radius, lightSpace.x + sphere.radius,
+                                                lightSpace.y - sphere.radius, lightSpace.y + sphere.radius,
+                                                -lightSpace.z - depthExtent, -lightSpace.z + depthExtent);
+        return projection * lightRotation;
+    }
+
+    bool Contains(const Sphere& outer, const Sphere& inner) {
+        return glm::length(inner.center - outer.center) + inner.radius <= outer.radius;
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+
+// Cascade placement for directional shadow maps, free of GL so it can be checked on its own.
+// Cascades are spheres around slices of the view frustum: a sphere's size does not change as the
+// camera turns, and with its centre snapped to whole shadow texels in light space, shadow edges do
+// not crawl as the camera moves.
+namespace CascadeMath {
+    struct Sphere {
+        glm::vec3 center{0.0f};
+        float radius = 0.0f;
+    };
+
+    // `count` + 1 view distances from `nearClip` to `farClip`: `lambda` 0 splits uniformly, 1
+    // logarithmically (equal texel density in screen space), in between blends the two
+    std::vector<float> ComputeSplits(float nearClip, float farClip, int count, float lambda);
+
+    // Smallest sphere around the frustum slice between view distances `sliceNear` and `sliceFar`,
+    // in world space. `fovY` in radians; depends only on the camera's position and forward axis.
+    Sphere FitSlice(const glm::mat4& inverseView, float fovY, float aspect, float sliceNear, float sliceFar);
+
+    // Rotation into light space, looking along `lightDirection`
+    glm::mat4 GetLightRotation(const glm::vec3& lightDirection);
+
+    // Moves `center` to the nearest multiple of a texel in light-space x and y
+    glm::vec3 SnapToTexel(const glm::vec3& center, const glm::mat4& lightRotation, float radius, int resolution);
+
+    // Orthographic light view-projection covering `sphere`; depth spans `depthExtent` either side of
+    // the centre along the light
+    glm::mat4 GetViewProjection(const Sphere& sphere, const glm::mat4& lightRotation, float depthExtent);
+
+    // True if `inner` lies entirely within `outer`
+    bool Contains(const Sphere& outer, const Sphere& inner);
+}
@@ -0,0 +1,286 @@
+#include "CascadedShadows.h"
+#include "../Camera/Camera.h"
+#include "../../../Utils/Hash.h"
+#include <algorithm>
+#include <bitset>
+#include <cmath>
+#include <stdexcept>
+#include <SDL3/SDL.h>
+#include <spdlog/spdlog.h>
+
+namespace {
+    int CountBits(uint32_t mask) {
+        return static_cast<int>(std::bitset<32>(mask).count());
+    }
+}
+
+CascadedShadows::CascadedShadows(const CascadedShadowSettings& settings)
+    : settings(settings),
+      cascadeCount(std::clamp(settings.cascadeCount, 1, 4)),
+      resolution(std::max(settings.resolution, 16))
+{
+    vertexLayer = SDL_GL_ExtensionSupported("GL_ARB_shader_viewport_layer_array");
+
+    shadowMap = CreateEmptyTexture(resolution, resolution, cascadeCount, TextureType::Tex2DArray,
+                                   TextureInternalFormat::Depth32F, 0, TextureFilter::Linear, TextureFilter::Linear,
+                                   TextureWrap::ClampToEdge, TextureWrap::ClampToEdge, TextureWrap::ClampToEdge);
+    const int cachedLayers = cascadeCount - std::clamp(settings.firstCachedCascade, 0, cascadeCount);
+    if (cachedLayers > 0) {
+        staticCache = CreateEmptyTexture(resolution, resolution, cachedLayers, TextureType::Tex2DArray,
+                                         TextureInternalFormat::Depth32F, 0, TextureFilter::Nearest, TextureFilter::Nearest,
+                                         TextureWrap::ClampToEdge, TextureWrap::ClampToEdge, TextureWrap::ClampToEdge);
+    }
+
+    SamplerDesc samplerDesc = shadowMap->GetSamplerDesc();
+    samplerDesc.depthCompare = true;
+    compareSampler = GetSamplerCache().Get(samplerDesc);
+
+    dataBuffer = CreateBuffer(BufferType::Uniform, sizeof(ShadowData), &data, BufferUsage::Dynamic, ShadowData::Binding);
+
+    ShaderDefines defines;
+    if (vertexLayer) defines.push_back({"SHADOW_VERTEX_LAYER", "1"});
+    auto vertex = CreateShader(ShaderStage::Vertex, "Shader/shadow.vert.glsl", defines);
+    program = CreateShaderProgram({vertex.get()});
+
+    glCreateFramebuffers(1, &framebuffer);
+    glNamedFramebufferDrawBuffer(framebuffer, GL_NONE);
+    glNamedFramebufferReadBuffer(framebuffer, GL_NONE);
+    if (vertexLayer) {
+        glNamedFramebufferTexture(framebuffer, GL_DEPTH_ATTACHMENT, shadowMap->id, 0);
+    } else {
+        glNamedFramebufferTextureLayer(framebuffer, GL_DEPTH_ATTACHMENT, shadowMap->id, 0, 0);
+    }
+    if (glCheckNamedFramebufferStatus(framebuffer, GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        glDeleteFramebuffers(1, &framebuffer);
+        throw std::runtime_error("Shadow map framebuffer is incomplete");
+    }
+
+    spdlog::info("Cascaded shadows: {} x {}^2, {} cached, {}", cascadeCount, resolution, cachedLayers,
+                 vertexLayer ? "one layered pass" : "one pass per cascade");
+}
+
+CascadedShadows::~CascadedShadows() {
+    if (framebuffer) glDeleteFramebuffers(1, &framebuffer);
+}
+
+void CascadedShadows::Invalidate() {
+    for (auto& cascade : cached) cascade.valid = false;
+}
+
+void CascadedShadows::fitCascades(const Camera& camera, const glm::vec3& lightDirection) {
+    const float nearClip = camera.GetNearClip();
+    const float farClip = std::max(std::min(camera.GetFarClip(), settings.maxDistance), nearClip * 2.0f);
+    const std::vector<float> splits = CascadeMath::ComputeSplits(nearClip, farClip, cascadeCount, settings.splitLambda);
+
+    const glm::vec3 direction = glm::normalize(lightDirection);
+    lightRotation = CascadeMath::GetLightRotation(direction);
+    const glm::mat4 inverseView = glm::inverse(camera.GetViewMatrix());
+    const float fovY = glm::radians(camera.GetFOV());
+    const int firstCached = std::clamp(settings.firstCachedCascade, 0, cascadeCount);
+
+    for (int c = 0; c < cascadeCount; ++c) {
+        CascadeMath::Sphere sphere =
+            CascadeMath::FitSlice(inverseView, fovY, camera.GetAspectRatio(), splits[c], splits[c + 1]);
+        // Snapping moves the centre by up to a texel diagonal; grow the sphere to cover it
+        sphere.radius *= 1.0f + 3.0f / static_cast<float>(resolution);
+
+        if (c >= firstCached) {
+            // Sticky fit: keep the cached sphere while it still holds the slice and is not far too big
+            CachedCascade& cache = cached[c];
+            const bool refit = !cache.valid || cache.lightDirection != direction ||
+                               !CascadeMath::Contains(cache.sphere, sphere) ||
+                               cache.sphere.radius > sphere.radius * (1.0f + 2.0f * settings.cacheMargin);
+            if (refit) {
+                sphere.radius = std::ceil(sphere.radius * (1.0f + settings.cacheMargin) * 16.0f) / 16.0f;
+                sphere.center = CascadeMath::SnapToTexel(sphere.center, lightRotation, sphere.radius, resolution);
+                cache.sphere = sphere;
+                cache.lightDirection = direction;
+                cache.valid = false;
+            }
+            sphere = cache.sphere;
+        } else {
+            sphere.center = CascadeMath::SnapToTexel(sphere.center, lightRotation, sphere.radius, resolution);
+        }
+
+        spheres[c] = sphere;
+        // Casters in front of the near plane are clamped onto it by GL_DEPTH_CLAMP, so the depth range
+        // only has to span the receivers
+        data.cascadeViewProjection[c] = CascadeMath::GetViewProjection(sphere, lightRotation, 2.0f * sphere.radius);
+        data.cascadeSplits[c] = splits[c + 1];
+        data.cascadeTexelSize[c] = 2.0f * sphere.radius / static_cast<float>(resolution);
+    }
+}
+
+uint32_t CascadedShadows::getCascadeMask(const MeshDrawItem& item, uint32_t cascades) const {
+    const glm::vec3 center = item.mesh->GetBoundingBoxCenter();
+    const glm::vec3 extent = item.mesh->GetBoundingBoxSize() * 0.5f;
+
+    uint32_t mask = 0;
+    for (int c = 0; c < cascadeCount; ++c) {
+        if (!(cascades & (1u << c))) continue;
+
+        // Light clip space is affine, so the box maps to a box around the transformed centre
+        const glm::mat4 m = data.cascadeViewProjection[c] * item.transform;
+        const glm::vec3 clipCenter = glm::vec3(m * glm::vec4(center, 1.0f));
+        const glm::vec3 clipExtent = glm::abs(glm::vec3(m[0])) * extent.x + glm::abs(glm::vec3(m[1])) * extent.y +
+                                     glm::abs(glm::vec3(m[2])) * extent.z;
+        const glm::vec3 lo = clipCenter - clipExtent;
+        const glm::vec3 hi = clipCenter + clipExtent;
+
+        // Nothing in front of the near plane is culled: it is pancaked and still casts
+        if (hi.x < -1.0f || lo.x > 1.0f || hi.y < -1.0f || lo.y > 1.0f || lo.z > 1.0f) continue;
+        mask |= 1u << c;
+    }
+    return mask;
+}
+
+void CascadedShadows::clearLayer(GLuint texture, int layer) {
+    const float one = 1.0f;
+    glClearTexSubImage(texture, 0, 0, 0, layer, resolution, resolution, 1, GL_DEPTH_COMPONENT, GL_FLOAT, &one);
+}
+
+void CascadedShadows::drawCasters(GLuint texture, int layerBase, const std::vector<Caster>& drawn) {
+    if (drawn.empty()) return;
+
+    program->useShaderProgram();
+    program->SetUniform1i("u_layerBase", layerBase);
+
+    if (vertexLayer) {
+        glNamedFramebufferTexture(framebuffer, GL_DEPTH_ATTACHMENT, texture, 0);
+        for (const Caster& caster : drawn) {
+            program->SetUniformMat4("u_modelMatrix", caster.item->transform);
+            program->SetUniform1ui("u_layerMask", caster.mask);
+            caster.item->mesh->DrawPositions(CountBits(caster.mask));
+        }
+        return;
+    }
+
+    uint32_t cascades = 0;
+    for (const Caster& caster : drawn) cascades |= caster.mask;
+
+    for (int c = 0; c < cascadeCount; ++c) {
+        if (!(cascades & (1u << c))) continue;
+
+        glNamedFramebufferTextureLayer(framebuffer, GL_DEPTH_ATTACHMENT, texture, 0, c - layerBase);
+        program->SetUniform1ui("u_layerMask", 1u << c);
+        for (const Caster& caster : drawn) {
+            if (!(caster.mask & (1u << c))) continue;
+            program->SetUniformMat4("u_modelMatrix", caster.item->transform);
+            caster.item->mesh->DrawPositions();
+        }
+    }
+}
+
+void CascadedShadows::Render(const std::vector<MeshDrawItem>& items, const Camera& camera,
+                             const glm::vec3& lightDirection) {
+    renderedCascades = 0;
+    if (!settings.enabled) {
+        data.params = glm::vec4(0.0f);
+        dataBuffer->UpdateBuffer(&data, sizeof(ShadowData));
+        return;
+    }
+
+    fitCascades(camera, lightDirection);
+    data.params = glm::vec4(static_cast<float>(cascadeCount), settings.normalOffset, settings.depthBias, 0.0f);
+    glBindBufferBase(GL_UNIFORM_BUFFER, ShadowData::Binding, dataBuffer->id);
+    dataBuffer->UpdateBuffer(&data, sizeof(ShadowData));
+
+    const int firstCached = std::clamp(settings.firstCachedCascade, 0, cascadeCount);
+    const uint32_t allMask = (1u << cascadeCount) - 1u;
+    const uint32_t liveMask = (1u << firstCached) - 1u;
+    const uint32_t cachedMask = allMask & ~liveMask;
+
+    // Sort casters into those drawn every frame and the static ones behind the cached cascades,
+    // hashing the latter per cascade to notice added, removed or moved static geometry
+    casters.clear();
+    staticCasters.clear();
+    std::array<uint64_t, 4> contentHashes;
+    contentHashes.fill(0);
+    uint32_t dynamicMask = 0;
+
+    for (const MeshDrawItem& item : items) {
+        const uint32_t mask = getCascadeMask(item, allMask);
+        if (!mask) continue;
+
+        if (item.dynamic) {
+            dynamicMask |= mask & cachedMask;
+            casters.push_back({&item, mask});
+            continue;
+        }
+        if (mask & liveMask) casters.push_back({&item, mask & liveMask});
+        if (mask & cachedMask) {
+            staticCasters.push_back({&item, mask & cachedMask});
+            for (int c = firstCached; c < cascadeCount; ++c) {
+                if (!(mask & (1u << c))) continue;
+                contentHashes[c] = HashCombine(contentHashes[c], HashBytes(&item.mesh, sizeof(item.mesh)));
+                contentHashes[c] = HashCombine(contentHashes[c], HashBytes(&item.transform, sizeof(item.transform)));
+            }
+        }
+    }
+
+    uint32_t staleMask = 0;
+    for (int c = firstCached; c < cascadeCount; ++c) {
+        if (!cached[c].valid || cached[c].contentHash != contentHashes[c]) staleMask |= 1u << c;
+    }
+
+    GLint depthFunc;
+    GLboolean depthMask;
+    glGetIntegerv(GL_DEPTH_FUNC, &depthFunc);
+    glGetBooleanv(GL_DEPTH_WRITEMASK, &depthMask);
+    const GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+    const GLboolean depthClamp = glIsEnabled(GL_DEPTH_CLAMP);
+    const GLboolean polygonOffset = glIsEnabled(GL_POLYGON_OFFSET_FILL);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glViewport(0, 0, resolution, resolution);
+    glEnable(GL_DEPTH_TEST);
+    glDepthMask(GL_TRUE);
+    glDepthFunc(GL_LESS);
+    glEnable(GL_DEPTH_CLAMP);
+    glEnable(GL_POLYGON_OFFSET_FILL);
+    glPolygonOffset(settings.slopeBias, settings.constantBias);
+
+    // Stale static copies first, only with the casters they need
+    if (staleMask) {
+        std::vector<Caster> stale;
+        for (const Caster& caster : staticCasters) {
+            if (caster.mask & staleMask) stale.push_back({caster.item, caster.mask & staleMask});
+        }
+        for (int c = firstCached; c < cascadeCount; ++c) {
+            if (!(staleMask & (1u << c))) continue;
+            clearLayer(staticCache->id, c - firstCached);
+            cached[c].valid = true;
+            cached[c].contentHash = contentHashes[c];
+        }
+        drawCasters(staticCache->id, firstCached, stale);
+    }
+
+    // A cached layer is refreshed from its static copy when that changed or moving casters were drawn
+    // over it; untouched it keeps last frame's depth
+    for (int c = firstCached; c < cascadeCount; ++c) {
+        const uint32_t bit = 1u << c;
+        if ((staleMask & bit) || (dynamicMask & bit) || cached[c].hadDynamic) {
+            glCopyImageSubData(staticCache->id, GL_TEXTURE_2D_ARRAY, 0, 0, 0, c - firstCached,
+                               shadowMap->id, GL_TEXTURE_2D_ARRAY, 0, 0, 0, c, resolution, resolution, 1);
+        }
+        cached[c].hadDynamic = (dynamicMask & bit) != 0;
+    }
+
+    for (int c = 0; c < firstCached; ++c) clearLayer(shadowMap->id, c);
+    drawCasters(shadowMap->id, 0, casters);
+
+    renderedCascades = CountBits(liveMask) + CountBits(staleMask | dynamicMask);
+
+    glDisable(GL_POLYGON_OFFSET_FILL);
+    if (polygonOffset) glEnable(GL_POLYGON_OFFSET_FILL);
+    if (!depthClamp) glDisable(GL_DEPTH_CLAMP);
+    if (!depthTest) glDisable(GL_DEPTH_TEST);
+    glDepthFunc(depthFunc);
+    glDepthMask(depthMask);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void CascadedShadows::Bind() const {
+    glBindBufferBase(GL_UNIFORM_BUFFER, ShadowData::Binding, dataBuffer->id);
+    shadowMap->BindTextureForSampling(8, *compareSampler);
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "CascadeMath.h"
+#include "../Buffer/Buffer.h"
+#include "../Mesh/Mesh.h"
+#include "../Shader/ShaderProgram.h"
+#include "../Texture/Texture.h"
+#include "../Texture/Sampler.h"
+
+class Camera;
+
+// std140 mirror of ShadowData in Shader/include/shadows.glsl
+struct ShadowData {
+    glm::mat4 cascadeViewProjection[4];
+    glm::vec4 cascadeSplits{0.0f};          // view distance each cascade ends at
+    glm::vec4 cascadeTexelSize{0.0f};       // world-space texel size per cascade
+    glm::vec4 params{0.0f};                 // cascade count (0 = off), normal offset in texels, depth bias
+
+    static constexpr GLuint Binding = 2;
+};
+
+static_assert(offsetof(ShadowData, cascadeSplits) == 256);
+static_assert(offsetof(ShadowData, cascadeTexelSize) == 272);
+static_assert(offsetof(ShadowData, params) == 288);
+static_assert(sizeof(ShadowData) == 304, "ShadowData must match the std140 size of the GLSL block");
+
+struct CascadedShadowSettings {
+    int cascadeCount = 4;               // 1 to 4; read at construction
+    int resolution = 2048;              // per cascade; read at construction
+    float maxDistance = 100.0f;         // view distance the last cascade ends at, capped by the far plane
+    float splitLambda = 0.75f;          // 0 uniform splits, 1 logarithmic
+    // Cascades from this index on are cached: they keep a static-only copy that re-renders only when
+    // the light turns, the cascade has to move, or its static casters change
+    int firstCachedCascade = 2;
+    float cacheMargin = 0.2f;           // extra radius of a cached cascade, so the camera can move inside it
+    float normalOffset = 1.5f;          // receiver offset along the normal, in texels
+    float depthBias = 0.0005f;
+    float slopeBias = 2.0f;             // caster polygon offset
+    float constantBias = 4.0f;
+    bool enabled = true;
+};
+
+// Cascaded shadow maps for the FrameData sun. Cascades are texel-snapped spheres around slices of the
+// camera frustum, so shadow edges stay put as the camera moves and turns. Casters are culled per
+// cascade and drawn once each, instanced into every cascade they touch, into a Depth32F array with
+// one layer per cascade. Cached cascades only pay for static geometry when something changed; moving
+// casters are copied over the cached static layer and drawn on top each frame.
+class CascadedShadows {
+    public:
+        explicit CascadedShadows(const CascadedShadowSettings& settings = {});
+        ~CascadedShadows();
+
+        CascadedShadows(const CascadedShadows&) = delete;
+        CascadedShadows& operator=(const CascadedShadows&) = delete;
+
+        // Fits the cascades to `camera` and renders the casters among `items` that need it.
+        // Changes the framebuffer and viewport; rebind the scene target afterwards.
+        void Render(const std::vector<MeshDrawItem>& items, const Camera& camera, const glm::vec3& lightDirection);
+
+        // Binds ShadowData and the shadow map for shaders including shadows.glsl
+        void Bind() const;
+
+        // Drops every cached cascade, e.g. after the scene was reloaded
+        void Invalidate();
+
+        // Cascades whose depth was redrawn by the last Render()
+        int GetRenderedCascadeCount() const { return renderedCascades; }
+
+        // For declaring the shadow pass in a render graph
+        Texture& GetShadowMap() { return *shadowMap; }
+
+        CascadedShadowSettings settings;
+
+    private:
+        struct Caster {
+            const MeshDrawItem* item;
+            uint32_t mask;      // cascades it overlaps
+        };
+
+        struct CachedCascade {
+            CascadeMath::Sphere sphere;
+            glm::vec3 lightDirection{0.0f};
+            uint64_t contentHash = 0;
+            bool valid = false;
+            bool hadDynamic = false;    // the live layer holds moving casters drawn over the cache
+        };
+
+        void fitCascades(const Camera& camera, const glm::vec3& lightDirection);
+        uint32_t getCascadeMask(const MeshDrawItem& item, uint32_t cascades) const;
+        void clearLayer(GLuint texture, int layer);
+        void drawCasters(GLuint texture, int layerBase, const std::vector<Caster>& casters);
+
+        const int cascadeCount;
+        const int resolution;
+        bool vertexLayer = false;       // GL_ARB_shader_viewport_layer_array
+
+        ShadowData data;
+        std::array<CascadeMath::Sphere, 4> spheres;
+        std::array<CachedCascade, 4> cached;
+        glm::mat4 lightRotation{1.0f};
+        int renderedCascades = 0;
+
+        std::unique_ptr<Texture> shadowMap;         // one layer per cascade, sampled by shaders
+        std::unique_ptr<Texture> staticCache;       // one layer per cached cascade, static casters only
+        std::shared_ptr<const Sampler> compareSampler;
+        std::unique_ptr<Buffer> dataBuffer;
+        std::unique_ptr<ShaderProgram> program;
+        GLuint framebuffer = 0;
+
+        std::vector<Caster> casters;
+        std::vector<Caster> staticCasters;
+};
+
+inline std::unique_ptr<CascadedShadows> CreateCascadedShadows(const CascadedShadowSettings& settings = {}) {
+    return std::make_unique<CascadedShadows>(settings);
+}
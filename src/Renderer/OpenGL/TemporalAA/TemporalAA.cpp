@@ -0,0 +1,70 @@
+#include "TemporalAA.h"
+#include <algorithm>
+#include <cmath>
+#include "../Window/Window.h"
+
+namespace {
+    constexpr GLuint GroupSize = 8;     // local size of taa_resolve.comp
+}
+
+namespace TemporalJitter {
+    float Halton(uint32_t index, uint32_t base) {
+        float result = 0.0f;
+        float fraction = 1.0f;
+        while (index > 0) {
+            fraction /= static_cast<float>(base);
+            result += fraction * static_cast<float>(index % base);
+            index /= base;
+        }
+        return result;
+    }
+}
+
+TemporalAA::TemporalAA() {
+    auto shader = CreateShader(ShaderStage::Compute, "Shader/taa_resolve.comp");
+    program = CreateShaderProgram(*shader);
+
+    RenderTargetDesc desc;
+    desc.colorFormats = {TextureInternalFormat::RGBA16F};
+    for (auto& target : history) target = CreateRenderTarget(desc, {s_CurrentWindow.width, s_CurrentWindow.height});
+}
+
+glm::vec2 TemporalAA::NextJitter(glm::ivec2 renderSize, glm::ivec2 outputSize) {
+    // Enough phases that every output pixel gets its share of distinct sample positions
+    const float ratio = static_cast<float>(outputSize.x) / static_cast<float>(std::max(renderSize.x, 1));
+    const uint32_t phases = std::max(1u, static_cast<uint32_t>(std::ceil(settings.jitterPhases * ratio * ratio)));
+
+    current ^= 1;
+
+    const uint32_t index = frameIndex++ % phases + 1;
+    jitter = glm::vec2(TemporalJitter::Halton(index, 2), TemporalJitter::Halton(index, 3)) - 0.5f;
+    return jitter;
+}
+
+void TemporalAA::Resize(glm::ivec2 outputSize) {
+    if (history[0]->GetSize() != outputSize) historyValid = false;
+    for (auto& target : history) target->Resize(outputSize);
+}
+
+void TemporalAA::Resolve(Texture& color, Texture& velocity, Texture& depth, glm::ivec2 renderSize,
+                         glm::ivec2 outputSize, const FrameData& frame) {
+    Resize(outputSize);
+
+    Texture& output = GetOutput();
+
+    program->useShaderProgram();
+    program->SetUniformVec2("u_renderSize", glm::vec2(renderSize));
+    program->SetUniformVec2("u_jitter", jitter);
+    program->SetUniformMat4("u_reprojection", frame.previousViewProjection * glm::inverse(frame.unjitteredViewProjection));
+    program->SetUniform1f("u_currentWeight", settings.currentWeight);
+    program->SetUniform1i("u_historyValid", historyValid ? 1 : 0);
+
+    color.BindTextureForSampling(0);
+    velocity.BindTextureForSampling(1);
+    depth.BindTextureForSampling(2);
+    GetHistory().BindTextureForSampling(3);
+    output.BindTextureForImageAccess(0, output.id, TextureAccess::Write, TextureInternalFormat::RGBA16F);
+
+    glDispatchCompute((outputSize.x + GroupSize - 1) / GroupSize, (outputSize.y + GroupSize - 1) / GroupSize, 1);
+    historyValid = true;
+}
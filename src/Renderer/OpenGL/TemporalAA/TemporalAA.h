@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "../Buffer/FrameUniforms.h"
+#include "../Framebuffer/RenderTarget.h"
+#include "../Shader/ShaderProgram.h"
+#include "../Texture/Texture.h"
+
+struct TemporalAASettings {
+    float renderScale = 1.0f;       // internal resolution per axis; below 1 the resolve upsamples
+    float currentWeight = 0.1f;     // share of the new frame per resolve, before sample confidence
+    uint32_t jitterPhases = 8;      // per output pixel; multiplied by the upsampling ratio squared
+};
+
+// Temporal anti-aliasing and upsampling. The camera is jittered by a sub-pixel Halton offset every
+// frame; taa_resolve.comp accumulates those samples over frames into a history at output resolution,
+// reprojected with the scene's motion vectors and clipped to the current neighbourhood so moving
+// and disoccluded surfaces do not ghost. Costs one shading sample per render pixel, unlike MSAA,
+// which stores and resolves several.
+class TemporalAA {
+    public:
+        TemporalAA();
+
+        // Starts a frame: swaps the histories and returns the offset for the frame about to render, in
+        // render pixels. Apply it to the camera as NDC: 2 * jitter / renderSize.
+        glm::vec2 NextJitter(glm::ivec2 renderSize, glm::ivec2 outputSize);
+
+        // Resolves the `renderSize` area of `color`, `velocity` and `depth` into a new history at
+        // `outputSize` with the jitter from the last NextJitter(). `frame` is the one the scene was
+        // drawn with.
+        void Resolve(Texture& color, Texture& velocity, Texture& depth, glm::ivec2 renderSize,
+                     glm::ivec2 outputSize, const FrameData& frame);
+
+        // This frame's resolve, and next frame's history; RGBA16F at output size
+        Texture& GetOutput() { return history[current]->GetColor(0); }
+        // Last frame's resolve, read by Resolve()
+        Texture& GetHistory() { return history[current ^ 1]->GetColor(0); }
+
+        // Matches the histories to the output size, dropping them if it changed; call before
+        // importing them into a frame graph
+        void Resize(glm::ivec2 outputSize);
+
+        // Forgets the history, e.g. after a camera cut or when TAA was off
+        void Reset() { historyValid = false; }
+
+        TemporalAASettings settings;
+
+    private:
+        std::unique_ptr<RenderTarget> history[2];
+        std::unique_ptr<ShaderProgram> program;
+        size_t current = 0;
+        bool historyValid = false;
+        uint32_t frameIndex = 0;
+        glm::vec2 jitter{0.0f};
+};
+
+inline std::unique_ptr<TemporalAA> CreateTemporalAA() {
+    return std::make_unique<TemporalAA>();
+}
+
+namespace TemporalJitter {
+    // Element `index` (from 1) of the Halton sequence in `base`, in [0, 1)
+    float Halton(uint32_t index, uint32_t base);
+}
@@ -0,0 +1,106 @@
+#include "Sampler.h"
+#include <algorithm>
+#include <spdlog/spdlog.h>
+
+#include "../../../Utils/Hash.h"
+
+bool SamplerDesc::operator==(const SamplerDesc& other) const {
+    return minFilter == other.minFilter && magFilter == other.magFilter &&
+           wrapS == other.wrapS && wrapT == other.wrapT && wrapR == other.wrapR &&
+           maxAnisotropy == other.maxAnisotropy && lodBias == other.lodBias &&
+           minLod == other.minLod && maxLod == other.maxLod &&
+           depthCompare == other.depthCompare && borderColor == other.borderColor;
+}
+
+uint64_t SamplerDesc::Hash() const {
+    uint64_t hash = HashCombine(static_cast<uint64_t>(minFilter), static_cast<uint64_t>(magFilter));
+    hash = HashCombine(hash, static_cast<uint64_t>(wrapS));
+    hash = HashCombine(hash, static_cast<uint64_t>(wrapT));
+    hash = HashCombine(hash, static_cast<uint64_t>(wrapR));
+    hash = HashCombine(hash, depthCompare ? 1 : 0);
+
+    const float values[] = {maxAnisotropy, lodBias, minLod, maxLod,
+                            borderColor.r, borderColor.g, borderColor.b, borderColor.a};
+    return HashCombine(hash, HashBytes(values, sizeof(values)));
+}
+
+Sampler::Sampler(const SamplerDesc& desc)
+    : desc(desc)
+{
+    glCreateSamplers(1, &id);
+
+    glSamplerParameteri(id, GL_TEXTURE_MIN_FILTER, static_cast<GLenum>(desc.minFilter));
+    glSamplerParameteri(id, GL_TEXTURE_MAG_FILTER, static_cast<GLenum>(desc.magFilter));
+    glSamplerParameteri(id, GL_TEXTURE_WRAP_S, static_cast<GLenum>(desc.wrapS));
+    glSamplerParameteri(id, GL_TEXTURE_WRAP_T, static_cast<GLenum>(desc.wrapT));
+    glSamplerParameteri(id, GL_TEXTURE_WRAP_R, static_cast<GLenum>(desc.wrapR));
+    glSamplerParameterf(id, GL_TEXTURE_LOD_BIAS, desc.lodBias);
+    glSamplerParameterf(id, GL_TEXTURE_MIN_LOD, desc.minLod);
+    glSamplerParameterf(id, GL_TEXTURE_MAX_LOD, desc.maxLod);
+    glSamplerParameterfv(id, GL_TEXTURE_BORDER_COLOR, &desc.borderColor[0]);
+
+    if (desc.maxAnisotropy > 1.0f) {
+        glSamplerParameterf(id, GL_TEXTURE_MAX_ANISOTROPY, desc.maxAnisotropy);
+    }
+
+    if (desc.depthCompare) {
+        glSamplerParameteri(id, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+        glSamplerParameteri(id, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+    }
+}
+
+Sampler::~Sampler() {
+    if (id) {
+        glDeleteSamplers(1, &id);
+    }
+}
+
+float SamplerCache::GetMaxAnisotropy() {
+    if (maxAnisotropy == 0.0f) {
+        glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY, &maxAnisotropy);
+        maxAnisotropy = std::max(maxAnisotropy, 1.0f);
+    }
+    return maxAnisotropy;
+}
+
+std::shared_ptr<const Sampler> SamplerCache::Get(const SamplerDesc& desc) {
+    // Clamp first so requests above the device limit share the sampler that is actually created.
+    SamplerDesc key = desc;
+    key.maxAnisotropy = std::clamp(desc.maxAnisotropy, 1.0f, GetMaxAnisotropy());
+
+    auto it = samplers.find(key);
+    if (it != samplers.end()) {
+        return it->second;
+    }
+
+    auto sampler = std::make_shared<const Sampler>(key);
+    samplers.emplace(key, sampler);
+    spdlog::debug("Created sampler {} ({} cached)", sampler->id, samplers.size());
+    return sampler;
+}
+
+SamplerCache& GetSamplerCache() {
+    static SamplerCache cache;
+    return cache;
+}
+
+GLuint TextureBindingBatch::Add(const Texture& texture, const Sampler* sampler) {
+    if (!sampler) sampler = texture.sampler.get();
+
+    textures.push_back(texture.id);
+    samplers.push_back(sampler ? sampler->id : 0);
+    return static_cast<GLuint>(textures.size() - 1);
+}
+
+void TextureBindingBatch::Bind(GLuint firstUnit) const {
+    if (textures.empty()) return;
+
+    const GLsizei count = static_cast<GLsizei>(textures.size());
+    glBindTextures(firstUnit, count, textures.data());
+    glBindSamplers(firstUnit, count, samplers.data());
+}
+
+void TextureBindingBatch::Clear() {
+    textures.clear();
+    samplers.clear();
+}
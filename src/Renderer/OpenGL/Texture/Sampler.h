@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "Texture.h"
+
+// Sampling state lives in immutable sampler objects instead of the texture, so one texture can be
+// sampled differently by different materials. Identical descriptions share one GL sampler through
+// the process-wide SamplerCache.
+
+struct SamplerDesc {
+    TextureFilter minFilter = TextureFilter::LinearMipmapLinear;
+    TextureFilter magFilter = TextureFilter::Linear;
+    TextureWrap wrapS = TextureWrap::Repeat;
+    TextureWrap wrapT = TextureWrap::Repeat;
+    TextureWrap wrapR = TextureWrap::Repeat;
+    float maxAnisotropy = 1.0f;         // clamped to the device limit by the cache
+    float lodBias = 0.0f;
+    float minLod = -1000.0f;
+    float maxLod = 1000.0f;
+    bool depthCompare = false;          // GL_COMPARE_REF_TO_TEXTURE with GL_LEQUAL, for shadow maps
+    glm::vec4 borderColor = glm::vec4(0.0f);
+
+    bool operator==(const SamplerDesc& other) const;
+    uint64_t Hash() const;
+};
+
+struct SamplerDescHash {
+    size_t operator()(const SamplerDesc& desc) const { return static_cast<size_t>(desc.Hash()); }
+};
+
+class Sampler {
+    public:
+        explicit Sampler(const SamplerDesc& desc);
+        ~Sampler();
+
+        Sampler(const Sampler&) = delete;
+        Sampler& operator=(const Sampler&) = delete;
+
+        void Bind(GLuint unit) const { glBindSampler(unit, id); }
+
+    public:
+        GLuint id = 0;
+        const SamplerDesc desc;
+};
+
+class SamplerCache {
+    public:
+        // Returns the shared sampler for `desc`, creating it on first use.
+        std::shared_ptr<const Sampler> Get(const SamplerDesc& desc);
+
+        // Largest anisotropy the device supports, queried once.
+        float GetMaxAnisotropy();
+        size_t GetCount() const { return samplers.size(); }
+
+        // Drops the cache's references; call while the GL context is still current.
+        void Clear() { samplers.clear(); }
+
+    private:
+        std::unordered_map<SamplerDesc, std::shared_ptr<const Sampler>, SamplerDescHash> samplers;
+        float maxAnisotropy = 0.0f;
+};
+
+SamplerCache& GetSamplerCache();
+
+inline std::shared_ptr<const Sampler> CreateSampler(const SamplerDesc& desc) {
+    return GetSamplerCache().Get(desc);
+}
+
+// Collects texture/sampler pairs for consecutive units and binds them with one glBindTextures and
+// one glBindSamplers call. Units without an explicit sampler use the texture's default sampler.
+class TextureBindingBatch {
+    public:
+        // Returns the unit the texture will be bound to, counted from the first unit passed to Bind().
+        GLuint Add(const Texture& texture, const Sampler* sampler = nullptr);
+        void Bind(GLuint firstUnit = 0) const;
+        void Clear();
+
+        size_t GetCount() const { return textures.size(); }
+
+    private:
+        std::vector<GLuint> textures;
+        std::vector<GLuint> samplers;
+};
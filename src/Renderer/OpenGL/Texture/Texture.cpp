@@ -1,8 +1,25 @@
 #include "Texture.h"
+#include "Sampler.h"
+#include "TextureMips.h"
+#include "TextureLoader.h"
+#include "../../../Utils/ThreadPool.h"
+#include <algorithm>
 #include <stdexcept>
 #include <iostream>
 
-#include <stb_image.h>
+static bool IsMipmapFilter(TextureFilter filter) {
+    return filter != TextureFilter::Linear && filter != TextureFilter::Nearest;
+}
+
+static std::vector<Texture*> fileTextures;
+
+static int GetChannelCount(TextureFormat format) {
+    switch (format) {
+        case TextureFormat::RED: return 1;
+        case TextureFormat::RGB: return 3;
+        default: return 4;
+    }
+}
 
 Texture::Texture(
     const std::string& source,
@@ -32,35 +49,24 @@ Texture::Texture(
     if (type == TextureType::CubeMap) {
         if (!faces) throw std::runtime_error("Cubemap faces vector cannot be null");
         
-        glGenTextures(1, &id);
         loadCubeMap(*faces);
     } else {
-        glCreateTextures(target, 1, &id);
-        stbi_set_flip_vertically_on_load(true);
-        unsigned char* data = stbi_load(source.c_str(), &width, &height, &nrChannels, 0);
-        if (!data) throw std::runtime_error("Failed to load texture: " + source);
-
-        if (type == TextureType::Tex2D) {
-            glTextureStorage2D(id, 1, static_cast<GLenum>(internalFormat), width, height);
-            glTextureSubImage2D(id, 0, 0, 0, width, height,
-                                static_cast<GLenum>(format), GL_UNSIGNED_BYTE, data);
-        } else { 
-            depth = 1;
-            glTextureStorage3D(id, 1, static_cast<GLenum>(internalFormat), width, height, depth);
-            glTextureSubImage3D(id, 0, 0, 0, 0, width, height, depth,
-                                static_cast<GLenum>(format), GL_UNSIGNED_BYTE, data);
-        }
+        // Decode to the channel count the upload format expects, whatever the file stores
+        nrChannels = GetChannelCount(format);
+        DecodedImage image = TextureLoader::Decode(source, nrChannels, true);
+        if (!image.Valid()) throw std::runtime_error("Failed to load texture: " + source);
 
-        stbi_image_free(data);
+        width = image.width;
+        height = image.height;
+        depth = 1;
+        uploadPixels(image.pixels.data());
     }
 
-    applyParameters();
-
-    glBindTextureUnit(unit, id);
+    sourceFiles = faces && type == TextureType::CubeMap ? *faces : std::vector<std::string>{source};
+    fileTextures.push_back(this);
 
-    if (minFilter == TextureFilter::LinearMipmapLinear) {
-        glGenerateTextureMipmap(id);
-    }
+    sampler = GetSamplerCache().Get(GetSamplerDesc());
+    BindTextureForSampling(unit);
 }
 
 Texture::Texture(
@@ -93,34 +99,23 @@ Texture::Texture(
 {
     glCreateTextures(target, 1, &id);
 
-    if (type == TextureType::Tex2D) {
-        glTextureStorage2D(id, 1, static_cast<GLenum>(internalFormat), width, height);
-        glTextureSubImage2D(id, 0, 0, 0, width, height,
-                            static_cast<GLenum>(format), GL_UNSIGNED_BYTE, data);
-    } 
-    else if (type == TextureType::Tex3D) {
-        glTextureStorage3D(id, 1, static_cast<GLenum>(internalFormat), width, height, depth);
-        glTextureSubImage3D(id, 0, 0, 0, 0, width, height, depth,
-                            static_cast<GLenum>(format), GL_UNSIGNED_BYTE, data);
+    if (type == TextureType::Tex2D || type == TextureType::Tex3D || type == TextureType::Tex2DArray) {
+        uploadPixels(static_cast<const unsigned char*>(data));
     } 
     else if (type == TextureType::CubeMap) {
-        int pixelSize = (format == TextureFormat::RGBA || format == TextureFormat::RGBA8) ? 4 : 3;
-        glBindTexture(GL_TEXTURE_CUBE_MAP, id);
-
-        for (int i = 0; i < 6; i++) {
-            const void* faceData = static_cast<const unsigned char*>(data) + i * width * height * pixelSize;
-            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0,
-                         static_cast<GLenum>(internalFormat), width, height, 0,
-                         static_cast<GLenum>(format), GL_UNSIGNED_BYTE, faceData);
-        }
+        const int channels = GetChannelCount(format);
+        const size_t faceSize = static_cast<size_t>(width) * height * channels;
 
-        applyParameters();
-        glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
-        return;
+        levels = 1;
+        glTextureStorage2D(id, levels, static_cast<GLenum>(internalFormat), width, height);
+        for (int face = 0; face < 6 && data; ++face) {
+            TextureLoader::Upload(id, type, 0, face, width, height, format, internalFormat,
+                                  static_cast<const unsigned char*>(data) + face * faceSize, faceSize);
+        }
     }
 
-    applyParameters();
-    glBindTextureUnit(unit, id);
+    sampler = GetSamplerCache().Get(GetSamplerDesc());
+    BindTextureForSampling(unit);
 }
 
 Texture::Texture(
@@ -152,86 +147,365 @@ Texture::Texture(
     glCreateTextures(target, 1, &id);
     std::cerr << "Created empty texture with ID: " << id << std::endl;
 
-    if (type == TextureType::Tex2D) {
-        glTextureStorage2D(id, 1, static_cast<GLenum>(internalFormat), width, height);
-    } else if (type == TextureType::Tex3D) {
-        glTextureStorage3D(id, 1, static_cast<GLenum>(internalFormat), width, height, depth);
+    if (type == TextureType::Tex2D || type == TextureType::Tex3D || type == TextureType::Tex2DArray ||
+        type == TextureType::CubeMap) {
+        uploadPixels(nullptr);
     }
 
-    applyParameters();
-    glBindTextureUnit(unit, id);
+    sampler = GetSamplerCache().Get(GetSamplerDesc());
+    BindTextureForSampling(unit);
+}
+
+Texture::Texture(
+    int width,
+    int height,
+    TextureInternalFormat internalFormat,
+    int levels,
+    int samples,
+    TextureFilter minFilter,
+    TextureFilter magFilter,
+    TextureWrap wrap
+)
+    : width(width),
+      height(height),
+      depth(1),
+      levels(samples > 1 ? 1 : std::max(1, levels)),
+      samples(std::max(1, samples)),
+      type(samples > 1 ? TextureType::Tex2DMultisample : TextureType::Tex2D),
+      format(IsDepthFormat(internalFormat) ? TextureFormat::Depth : TextureFormat::RGBA),
+      internalFormat(internalFormat),
+      target(samples > 1 ? GL_TEXTURE_2D_MULTISAMPLE : GL_TEXTURE_2D),
+      minFilter(minFilter),
+      magFilter(magFilter),
+      wrapS(wrap),
+      wrapT(wrap),
+      wrapR(wrap)
+{
+    glCreateTextures(target, 1, &id);
+
+    if (this->samples > 1) {
+        glTextureStorage2DMultisample(id, this->samples, static_cast<GLenum>(internalFormat), width, height, GL_TRUE);
+    } else {
+        glTextureStorage2D(id, this->levels, static_cast<GLenum>(internalFormat), width, height);
+    }
+
+    sampler = GetSamplerCache().Get(GetSamplerDesc());
+}
+
+Texture::Texture(
+    TextureFormat format,
+    TextureInternalFormat internalFormat,
+    const std::vector<TextureMipData>& mipLevels,
+    GLuint unit,
+    TextureFilter minFilter,
+    TextureFilter magFilter,
+    TextureWrap wrapS,
+    TextureWrap wrapT
+)
+    : type(TextureType::Tex2D),
+      format(format),
+      internalFormat(internalFormat),
+      target(GL_TEXTURE_2D),
+      minFilter(minFilter),
+      magFilter(magFilter),
+      wrapS(wrapS),
+      wrapT(wrapT)
+{
+    if (mipLevels.empty()) throw std::runtime_error("Texture needs at least one mip level");
+
+    width = mipLevels[0].width;
+    height = mipLevels[0].height;
+    depth = 1;
+    levels = static_cast<int>(mipLevels.size());
+
+    glCreateTextures(target, 1, &id);
+    glTextureStorage2D(id, levels, static_cast<GLenum>(internalFormat), width, height);
+
+    for (int level = 0; level < levels; ++level) {
+        const auto& mip = mipLevels[level];
+        TextureLoader::Upload(id, type, level, 0, mip.width, mip.height, format, internalFormat, mip.data, mip.size);
+    }
+
+    sampler = GetSamplerCache().Get(GetSamplerDesc());
+    BindTextureForSampling(unit);
 }
 
 Texture::~Texture() {
+    if (!sourceFiles.empty()) {
+        fileTextures.erase(std::remove(fileTextures.begin(), fileTextures.end(), this), fileTextures.end());
+    }
     if (id != 0) {
         glDeleteTextures(1, &id);
     }
 }
 
-void Texture::loadCubeMap(const std::vector<std::string>& faces) {
-    if (faces.size() != 6)
-        throw std::runtime_error("CubeMap requires 6 face textures!");
+const std::vector<Texture*>& Texture::GetFileTextures() {
+    return fileTextures;
+}
 
-    glBindTexture(GL_TEXTURE_CUBE_MAP, id);
+void Texture::SwapStorage(Texture& other) {
+    std::swap(id, other.id);
+    std::swap(width, other.width);
+    std::swap(height, other.height);
+    std::swap(depth, other.depth);
+    std::swap(nrChannels, other.nrChannels);
+    std::swap(levels, other.levels);
+    std::swap(samples, other.samples);
+    std::swap(droppedLevels, other.droppedLevels);
+}
 
-    // Don't flip vertically for cubemaps
-    stbi_set_flip_vertically_on_load(false);
+void Texture::uploadPixels(const unsigned char* pixels) {
+    // 2D and array textures get a full mip chain whenever the min filter samples mips;
+    // the chain is built on the CPU so the upload is the only GL work.
+    const bool mipmapped = IsMipmapFilter(minFilter) && type != TextureType::Tex3D;
+    const int layers = type == TextureType::Tex2D ? 1 : depth;
+    const int channels = GetChannelCount(format);
 
-    for (size_t i = 0; i < faces.size(); i++) {
-        int w, h, channels;
-        unsigned char* data = stbi_load(faces[i].c_str(), &w, &h, &channels, 0);
-        if (!data) {
-            throw std::runtime_error("Failed to load CubeMap face: " + faces[i]);
+    // Only sRGB storage holds encoded color; everything else is filtered as stored, like glGenerateMipmap would.
+    // Edge taps follow the sampler's addressing so tiling textures stay seamless down the chain.
+    MipSettings mips;
+    mips.srgb = IsSRGBFormat(internalFormat);
+    mips.wrapS = wrapS;
+    mips.wrapT = wrapT;
+
+    std::vector<MipChain> chains(mipmapped && pixels ? layers : 0);
+    GetThreadPool().ParallelFor(chains.size(), [&](size_t layer) {
+        const size_t layerSize = static_cast<size_t>(width) * height * channels;
+        chains[layer] = MipGeneration::Generate(pixels + layer * layerSize, width, height, channels, mips);
+    });
+
+    levels = mipmapped ? MipGeneration::GetLevelCount(width, height) : 1;
+
+    // Cube maps allocate all six faces through the 2D call; only the empty constructor gets here with one
+    if (type == TextureType::Tex2D || type == TextureType::CubeMap) {
+        glTextureStorage2D(id, levels, static_cast<GLenum>(internalFormat), width, height);
+    } else {
+        glTextureStorage3D(id, levels, static_cast<GLenum>(internalFormat), width, height, depth);
+    }
+
+    if (!pixels) return;
+
+    const size_t layerSize = static_cast<size_t>(width) * height * channels;
+
+    if (chains.empty()) {
+        if (type == TextureType::Tex3D) {
+            // Volume slices are uploaded in one call; the staging ring only handles 2D regions.
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            glTextureSubImage3D(id, 0, 0, 0, 0, width, height, depth,
+                                static_cast<GLenum>(format), GL_UNSIGNED_BYTE, pixels);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            return;
         }
+        for (int layer = 0; layer < layers; ++layer) {
+            TextureLoader::Upload(id, type, 0, layer, width, height, format, internalFormat,
+                                  pixels + layer * layerSize, layerSize);
+        }
+        return;
+    }
+
+    for (int level = 0; level < levels; ++level) {
+        int levelWidth = std::max(1, width >> level);
+        int levelHeight = std::max(1, height >> level);
+        for (int layer = 0; layer < layers; ++layer) {
+            const auto& levelData = chains[layer].levels[level];
+            TextureLoader::Upload(id, type, level, layer, levelWidth, levelHeight, format, internalFormat,
+                                  levelData.data(), levelData.size());
+        }
+    }
+}
+
+size_t Texture::GetMemorySize() const {
+    return getMemorySize(width, height, levels);
+}
+
+size_t Texture::GetRestoredMemorySize(int count) const {
+    count = std::min(count, GetDroppedLevelCount());
+    if (count <= 0) return GetMemorySize();
 
-        if (i == 0) {
-            width = w;
-            height = h;
-            nrChannels = channels;
+    const DroppedMipLevel& largest = droppedLevels[droppedLevels.size() - count];
+    return getMemorySize(largest.width, largest.height, levels + count);
+}
+
+size_t Texture::getMemorySize(int baseWidth, int baseHeight, int levelCount) const {
+    const int layers = type == TextureType::CubeMap ? 6 : std::max(1, depth);
+
+    size_t size = 0;
+    for (int level = 0; level < levelCount; ++level) {
+        size_t levelWidth = std::max(1, baseWidth >> level);
+        size_t levelHeight = std::max(1, baseHeight >> level);
+        size_t levelLayers = type == TextureType::Tex3D ? std::max(1, depth >> level) : layers;
+
+        if (IsCompressedFormat(internalFormat)) {
+            size_t blockSize = internalFormat == TextureInternalFormat::BC1 ? 8 : 16;
+            size += ((levelWidth + 3) / 4) * ((levelHeight + 3) / 4) * blockSize * levelLayers;
+        } else {
+            size += levelWidth * levelHeight * GetBytesPerPixel(internalFormat) * levelLayers;
         }
+    }
+    return size * samples;
+}
+
+bool Texture::DropMipLevels(int count) {
+    if (type != TextureType::Tex2D && type != TextureType::Tex2DArray) return false;
 
-        glTexImage2D(
-            GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 
-            0,                                  
-            static_cast<GLenum>(internalFormat), 
-            w, h,                             
-            0,                                 
-            static_cast<GLenum>(format),       
-            GL_UNSIGNED_BYTE,                  
-            data                              
-        );
+    count = std::min(count, levels - 1);
+    if (count <= 0) return false;
 
-        stbi_image_free(data);
+    const int newLevels = levels - count;
+    const int newWidth = std::max(1, width >> count);
+    const int newHeight = std::max(1, height >> count);
+    const int layers = type == TextureType::Tex2D ? 1 : depth;
+
+    // Largest first, so the smallest dropped level ends up last
+    if (!IsDepthFormat(internalFormat)) {
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        for (int level = 0; level < count; ++level) {
+            DroppedMipLevel dropped;
+            dropped.width = std::max(1, width >> level);
+            dropped.height = std::max(1, height >> level);
+            if (IsCompressedFormat(internalFormat)) {
+                const size_t blockSize = internalFormat == TextureInternalFormat::BC1 ? 8 : 16;
+                dropped.pixels.resize(((dropped.width + 3) / 4) * ((dropped.height + 3) / 4) * blockSize * layers);
+                glGetCompressedTextureImage(id, level, static_cast<GLsizei>(dropped.pixels.size()), dropped.pixels.data());
+            } else {
+                dropped.pixels.resize(static_cast<size_t>(dropped.width) * dropped.height * GetChannelCount(format) * layers);
+                glGetTextureImage(id, level, static_cast<GLenum>(format), GL_UNSIGNED_BYTE,
+                                  static_cast<GLsizei>(dropped.pixels.size()), dropped.pixels.data());
+            }
+            droppedLevels.push_back(std::move(dropped));
+        }
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
     }
 
-    applyParameters();
+    GLuint newId = 0;
+    glCreateTextures(target, 1, &newId);
+    if (type == TextureType::Tex2D) {
+        glTextureStorage2D(newId, newLevels, static_cast<GLenum>(internalFormat), newWidth, newHeight);
+    } else {
+        glTextureStorage3D(newId, newLevels, static_cast<GLenum>(internalFormat), newWidth, newHeight, depth);
+    }
 
-    if (minFilter == TextureFilter::LinearMipmapLinear) {
-        glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
+    for (int level = 0; level < newLevels; ++level) {
+        glCopyImageSubData(id, target, level + count, 0, 0, 0,
+                           newId, target, level, 0, 0, 0,
+                           std::max(1, newWidth >> level), std::max(1, newHeight >> level),
+                           type == TextureType::Tex2D ? 1 : depth);
     }
 
-    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+    glDeleteTextures(1, &id);
+    id = newId;
+    width = newWidth;
+    height = newHeight;
+    levels = newLevels;
+    return true;
 }
 
-void Texture::applyParameters() {
-    if (type == TextureType::CubeMap) {
-        glBindTexture(GL_TEXTURE_CUBE_MAP, id);
-        
-        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        
-        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-        
-        glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+int Texture::RestoreMipLevels(int count) {
+    count = std::min(count, GetDroppedLevelCount());
+    if (count <= 0) return 0;
+
+    const int newLevels = levels + count;
+    const DroppedMipLevel& largest = droppedLevels[droppedLevels.size() - count];
+    const int newWidth = largest.width;
+    const int newHeight = largest.height;
+    const int layers = type == TextureType::Tex2D ? 1 : depth;
+
+    GLuint newId = 0;
+    glCreateTextures(target, 1, &newId);
+    if (type == TextureType::Tex2D) {
+        glTextureStorage2D(newId, newLevels, static_cast<GLenum>(internalFormat), newWidth, newHeight);
     } else {
-        glTextureParameteri(id, GL_TEXTURE_MIN_FILTER, static_cast<GLenum>(minFilter));
-        glTextureParameteri(id, GL_TEXTURE_MAG_FILTER, static_cast<GLenum>(magFilter));
-        glTextureParameteri(id, GL_TEXTURE_WRAP_S, static_cast<GLenum>(wrapS));
-        glTextureParameteri(id, GL_TEXTURE_WRAP_T, static_cast<GLenum>(wrapT));
+        glTextureStorage3D(newId, newLevels, static_cast<GLenum>(internalFormat), newWidth, newHeight, depth);
+    }
+
+    for (int level = 0; level < levels; ++level) {
+        glCopyImageSubData(id, target, level, 0, 0, 0,
+                           newId, target, level + count, 0, 0, 0,
+                           std::max(1, width >> level), std::max(1, height >> level), layers);
+    }
+
+    for (int level = count - 1; level >= 0; --level) {
+        const DroppedMipLevel& restored = droppedLevels.back();
+        const size_t layerSize = restored.pixels.size() / layers;
+        for (int layer = 0; layer < layers; ++layer) {
+            TextureLoader::Upload(newId, type, level, layer, restored.width, restored.height, format, internalFormat,
+                                  restored.pixels.data() + layer * layerSize, layerSize);
+        }
+        droppedLevels.pop_back();
+    }
+
+    glDeleteTextures(1, &id);
+    id = newId;
+    width = newWidth;
+    height = newHeight;
+    levels = newLevels;
+    return count;
+}
+
+void Texture::loadCubeMap(const std::vector<std::string>& faces) {
+    if (faces.size() != 6)
+        throw std::runtime_error("CubeMap requires 6 face textures!");
+
+    // Faces decode in parallel and are not flipped; cube map faces are stored top row first.
+    const TextureLoadStats baseline = TextureLoader::GetStats();
+    nrChannels = GetChannelCount(format);
+    std::vector<DecodedImage> images = TextureLoader::DecodeAll(faces, nrChannels, false);
+
+    for (size_t i = 0; i < images.size(); i++) {
+        if (!images[i].Valid()) {
+            throw std::runtime_error("Failed to load CubeMap face: " + faces[i]);
+        }
+        if (images[i].width != images[0].width || images[i].height != images[0].height) {
+            throw std::runtime_error("CubeMap face size mismatch: " + faces[i]);
+        }
+    }
+
+    width = images[0].width;
+    height = images[0].height;
+    depth = 1;
+
+    const bool mipmapped = IsMipmapFilter(minFilter);
+    std::vector<MipChain> chains(mipmapped ? images.size() : 0);
+    GetThreadPool().ParallelFor(chains.size(), [&](size_t face) {
+        MipSettings settings;
+        settings.srgb = IsSRGBFormat(internalFormat);
+        settings.wrapS = TextureWrap::ClampToEdge;
+        settings.wrapT = TextureWrap::ClampToEdge;
+        chains[face] = MipGeneration::Generate(images[face].pixels.data(), width, height, nrChannels, settings);
+    });
 
-        if (type == TextureType::Tex3D)
-            glTextureParameteri(id, GL_TEXTURE_WRAP_R, static_cast<GLenum>(wrapR));
+    levels = mipmapped ? MipGeneration::GetLevelCount(width, height) : 1;
+    glTextureStorage2D(id, levels, static_cast<GLenum>(internalFormat), width, height);
+
+    for (int level = 0; level < levels; ++level) {
+        int levelWidth = std::max(1, width >> level);
+        int levelHeight = std::max(1, height >> level);
+        for (int face = 0; face < 6; ++face) {
+            const auto& levelData = mipmapped ? chains[face].levels[level] : images[face].pixels;
+            TextureLoader::Upload(id, type, level, face, levelWidth, levelHeight, format, internalFormat,
+                                  levelData.data(), levelData.size());
+        }
     }
-}
\ No newline at end of file
+
+    TextureLoader::LogStats("Cubemap", baseline);
+}
+
+SamplerDesc Texture::GetSamplerDesc() const {
+    SamplerDesc desc;
+    desc.minFilter = minFilter;
+    desc.magFilter = magFilter;
+    desc.wrapS = wrapS;
+    desc.wrapT = wrapT;
+    desc.wrapR = wrapR;
+    return desc;
+}
+
+void Texture::BindTextureForSampling(GLuint unit) const {
+    glBindTextureUnit(unit, id);
+    glBindSampler(unit, sampler ? sampler->id : 0);
+}
+
+void Texture::BindTextureForSampling(GLuint unit, const Sampler& sampler) const {
+    glBindTextureUnit(unit, id);
+    sampler.Bind(unit);
+}
@@ -7,16 +7,28 @@
 #include <vector>
 #include <memory>
 
+// S3TC is an extension and not part of the core 4.6 glad loader
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
 enum class TextureType : GLenum {
     Tex2D = GL_TEXTURE_2D,
     Tex3D = GL_TEXTURE_3D,
-    CubeMap = GL_TEXTURE_CUBE_MAP
+    Tex2DArray = GL_TEXTURE_2D_ARRAY,
+    CubeMap = GL_TEXTURE_CUBE_MAP,
+    Tex2DMultisample = GL_TEXTURE_2D_MULTISAMPLE
 };
 
 enum class TextureFormat : GLenum {
     RGB = GL_RGB,
     RGBA = GL_RGBA,
     RGBA8 = GL_RGBA8,
+    SRGB8 = GL_SRGB8,
+    SRGB8_ALPHA8 = GL_SRGB8_ALPHA8,
     Depth = GL_DEPTH_COMPONENT,
     DepthStencil = GL_DEPTH24_STENCIL8,
     RED = GL_RED
@@ -25,10 +37,57 @@ enum class TextureFormat : GLenum {
 enum class TextureInternalFormat : GLenum {
     RGB8 = GL_RGB8,
     RGBA8 = GL_RGBA8,
+    SRGB8 = GL_SRGB8,
+    SRGB8_ALPHA8 = GL_SRGB8_ALPHA8,
     RGBA16F = GL_RGBA16F,
+    RG16F = GL_RG16F,
+    R16F = GL_R16F,
+    R32F = GL_R32F,
+    R11G11B10F = GL_R11F_G11F_B10F,
+    Depth24 = GL_DEPTH_COMPONENT24,
+    Depth32F = GL_DEPTH_COMPONENT32F,
     RGB = GL_RGB,
     Depth24Stencil8 = GL_DEPTH24_STENCIL8,
-    R8 = GL_R8
+    R8 = GL_R8,
+    BC1 = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT,
+    BC3 = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT,
+    BC5 = GL_COMPRESSED_RG_RGTC2,
+    BC7 = GL_COMPRESSED_RGBA_BPTC_UNORM
+};
+
+// Uncompressed formats only
+inline size_t GetBytesPerPixel(TextureInternalFormat format) {
+    switch (format) {
+        case TextureInternalFormat::R8: return 1;
+        case TextureInternalFormat::R16F: return 2;
+        case TextureInternalFormat::RGBA16F: return 8;
+        default: return 4;      // RGB8 is padded to four bytes by every driver we target
+    }
+}
+
+inline bool IsDepthFormat(TextureInternalFormat format) {
+    return format == TextureInternalFormat::Depth24 || format == TextureInternalFormat::Depth32F ||
+           format == TextureInternalFormat::Depth24Stencil8;
+}
+
+inline bool IsSRGBFormat(TextureInternalFormat format) {
+    return format == TextureInternalFormat::SRGB8 || format == TextureInternalFormat::SRGB8_ALPHA8;
+}
+
+inline bool IsCompressedFormat(TextureInternalFormat format) {
+    return format == TextureInternalFormat::BC1 || format == TextureInternalFormat::BC3 ||
+           format == TextureInternalFormat::BC5 || format == TextureInternalFormat::BC7;
+}
+
+class Sampler;
+struct SamplerDesc;
+
+// One level of a prebuilt mip chain, level 0 first
+struct TextureMipData {
+    int width;
+    int height;
+    const void* data;
+    size_t size;
 };
 
 enum class TextureFilter : GLenum {
@@ -100,14 +159,65 @@ class Texture {
             TextureWrap wrapR = TextureWrap::Repeat
         );
 
+        // Storage-only 2D render target with `levels` mips, multisampled when `samples` > 1
+        Texture(
+            int width,
+            int height,
+            TextureInternalFormat internalFormat,
+            int levels,
+            int samples,
+            TextureFilter minFilter = TextureFilter::Linear,
+            TextureFilter magFilter = TextureFilter::Linear,
+            TextureWrap wrap = TextureWrap::ClampToEdge
+        );
+
+        // 2D texture from a prebuilt mip chain, block-compressed or not
+        Texture(
+            TextureFormat format,
+            TextureInternalFormat internalFormat,
+            const std::vector<TextureMipData>& levels,
+            GLuint unit = 0,
+            TextureFilter minFilter = TextureFilter::LinearMipmapLinear,
+            TextureFilter magFilter = TextureFilter::Linear,
+            TextureWrap wrapS = TextureWrap::Repeat,
+            TextureWrap wrapT = TextureWrap::Repeat
+        );
+
         ~Texture();
 
-        void BindTextureForSampling(GLuint unit) const { glBindTextureUnit(unit, id); }
+        Texture(const Texture&) = delete;
+        Texture& operator=(const Texture&) = delete;
+
+        // Binds the texture together with its default sampler, or with `sampler` when given
+        void BindTextureForSampling(GLuint unit) const;
+        void BindTextureForSampling(GLuint unit, const Sampler& sampler) const;
         void BindTextureForImageAccess(GLuint binding, GLuint texture, TextureAccess access, TextureInternalFormat internalFormat) const { glBindImageTexture(binding, id, 0, GL_FALSE, 0, static_cast<GLenum>(access), static_cast<GLenum>(internalFormat)); }
         void BindTextureForImageAccess(GLuint binding, GLuint id, TextureAccess access, TextureInternalFormat internalFormat, 
                           int mipLevel, bool layered, int layer) const { glBindImageTexture(binding, id, mipLevel, layered, layer, static_cast<GLenum>(access), static_cast<GLenum>(internalFormat)); }
-        
-        void applyParameters();
+
+        // Sampling state built from the filter and wrap members
+        SamplerDesc GetSamplerDesc() const;
+
+        // Bytes of GPU storage across all levels and layers, ignoring driver padding
+        size_t GetMemorySize() const;
+
+        // Reallocates a 2D or array texture without its `count` largest levels, copying the rest
+        // on the GPU. Always keeps at least one level; returns false if nothing was dropped. The
+        // dropped levels are read back into system memory first (a GPU stall) so they can be restored.
+        bool DropMipLevels(int count);
+        // Uploads up to `count` of the most recently dropped levels again, smallest first, and
+        // returns how many came back.
+        int RestoreMipLevels(int count);
+        int GetDroppedLevelCount() const { return static_cast<int>(droppedLevels.size()); }
+        // GPU bytes the texture would take after RestoreMipLevels(count)
+        size_t GetRestoredMemorySize(int count) const;
+
+        // Exchanges GL storage and size with `other`, keeping this object (and every owner's pointer)
+        // alive. Used by hot reload to swap in a re-decoded texture between frames.
+        void SwapStorage(Texture& other);
+
+        // Textures constructed from files, for hot reload; maintained by the constructors and destructor
+        static const std::vector<Texture*>& GetFileTextures();
 
     public:
         GLuint id = 0;
@@ -115,6 +225,8 @@ class Texture {
         int height = 0;
         int depth = 0;
         int nrChannels = 0;
+        int levels = 1;
+        int samples = 1;
 
         TextureFilter minFilter = TextureFilter::LinearMipmapLinear;
         TextureFilter magFilter = TextureFilter::Linear;
@@ -122,13 +234,30 @@ class Texture {
         TextureWrap wrapT = TextureWrap::Repeat;
         TextureWrap wrapR = TextureWrap::Repeat;
 
+        // Shared sampler for the filter and wrap members; texture objects carry no sampling state
+        std::shared_ptr<const Sampler> sampler;
+
         TextureType type;
         TextureFormat format;
         TextureInternalFormat internalFormat;
         const GLenum target;
 
+        // Files this texture was decoded from: the image, or the six cube faces; empty otherwise
+        std::vector<std::string> sourceFiles;
+
     private: 
         void loadCubeMap(const std::vector<std::string>& faces);
+        void uploadPixels(const unsigned char* pixels);
+        size_t getMemorySize(int levelWidth, int levelHeight, int levelCount) const;
+
+        // One level removed by DropMipLevels, every layer back to back in upload layout
+        struct DroppedMipLevel {
+            int width;
+            int height;
+            std::vector<unsigned char> pixels;
+        };
+        // Smallest level last; it is the next one RestoreMipLevels brings back
+        std::vector<DroppedMipLevel> droppedLevels;
 };
 
 inline std::unique_ptr<Texture> CreateTextureFromFile(
@@ -172,6 +301,19 @@ inline std::unique_ptr<Texture> CreateTextureFromData(
     );
 }
 
+inline std::unique_ptr<Texture> CreateTextureFromMips(
+    TextureFormat format,
+    TextureInternalFormat internalFormat,
+    const std::vector<TextureMipData>& levels,
+    GLuint unit = 0,
+    TextureFilter minFilter = TextureFilter::LinearMipmapLinear,
+    TextureFilter magFilter = TextureFilter::Linear,
+    TextureWrap wrapS = TextureWrap::Repeat,
+    TextureWrap wrapT = TextureWrap::Repeat)
+{
+    return std::make_unique<Texture>(format, internalFormat, levels, unit, minFilter, magFilter, wrapS, wrapT);
+}
+
 inline std::unique_ptr<Texture> CreateEmptyTexture(
     int width, int height, int depth,
     TextureType type,
@@ -187,3 +329,14 @@ inline std::unique_ptr<Texture> CreateEmptyTexture(
                                      unit, minFilter, magFilter, wrapS, wrapT, wrapR);
 }
 
+inline std::unique_ptr<Texture> CreateRenderTexture(
+    int width, int height,
+    TextureInternalFormat internalFormat,
+    int levels = 1,
+    int samples = 1,
+    TextureFilter minFilter = TextureFilter::Linear,
+    TextureFilter magFilter = TextureFilter::Linear,
+    TextureWrap wrap = TextureWrap::ClampToEdge)
+{
+    return std::make_unique<Texture>(width, height, internalFormat, levels, samples, minFilter, magFilter, wrap);
+}
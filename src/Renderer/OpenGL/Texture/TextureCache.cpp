@@ -0,0 +1,191 @@
+#include "TextureCache.h"
+#include <algorithm>
+#include <vector>
+#include <spdlog/spdlog.h>
+
+TextureCache::TextureCache(size_t budgetBytes)
+    : budget(budgetBytes)
+{
+}
+
+std::shared_ptr<Texture> TextureCache::Find(const TextureCacheKey& key) {
+    auto it = entries.find(key);
+    if (it != entries.end()) {
+        if (auto texture = it->second.texture.lock()) {
+            ++stats.hits;
+            stats.savedBytes += it->second.bytes;
+            it->second.lastUsedFrame = frame;
+            return texture;
+        }
+    }
+
+    ++stats.misses;
+    return nullptr;
+}
+
+bool TextureCache::Contains(const TextureCacheKey& key) const {
+    auto it = entries.find(key);
+    return it != entries.end() && !it->second.texture.expired();
+}
+
+void TextureCache::Insert(const TextureCacheKey& key, const std::shared_ptr<Texture>& texture) {
+    if (!texture) return;
+
+    auto it = entries.find(key);
+    if (it != entries.end()) {
+        // Replacing an existing entry, expired or not: its bytes leave the resident total and the old
+        // texture, if still alive, is no longer tracked here.
+        stats.residentBytes -= it->second.bytes;
+        for (auto byTexture = keysByTexture.begin(); byTexture != keysByTexture.end(); ++byTexture) {
+            if (byTexture->second == key) {
+                keysByTexture.erase(byTexture);
+                break;
+            }
+        }
+    }
+
+    Entry& entry = entries[key];
+    entry.texture = texture;
+    entry.bytes = texture->GetMemorySize();
+    entry.lastUsedFrame = frame;
+    keysByTexture[texture.get()] = key;
+
+    stats.residentBytes += entry.bytes;
+    stats.peakResidentBytes = std::max(stats.peakResidentBytes, stats.residentBytes);
+}
+
+void TextureCache::Touch(const Texture* texture) {
+    auto it = keysByTexture.find(texture);
+    if (it == keysByTexture.end()) return;
+
+    auto entry = entries.find(it->second);
+    if (entry != entries.end()) entry->second.lastUsedFrame = frame;
+}
+
+void TextureCache::UpdateSize(const Texture* texture) {
+    auto it = keysByTexture.find(texture);
+    if (it == keysByTexture.end()) return;
+
+    auto entry = entries.find(it->second);
+    if (entry == entries.end() || entry->second.texture.expired()) return;
+
+    const size_t bytes = texture->GetMemorySize();
+    stats.residentBytes = stats.residentBytes - entry->second.bytes + bytes;
+    stats.peakResidentBytes = std::max(stats.peakResidentBytes, stats.residentBytes);
+    entry->second.bytes = bytes;
+}
+
+void TextureCache::BeginFrame() {
+    ++frame;
+    purgeExpired();
+    if (stats.residentBytes > budget) {
+        enforceBudget();
+    } else {
+        promoteRecent();
+    }
+}
+
+void TextureCache::purgeExpired() {
+    for (auto it = entries.begin(); it != entries.end();) {
+        if (it->second.texture.expired()) {
+            stats.residentBytes -= it->second.bytes;
+            ++stats.evictions;
+            it = entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    // Texture addresses of released entries may be reused by new allocations.
+    for (auto it = keysByTexture.begin(); it != keysByTexture.end();) {
+        if (entries.find(it->second) == entries.end()) {
+            it = keysByTexture.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void TextureCache::enforceBudget() {
+    std::vector<Entry*> candidates;
+    for (auto& [key, entry] : entries) {
+        // Textures drawn this frame stay sharp; demoting them would only cause visible popping.
+        if (entry.lastUsedFrame + 1 >= frame) continue;
+        candidates.push_back(&entry);
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [](const Entry* a, const Entry* b) {
+        return a->lastUsedFrame < b->lastUsedFrame;
+    });
+
+    // Drop one level at a time from the oldest texture first; each step frees about 3/4 of it.
+    bool demoted = true;
+    while (stats.residentBytes > budget && demoted) {
+        demoted = false;
+        for (Entry* entry : candidates) {
+            if (stats.residentBytes <= budget) break;
+
+            auto texture = entry->texture.lock();
+            if (!texture || std::max(texture->width, texture->height) <= minimumDemotionSize) continue;
+            if (!texture->DropMipLevels(1)) continue;
+
+            size_t bytes = texture->GetMemorySize();
+            stats.residentBytes -= entry->bytes - bytes;
+            entry->bytes = bytes;
+            ++stats.demotions;
+            demoted = true;
+        }
+    }
+
+    if (stats.residentBytes > budget) {
+        spdlog::warn("Texture cache is {:.1f} MB over its {:.1f} MB budget with nothing left to demote",
+                     (stats.residentBytes - budget) / (1024.0 * 1024.0), budget / (1024.0 * 1024.0));
+    }
+}
+
+void TextureCache::promoteRecent() {
+    std::vector<Entry*> candidates;
+    for (auto& [key, entry] : entries) {
+        // Only textures that were drawn; anything else would be the next to be demoted again.
+        if (entry.lastUsedFrame + 1 < frame) continue;
+        auto texture = entry.texture.lock();
+        if (texture && texture->GetDroppedLevelCount() > 0) candidates.push_back(&entry);
+    }
+    if (candidates.empty()) return;
+
+    std::sort(candidates.begin(), candidates.end(), [](const Entry* a, const Entry* b) {
+        return a->lastUsedFrame > b->lastUsedFrame;
+    });
+
+    // One level per texture per frame, smallest missing level first, as long as it fits the budget.
+    size_t restored = 0;
+    for (Entry* entry : candidates) {
+        if (restored >= promotionBytesPerFrame) break;
+
+        auto texture = entry->texture.lock();
+        const size_t bytes = texture->GetRestoredMemorySize(1);
+        if (stats.residentBytes - entry->bytes + bytes > budget) continue;
+        if (texture->RestoreMipLevels(1) == 0) continue;
+
+        restored += bytes - entry->bytes;
+        stats.residentBytes = stats.residentBytes - entry->bytes + bytes;
+        stats.peakResidentBytes = std::max(stats.peakResidentBytes, stats.residentBytes);
+        entry->bytes = bytes;
+        ++stats.promotions;
+    }
+}
+
+void TextureCache::LogStats() const {
+    size_t lookups = stats.hits + stats.misses;
+    spdlog::info("Texture cache: {} hits / {} misses ({:.0f}% hit rate), {} evictions, {} demotions, "
+                 "{} promotions, {:.1f} MB resident (peak {:.1f} MB), {:.1f} MB deduplicated",
+                 stats.hits, stats.misses, lookups ? 100.0 * stats.hits / lookups : 0.0,
+                 stats.evictions, stats.demotions, stats.promotions,
+                 stats.residentBytes / (1024.0 * 1024.0), stats.peakResidentBytes / (1024.0 * 1024.0),
+                 stats.savedBytes / (1024.0 * 1024.0));
+}
+
+TextureCache& GetTextureCache() {
+    static TextureCache cache;
+    return cache;
+}
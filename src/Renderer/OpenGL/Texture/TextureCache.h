@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include "Texture.h"
+
+// Process-wide texture cache keyed by image content and the parameters the texture was built with.
+// Entries hold weak references: a texture lives as long as some model or material owns it, and
+// identical images loaded by different models share one GPU texture. When resident textures exceed
+// the VRAM budget, the least recently used ones drop their largest mip levels into system memory;
+// once a demoted texture is drawn again and the budget has room, those levels are uploaded again.
+
+struct TextureCacheKey {
+    uint64_t content = 0;       // hash of the encoded source bytes
+    uint64_t parameters = 0;    // hash of usage and format settings; sampling lives in samplers
+
+    bool operator==(const TextureCacheKey& other) const {
+        return content == other.content && parameters == other.parameters;
+    }
+};
+
+struct TextureCacheKeyHash {
+    size_t operator()(const TextureCacheKey& key) const {
+        return static_cast<size_t>(key.content ^ (key.parameters * 0x9e3779b97f4a7c15ull));
+    }
+};
+
+struct TextureCacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;           // entries dropped after their last owner released them
+    size_t demotions = 0;           // times a texture lost mip levels to the budget
+    size_t promotions = 0;          // times a drawn texture got a dropped level back
+    size_t residentBytes = 0;
+    size_t peakResidentBytes = 0;
+    size_t savedBytes = 0;          // VRAM that hits did not allocate again
+};
+
+class TextureCache {
+    public:
+        explicit TextureCache(size_t budgetBytes = size_t(2) * 1024 * 1024 * 1024);
+
+        TextureCache(const TextureCache&) = delete;
+        TextureCache& operator=(const TextureCache&) = delete;
+
+        // Counts a hit or a miss; returns nullptr on a miss or if the texture was already released.
+        std::shared_ptr<Texture> Find(const TextureCacheKey& key);
+        // Lookup without touching stats or LRU order, for deciding whether source data is needed.
+        bool Contains(const TextureCacheKey& key) const;
+
+        void Insert(const TextureCacheKey& key, const std::shared_ptr<Texture>& texture);
+
+        // Marks a texture as used this frame; unknown textures are ignored.
+        void Touch(const Texture* texture);
+        // Re-reads the size of a texture whose storage was replaced, e.g. by Texture::SwapStorage
+        // on a hot reload, so the resident total and the budget stay right. Unknown textures are ignored.
+        void UpdateSize(const Texture* texture);
+
+        // Advances the LRU clock, drops released entries and enforces the budget, or restores
+        // dropped levels of textures drawn last frame while there is room under it.
+        void BeginFrame();
+
+        void SetBudget(size_t bytes) { budget = bytes; }
+        size_t GetBudget() const { return budget; }
+
+        // Textures with a largest side at or below this are never demoted.
+        void SetMinimumDemotionSize(int size) { minimumDemotionSize = size; }
+        // Upper bound on the VRAM restored per frame, to spread the uploads out.
+        void SetPromotionBytesPerFrame(size_t bytes) { promotionBytesPerFrame = bytes; }
+
+        const TextureCacheStats& GetStats() const { return stats; }
+        void LogStats() const;
+
+    private:
+        struct Entry {
+            std::weak_ptr<Texture> texture;
+            size_t bytes = 0;
+            uint64_t lastUsedFrame = 0;
+        };
+
+        void purgeExpired();
+        void enforceBudget();
+        void promoteRecent();
+
+        std::unordered_map<TextureCacheKey, Entry, TextureCacheKeyHash> entries;
+        std::unordered_map<const Texture*, TextureCacheKey> keysByTexture;
+
+        size_t budget;
+        int minimumDemotionSize = 128;
+        size_t promotionBytesPerFrame = size_t(64) * 1024 * 1024;
+        uint64_t frame = 0;
+        TextureCacheStats stats;
+};
+
+TextureCache& GetTextureCache();
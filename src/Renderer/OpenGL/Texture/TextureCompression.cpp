@@ -0,0 +1,1009 @@
+#include "TextureCompression.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <spdlog/spdlog.h>
+
+#include "../../../Utils/AtomicFile.h"
+#include "../../../Utils/Hash.h"
+#include "../../../Utils/ThreadPool.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TEXTURE_COMPRESSION_SSE2 1
+#endif
+
+std::vector<TextureMipData> CompressedImage::GetMipData() const {
+    std::vector<TextureMipData> mips;
+    for (size_t level = 0; level < levels.size(); ++level) {
+        mips.push_back({
+            std::max(1, width >> level),
+            std::max(1, height >> level),
+            levels[level].data(),
+            levels[level].size()
+        });
+    }
+    return mips;
+}
+
+size_t CompressedImage::GetSize() const {
+    size_t size = 0;
+    for (const auto& level : levels) size += level.size();
+    return size;
+}
+
+namespace {
+
+struct Block {
+    uint8_t rgba[16][4];
+};
+
+void LoadBlock(const unsigned char* rgba, int width, int height, int bx, int by, Block& block) {
+    // Partial edge blocks repeat the last row/column.
+    for (int y = 0; y < 4; ++y) {
+        int sy = std::min(by * 4 + y, height - 1);
+        for (int x = 0; x < 4; ++x) {
+            int sx = std::min(bx * 4 + x, width - 1);
+            std::memcpy(block.rgba[y * 4 + x], rgba + (static_cast<size_t>(sy) * width + sx) * 4, 4);
+        }
+    }
+}
+
+void BlockMinMax(const Block& block, uint8_t minColor[4], uint8_t maxColor[4]) {
+#ifdef TEXTURE_COMPRESSION_SSE2
+    const __m128i* rows = reinterpret_cast<const __m128i*>(block.rgba);
+    __m128i r0 = _mm_loadu_si128(rows + 0);
+    __m128i r1 = _mm_loadu_si128(rows + 1);
+    __m128i r2 = _mm_loadu_si128(rows + 2);
+    __m128i r3 = _mm_loadu_si128(rows + 3);
+
+    __m128i lo = _mm_min_epu8(_mm_min_epu8(r0, r1), _mm_min_epu8(r2, r3));
+    __m128i hi = _mm_max_epu8(_mm_max_epu8(r0, r1), _mm_max_epu8(r2, r3));
+    lo = _mm_min_epu8(lo, _mm_srli_si128(lo, 8));
+    hi = _mm_max_epu8(hi, _mm_srli_si128(hi, 8));
+    lo = _mm_min_epu8(lo, _mm_srli_si128(lo, 4));
+    hi = _mm_max_epu8(hi, _mm_srli_si128(hi, 4));
+
+    int packedMin = _mm_cvtsi128_si32(lo);
+    int packedMax = _mm_cvtsi128_si32(hi);
+    std::memcpy(minColor, &packedMin, 4);
+    std::memcpy(maxColor, &packedMax, 4);
+#else
+    for (int c = 0; c < 4; ++c) {
+        minColor[c] = 255;
+        maxColor[c] = 0;
+    }
+    for (int i = 0; i < 16; ++i) {
+        for (int c = 0; c < 4; ++c) {
+            minColor[c] = std::min(minColor[c], block.rgba[i][c]);
+            maxColor[c] = std::max(maxColor[c], block.rgba[i][c]);
+        }
+    }
+#endif
+}
+
+// Principal axis of the block colors over the first `channels` components.
+void PrincipalAxis(const Block& block, int channels, const uint8_t minColor[4], const uint8_t maxColor[4],
+                   float mean[4], float axis[4]) {
+    for (int c = 0; c < 4; ++c) {
+        mean[c] = 0.0f;
+        axis[c] = 0.0f;
+    }
+    for (int i = 0; i < 16; ++i) {
+        for (int c = 0; c < channels; ++c) mean[c] += block.rgba[i][c];
+    }
+    for (int c = 0; c < channels; ++c) mean[c] /= 16.0f;
+
+    float covariance[4][4] = {};
+    for (int i = 0; i < 16; ++i) {
+        float d[4];
+        for (int c = 0; c < channels; ++c) d[c] = block.rgba[i][c] - mean[c];
+        for (int a = 0; a < channels; ++a) {
+            for (int b = a; b < channels; ++b) covariance[a][b] += d[a] * d[b];
+        }
+    }
+    for (int a = 0; a < channels; ++a) {
+        for (int b = 0; b < a; ++b) covariance[a][b] = covariance[b][a];
+    }
+
+    // Power iteration seeded with the bounding box diagonal.
+    for (int c = 0; c < channels; ++c) axis[c] = static_cast<float>(maxColor[c] - minColor[c]);
+    for (int iteration = 0; iteration < 8; ++iteration) {
+        float next[4] = {};
+        for (int a = 0; a < channels; ++a) {
+            for (int b = 0; b < channels; ++b) next[a] += covariance[a][b] * axis[b];
+        }
+        float length = 0.0f;
+        for (int c = 0; c < channels; ++c) length = std::max(length, std::fabs(next[c]));
+        if (length < 1e-6f) break;
+        for (int c = 0; c < channels; ++c) axis[c] = next[c] / length;
+    }
+
+    // Unit length, so projecting onto the axis and stepping back along it cover the same distance
+    float squaredLength = 0.0f;
+    for (int c = 0; c < channels; ++c) squaredLength += axis[c] * axis[c];
+    if (squaredLength > 0.0f) {
+        const float inverseLength = 1.0f / std::sqrt(squaredLength);
+        for (int c = 0; c < channels; ++c) axis[c] *= inverseLength;
+    }
+}
+
+// Solves for the two endpoints that minimize squared error given fixed interpolation weights.
+bool LeastSquaresEndpoints(const Block& block, int channels, const int* indices, const float* weights,
+                           float endpoint0[4], float endpoint1[4]) {
+    float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+    float ax[4] = {}, bx[4] = {};
+    for (int i = 0; i < 16; ++i) {
+        float b = weights[indices[i]];
+        float a = 1.0f - b;
+        aa += a * a;
+        ab += a * b;
+        bb += b * b;
+        for (int c = 0; c < channels; ++c) {
+            ax[c] += a * block.rgba[i][c];
+            bx[c] += b * block.rgba[i][c];
+        }
+    }
+
+    float determinant = aa * bb - ab * ab;
+    if (std::fabs(determinant) < 1e-6f) return false;
+
+    float inverse = 1.0f / determinant;
+    for (int c = 0; c < channels; ++c) {
+        endpoint0[c] = std::clamp((ax[c] * bb - bx[c] * ab) * inverse, 0.0f, 255.0f);
+        endpoint1[c] = std::clamp((bx[c] * aa - ax[c] * ab) * inverse, 0.0f, 255.0f);
+    }
+    return true;
+}
+
+// --- BC1 -------------------------------------------------------------------
+
+uint16_t PackRGB565(const float color[4]) {
+    int r = std::clamp(static_cast<int>(color[0] * 31.0f / 255.0f + 0.5f), 0, 31);
+    int g = std::clamp(static_cast<int>(color[1] * 63.0f / 255.0f + 0.5f), 0, 63);
+    int b = std::clamp(static_cast<int>(color[2] * 31.0f / 255.0f + 0.5f), 0, 31);
+    return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+void UnpackRGB565(uint16_t packed, int color[3]) {
+    int r = (packed >> 11) & 31;
+    int g = (packed >> 5) & 63;
+    int b = packed & 31;
+    color[0] = (r << 3) | (r >> 2);
+    color[1] = (g << 2) | (g >> 4);
+    color[2] = (b << 3) | (b >> 2);
+}
+
+void BC1Palette(uint16_t c0, uint16_t c1, int palette[4][3]) {
+    UnpackRGB565(c0, palette[0]);
+    UnpackRGB565(c1, palette[1]);
+    for (int c = 0; c < 3; ++c) {
+        if (c0 > c1) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        } else {
+            palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+            palette[3][c] = 0;
+        }
+    }
+}
+
+int BC1Indices(const Block& block, uint16_t c0, uint16_t c1, int indices[16]) {
+    int palette[4][3];
+    BC1Palette(c0, c1, palette);
+
+    int error = 0;
+    for (int i = 0; i < 16; ++i) {
+        int best = 0;
+        int bestDistance = INT32_MAX;
+        for (int p = 0; p < 4; ++p) {
+            int dr = block.rgba[i][0] - palette[p][0];
+            int dg = block.rgba[i][1] - palette[p][1];
+            int db = block.rgba[i][2] - palette[p][2];
+            int distance = dr * dr + dg * dg + db * db;
+            if (distance < bestDistance) {
+                bestDistance = distance;
+                best = p;
+            }
+        }
+        indices[i] = best;
+        error += bestDistance;
+    }
+    return error;
+}
+
+// Endpoint pair per 8-bit value whose 2/3 : 1/3 blend decodes closest to it. No pair hits every
+// value, so solid blocks are within one step, and exact whenever the color fits in RGB565.
+struct SingleColorMatch {
+    uint8_t endpoint0;
+    uint8_t endpoint1;
+};
+
+std::array<SingleColorMatch, 256> BuildSingleColorTable(int bits) {
+    const int count = 1 << bits;
+    auto expand = [bits](int value) { return (value << (8 - bits)) | (value >> (2 * bits - 8)); };
+
+    std::array<SingleColorMatch, 256> table{};
+    for (int value = 0; value < 256; ++value) {
+        int bestError = INT32_MAX;
+        for (int e0 = 0; e0 < count; ++e0) {
+            for (int e1 = 0; e1 < count; ++e1) {
+                // Ties go to the closer pair, which other decoders' rounding moves the least
+                int error = std::abs((2 * expand(e0) + expand(e1)) / 3 - value) * 256 + std::abs(e0 - e1);
+                if (error < bestError) {
+                    bestError = error;
+                    table[value] = {static_cast<uint8_t>(e0), static_cast<uint8_t>(e1)};
+                }
+            }
+        }
+    }
+    return table;
+}
+
+void EncodeBC1Solid(const uint8_t color[4], uint8_t* out) {
+    static const std::array<SingleColorMatch, 256> match5 = BuildSingleColorTable(5);
+    static const std::array<SingleColorMatch, 256> match6 = BuildSingleColorTable(6);
+
+    const SingleColorMatch& r = match5[color[0]];
+    const SingleColorMatch& g = match6[color[1]];
+    const SingleColorMatch& b = match5[color[2]];
+    uint16_t c0 = static_cast<uint16_t>((r.endpoint0 << 11) | (g.endpoint0 << 5) | b.endpoint0);
+    uint16_t c1 = static_cast<uint16_t>((r.endpoint1 << 11) | (g.endpoint1 << 5) | b.endpoint1);
+
+    // Index 2 is the 2/3 blend in four-color mode; swapped endpoints reach it through index 3, and
+    // equal ones select three-color mode where index 2 is c0 again
+    uint32_t index = 2;
+    if (c0 < c1) {
+        std::swap(c0, c1);
+        index = 3;
+    }
+    uint32_t packedIndices = 0;
+    for (int i = 0; i < 16; ++i) packedIndices |= index << (2 * i);
+
+    std::memcpy(out, &c0, 2);
+    std::memcpy(out + 2, &c1, 2);
+    std::memcpy(out + 4, &packedIndices, 4);
+}
+
+void EncodeBC1(const Block& block, uint8_t* out) {
+    uint8_t minColor[4], maxColor[4];
+    BlockMinMax(block, minColor, maxColor);
+
+    if (minColor[0] == maxColor[0] && minColor[1] == maxColor[1] && minColor[2] == maxColor[2]) {
+        EncodeBC1Solid(minColor, out);
+        return;
+    }
+
+    float mean[4], axis[4];
+    PrincipalAxis(block, 3, minColor, maxColor, mean, axis);
+
+    float minT = 0.0f, maxT = 0.0f;
+    for (int i = 0; i < 16; ++i) {
+        float t = 0.0f;
+        for (int c = 0; c < 3; ++c) t += (block.rgba[i][c] - mean[c]) * axis[c];
+        minT = std::min(minT, t);
+        maxT = std::max(maxT, t);
+    }
+
+    float endpoint0[4] = {}, endpoint1[4] = {};
+    for (int c = 0; c < 3; ++c) {
+        endpoint0[c] = std::clamp(mean[c] + axis[c] * maxT, 0.0f, 255.0f);
+        endpoint1[c] = std::clamp(mean[c] + axis[c] * minT, 0.0f, 255.0f);
+    }
+
+    uint16_t c0 = PackRGB565(endpoint0);
+    uint16_t c1 = PackRGB565(endpoint1);
+    if (c0 < c1) std::swap(c0, c1);
+
+    int indices[16];
+    int error = BC1Indices(block, c0, c1, indices);
+
+    // One refinement pass; palette index order is e0, e1, 1/3, 2/3.
+    static const float weights[4] = {0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f};
+    if (c0 != c1 && LeastSquaresEndpoints(block, 3, indices, weights, endpoint0, endpoint1)) {
+        uint16_t r0 = PackRGB565(endpoint0);
+        uint16_t r1 = PackRGB565(endpoint1);
+        if (r0 < r1) std::swap(r0, r1);
+        if (r0 != r1) {
+            int refined[16];
+            int refinedError = BC1Indices(block, r0, r1, refined);
+            if (refinedError < error) {
+                c0 = r0;
+                c1 = r1;
+                std::memcpy(indices, refined, sizeof(refined));
+            }
+        }
+    }
+
+    if (c0 == c1) {
+        // Both endpoints quantized to the same color: c0 == c1 selects three-color mode, index 0 is still c0.
+        std::fill(indices, indices + 16, 0);
+    }
+
+    uint32_t packedIndices = 0;
+    for (int i = 0; i < 16; ++i) packedIndices |= static_cast<uint32_t>(indices[i]) << (2 * i);
+
+    std::memcpy(out, &c0, 2);
+    std::memcpy(out + 2, &c1, 2);
+    std::memcpy(out + 4, &packedIndices, 4);
+}
+
+void DecodeBC1(const uint8_t* in, uint8_t pixels[16][4]) {
+    uint16_t c0, c1;
+    uint32_t packedIndices;
+    std::memcpy(&c0, in, 2);
+    std::memcpy(&c1, in + 2, 2);
+    std::memcpy(&packedIndices, in + 4, 4);
+
+    int palette[4][3];
+    BC1Palette(c0, c1, palette);
+
+    for (int i = 0; i < 16; ++i) {
+        int index = (packedIndices >> (2 * i)) & 3;
+        for (int c = 0; c < 3; ++c) pixels[i][c] = static_cast<uint8_t>(palette[index][c]);
+        pixels[i][3] = (c0 <= c1 && index == 3) ? 0 : 255;
+    }
+}
+
+// --- BC4 (BC3 alpha, BC5 channels) ----------------------------------------
+
+void BC4Palette(int a0, int a1, int palette[8]) {
+    palette[0] = a0;
+    palette[1] = a1;
+    if (a0 > a1) {
+        for (int i = 1; i < 7; ++i) palette[i + 1] = ((7 - i) * a0 + i * a1) / 7;
+    } else {
+        for (int i = 1; i < 5; ++i) palette[i + 1] = ((5 - i) * a0 + i * a1) / 5;
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+}
+
+void EncodeBC4(const Block& block, int channel, uint8_t* out) {
+    int lo = 255, hi = 0;
+    for (int i = 0; i < 16; ++i) {
+        lo = std::min<int>(lo, block.rgba[i][channel]);
+        hi = std::max<int>(hi, block.rgba[i][channel]);
+    }
+
+    int palette[8];
+    BC4Palette(hi, lo, palette);
+
+    uint64_t packedIndices = 0;
+    if (hi != lo) {
+        for (int i = 0; i < 16; ++i) {
+            int value = block.rgba[i][channel];
+            int best = 0;
+            int bestDistance = INT32_MAX;
+            for (int p = 0; p < 8; ++p) {
+                int distance = std::abs(value - palette[p]);
+                if (distance < bestDistance) {
+                    bestDistance = distance;
+                    best = p;
+                }
+            }
+            packedIndices |= static_cast<uint64_t>(best) << (3 * i);
+        }
+    }
+
+    out[0] = static_cast<uint8_t>(hi);
+    out[1] = static_cast<uint8_t>(lo);
+    for (int i = 0; i < 6; ++i) out[2 + i] = static_cast<uint8_t>(packedIndices >> (8 * i));
+}
+
+void DecodeBC4(const uint8_t* in, uint8_t pixels[16][4], int channel) {
+    int palette[8];
+    BC4Palette(in[0], in[1], palette);
+
+    uint64_t packedIndices = 0;
+    for (int i = 0; i < 6; ++i) packedIndices |= static_cast<uint64_t>(in[2 + i]) << (8 * i);
+
+    for (int i = 0; i < 16; ++i) {
+        pixels[i][channel] = static_cast<uint8_t>(palette[(packedIndices >> (3 * i)) & 7]);
+    }
+}
+
+// --- BC7 modes 5 and 6 -------------------------------------------------------
+
+const int bc7Weights2[4] = {0, 21, 43, 64};
+const int bc7Weights4[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+struct BC7Endpoint {
+    int quantized[4];   // 7 bits per channel
+    int pbit;
+
+    int Value(int channel) const { return (quantized[channel] << 1) | pbit; }
+};
+
+BC7Endpoint QuantizeBC7Endpoint(const float color[4]) {
+    BC7Endpoint best{};
+    float bestError = 1e30f;
+
+    for (int pbit = 0; pbit < 2; ++pbit) {
+        BC7Endpoint candidate{};
+        candidate.pbit = pbit;
+        float error = 0.0f;
+        for (int c = 0; c < 4; ++c) {
+            candidate.quantized[c] = std::clamp(static_cast<int>(std::lround((color[c] - pbit) * 0.5f)), 0, 127);
+            float difference = color[c] - candidate.Value(c);
+            error += difference * difference;
+        }
+        if (error < bestError) {
+            bestError = error;
+            best = candidate;
+        }
+    }
+    return best;
+}
+
+int BC7Interpolate(int e0, int e1, int weight) {
+    return ((64 - weight) * e0 + weight * e1 + 32) >> 6;
+}
+
+int BC7Indices(const Block& block, const BC7Endpoint& e0, const BC7Endpoint& e1, int indices[16]) {
+    int palette[16][4];
+    for (int p = 0; p < 16; ++p) {
+        for (int c = 0; c < 4; ++c) palette[p][c] = BC7Interpolate(e0.Value(c), e1.Value(c), bc7Weights4[p]);
+    }
+
+    int error = 0;
+    for (int i = 0; i < 16; ++i) {
+        int best = 0;
+        int bestDistance = INT32_MAX;
+        for (int p = 0; p < 16; ++p) {
+            int distance = 0;
+            for (int c = 0; c < 4; ++c) {
+                int d = block.rgba[i][c] - palette[p][c];
+                distance += d * d;
+            }
+            if (distance < bestDistance) {
+                bestDistance = distance;
+                best = p;
+            }
+        }
+        indices[i] = best;
+        error += bestDistance;
+    }
+    return error;
+}
+
+class BitWriter {
+public:
+    explicit BitWriter(uint8_t* out) : out(out) { std::memset(out, 0, 16); }
+
+    void Write(uint32_t value, int bits) {
+        for (int i = 0; i < bits; ++i, ++position) {
+            if (value & (1u << i)) out[position >> 3] |= static_cast<uint8_t>(1u << (position & 7));
+        }
+    }
+
+private:
+    uint8_t* out;
+    int position = 0;
+};
+
+class BitReader {
+public:
+    explicit BitReader(const uint8_t* in) : in(in) {}
+
+    uint32_t Read(int bits) {
+        uint32_t value = 0;
+        for (int i = 0; i < bits; ++i, ++position) {
+            value |= static_cast<uint32_t>((in[position >> 3] >> (position & 7)) & 1) << i;
+        }
+        return value;
+    }
+
+private:
+    const uint8_t* in;
+    int position = 0;
+};
+
+void WriteBC7Mode6(const BC7Endpoint& e0, const BC7Endpoint& e1, const int indices[16], uint8_t* out) {
+    BitWriter writer(out);
+    writer.Write(1u << 6, 7);
+    for (int c = 0; c < 4; ++c) {
+        writer.Write(e0.quantized[c], 7);
+        writer.Write(e1.quantized[c], 7);
+    }
+    writer.Write(e0.pbit, 1);
+    writer.Write(e1.pbit, 1);
+    writer.Write(indices[0], 3);
+    for (int i = 1; i < 16; ++i) writer.Write(indices[i], 4);
+}
+
+// Mode 5 endpoint pair per 8-bit value whose 1/3 blend decodes to exactly that value. Mode 6 cannot
+// hold every solid color (its shared p-bits miss e.g. opaque black), mode 5's 7-bit color endpoints
+// at weight 21 reach all 256 values and its alpha endpoints are 8-bit, so solid blocks use mode 5.
+std::array<SingleColorMatch, 256> BuildBC7SolidTable() {
+    auto expand = [](int value) { return (value << 1) | (value >> 6); };
+
+    std::array<SingleColorMatch, 256> table{};
+    for (int value = 0; value < 256; ++value) {
+        int bestError = INT32_MAX;
+        for (int e0 = 0; e0 < 128 && bestError > 0; ++e0) {
+            for (int e1 = 0; e1 < 128; ++e1) {
+                int error = std::abs(BC7Interpolate(expand(e0), expand(e1), bc7Weights2[1]) - value);
+                if (error < bestError) {
+                    bestError = error;
+                    table[value] = {static_cast<uint8_t>(e0), static_cast<uint8_t>(e1)};
+                }
+            }
+        }
+    }
+    return table;
+}
+
+void EncodeBC7Solid(const uint8_t color[4], uint8_t* out) {
+    static const std::array<SingleColorMatch, 256> match = BuildBC7SolidTable();
+
+    // Mode 5, no rotation; every color index is 1 and every alpha index 0, anchors included
+    BitWriter writer(out);
+    writer.Write(1u << 5, 6);
+    writer.Write(0, 2);
+    for (int c = 0; c < 3; ++c) {
+        writer.Write(match[color[c]].endpoint0, 7);
+        writer.Write(match[color[c]].endpoint1, 7);
+    }
+    writer.Write(color[3], 8);
+    writer.Write(color[3], 8);
+    writer.Write(1, 1);
+    for (int i = 1; i < 16; ++i) writer.Write(1, 2);
+}
+
+void EncodeBC7(const Block& block, uint8_t* out) {
+    uint8_t minColor[4], maxColor[4];
+    BlockMinMax(block, minColor, maxColor);
+
+    if (std::memcmp(minColor, maxColor, 4) == 0) {
+        EncodeBC7Solid(minColor, out);
+        return;
+    }
+
+    float mean[4], axis[4];
+    PrincipalAxis(block, 4, minColor, maxColor, mean, axis);
+
+    float minT = 0.0f, maxT = 0.0f;
+    for (int i = 0; i < 16; ++i) {
+        float t = 0.0f;
+        for (int c = 0; c < 4; ++c) t += (block.rgba[i][c] - mean[c]) * axis[c];
+        minT = std::min(minT, t);
+        maxT = std::max(maxT, t);
+    }
+
+    float endpoint0[4], endpoint1[4];
+    for (int c = 0; c < 4; ++c) {
+        endpoint0[c] = std::clamp(mean[c] + axis[c] * minT, 0.0f, 255.0f);
+        endpoint1[c] = std::clamp(mean[c] + axis[c] * maxT, 0.0f, 255.0f);
+    }
+
+    BC7Endpoint e0 = QuantizeBC7Endpoint(endpoint0);
+    BC7Endpoint e1 = QuantizeBC7Endpoint(endpoint1);
+
+    int indices[16];
+    int error = BC7Indices(block, e0, e1, indices);
+
+    float weights[16];
+    for (int p = 0; p < 16; ++p) weights[p] = bc7Weights4[p] / 64.0f;
+
+    if (error > 0 && LeastSquaresEndpoints(block, 4, indices, weights, endpoint0, endpoint1)) {
+        BC7Endpoint r0 = QuantizeBC7Endpoint(endpoint0);
+        BC7Endpoint r1 = QuantizeBC7Endpoint(endpoint1);
+        int refined[16];
+        int refinedError = BC7Indices(block, r0, r1, refined);
+        if (refinedError < error) {
+            e0 = r0;
+            e1 = r1;
+            std::memcpy(indices, refined, sizeof(refined));
+        }
+    }
+
+    // The anchor index is stored without its top bit, so it must be < 8.
+    if (indices[0] >= 8) {
+        std::swap(e0, e1);
+        for (int& index : indices) index = 15 - index;
+    }
+
+    WriteBC7Mode6(e0, e1, indices, out);
+}
+
+void DecodeBC7Mode5(BitReader& reader, uint8_t pixels[16][4]) {
+    int rotation = static_cast<int>(reader.Read(2));
+
+    int e0[4], e1[4];
+    for (int c = 0; c < 3; ++c) {
+        int q0 = static_cast<int>(reader.Read(7));
+        int q1 = static_cast<int>(reader.Read(7));
+        e0[c] = (q0 << 1) | (q0 >> 6);
+        e1[c] = (q1 << 1) | (q1 >> 6);
+    }
+    e0[3] = static_cast<int>(reader.Read(8));
+    e1[3] = static_cast<int>(reader.Read(8));
+
+    int colorIndices[16], alphaIndices[16];
+    for (int i = 0; i < 16; ++i) colorIndices[i] = static_cast<int>(reader.Read(i == 0 ? 1 : 2));
+    for (int i = 0; i < 16; ++i) alphaIndices[i] = static_cast<int>(reader.Read(i == 0 ? 1 : 2));
+
+    for (int i = 0; i < 16; ++i) {
+        for (int c = 0; c < 3; ++c) {
+            pixels[i][c] = static_cast<uint8_t>(BC7Interpolate(e0[c], e1[c], bc7Weights2[colorIndices[i]]));
+        }
+        pixels[i][3] = static_cast<uint8_t>(BC7Interpolate(e0[3], e1[3], bc7Weights2[alphaIndices[i]]));
+        if (rotation > 0) std::swap(pixels[i][3], pixels[i][rotation - 1]);
+    }
+}
+
+bool DecodeBC7(const uint8_t* in, uint8_t pixels[16][4]) {
+    BitReader reader(in);
+    // The mode is the number of zero bits before the first set one
+    int mode = 0;
+    while (mode < 8 && reader.Read(1) == 0) ++mode;
+
+    if (mode == 5) {
+        DecodeBC7Mode5(reader, pixels);
+        return true;
+    }
+    if (mode != 6) {
+        // Only modes 5 and 6 are produced by the encoder; anything else decodes as magenta.
+        for (int i = 0; i < 16; ++i) {
+            pixels[i][0] = 255; pixels[i][1] = 0; pixels[i][2] = 255; pixels[i][3] = 255;
+        }
+        return false;
+    }
+
+    BC7Endpoint e0{}, e1{};
+    for (int c = 0; c < 4; ++c) {
+        e0.quantized[c] = reader.Read(7);
+        e1.quantized[c] = reader.Read(7);
+    }
+    e0.pbit = reader.Read(1);
+    e1.pbit = reader.Read(1);
+
+    for (int i = 0; i < 16; ++i) {
+        int index = reader.Read(i == 0 ? 3 : 4);
+        for (int c = 0; c < 4; ++c) {
+            pixels[i][c] = static_cast<uint8_t>(BC7Interpolate(e0.Value(c), e1.Value(c), bc7Weights4[index]));
+        }
+    }
+    return true;
+}
+
+void EncodeBlock(const Block& block, TextureInternalFormat format, uint8_t* out) {
+    switch (format) {
+        case TextureInternalFormat::BC1:
+            EncodeBC1(block, out);
+            break;
+        case TextureInternalFormat::BC3:
+            EncodeBC4(block, 3, out);
+            EncodeBC1(block, out + 8);
+            break;
+        case TextureInternalFormat::BC5:
+            EncodeBC4(block, 0, out);
+            EncodeBC4(block, 1, out + 8);
+            break;
+        case TextureInternalFormat::BC7:
+            EncodeBC7(block, out);
+            break;
+        default:
+            break;
+    }
+}
+
+void DecodeBlock(const uint8_t* in, TextureInternalFormat format, uint8_t pixels[16][4]) {
+    switch (format) {
+        case TextureInternalFormat::BC1:
+            DecodeBC1(in, pixels);
+            break;
+        case TextureInternalFormat::BC3:
+            DecodeBC1(in + 8, pixels);
+            DecodeBC4(in, pixels, 3);
+            break;
+        case TextureInternalFormat::BC5:
+            DecodeBC4(in, pixels, 0);
+            DecodeBC4(in + 8, pixels, 1);
+            for (int i = 0; i < 16; ++i) {
+                pixels[i][2] = 0;
+                pixels[i][3] = 255;
+            }
+            break;
+        case TextureInternalFormat::BC7:
+            DecodeBC7(in, pixels);
+            break;
+        default:
+            break;
+    }
+}
+
+// --- DDS ---------------------------------------------------------------------
+
+constexpr uint32_t MakeFourCC(char a, char b, char c, char d) {
+    return static_cast<uint32_t>(a) | (static_cast<uint32_t>(b) << 8) |
+           (static_cast<uint32_t>(c) << 16) | (static_cast<uint32_t>(d) << 24);
+}
+
+struct DDSPixelFormat {
+    uint32_t size;
+    uint32_t flags;
+    uint32_t fourCC;
+    uint32_t rgbBitCount;
+    uint32_t rBitMask;
+    uint32_t gBitMask;
+    uint32_t bBitMask;
+    uint32_t aBitMask;
+};
+
+struct DDSHeader {
+    uint32_t size;
+    uint32_t flags;
+    uint32_t height;
+    uint32_t width;
+    uint32_t pitchOrLinearSize;
+    uint32_t depth;
+    uint32_t mipMapCount;
+    uint32_t reserved1[11];
+    DDSPixelFormat pixelFormat;
+    uint32_t caps;
+    uint32_t caps2;
+    uint32_t caps3;
+    uint32_t caps4;
+    uint32_t reserved2;
+};
+
+struct DDSHeaderDX10 {
+    uint32_t dxgiFormat;
+    uint32_t resourceDimension;
+    uint32_t miscFlag;
+    uint32_t arraySize;
+    uint32_t miscFlags2;
+};
+
+static_assert(sizeof(DDSHeader) == 124, "DDS header must be 124 bytes");
+
+constexpr uint32_t DXGI_FORMAT_BC1_UNORM = 71;
+constexpr uint32_t DXGI_FORMAT_BC3_UNORM = 77;
+constexpr uint32_t DXGI_FORMAT_BC5_UNORM = 83;
+constexpr uint32_t DXGI_FORMAT_BC7_UNORM = 98;
+
+uint32_t ToDXGIFormat(TextureInternalFormat format) {
+    switch (format) {
+        case TextureInternalFormat::BC1: return DXGI_FORMAT_BC1_UNORM;
+        case TextureInternalFormat::BC3: return DXGI_FORMAT_BC3_UNORM;
+        case TextureInternalFormat::BC5: return DXGI_FORMAT_BC5_UNORM;
+        case TextureInternalFormat::BC7: return DXGI_FORMAT_BC7_UNORM;
+        default: return 0;
+    }
+}
+
+bool FromDXGIFormat(uint32_t dxgiFormat, TextureInternalFormat& format) {
+    switch (dxgiFormat) {
+        case DXGI_FORMAT_BC1_UNORM: format = TextureInternalFormat::BC1; return true;
+        case DXGI_FORMAT_BC3_UNORM: format = TextureInternalFormat::BC3; return true;
+        case DXGI_FORMAT_BC5_UNORM: format = TextureInternalFormat::BC5; return true;
+        case DXGI_FORMAT_BC7_UNORM: format = TextureInternalFormat::BC7; return true;
+        default: return false;
+    }
+}
+
+const char* FormatName(TextureInternalFormat format) {
+    switch (format) {
+        case TextureInternalFormat::BC1: return "BC1";
+        case TextureInternalFormat::BC3: return "BC3";
+        case TextureInternalFormat::BC5: return "BC5";
+        case TextureInternalFormat::BC7: return "BC7";
+        default: return "uncompressed";
+    }
+}
+
+}
+
+namespace TextureCompression {
+
+size_t GetBlockSize(TextureInternalFormat format) {
+    return format == TextureInternalFormat::BC1 ? 8 : 16;
+}
+
+size_t GetCompressedSize(TextureInternalFormat format, int width, int height) {
+    size_t blocksX = (std::max(1, width) + 3) / 4;
+    size_t blocksY = (std::max(1, height) + 3) / 4;
+    return blocksX * blocksY * GetBlockSize(format);
+}
+
+TextureInternalFormat ChooseFormat(const unsigned char* rgba, int width, int height, bool normalMap,
+                                   const TextureCompressionSettings& settings) {
+    if (normalMap) return settings.normalFormat;
+
+    size_t pixelCount = static_cast<size_t>(width) * height;
+    for (size_t i = 0; i < pixelCount; ++i) {
+        if (rgba[i * 4 + 3] != 255) return settings.alphaFormat;
+    }
+    return settings.opaqueFormat;
+}
+
+std::vector<uint8_t> Compress(const unsigned char* rgba, int width, int height, TextureInternalFormat format) {
+    const int blocksX = (width + 3) / 4;
+    const int blocksY = (height + 3) / 4;
+    const size_t blockSize = GetBlockSize(format);
+
+    std::vector<uint8_t> blocks(static_cast<size_t>(blocksX) * blocksY * blockSize);
+
+    GetThreadPool().ParallelFor(blocksY, [&](size_t by) {
+        Block block;
+        uint8_t* out = blocks.data() + by * blocksX * blockSize;
+        for (int bx = 0; bx < blocksX; ++bx) {
+            LoadBlock(rgba, width, height, bx, static_cast<int>(by), block);
+            EncodeBlock(block, format, out + bx * blockSize);
+        }
+    });
+
+    return blocks;
+}
+
+std::vector<unsigned char> Decompress(const uint8_t* blocks, int width, int height, TextureInternalFormat format) {
+    const int blocksX = (width + 3) / 4;
+    const int blocksY = (height + 3) / 4;
+    const size_t blockSize = GetBlockSize(format);
+
+    std::vector<unsigned char> rgba(static_cast<size_t>(width) * height * 4);
+
+    for (int by = 0; by < blocksY; ++by) {
+        for (int bx = 0; bx < blocksX; ++bx) {
+            uint8_t pixels[16][4] = {};
+            DecodeBlock(blocks + (static_cast<size_t>(by) * blocksX + bx) * blockSize, format, pixels);
+
+            for (int y = 0; y < 4 && by * 4 + y < height; ++y) {
+                for (int x = 0; x < 4 && bx * 4 + x < width; ++x) {
+                    std::memcpy(rgba.data() + (static_cast<size_t>(by * 4 + y) * width + bx * 4 + x) * 4,
+                                pixels[y * 4 + x], 4);
+                }
+            }
+        }
+    }
+
+    return rgba;
+}
+
+double ComputePSNR(const unsigned char* reference, const unsigned char* test, int width, int height,
+                   int channels, int comparedChannels) {
+    double squaredError = 0.0;
+    size_t pixelCount = static_cast<size_t>(width) * height;
+    for (size_t i = 0; i < pixelCount; ++i) {
+        for (int c = 0; c < comparedChannels; ++c) {
+            double difference = static_cast<double>(reference[i * channels + c]) - test[i * channels + c];
+            squaredError += difference * difference;
+        }
+    }
+
+    double meanSquaredError = squaredError / (static_cast<double>(pixelCount) * comparedChannels);
+    if (meanSquaredError <= 0.0) return INFINITY;
+    return 10.0 * std::log10(255.0 * 255.0 / meanSquaredError);
+}
+
+bool WriteDDS(const std::string& path, const CompressedImage& image) {
+    DDSHeader header{};
+    header.size = sizeof(DDSHeader);
+    header.flags = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000;
+    header.height = image.height;
+    header.width = image.width;
+    header.pitchOrLinearSize = static_cast<uint32_t>(image.levels.empty() ? 0 : image.levels[0].size());
+    header.depth = 1;
+    header.mipMapCount = static_cast<uint32_t>(image.levels.size());
+    header.pixelFormat.size = sizeof(DDSPixelFormat);
+    header.pixelFormat.flags = 0x4;
+    header.pixelFormat.fourCC = MakeFourCC('D', 'X', '1', '0');
+    header.caps = 0x1000 | (image.levels.size() > 1 ? 0x8 | 0x400000 : 0);
+
+    DDSHeaderDX10 headerDX10{};
+    headerDX10.dxgiFormat = ToDXGIFormat(image.format);
+    headerDX10.resourceDimension = 3;
+    headerDX10.arraySize = 1;
+
+    const uint32_t magic = MakeFourCC('D', 'D', 'S', ' ');
+    std::vector<FileChunk> chunks = {{&magic, sizeof(magic)}, {&header, sizeof(header)}, {&headerDX10, sizeof(headerDX10)}};
+    for (const auto& level : image.levels) {
+        chunks.push_back({level.data(), level.size()});
+    }
+
+    if (!WriteFileAtomic(path, chunks)) {
+        spdlog::error("Could not write DDS file: {}", path);
+        return false;
+    }
+    return true;
+}
+
+bool ReadDDS(const std::string& path, CompressedImage& image) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+
+    uint32_t magic = 0;
+    DDSHeader header{};
+    file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file || magic != MakeFourCC('D', 'D', 'S', ' ') || header.size != sizeof(DDSHeader)) return false;
+
+    TextureInternalFormat format;
+    uint32_t fourCC = header.pixelFormat.fourCC;
+    if (fourCC == MakeFourCC('D', 'X', '1', '0')) {
+        DDSHeaderDX10 headerDX10{};
+        file.read(reinterpret_cast<char*>(&headerDX10), sizeof(headerDX10));
+        if (!file || !FromDXGIFormat(headerDX10.dxgiFormat, format)) return false;
+    } else if (fourCC == MakeFourCC('D', 'X', 'T', '1')) {
+        format = TextureInternalFormat::BC1;
+    } else if (fourCC == MakeFourCC('D', 'X', 'T', '5')) {
+        format = TextureInternalFormat::BC3;
+    } else if (fourCC == MakeFourCC('A', 'T', 'I', '2')) {
+        format = TextureInternalFormat::BC5;
+    } else {
+        return false;
+    }
+
+    image.format = format;
+    image.width = static_cast<int>(header.width);
+    image.height = static_cast<int>(header.height);
+    image.levels.clear();
+
+    uint32_t levelCount = std::max(1u, header.mipMapCount);
+    for (uint32_t level = 0; level < levelCount; ++level) {
+        int levelWidth = std::max(1, image.width >> level);
+        int levelHeight = std::max(1, image.height >> level);
+
+        std::vector<uint8_t> data(GetCompressedSize(format, levelWidth, levelHeight));
+        file.read(reinterpret_cast<char*>(data.data()), data.size());
+        if (!file) return false;
+        image.levels.push_back(std::move(data));
+    }
+
+    return true;
+}
+
+CompressedImage TranscodeCached(const unsigned char* rgba, int width, int height, TextureInternalFormat format,
+                                const std::string& cacheDirectory, const MipSettings& mips) {
+    uint64_t key = HashBytes(rgba, static_cast<size_t>(width) * height * 4);
+    key = HashCombine(key, static_cast<uint64_t>(format));
+    key = HashCombine(key, (static_cast<uint64_t>(width) << 32) | static_cast<uint32_t>(height));
+    key = HashCombine(key, (static_cast<uint64_t>(mips.filter) << 24) | (mips.srgb << 17) |
+                           static_cast<uint32_t>(mips.maxLevels & 0xFFFF));
+    key = HashCombine(key, (static_cast<uint64_t>(mips.wrapS) << 32) | static_cast<uint32_t>(mips.wrapT));
+
+    std::filesystem::path path = std::filesystem::path(cacheDirectory) / (HashToString(key) + ".dds");
+
+    CompressedImage image;
+    if (ReadDDS(path.string(), image) && image.format == format && image.width == width && image.height == height) {
+        return image;
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    image = CompressedImage{};
+    image.format = format;
+    image.width = width;
+    image.height = height;
+
+    // The chain is filtered from uncompressed data, then every level is encoded on its own.
+    MipChain chain = MipGeneration::Generate(rgba, width, height, 4, mips);
+    for (size_t level = 0; level < chain.levels.size(); ++level) {
+        image.levels.push_back(Compress(chain.levels[level].data(), std::max(1, width >> level),
+                                        std::max(1, height >> level), format));
+    }
+
+    double milliseconds = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - start).count();
+
+    auto decoded = Decompress(image.levels[0].data(), width, height, format);
+    int comparedChannels = format == TextureInternalFormat::BC5 ? 2 : format == TextureInternalFormat::BC1 ? 3 : 4;
+    double psnr = ComputePSNR(rgba, decoded.data(), width, height, 4, comparedChannels);
+
+    spdlog::info("Transcoded {}x{} ({} levels) to {} in {:.1f} ms ({:.1f} MPix/s), PSNR {:.2f} dB, {:.1f} KB -> {:.1f} KB",
+                 width, height, image.levels.size(), FormatName(format), milliseconds,
+                 width * static_cast<double>(height) / (milliseconds * 1000.0), psnr,
+                 width * height * 4 / 1024.0, image.GetSize() / 1024.0);
+
+    WriteDDS(path.string(), image);
+
+    return image;
+}
+
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Texture.h"
+#include "TextureMips.h"
+
+// CPU block compression for BC1/BC3/BC5/BC7 plus a DDS cache so every image is transcoded once.
+// BC7 output uses mode 6 (single subset, RGBA, 4-bit indices), and mode 5 for solid blocks so
+// they decode exactly.
+
+struct CompressedImage {
+    TextureInternalFormat format = TextureInternalFormat::BC7;
+    int width = 0;
+    int height = 0;
+    std::vector<std::vector<uint8_t>> levels;   // level 0 first
+
+    std::vector<TextureMipData> GetMipData() const;
+    size_t GetSize() const;
+};
+
+struct TextureCompressionSettings {
+    TextureInternalFormat opaqueFormat = TextureInternalFormat::BC1;
+    TextureInternalFormat alphaFormat = TextureInternalFormat::BC7;
+    TextureInternalFormat normalFormat = TextureInternalFormat::BC5;
+    std::string cacheDirectory = "TextureCache";
+};
+
+namespace TextureCompression {
+    size_t GetBlockSize(TextureInternalFormat format);
+    size_t GetCompressedSize(TextureInternalFormat format, int width, int height);
+
+    TextureInternalFormat ChooseFormat(const unsigned char* rgba, int width, int height, bool normalMap,
+                                       const TextureCompressionSettings& settings = {});
+
+    // Input is tightly packed RGBA8. Block rows are spread over the worker pool.
+    std::vector<uint8_t> Compress(const unsigned char* rgba, int width, int height, TextureInternalFormat format);
+    std::vector<unsigned char> Decompress(const uint8_t* blocks, int width, int height, TextureInternalFormat format);
+
+    double ComputePSNR(const unsigned char* reference, const unsigned char* test, int width, int height,
+                       int channels = 4, int comparedChannels = 4);
+
+    // Written through a temporary file, so readers never see a partial DDS; creates the directory.
+    bool WriteDDS(const std::string& path, const CompressedImage& image);
+    bool ReadDDS(const std::string& path, CompressedImage& image);
+
+    // Loads the cached DDS for this image if present, otherwise builds the mip chain, compresses
+    // every level and writes it. The mip settings are part of the cache key.
+    CompressedImage TranscodeCached(const unsigned char* rgba, int width, int height, TextureInternalFormat format,
+                                    const std::string& cacheDirectory, const MipSettings& mips = {});
+}
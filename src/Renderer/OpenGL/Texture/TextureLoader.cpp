@@ -0,0 +1,352 @@
+#include "TextureLoader.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <spdlog/spdlog.h>
+
+#include <stb_image.h>
+
+#include "../../../Utils/ThreadPool.h"
+
+namespace {
+
+std::mutex statsMutex;
+TextureLoadStats stats;
+
+std::unique_ptr<StagingRing> stagingRing;
+
+double ElapsedMilliseconds(std::chrono::high_resolution_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void RecordDecode(const std::vector<DecodedImage>& images, size_t encodedBytes, double milliseconds) {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    for (const auto& image : images) {
+        if (!image.Valid()) continue;
+        ++stats.images;
+        stats.decodedBytes += image.GetSize();
+    }
+    stats.encodedBytes += encodedBytes;
+    stats.decodeMilliseconds += milliseconds;
+}
+
+bool ReadFile(const std::string& path, std::vector<unsigned char>& bytes) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) return false;
+
+    std::streamsize size = file.tellg();
+    file.seekg(0, std::ios::beg);
+    bytes.resize(static_cast<size_t>(size));
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(bytes.data()), size));
+}
+
+DecodedImage DecodeBytes(const unsigned char* bytes, size_t size, int channels, bool flip) {
+    DecodedImage image;
+
+    // The thread-local flag keeps concurrent decodes from racing on stb's global flip state.
+    stbi_set_flip_vertically_on_load_thread(flip ? 1 : 0);
+
+    int fileChannels = 0;
+    unsigned char* data = stbi_load_from_memory(bytes, static_cast<int>(size),
+                                                &image.width, &image.height, &fileChannels, channels);
+    if (!data) return image;
+
+    image.channels = channels ? channels : fileChannels;
+    image.pixels.assign(data, data + static_cast<size_t>(image.width) * image.height * image.channels);
+    stbi_image_free(data);
+    return image;
+}
+
+void SubmitUpload(GLuint texture, TextureType type, int level, int layer, int x, int y, int width, int height,
+                  TextureFormat format, TextureInternalFormat internalFormat, const void* pixels, size_t size) {
+    const bool compressed = IsCompressedFormat(internalFormat);
+    const bool layered = type != TextureType::Tex2D;
+
+    if (compressed && layered) {
+        glCompressedTextureSubImage3D(texture, level, x, y, layer, width, height, 1,
+                                      static_cast<GLenum>(internalFormat), static_cast<GLsizei>(size), pixels);
+    } else if (compressed) {
+        glCompressedTextureSubImage2D(texture, level, x, y, width, height,
+                                      static_cast<GLenum>(internalFormat), static_cast<GLsizei>(size), pixels);
+    } else if (layered) {
+        // Cube maps created with glTextureStorage2D address their faces as layers here.
+        glTextureSubImage3D(texture, level, x, y, layer, width, height, 1,
+                            static_cast<GLenum>(format), GL_UNSIGNED_BYTE, pixels);
+    } else {
+        glTextureSubImage2D(texture, level, x, y, width, height,
+                            static_cast<GLenum>(format), GL_UNSIGNED_BYTE, pixels);
+    }
+}
+
+}
+
+StagingRing::StagingRing(size_t segmentSize, int segmentCount)
+    : segmentSize(segmentSize),
+      fences(std::max(2, segmentCount), nullptr)
+{
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+    glCreateBuffers(1, &buffer);
+    glNamedBufferStorage(buffer, static_cast<GLsizeiptr>(GetCapacity()), nullptr, flags);
+    mapped = static_cast<unsigned char*>(glMapNamedBufferRange(buffer, 0, static_cast<GLsizeiptr>(GetCapacity()), flags));
+
+    if (!mapped) {
+        glDeleteBuffers(1, &buffer);
+        throw std::runtime_error("Failed to map texture staging buffer");
+    }
+}
+
+StagingRing::~StagingRing() {
+    for (int i = 0; i < static_cast<int>(fences.size()); ++i) {
+        waitForSegment(i);
+    }
+    if (buffer) {
+        glUnmapNamedBuffer(buffer);
+        glDeleteBuffers(1, &buffer);
+    }
+}
+
+void StagingRing::waitForSegment(int index) {
+    GLsync& fence = fences[index];
+    if (!fence) return;
+
+    GLenum result = glClientWaitSync(fence, 0, 0);
+    if (result == GL_TIMEOUT_EXPIRED) {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        ++stats.fenceWaits;
+    }
+    while (result == GL_TIMEOUT_EXPIRED) {
+        result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+    }
+
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+unsigned char* StagingRing::stage(const void* data, size_t size, GLintptr& offset) {
+    if (head + size > segmentSize) {
+        Flush();
+        segment = (segment + 1) % static_cast<int>(fences.size());
+        head = 0;
+        waitForSegment(segment);
+    }
+
+    offset = static_cast<GLintptr>(segment * segmentSize + head);
+    unsigned char* destination = mapped + offset;
+    std::memcpy(destination, data, size);
+
+    // Keep every region 16-byte aligned so any pixel type can be unpacked from it.
+    head += (size + 15) & ~static_cast<size_t>(15);
+    return destination;
+}
+
+void StagingRing::Flush() {
+    if (head == 0) return;
+    // A newer fence covers everything the older one did.
+    if (fences[segment]) glDeleteSync(fences[segment]);
+    fences[segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void StagingRing::Upload(GLuint texture, TextureType type, int level, int layer, int width, int height,
+                         TextureFormat format, TextureInternalFormat internalFormat, const void* data, size_t size,
+                         int x, int y) {
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    if (size > segmentSize) {
+        SubmitUpload(texture, type, level, layer, x, y, width, height, format, internalFormat, data, size);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+        std::lock_guard<std::mutex> lock(statsMutex);
+        ++stats.directUploads;
+        return;
+    }
+
+    GLintptr offset = 0;
+    stage(data, size, offset);
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+    SubmitUpload(texture, type, level, layer, x, y, width, height, format, internalFormat,
+                 reinterpret_cast<const void*>(offset), size);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    std::lock_guard<std::mutex> lock(statsMutex);
+    ++stats.stagedUploads;
+}
+
+namespace TextureLoader {
+
+DecodedImage Decode(const std::string& path, int channels, bool flip) {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    std::vector<unsigned char> bytes;
+    if (!ReadFile(path, bytes)) return {};
+
+    std::vector<DecodedImage> images;
+    images.push_back(DecodeBytes(bytes.data(), bytes.size(), channels, flip));
+    RecordDecode(images, bytes.size(), ElapsedMilliseconds(start));
+    return std::move(images[0]);
+}
+
+DecodedImage DecodeMemory(const unsigned char* bytes, size_t size, int channels, bool flip) {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    std::vector<DecodedImage> images;
+    images.push_back(DecodeBytes(bytes, size, channels, flip));
+    RecordDecode(images, size, ElapsedMilliseconds(start));
+    return std::move(images[0]);
+}
+
+bool ReadInfo(const unsigned char* bytes, size_t size, int& width, int& height, int& channels) {
+    return stbi_info_from_memory(bytes, static_cast<int>(size), &width, &height, &channels) != 0;
+}
+
+std::vector<DecodedImage> DecodeAll(const std::vector<std::string>& paths, int channels, bool flip) {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    std::vector<DecodedImage> images(paths.size());
+    std::vector<size_t> encodedSizes(paths.size(), 0);
+
+    GetThreadPool().ParallelFor(paths.size(), [&](size_t i) {
+        std::vector<unsigned char> bytes;
+        if (!ReadFile(paths[i], bytes)) return;
+        encodedSizes[i] = bytes.size();
+        images[i] = DecodeBytes(bytes.data(), bytes.size(), channels, flip);
+    });
+
+    size_t encodedBytes = 0;
+    for (size_t size : encodedSizes) encodedBytes += size;
+    RecordDecode(images, encodedBytes, ElapsedMilliseconds(start));
+    return images;
+}
+
+std::vector<DecodedImage> DecodeAllMemory(const std::vector<EncodedImage>& encoded, int channels, bool flip) {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    std::vector<DecodedImage> images(encoded.size());
+    GetThreadPool().ParallelFor(encoded.size(), [&](size_t i) {
+        if (encoded[i].bytes && encoded[i].size) {
+            images[i] = DecodeBytes(encoded[i].bytes, encoded[i].size, channels, flip);
+        }
+    });
+
+    size_t encodedBytes = 0;
+    for (const auto& image : encoded) encodedBytes += image.size;
+    RecordDecode(images, encodedBytes, ElapsedMilliseconds(start));
+    return images;
+}
+
+StagingRing& GetStagingRing() {
+    if (!stagingRing) stagingRing = std::make_unique<StagingRing>();
+    return *stagingRing;
+}
+
+void ReleaseStagingRing() {
+    stagingRing.reset();
+}
+
+void Upload(GLuint texture, TextureType type, int level, int layer, int width, int height,
+            TextureFormat format, TextureInternalFormat internalFormat, const void* data, size_t size,
+            int x, int y) {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    GetStagingRing().Upload(texture, type, level, layer, width, height, format, internalFormat, data, size, x, y);
+
+    double milliseconds = ElapsedMilliseconds(start);
+    std::lock_guard<std::mutex> lock(statsMutex);
+    stats.uploadedBytes += size;
+    stats.uploadMilliseconds += milliseconds;
+}
+
+TextureLoadStats GetStats() {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return stats;
+}
+
+void ResetStats() {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    stats = {};
+}
+
+void LogStats(const std::string& label, const TextureLoadStats& baseline) {
+    TextureLoadStats current = GetStats();
+    current.images -= baseline.images;
+    current.encodedBytes -= baseline.encodedBytes;
+    current.decodedBytes -= baseline.decodedBytes;
+    current.decodeMilliseconds -= baseline.decodeMilliseconds;
+    current.uploadedBytes -= baseline.uploadedBytes;
+    current.uploadMilliseconds -= baseline.uploadMilliseconds;
+    current.stagedUploads -= baseline.stagedUploads;
+    current.directUploads -= baseline.directUploads;
+    current.fenceWaits -= baseline.fenceWaits;
+    auto megabytes = [](size_t bytes) { return bytes / (1024.0 * 1024.0); };
+    auto throughput = [&](size_t bytes, double milliseconds) {
+        return milliseconds > 0.0 ? megabytes(bytes) / (milliseconds / 1000.0) : 0.0;
+    };
+
+    spdlog::info("{}: decoded {} images, {:.1f} MB -> {:.1f} MB in {:.1f} ms ({:.1f} MB/s)",
+                 label, current.images, megabytes(current.encodedBytes), megabytes(current.decodedBytes),
+                 current.decodeMilliseconds, throughput(current.decodedBytes, current.decodeMilliseconds));
+    spdlog::info("{}: uploaded {:.1f} MB in {:.1f} ms ({:.1f} MB/s), {} staged, {} direct, {} fence waits",
+                 label, megabytes(current.uploadedBytes), current.uploadMilliseconds,
+                 throughput(current.uploadedBytes, current.uploadMilliseconds),
+                 current.stagedUploads, current.directUploads, current.fenceWaits);
+}
+
+void Benchmark(const std::vector<int>& sizes) {
+    constexpr int Iterations = 16;
+
+    const TextureLoadStats saved = GetStats();
+    StagingRing& ring = GetStagingRing();
+
+    for (int size : sizes) {
+        const size_t bytes = static_cast<size_t>(size) * size * 4;
+        std::vector<unsigned char> pixels(bytes);
+        for (size_t i = 0; i < bytes; ++i) pixels[i] = static_cast<unsigned char>(i * 31 + (i >> 12));
+
+        GLuint texture;
+        glCreateTextures(GL_TEXTURE_2D, 1, &texture);
+        glTextureStorage2D(texture, 1, GL_RGBA8, size, size);
+
+        // Submit time is what the loading thread pays; completion includes the GPU copy
+        auto run = [&](bool staged, double& submitMilliseconds, double& completeMilliseconds) {
+            glFinish();
+            auto start = std::chrono::high_resolution_clock::now();
+            for (int i = 0; i < Iterations; ++i) {
+                if (staged) {
+                    ring.Upload(texture, TextureType::Tex2D, 0, 0, size, size, TextureFormat::RGBA,
+                                TextureInternalFormat::RGBA8, pixels.data(), bytes);
+                } else {
+                    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+                    SubmitUpload(texture, TextureType::Tex2D, 0, 0, 0, 0, size, size, TextureFormat::RGBA,
+                                 TextureInternalFormat::RGBA8, pixels.data(), bytes);
+                    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+                }
+            }
+            submitMilliseconds = ElapsedMilliseconds(start);
+            if (staged) ring.Flush();
+            glFinish();
+            completeMilliseconds = ElapsedMilliseconds(start);
+        };
+
+        double stagedSubmit, stagedComplete, directSubmit, directComplete;
+        run(true, stagedSubmit, stagedComplete);
+        run(false, directSubmit, directComplete);
+        glDeleteTextures(1, &texture);
+
+        const double megabytes = bytes * Iterations / (1024.0 * 1024.0);
+        spdlog::info("Texture uploads {:>4}x{:<4} ({:.1f} MB{}): staged {:.0f} MB/s submitted, {:.0f} MB/s completed; "
+                     "direct {:.0f} MB/s submitted, {:.0f} MB/s completed",
+                     size, size, bytes / (1024.0 * 1024.0), bytes > ring.GetSegmentSize() ? ", over a segment" : "",
+                     megabytes / (stagedSubmit / 1000.0), megabytes / (stagedComplete / 1000.0),
+                     megabytes / (directSubmit / 1000.0), megabytes / (directComplete / 1000.0));
+    }
+
+    std::lock_guard<std::mutex> lock(statsMutex);
+    stats = saved;
+}
+
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "glad/glad.h"
+#include "Texture.h"
+
+// Image decoding on the worker pool and texture uploads through a persistently mapped staging ring.
+// Decoding is thread-safe; everything that touches GL (StagingRing, Upload*) must run on the GL thread.
+
+struct DecodedImage {
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    std::vector<unsigned char> pixels;     // 8 bits per channel, tightly packed
+
+    bool Valid() const { return !pixels.empty(); }
+    size_t GetSize() const { return pixels.size(); }
+};
+
+struct TextureLoadStats {
+    size_t images = 0;
+    size_t encodedBytes = 0;
+    size_t decodedBytes = 0;
+    double decodeMilliseconds = 0.0;       // wall time of decode batches, not summed per thread
+    size_t uploadedBytes = 0;
+    double uploadMilliseconds = 0.0;
+    size_t stagedUploads = 0;
+    size_t directUploads = 0;
+    size_t fenceWaits = 0;
+};
+
+// Ring of fixed-size segments inside one persistently mapped pixel unpack buffer. Each segment
+// is fenced when the ring moves past it and only rewritten once the GPU has consumed it.
+class StagingRing {
+    public:
+        explicit StagingRing(size_t segmentSize = 16 * 1024 * 1024, int segmentCount = 4);
+        ~StagingRing();
+
+        StagingRing(const StagingRing&) = delete;
+        StagingRing& operator=(const StagingRing&) = delete;
+
+        // Uploads one region of `texture`; `layer` is the z offset for array, 3D and cube textures
+        // (face index for cubes). Data larger than a segment is uploaded from client memory instead.
+        void Upload(GLuint texture, TextureType type, int level, int layer, int width, int height,
+                    TextureFormat format, TextureInternalFormat internalFormat, const void* data, size_t size,
+                    int x = 0, int y = 0);
+
+        // Fences the current segment so its uploads are tracked even if the ring idles.
+        void Flush();
+
+        size_t GetCapacity() const { return segmentSize * fences.size(); }
+        size_t GetSegmentSize() const { return segmentSize; }
+
+    private:
+        unsigned char* stage(const void* data, size_t size, GLintptr& offset);
+        void waitForSegment(int index);
+
+        GLuint buffer = 0;
+        unsigned char* mapped = nullptr;
+        size_t segmentSize = 0;
+        std::vector<GLsync> fences;
+        int segment = 0;
+        size_t head = 0;
+};
+
+namespace TextureLoader {
+    // `channels` 0 keeps the file's channel count. stb flips rows during decode through its
+    // per-thread flag, so it is safe to decode with and without flipping on several threads at once.
+    DecodedImage Decode(const std::string& path, int channels = 0, bool flip = false);
+    DecodedImage DecodeMemory(const unsigned char* bytes, size_t size, int channels = 0, bool flip = false);
+
+    // Reads only the header; returns false if stb cannot parse it.
+    bool ReadInfo(const unsigned char* bytes, size_t size, int& width, int& height, int& channels);
+
+    // Batch versions decode on the worker pool; failed entries come back with Valid() == false.
+    std::vector<DecodedImage> DecodeAll(const std::vector<std::string>& paths, int channels = 0, bool flip = false);
+
+    struct EncodedImage {
+        const unsigned char* bytes = nullptr;
+        size_t size = 0;
+    };
+    std::vector<DecodedImage> DecodeAllMemory(const std::vector<EncodedImage>& images, int channels = 0, bool flip = false);
+
+    StagingRing& GetStagingRing();
+    // Destroys the staging ring; call while the GL context is still current.
+    void ReleaseStagingRing();
+
+    // Shorthand for GetStagingRing().Upload(...), recording upload stats.
+    void Upload(GLuint texture, TextureType type, int level, int layer, int width, int height,
+                TextureFormat format, TextureInternalFormat internalFormat, const void* data, size_t size,
+                int x = 0, int y = 0);
+
+    TextureLoadStats GetStats();
+    void ResetStats();
+    // Logs decode and upload throughput in MB/s for everything recorded after `baseline`.
+    void LogStats(const std::string& label, const TextureLoadStats& baseline = {});
+
+    // Uploads size x size RGBA8 images repeatedly, through the staging ring and straight from client
+    // memory, and logs MB/s for submitting them on the CPU and for the GPU finishing them. The load
+    // stats are left as they were.
+    void Benchmark(const std::vector<int>& sizes);
+}
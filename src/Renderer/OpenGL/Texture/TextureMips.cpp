@@ -0,0 +1,233 @@
+#include "TextureMips.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+#include "../../../Utils/ThreadPool.h"
+
+std::vector<TextureMipData> MipChain::GetMipData() const {
+    std::vector<TextureMipData> mips;
+    for (size_t level = 0; level < levels.size(); ++level) {
+        mips.push_back({
+            std::max(1, width >> level),
+            std::max(1, height >> level),
+            levels[level].data(),
+            levels[level].size()
+        });
+    }
+    return mips;
+}
+
+namespace {
+
+constexpr float kaiserWidth = 3.0f;
+constexpr float kaiserAlpha = 4.0f;
+
+const std::array<float, 256>& SrgbToLinearTable() {
+    static const std::array<float, 256> table = [] {
+        std::array<float, 256> values{};
+        for (int i = 0; i < 256; ++i) {
+            float c = i / 255.0f;
+            values[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+        return values;
+    }();
+    return table;
+}
+
+const std::array<unsigned char, 4096>& LinearToSrgbTable() {
+    static const std::array<unsigned char, 4096> table = [] {
+        std::array<unsigned char, 4096> values{};
+        for (int i = 0; i < 4096; ++i) {
+            float l = i / 4095.0f;
+            float c = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+            values[i] = static_cast<unsigned char>(std::clamp(c * 255.0f + 0.5f, 0.0f, 255.0f));
+        }
+        return values;
+    }();
+    return table;
+}
+
+float BesselI0(float x) {
+    float sum = 1.0f;
+    float term = 1.0f;
+    float halfX = x * 0.5f;
+    for (int k = 1; k < 32; ++k) {
+        term *= (halfX / k) * (halfX / k);
+        sum += term;
+        if (term < sum * 1e-8f) break;
+    }
+    return sum;
+}
+
+float Sinc(float x) {
+    if (std::fabs(x) < 1e-5f) return 1.0f;
+    float px = 3.14159265358979323846f * x;
+    return std::sin(px) / px;
+}
+
+float EvaluateFilter(MipFilter filter, float t) {
+    if (filter == MipFilter::Box) {
+        return std::fabs(t) <= 0.5f ? 1.0f : 0.0f;
+    }
+
+    if (std::fabs(t) >= kaiserWidth) return 0.0f;
+    float ratio = t / kaiserWidth;
+    float window = BesselI0(kaiserAlpha * std::sqrt(1.0f - ratio * ratio)) / BesselI0(kaiserAlpha);
+    return Sinc(t) * window;
+}
+
+// Precomputed taps for resampling one axis from srcSize to dstSize.
+struct Kernel {
+    std::vector<int> first;       // first tap of every output sample
+    std::vector<int> indices;
+    std::vector<float> weights;
+    int taps = 0;
+};
+
+int AddressTap(int i, int size, TextureWrap wrap) {
+    switch (wrap) {
+        case TextureWrap::Repeat:
+            return ((i % size) + size) % size;
+        case TextureWrap::MirroredRepeat: {
+            int period = ((i % (2 * size)) + 2 * size) % (2 * size);
+            return period < size ? period : 2 * size - 1 - period;
+        }
+        default:
+            return std::clamp(i, 0, size - 1);
+    }
+}
+
+Kernel BuildKernel(int srcSize, int dstSize, MipFilter filter, TextureWrap wrap) {
+    const float scale = static_cast<float>(srcSize) / dstSize;
+    const float radius = (filter == MipFilter::Box ? 0.5f : kaiserWidth) * scale;
+
+    Kernel kernel;
+    kernel.taps = static_cast<int>(std::ceil(radius * 2.0f)) + 1;
+    kernel.first.resize(dstSize);
+    kernel.indices.resize(static_cast<size_t>(dstSize) * kernel.taps);
+    kernel.weights.resize(static_cast<size_t>(dstSize) * kernel.taps);
+
+    for (int d = 0; d < dstSize; ++d) {
+        float center = (d + 0.5f) * scale;
+        int start = static_cast<int>(std::floor(center - radius));
+
+        float sum = 0.0f;
+        for (int k = 0; k < kernel.taps; ++k) {
+            int i = start + k;
+            float weight = EvaluateFilter(filter, (i + 0.5f - center) / scale);
+            int index = AddressTap(i, srcSize, wrap);
+
+            kernel.indices[d * kernel.taps + k] = index;
+            kernel.weights[d * kernel.taps + k] = weight;
+            sum += weight;
+        }
+
+        if (sum != 0.0f) {
+            for (int k = 0; k < kernel.taps; ++k) kernel.weights[d * kernel.taps + k] /= sum;
+        }
+        kernel.first[d] = d * kernel.taps;
+    }
+
+    return kernel;
+}
+
+}
+
+namespace MipGeneration {
+
+int GetLevelCount(int width, int height) {
+    int levels = 1;
+    int size = std::max(width, height);
+    while (size > 1) {
+        size >>= 1;
+        ++levels;
+    }
+    return levels;
+}
+
+MipChain Generate(const unsigned char* pixels, int width, int height, int channels, const MipSettings& settings) {
+    MipChain chain;
+    chain.width = width;
+    chain.height = height;
+    chain.channels = channels;
+
+    int levelCount = GetLevelCount(width, height);
+    if (settings.maxLevels > 0) levelCount = std::min(levelCount, settings.maxLevels);
+
+    const size_t baseSize = static_cast<size_t>(width) * height * channels;
+    chain.levels.emplace_back(pixels, pixels + baseSize);
+
+    if (levelCount == 1) return chain;
+
+    const auto& toLinear = SrgbToLinearTable();
+    const auto& toSrgb = LinearToSrgbTable();
+    const int colorChannels = settings.srgb ? std::min(channels, 3) : 0;
+
+    auto& pool = GetThreadPool();
+
+    // Work in linear float so every level is filtered from full-precision data.
+    std::vector<float> current(baseSize);
+    for (size_t i = 0; i < baseSize; ++i) {
+        int channel = static_cast<int>(i % channels);
+        current[i] = channel < colorChannels ? toLinear[pixels[i]] : pixels[i] / 255.0f;
+    }
+
+    int srcWidth = width;
+    int srcHeight = height;
+
+    for (int level = 1; level < levelCount; ++level) {
+        int dstWidth = std::max(1, srcWidth >> 1);
+        int dstHeight = std::max(1, srcHeight >> 1);
+
+        Kernel horizontal = BuildKernel(srcWidth, dstWidth, settings.filter, settings.wrapS);
+        Kernel vertical = BuildKernel(srcHeight, dstHeight, settings.filter, settings.wrapT);
+
+        std::vector<float> rows(static_cast<size_t>(dstWidth) * srcHeight * channels);
+        pool.ParallelFor(srcHeight, [&](size_t y) {
+            const float* src = current.data() + y * srcWidth * channels;
+            float* dst = rows.data() + y * dstWidth * channels;
+            for (int x = 0; x < dstWidth; ++x) {
+                float accum[4] = {};
+                for (int k = 0; k < horizontal.taps; ++k) {
+                    float weight = horizontal.weights[horizontal.first[x] + k];
+                    const float* texel = src + horizontal.indices[horizontal.first[x] + k] * channels;
+                    for (int c = 0; c < channels; ++c) accum[c] += texel[c] * weight;
+                }
+                for (int c = 0; c < channels; ++c) dst[x * channels + c] = accum[c];
+            }
+        });
+
+        std::vector<float> next(static_cast<size_t>(dstWidth) * dstHeight * channels);
+        std::vector<unsigned char> bytes(next.size());
+        pool.ParallelFor(dstHeight, [&](size_t y) {
+            float* dst = next.data() + y * dstWidth * channels;
+            unsigned char* out = bytes.data() + y * dstWidth * channels;
+            for (int x = 0; x < dstWidth; ++x) {
+                float accum[4] = {};
+                for (int k = 0; k < vertical.taps; ++k) {
+                    float weight = vertical.weights[vertical.first[y] + k];
+                    const float* texel = rows.data() + (static_cast<size_t>(vertical.indices[vertical.first[y] + k]) * dstWidth + x) * channels;
+                    for (int c = 0; c < channels; ++c) accum[c] += texel[c] * weight;
+                }
+                for (int c = 0; c < channels; ++c) {
+                    // Kaiser lobes can overshoot; clamp before storing.
+                    float value = std::clamp(accum[c], 0.0f, 1.0f);
+                    dst[x * channels + c] = value;
+                    out[x * channels + c] = c < colorChannels ? toSrgb[static_cast<int>(value * 4095.0f + 0.5f)]
+                                                              : static_cast<unsigned char>(value * 255.0f + 0.5f);
+                }
+            }
+        });
+
+        chain.levels.push_back(std::move(bytes));
+        current = std::move(next);
+        srcWidth = dstWidth;
+        srcHeight = dstHeight;
+    }
+
+    return chain;
+}
+
+}
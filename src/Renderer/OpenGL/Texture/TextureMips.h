@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "Texture.h"
+
+// CPU mip chain generation. Color data is filtered in linear space (sRGB decode/encode around
+// the filter), alpha and non-color data are filtered as stored. Rows are split across the worker pool.
+
+enum class MipFilter { Box, Kaiser };
+
+struct MipSettings {
+    MipFilter filter = MipFilter::Kaiser;
+    bool srgb = true;            // RGB channels hold sRGB-encoded color
+    // How filter taps past an edge are addressed, per axis, like the sampler that will read the
+    // chain; ClampToBorder clamps since the border color is not known here
+    TextureWrap wrapS = TextureWrap::Repeat;
+    TextureWrap wrapT = TextureWrap::Repeat;
+    int maxLevels = 0;           // 0 = full chain down to 1x1
+};
+
+struct MipChain {
+    int width = 0;
+    int height = 0;
+    int channels = 4;
+    std::vector<std::vector<unsigned char>> levels;   // level 0 first
+
+    std::vector<TextureMipData> GetMipData() const;
+};
+
+namespace MipGeneration {
+    int GetLevelCount(int width, int height);
+
+    // Level 0 is copied from `pixels`; `channels` is 1 to 4, tightly packed.
+    MipChain Generate(const unsigned char* pixels, int width, int height, int channels, const MipSettings& settings = {});
+}
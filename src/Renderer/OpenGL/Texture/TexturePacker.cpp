@@ -0,0 +1,303 @@
+#include "TexturePacker.h"
+#include "TextureMips.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <tuple>
+#include <spdlog/spdlog.h>
+
+static int NextPowerOfTwo(int value) {
+    int result = 1;
+    while (result < value) result <<= 1;
+    return result;
+}
+
+static int RoundUp(int value, int multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+static int FloorLog2(int value) {
+    int result = 0;
+    while (value > 1) {
+        value >>= 1;
+        ++result;
+    }
+    return result;
+}
+
+TexturePacker::TexturePacker(const TexturePackerSettings& settings) : settings(settings) {
+    this->settings.padding = std::max(0, settings.padding);
+    this->settings.maxAtlasSize = NextPowerOfTwo(std::max(1, settings.maxAtlasSize));
+    this->settings.maxImageSize = std::min(settings.maxImageSize, this->settings.maxAtlasSize - 2 * this->settings.padding);
+}
+
+int TexturePacker::AddImage(const PackerImage& image) {
+    images.push_back(image);
+    regions.emplace_back();
+    return static_cast<int>(images.size() - 1);
+}
+
+int TexturePacker::Alignment() const {
+    // A border of p texels survives floor(log2(p)) downsamples, as long as every region
+    // starts on a texel that is still a texel boundary at that level.
+    if (settings.padding == 0) return 1;
+    return 1 << FloorLog2(settings.padding);
+}
+
+void TexturePacker::Pack() {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    pages.clear();
+    for (auto& region : regions) region = AtlasRegion{};
+    stats = TexturePackerStats{};
+    stats.imagesSubmitted = images.size();
+
+    std::vector<int> order;
+    for (int i = 0; i < static_cast<int>(images.size()); ++i) {
+        const auto& image = images[i];
+        bool supportedChannels = image.channels == 1 || image.channels == 3 || image.channels == 4;
+        if (!image.pixels || !supportedChannels || image.width <= 0 || image.height <= 0) continue;
+        if (image.width > settings.maxImageSize || image.height > settings.maxImageSize) continue;
+        order.push_back(i);
+    }
+
+    // Tallest first packs a skyline well; the index tie-break keeps the result deterministic.
+    std::sort(order.begin(), order.end(), [this](int a, int b) {
+        const auto& ia = images[a];
+        const auto& ib = images[b];
+        return std::make_tuple(ia.channels, -ia.height, -ia.width, a) <
+               std::make_tuple(ib.channels, -ib.height, -ib.width, b);
+    });
+
+    PackAtlas(order);
+
+    size_t usedTexels = 0;
+    size_t totalTexels = 0;
+    for (size_t i = 0; i < regions.size(); ++i) {
+        if (regions[i].page < 0) continue;
+        usedTexels += static_cast<size_t>(images[i].width) * images[i].height;
+        ++stats.imagesPacked;
+    }
+    for (const auto& page : pages) {
+        totalTexels += static_cast<size_t>(page.width) * page.height;
+    }
+
+    stats.pages = pages.size();
+    stats.occupancy = totalTexels ? static_cast<double>(usedTexels) / totalTexels : 0.0;
+    stats.packTimeMs = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - start).count();
+
+    spdlog::info("Packed {} of {} textures into {} atlases ({:.1f}% occupancy) in {:.2f} ms",
+                 stats.imagesPacked, stats.imagesSubmitted, stats.pages,
+                 stats.occupancy * 100.0, stats.packTimeMs);
+}
+
+void TexturePacker::PackAtlas(const std::vector<int>& order) {
+    const int align = Alignment();
+    const int padding = settings.padding;
+    const int mipLevels = FloorLog2(align) + 1;
+
+    auto paddedWidth  = [&](int i) { return RoundUp(images[i].width + 2 * padding, align); };
+    auto paddedHeight = [&](int i) { return RoundUp(images[i].height + 2 * padding, align); };
+
+    size_t begin = 0;
+    while (begin < order.size()) {
+        // Every page holds a single channel count so it maps to one GL format.
+        size_t end = begin;
+        while (end < order.size() && images[order[end]].channels == images[order[begin]].channels) ++end;
+
+        std::vector<int> remaining(order.begin() + begin, order.begin() + end);
+
+        while (!remaining.empty()) {
+            size_t area = 0;
+            for (int i : remaining) area += static_cast<size_t>(paddedWidth(i)) * paddedHeight(i);
+
+            int side = NextPowerOfTwo(static_cast<int>(std::ceil(std::sqrt(static_cast<double>(area)))));
+            side = std::clamp(side, align, settings.maxAtlasSize);
+
+            std::vector<std::pair<int, glm::ivec2>> placed;
+            int usedHeight = 0;
+
+            while (true) {
+                placed.clear();
+                usedHeight = 0;
+
+                std::vector<Skyline> skyline = {{0, 0, side}};
+                for (int i : remaining) {
+                    int index, x, y;
+                    int w = paddedWidth(i);
+                    int h = paddedHeight(i);
+                    if (!FindPosition(skyline, side, side, w, h, index, x, y)) continue;
+
+                    InsertSkyline(skyline, index, x, y, w, h);
+                    placed.push_back({i, glm::ivec2(x, y)});
+                    usedHeight = std::max(usedHeight, y + h);
+                }
+
+                if (placed.size() == remaining.size() || side >= settings.maxAtlasSize) break;
+                side *= 2;
+            }
+
+            if (placed.empty()) break;
+
+            AtlasPage page;
+            page.width = side;
+            page.height = RoundUp(usedHeight, align);
+            page.channels = images[remaining.front()].channels;
+            page.mipLevels = mipLevels;
+            page.pixels.assign(static_cast<size_t>(page.width) * page.height * page.channels, 0);
+
+            const int pageIndex = static_cast<int>(pages.size());
+            for (const auto& [i, pos] : placed) {
+                BlitWithBorder(page, images[i], pos.x + padding, pos.y + padding);
+
+                auto& region = regions[i];
+                region.page = pageIndex;
+                region.x = pos.x + padding;
+                region.y = pos.y + padding;
+                region.width = images[i].width;
+                region.height = images[i].height;
+                region.uvTransform = glm::vec4(
+                    static_cast<float>(region.x) / page.width,
+                    static_cast<float>(region.y) / page.height,
+                    static_cast<float>(region.width) / page.width,
+                    static_cast<float>(region.height) / page.height
+                );
+            }
+            pages.push_back(std::move(page));
+
+            std::vector<int> next;
+            for (int i : remaining) {
+                if (regions[i].page < 0) next.push_back(i);
+            }
+            remaining = std::move(next);
+        }
+
+        begin = end;
+    }
+}
+
+bool TexturePacker::FindPosition(const std::vector<Skyline>& skyline, int pageWidth, int pageHeight,
+                                 int width, int height, int& bestIndex, int& bestX, int& bestY) const {
+    int bestTop = INT32_MAX;
+    bestIndex = -1;
+
+    for (int i = 0; i < static_cast<int>(skyline.size()); ++i) {
+        int x = skyline[i].x;
+        if (x + width > pageWidth) break;
+
+        int y = 0;
+        int widthLeft = width;
+        int j = i;
+        while (widthLeft > 0 && j < static_cast<int>(skyline.size())) {
+            y = std::max(y, skyline[j].y);
+            widthLeft -= skyline[j].width;
+            ++j;
+        }
+        if (widthLeft > 0 || y + height > pageHeight) continue;
+
+        // Bottom-left rule: lowest top edge wins, leftmost on ties.
+        if (y + height < bestTop) {
+            bestTop = y + height;
+            bestIndex = i;
+            bestX = x;
+            bestY = y;
+        }
+    }
+
+    return bestIndex >= 0;
+}
+
+void TexturePacker::InsertSkyline(std::vector<Skyline>& skyline, int index, int x, int y, int width, int height) const {
+    skyline.insert(skyline.begin() + index, Skyline{x, y + height, width});
+
+    for (size_t i = index + 1; i < skyline.size(); ++i) {
+        const auto& prev = skyline[i - 1];
+        int prevRight = prev.x + prev.width;
+        if (skyline[i].x >= prevRight) break;
+
+        int shrink = prevRight - skyline[i].x;
+        skyline[i].x += shrink;
+        skyline[i].width -= shrink;
+        if (skyline[i].width > 0) break;
+
+        skyline.erase(skyline.begin() + i);
+        --i;
+    }
+
+    for (size_t i = 0; i + 1 < skyline.size(); ++i) {
+        if (skyline[i].y == skyline[i + 1].y) {
+            skyline[i].width += skyline[i + 1].width;
+            skyline.erase(skyline.begin() + i + 1);
+            --i;
+        }
+    }
+}
+
+void TexturePacker::BlitWithBorder(AtlasPage& page, const PackerImage& image, int x, int y) const {
+    const int padding = settings.padding;
+    const int channels = image.channels;
+
+    // Repeating images wrap their border around to the opposite edge so sampling
+    // through fract() filters across the seam exactly like GL_REPEAT would.
+    auto source = [&](int coord, int size) {
+        return image.repeat ? ((coord % size) + size) % size : std::clamp(coord, 0, size - 1);
+    };
+
+    for (int row = -padding; row < image.height + padding; ++row) {
+        int srcRow = source(row, image.height);
+        unsigned char* dst = page.pixels.data() +
+            (static_cast<size_t>(y + row) * page.width + (x - padding)) * channels;
+
+        for (int col = -padding; col < image.width + padding; ++col) {
+            int srcCol = source(col, image.width);
+            const unsigned char* src = image.pixels +
+                (static_cast<size_t>(srcRow) * image.width + srcCol) * channels;
+            std::memcpy(dst, src, channels);
+            dst += channels;
+        }
+    }
+}
+
+std::shared_ptr<Texture> TexturePacker::CreateTexture(size_t pageIndex, TextureFilter minFilter, TextureFilter magFilter) const {
+    const auto& page = pages[pageIndex];
+
+    TextureFormat format = page.channels == 4 ? TextureFormat::RGBA :
+                           page.channels == 3 ? TextureFormat::RGB : TextureFormat::RED;
+    TextureInternalFormat internalFormat = page.channels == 4 ? TextureInternalFormat::RGBA8 :
+                                           page.channels == 3 ? TextureInternalFormat::RGB8 : TextureInternalFormat::R8;
+
+    // Atlas regions are addressed through fract() in the shader, so the page itself clamps.
+    TextureWrap wrap = TextureWrap::ClampToEdge;
+
+    bool mipmapped = minFilter != TextureFilter::Linear && minFilter != TextureFilter::Nearest;
+    if (mipmapped) {
+        MipSettings mips;
+        mips.srgb = settings.srgb;
+        mips.wrapS = wrap;
+        mips.wrapT = wrap;
+        mips.maxLevels = page.mipLevels;
+        auto chain = MipGeneration::Generate(page.pixels.data(), page.width, page.height, page.channels, mips);
+        return CreateTextureFromMips(format, internalFormat, chain.GetMipData(),
+                                     0, minFilter, magFilter, wrap, wrap);
+    }
+
+    return CreateTextureFromData(
+        page.width, page.height, 1, TextureType::Tex2D,
+        format, internalFormat,
+        page.pixels.data(),
+        0, minFilter, magFilter, wrap, wrap
+    );
+}
+
+std::vector<std::shared_ptr<Texture>> TexturePacker::CreateTextures(TextureFilter minFilter, TextureFilter magFilter) const {
+    std::vector<std::shared_ptr<Texture>> textures;
+    textures.reserve(pages.size());
+
+    for (size_t i = 0; i < pages.size(); ++i) {
+        textures.push_back(CreateTexture(i, minFilter, magFilter));
+    }
+
+    return textures;
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+#include <memory>
+#include "Texture.h"
+
+// Import-time packer for small material textures.
+// Images are packed into atlases with extruded borders so the first few mip levels don't bleed.
+// One packer holds one kind of image: color, data and normal maps need differently filtered mips.
+// Packing is pure CPU work and deterministic: the same input always gives the same layout.
+
+struct PackerImage {
+    int width = 0;
+    int height = 0;
+    int channels = 4;
+    const unsigned char* pixels = nullptr;   // tightly packed, row 0 first
+    bool repeat = true;                      // wrap borders instead of clamping them
+};
+
+struct TexturePackerSettings {
+    int maxAtlasSize = 4096;
+    int maxImageSize = 512;      // larger images are left alone
+    int padding = 4;             // extruded border texels around every image
+    bool srgb = true;            // images hold sRGB-encoded color; decides how page mips are filtered
+};
+
+struct AtlasRegion {
+    int page = -1;               // atlas page, -1 if the image was not packed
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+    glm::vec4 uvTransform = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);   // offset.xy, scale.zw
+};
+
+struct AtlasPage {
+    int width = 0;
+    int height = 0;
+    int channels = 4;
+    int mipLevels = 1;           // levels that stay free of bleeding between regions
+    std::vector<unsigned char> pixels;
+};
+
+struct TexturePackerStats {
+    size_t imagesSubmitted = 0;
+    size_t imagesPacked = 0;
+    size_t pages = 0;
+    double occupancy = 0.0;      // used texels / allocated texels
+    double packTimeMs = 0.0;
+};
+
+class TexturePacker {
+    public:
+        explicit TexturePacker(const TexturePackerSettings& settings = {});
+
+        // Returns a handle used to query the resulting region after Pack().
+        int AddImage(const PackerImage& image);
+
+        void Pack();
+
+        const AtlasRegion& GetRegion(int handle) const { return regions[handle]; }
+        const std::vector<AtlasPage>& GetPages() const { return pages; }
+        const TexturePackerStats& GetStats() const { return stats; }
+
+        // Uploads every page; the returned vector is indexed like GetPages(). With a mipmap filter,
+        // pages only get the levels their padding keeps free of bleeding.
+        std::vector<std::shared_ptr<Texture>> CreateTextures(
+            TextureFilter minFilter = TextureFilter::LinearMipmapLinear,
+            TextureFilter magFilter = TextureFilter::Linear) const;
+        std::shared_ptr<Texture> CreateTexture(
+            size_t pageIndex,
+            TextureFilter minFilter = TextureFilter::LinearMipmapLinear,
+            TextureFilter magFilter = TextureFilter::Linear) const;
+
+    private:
+        struct Skyline {
+            int x;
+            int y;
+            int width;
+        };
+
+        void PackAtlas(const std::vector<int>& order);
+        bool FindPosition(const std::vector<Skyline>& skyline, int pageWidth, int pageHeight,
+                          int width, int height, int& bestIndex, int& bestX, int& bestY) const;
+        void InsertSkyline(std::vector<Skyline>& skyline, int index, int x, int y, int width, int height) const;
+        void BlitWithBorder(AtlasPage& page, const PackerImage& image, int x, int y) const;
+        int Alignment() const;
+
+        TexturePackerSettings settings;
+        std::vector<PackerImage> images;
+        std::vector<AtlasRegion> regions;
+        std::vector<AtlasPage> pages;
+        TexturePackerStats stats;
+};
+
+inline std::unique_ptr<TexturePacker> CreateTexturePacker(const TexturePackerSettings& settings = {}) {
+    return std::make_unique<TexturePacker>(settings);
+}
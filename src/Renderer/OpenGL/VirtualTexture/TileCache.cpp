@@ -0,0 +1,219 @@
+#include "TileCache.h"
+#include <stdexcept>
+
+static bool IsPowerOfTwo(int value) {
+    return value > 0 && (value & (value - 1)) == 0;
+}
+
+VirtualTextureLayout VirtualTextureLayout::Create(int width, int height, int tileSize) {
+    if (!IsPowerOfTwo(width) || !IsPowerOfTwo(height) || !IsPowerOfTwo(tileSize)) {
+        throw std::runtime_error("Virtual texture and tile sizes must be powers of two");
+    }
+    if (width < tileSize || height < tileSize) {
+        throw std::runtime_error("Virtual texture is smaller than one tile");
+    }
+    if (width / tileSize > 4096 || height / tileSize > 4096) {
+        throw std::runtime_error("Virtual texture has more than 4096 tiles per side");
+    }
+
+    VirtualTextureLayout layout;
+    layout.width = width;
+    layout.height = height;
+    layout.tileSize = tileSize;
+
+    int pages = std::min(width, height) / tileSize;
+    layout.levels = 1;
+    while (pages > 1) {
+        pages >>= 1;
+        ++layout.levels;
+    }
+    return layout;
+}
+
+namespace TileFeedback {
+
+std::vector<TileRequest> Analyze(const uint32_t* texels, size_t count, const VirtualTextureLayout& layout) {
+    std::unordered_map<uint32_t, uint32_t> counts;
+
+    uint32_t previous = 0;
+    uint32_t* previousCount = nullptr;
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t texel = texels[i];
+        if (texel == 0) continue;
+
+        // Neighbouring feedback texels usually hit the same tile.
+        if (texel == previous && previousCount) {
+            ++*previousCount;
+            continue;
+        }
+
+        TileId tile = TileId::Unpack(texel - 1);
+        if (tile.level >= layout.levels || tile.x >= layout.GetPagesX(tile.level) ||
+            tile.y >= layout.GetPagesY(tile.level)) {
+            continue;
+        }
+
+        previous = texel;
+        previousCount = &counts[tile.Pack()];
+        ++*previousCount;
+    }
+
+    // Push counts up one level at a time so every ancestor carries the total of its subtree.
+    std::vector<std::vector<TileRequest>> byLevel(layout.levels);
+    for (const auto& [packed, pixels] : counts) {
+        TileId tile = TileId::Unpack(packed);
+        byLevel[tile.level].push_back({tile, pixels});
+    }
+
+    for (int level = 0; level + 1 < layout.levels; ++level) {
+        std::unordered_map<uint32_t, uint32_t> parents;
+        for (const auto& request : byLevel[level]) {
+            parents[request.tile.Parent().Pack()] += request.pixels;
+        }
+
+        auto& next = byLevel[level + 1];
+        for (auto& request : next) {
+            auto it = parents.find(request.tile.Pack());
+            if (it != parents.end()) {
+                request.pixels += it->second;
+                parents.erase(it);
+            }
+        }
+        for (const auto& [packed, pixels] : parents) {
+            next.push_back({TileId::Unpack(packed), pixels});
+        }
+    }
+
+    std::vector<TileRequest> requests;
+    for (int level = layout.levels - 1; level >= 0; --level) {
+        auto& tiles = byLevel[level];
+        std::sort(tiles.begin(), tiles.end(), [](const TileRequest& a, const TileRequest& b) {
+            return a.pixels != b.pixels ? a.pixels > b.pixels : a.tile.Pack() < b.tile.Pack();
+        });
+        requests.insert(requests.end(), tiles.begin(), tiles.end());
+    }
+    return requests;
+}
+
+}
+
+TileCache::TileCache(int slotsX, int slotsY)
+    : slotsX(slotsX),
+      slotsY(slotsY),
+      slots(static_cast<size_t>(slotsX) * slotsY)
+{
+    if (slotsX <= 0 || slotsY <= 0 || slotsX > 256 || slotsY > 256) {
+        throw std::runtime_error("Tile cache needs between 1 and 256 slots per side");
+    }
+}
+
+int TileCache::Find(TileId tile) const {
+    auto it = slotsByTile.find(tile.Pack());
+    return it != slotsByTile.end() ? it->second : -1;
+}
+
+void TileCache::Touch(TileId tile, uint64_t frame) {
+    int slot = Find(tile);
+    if (slot >= 0) slots[slot].lastUsedFrame = frame;
+}
+
+int TileCache::Allocate(TileId tile, uint64_t frame, std::optional<TileId>& evicted) {
+    evicted.reset();
+
+    int existing = Find(tile);
+    if (existing >= 0) {
+        slots[existing].lastUsedFrame = frame;
+        return existing;
+    }
+
+    int chosen = -1;
+    for (int i = 0; i < static_cast<int>(slots.size()); ++i) {
+        const Slot& slot = slots[i];
+        if (!slot.occupied) {
+            chosen = i;
+            break;
+        }
+        if (slot.pinned || slot.lastUsedFrame >= frame) continue;
+        if (chosen < 0 || slot.lastUsedFrame < slots[chosen].lastUsedFrame) chosen = i;
+    }
+
+    if (chosen < 0) {
+        ++stats.failedAllocations;
+        return -1;
+    }
+
+    Slot& slot = slots[chosen];
+    if (slot.occupied) {
+        evicted = slot.tile;
+        slotsByTile.erase(slot.tile.Pack());
+        ++stats.evictions;
+    }
+
+    slot.tile = tile;
+    slot.lastUsedFrame = frame;
+    slot.occupied = true;
+    slot.pinned = false;
+    slotsByTile[tile.Pack()] = chosen;
+    ++stats.allocations;
+    return chosen;
+}
+
+void TileCache::Pin(TileId tile) {
+    int slot = Find(tile);
+    if (slot >= 0) slots[slot].pinned = true;
+}
+
+PageTable::PageTable(const VirtualTextureLayout& layout)
+    : layout(layout),
+      mapped(layout.levels),
+      resolved(layout.levels)
+{
+    for (int level = 0; level < layout.levels; ++level) {
+        size_t size = static_cast<size_t>(layout.GetPagesX(level)) * layout.GetPagesY(level);
+        mapped[level].assign(size, 0);
+        resolved[level].assign(size, 0);
+    }
+}
+
+size_t PageTable::indexOf(TileId tile) const {
+    return static_cast<size_t>(tile.y) * layout.GetPagesX(tile.level) + tile.x;
+}
+
+void PageTable::Map(TileId tile, int slotX, int slotY) {
+    mapped[tile.level][indexOf(tile)] = MakeEntry(slotX, slotY, tile.level);
+    dirty = true;
+}
+
+void PageTable::Unmap(TileId tile) {
+    mapped[tile.level][indexOf(tile)] = 0;
+    dirty = true;
+}
+
+uint32_t PageTable::GetEntry(TileId tile) const {
+    return resolved[tile.level][indexOf(tile)];
+}
+
+bool PageTable::Resolve() {
+    if (!dirty) return false;
+
+    for (int level = layout.levels - 1; level >= 0; --level) {
+        const int pagesX = layout.GetPagesX(level);
+        const int pagesY = layout.GetPagesY(level);
+        const bool coarsest = level == layout.levels - 1;
+
+        for (int y = 0; y < pagesY; ++y) {
+            for (int x = 0; x < pagesX; ++x) {
+                size_t index = static_cast<size_t>(y) * pagesX + x;
+                uint32_t entry = mapped[level][index];
+                if (entry == 0 && !coarsest) {
+                    const int parentPagesX = layout.GetPagesX(level + 1);
+                    entry = resolved[level + 1][static_cast<size_t>(y >> 1) * parentPagesX + (x >> 1)];
+                }
+                resolved[level][index] = entry;
+            }
+        }
+    }
+
+    dirty = false;
+    return true;
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+// GL-free parts of the virtual texture: tile addressing, feedback analysis, physical slot
+// allocation with LRU eviction and the CPU copy of the page table. None of this touches the
+// GL context, so tile selection and eviction can be exercised on the CPU alone.
+
+// Virtual textures are power-of-two sized; level L has (pagesX >> L) x (pagesY >> L) tiles and the
+// coarsest level is the first one whose shorter side is a single tile.
+struct VirtualTextureLayout {
+    int width = 0;
+    int height = 0;
+    int tileSize = 128;
+    int levels = 1;
+
+    int GetPagesX(int level) const { return std::max(1, (width / tileSize) >> level); }
+    int GetPagesY(int level) const { return std::max(1, (height / tileSize) >> level); }
+
+    static VirtualTextureLayout Create(int width, int height, int tileSize);
+};
+
+// Packed as level << 24 | y << 12 | x; the feedback shader writes the same layout plus one.
+struct TileId {
+    uint8_t level = 0;
+    uint16_t x = 0;
+    uint16_t y = 0;
+
+    uint32_t Pack() const { return (uint32_t(level) << 24) | (uint32_t(y) << 12) | uint32_t(x); }
+    static TileId Unpack(uint32_t packed) {
+        return { uint8_t(packed >> 24), uint16_t(packed & 0xFFF), uint16_t((packed >> 12) & 0xFFF) };
+    }
+    TileId Parent() const { return { uint8_t(level + 1), uint16_t(x >> 1), uint16_t(y >> 1) }; }
+
+    bool operator==(const TileId& other) const { return Pack() == other.Pack(); }
+};
+
+struct TileRequest {
+    TileId tile;
+    uint32_t pixels = 0;    // feedback texels that asked for this tile or one of its descendants
+};
+
+namespace TileFeedback {
+    // Turns feedback texels (packed id + 1, 0 = nothing drawn) into unique requests. Every requested
+    // tile also requests its ancestors, so a coarser fallback is always on the way. Sorted coarse
+    // levels first, then by pixel count, which is the order loads should be issued in.
+    std::vector<TileRequest> Analyze(const uint32_t* texels, size_t count, const VirtualTextureLayout& layout);
+}
+
+struct TileCacheStats {
+    size_t allocations = 0;
+    size_t evictions = 0;
+    size_t failedAllocations = 0;   // every slot was pinned or in use this frame
+};
+
+// Fixed pool of physical slots. Tiles are evicted least recently used first, never while pinned
+// or while used in the current frame.
+class TileCache {
+    public:
+        TileCache(int slotsX, int slotsY);
+
+        int GetSlotCount() const { return static_cast<int>(slots.size()); }
+        int GetSlotsX() const { return slotsX; }
+        int GetSlotsY() const { return slotsY; }
+        size_t GetResidentCount() const { return slotsByTile.size(); }
+
+        // Slot index of a resident tile, -1 otherwise.
+        int Find(TileId tile) const;
+        bool IsResident(TileId tile) const { return Find(tile) >= 0; }
+
+        void Touch(TileId tile, uint64_t frame);
+
+        // Returns a slot for `tile`, evicting the least recently used unpinned tile if needed.
+        // `evicted` receives the tile that lost its slot, if any. Returns -1 if nothing can be evicted.
+        int Allocate(TileId tile, uint64_t frame, std::optional<TileId>& evicted);
+
+        void Pin(TileId tile);
+
+        const TileCacheStats& GetStats() const { return stats; }
+
+    private:
+        struct Slot {
+            TileId tile;
+            uint64_t lastUsedFrame = 0;
+            bool occupied = false;
+            bool pinned = false;
+        };
+
+        int slotsX;
+        int slotsY;
+        std::vector<Slot> slots;
+        std::unordered_map<uint32_t, int> slotsByTile;
+        TileCacheStats stats;
+};
+
+// CPU copy of the page table, one RGBA8 texel per tile and level: slot x, slot y, the level that is
+// actually mapped (the tile itself or its closest resident ancestor) and 255 once anything is mapped.
+class PageTable {
+    public:
+        explicit PageTable(const VirtualTextureLayout& layout);
+
+        void Map(TileId tile, int slotX, int slotY);
+        void Unmap(TileId tile);
+
+        // Rebuilds ancestor fallbacks after Map/Unmap; returns false if nothing changed.
+        bool Resolve();
+
+        const std::vector<uint32_t>& GetLevel(int level) const { return resolved[level]; }
+        uint32_t GetEntry(TileId tile) const;
+
+        static uint32_t MakeEntry(int slotX, int slotY, int level) {
+            return uint32_t(slotX) | (uint32_t(slotY) << 8) | (uint32_t(level) << 16) | 0xFF000000u;
+        }
+
+    private:
+        size_t indexOf(TileId tile) const;
+
+        VirtualTextureLayout layout;
+        std::vector<std::vector<uint32_t>> mapped;      // 0 where the tile itself is not resident
+        std::vector<std::vector<uint32_t>> resolved;
+        bool dirty = true;
+};
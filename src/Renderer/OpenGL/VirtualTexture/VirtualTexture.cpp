@@ -0,0 +1,411 @@
+#include "VirtualTexture.h"
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <SDL3/SDL.h>
+#include <spdlog/spdlog.h>
+
+#include "../Shader/Shader.h"
+#include "../Texture/TextureLoader.h"
+#include "../../../Utils/ThreadPool.h"
+
+// ARB_sparse_texture is not part of the core 4.6 glad loader
+#ifndef GL_TEXTURE_SPARSE_ARB
+#define GL_TEXTURE_SPARSE_ARB 0x91A6
+#endif
+#ifndef GL_VIRTUAL_PAGE_SIZE_INDEX_ARB
+#define GL_VIRTUAL_PAGE_SIZE_INDEX_ARB 0x91A7
+#endif
+#ifndef GL_NUM_SPARSE_LEVELS_ARB
+#define GL_NUM_SPARSE_LEVELS_ARB 0x91AA
+#endif
+#ifndef GL_VIRTUAL_PAGE_SIZE_X_ARB
+#define GL_VIRTUAL_PAGE_SIZE_X_ARB 0x9195
+#endif
+#ifndef GL_VIRTUAL_PAGE_SIZE_Y_ARB
+#define GL_VIRTUAL_PAGE_SIZE_Y_ARB 0x9196
+#endif
+
+using TexPageCommitmentFunction = void (APIENTRYP)(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint zoffset,
+                                                   GLsizei width, GLsizei height, GLsizei depth, GLboolean commit);
+
+static TexPageCommitmentFunction texPageCommitment = nullptr;
+
+static void CommitTile(GLuint texture, TileId tile, int tileSize, bool commit) {
+    glBindTexture(GL_TEXTURE_2D, texture);
+    texPageCommitment(GL_TEXTURE_2D, tile.level, tile.x * tileSize, tile.y * tileSize, 0,
+                      tileSize, tileSize, 1, commit ? GL_TRUE : GL_FALSE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+static std::vector<unsigned char> CropBorder(const std::vector<unsigned char>& texels, int tileSize, int border) {
+    const int padded = tileSize + 2 * border;
+    std::vector<unsigned char> interior(static_cast<size_t>(tileSize) * tileSize * 4);
+    for (int y = 0; y < tileSize; ++y) {
+        std::memcpy(&interior[static_cast<size_t>(y) * tileSize * 4],
+                    &texels[(static_cast<size_t>(y + border) * padded + border) * 4],
+                    static_cast<size_t>(tileSize) * 4);
+    }
+    return interior;
+}
+
+VirtualTexture::VirtualTexture(const std::string& path, const VirtualTextureSettings& settings)
+    : file(OpenVirtualTextureFile(path)),
+      settings(settings),
+      tileCache(settings.cacheSlotsX, settings.cacheSlotsY),
+      pageTable(file->GetLayout())
+{
+    const auto& layout = file->GetLayout();
+
+    sparse = settings.useSparseTexture && createSparseStorage();
+    if (!sparse) createPhysicalStorage();
+
+    pageTableTexture = CreateEmptyTexture(
+        layout.GetPagesX(0), layout.GetPagesY(0), 1,
+        TextureType::Tex2D, TextureInternalFormat::RGBA8, 0,
+        TextureFilter::NearestMipmapNearest, TextureFilter::Nearest,
+        TextureWrap::ClampToEdge, TextureWrap::ClampToEdge
+    );
+
+    auto vertex = CreateShader(ShaderStage::Vertex, "Shader/model.vert.glsl");
+    auto fragment = CreateShader(ShaderStage::Fragment, "Shader/vt_feedback.frag.glsl");
+    feedbackProgram = CreateShaderProgram({vertex.get(), fragment.get()});
+
+    for (auto& readback : readbacks) {
+        glCreateBuffers(1, &readback.buffer);
+    }
+
+    loadCoarsestLevel();
+
+    spdlog::info("Virtual texture {}: {}x{}, {} levels, {} px tiles, {} cache slots ({})",
+                 path, layout.width, layout.height, layout.levels, layout.tileSize,
+                 tileCache.GetSlotCount(), sparse ? "sparse texture" : "tile cache atlas");
+}
+
+VirtualTexture::~VirtualTexture() {
+    // Loader tasks read from `file`; let them finish before it goes away.
+    for (auto& [packed, load] : pendingLoads) {
+        load.wait();
+    }
+
+    for (auto& readback : readbacks) {
+        if (readback.fence) glDeleteSync(readback.fence);
+        if (readback.buffer) glDeleteBuffers(1, &readback.buffer);
+    }
+    if (feedbackFramebuffer) glDeleteFramebuffers(1, &feedbackFramebuffer);
+    if (feedbackColor) glDeleteTextures(1, &feedbackColor);
+    if (feedbackDepth) glDeleteRenderbuffers(1, &feedbackDepth);
+    if (sparseTexture) glDeleteTextures(1, &sparseTexture);
+}
+
+void VirtualTexture::createPhysicalStorage() {
+    const int padded = file->GetPaddedTileSize();
+    physicalTexture = CreateEmptyTexture(
+        settings.cacheSlotsX * padded, settings.cacheSlotsY * padded, 1,
+        TextureType::Tex2D, TextureInternalFormat::RGBA8, 0,
+        TextureFilter::Linear, TextureFilter::Linear,
+        TextureWrap::ClampToEdge, TextureWrap::ClampToEdge
+    );
+}
+
+bool VirtualTexture::createSparseStorage() {
+    if (!SDL_GL_ExtensionSupported("GL_ARB_sparse_texture")) return false;
+
+    texPageCommitment = reinterpret_cast<TexPageCommitmentFunction>(SDL_GL_GetProcAddress("glTexPageCommitmentARB"));
+    if (!texPageCommitment) return false;
+
+    const auto& layout = file->GetLayout();
+
+    GLint pageWidth = 0, pageHeight = 0;
+    glGetInternalformativ(GL_TEXTURE_2D, GL_RGBA8, GL_VIRTUAL_PAGE_SIZE_X_ARB, 1, &pageWidth);
+    glGetInternalformativ(GL_TEXTURE_2D, GL_RGBA8, GL_VIRTUAL_PAGE_SIZE_Y_ARB, 1, &pageHeight);
+    if (pageWidth != layout.tileSize || pageHeight != layout.tileSize) {
+        spdlog::info("Sparse page size {}x{} does not match {} px tiles, using the tile cache atlas",
+                     pageWidth, pageHeight, layout.tileSize);
+        return false;
+    }
+
+    glCreateTextures(GL_TEXTURE_2D, 1, &sparseTexture);
+    glTextureParameteri(sparseTexture, GL_TEXTURE_SPARSE_ARB, GL_TRUE);
+    glTextureParameteri(sparseTexture, GL_VIRTUAL_PAGE_SIZE_INDEX_ARB, 0);
+    glTextureStorage2D(sparseTexture, layout.levels, GL_RGBA8, layout.width, layout.height);
+
+    // Levels in the mip tail cannot be committed per tile; every stored level must be sparse.
+    GLint sparseLevels = 0;
+    glGetTextureParameteriv(sparseTexture, GL_NUM_SPARSE_LEVELS_ARB, &sparseLevels);
+    if (sparseLevels < layout.levels) {
+        glDeleteTextures(1, &sparseTexture);
+        sparseTexture = 0;
+        return false;
+    }
+
+    // Bilinear within one level: the shader picks the resident level and nothing may blend in
+    // a neighbouring level that is not committed
+    SamplerDesc samplerDesc;
+    samplerDesc.minFilter = TextureFilter::LinearMipmapNearest;
+    samplerDesc.minLod = 0.0f;
+    samplerDesc.maxLod = static_cast<float>(layout.levels - 1);
+    sparseSampler = GetSamplerCache().Get(samplerDesc);
+    return true;
+}
+
+void VirtualTexture::loadCoarsestLevel() {
+    // The coarsest level stays resident so every lookup has something to fall back to.
+    const auto& layout = file->GetLayout();
+    const int level = layout.levels - 1;
+
+    for (int y = 0; y < layout.GetPagesY(level); ++y) {
+        for (int x = 0; x < layout.GetPagesX(level); ++x) {
+            TileId tile{uint8_t(level), uint16_t(x), uint16_t(y)};
+            auto texels = file->ReadTile(tile);
+            if (sparse) texels = CropBorder(texels, layout.tileSize, file->GetBorder());
+            uploadTile(tile, texels);
+            tileCache.Pin(tile);
+        }
+    }
+
+    if (pageTable.Resolve()) {
+        for (int level = 0; level < layout.levels; ++level) {
+            const auto& entries = pageTable.GetLevel(level);
+            TextureLoader::Upload(pageTableTexture->id, TextureType::Tex2D, level, 0,
+                                  layout.GetPagesX(level), layout.GetPagesY(level),
+                                  TextureFormat::RGBA, TextureInternalFormat::RGBA8,
+                                  entries.data(), entries.size() * sizeof(uint32_t));
+        }
+    }
+}
+
+void VirtualTexture::resizeFeedback(int width, int height) {
+    if (width == feedbackWidth && height == feedbackHeight) return;
+
+    if (feedbackFramebuffer) glDeleteFramebuffers(1, &feedbackFramebuffer);
+    if (feedbackColor) glDeleteTextures(1, &feedbackColor);
+    if (feedbackDepth) glDeleteRenderbuffers(1, &feedbackDepth);
+
+    feedbackWidth = width;
+    feedbackHeight = height;
+
+    glCreateTextures(GL_TEXTURE_2D, 1, &feedbackColor);
+    glTextureStorage2D(feedbackColor, 1, GL_R32UI, width, height);
+
+    glCreateRenderbuffers(1, &feedbackDepth);
+    glNamedRenderbufferStorage(feedbackDepth, GL_DEPTH_COMPONENT24, width, height);
+
+    glCreateFramebuffers(1, &feedbackFramebuffer);
+    glNamedFramebufferTexture(feedbackFramebuffer, GL_COLOR_ATTACHMENT0, feedbackColor, 0);
+    glNamedFramebufferRenderbuffer(feedbackFramebuffer, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, feedbackDepth);
+
+    if (glCheckNamedFramebufferStatus(feedbackFramebuffer, GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        throw std::runtime_error("Virtual texture feedback framebuffer is incomplete");
+    }
+}
+
+ShaderProgram& VirtualTexture::BeginFeedbackPass(int viewportWidth, int viewportHeight) {
+    const auto& layout = file->GetLayout();
+    const int divisor = std::max(1, settings.feedbackDivisor);
+
+    resizeFeedback(std::max(1, viewportWidth / divisor), std::max(1, viewportHeight / divisor));
+
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+    glGetIntegerv(GL_VIEWPORT, previousViewport);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, feedbackFramebuffer);
+    glViewport(0, 0, feedbackWidth, feedbackHeight);
+
+    const GLuint noTile[4] = {0, 0, 0, 0};
+    const GLfloat farDepth = 1.0f;
+    glClearBufferuiv(GL_COLOR, 0, noTile);
+    glClearBufferfv(GL_DEPTH, 0, &farDepth);
+
+    // The feedback target is smaller than the viewport, so its derivatives are `divisor` times larger.
+    feedbackProgram->SetUniformVec2("u_vtVirtualSize", glm::vec2(layout.width, layout.height));
+    feedbackProgram->SetUniform1f("u_vtTileSize", static_cast<float>(layout.tileSize));
+    feedbackProgram->SetUniform1i("u_vtLevels", layout.levels);
+    feedbackProgram->SetUniform1f("u_vtLodBias", settings.lodBias - std::log2(static_cast<float>(divisor)));
+    feedbackProgram->useShaderProgram();
+
+    return *feedbackProgram;
+}
+
+void VirtualTexture::EndFeedbackPass() {
+    Readback& readback = readbacks[readbackIndex];
+
+    // If the GPU has not finished the older readback yet, skip this frame's feedback.
+    if (!readback.fence) {
+        const size_t size = static_cast<size_t>(feedbackWidth) * feedbackHeight * sizeof(uint32_t);
+        if (readback.width != feedbackWidth || readback.height != feedbackHeight) {
+            glNamedBufferData(readback.buffer, static_cast<GLsizeiptr>(size), nullptr, GL_STREAM_READ);
+            readback.width = feedbackWidth;
+            readback.height = feedbackHeight;
+        }
+
+        glNamedFramebufferReadBuffer(feedbackFramebuffer, GL_COLOR_ATTACHMENT0);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        glReadPixels(0, 0, feedbackWidth, feedbackHeight, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        readbackIndex ^= 1;
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+    glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+}
+
+void VirtualTexture::readFeedback() {
+    // The slot about to be written next holds the older readback.
+    for (int i = 0; i < 2; ++i) {
+        Readback& readback = readbacks[(readbackIndex + i) & 1];
+        if (!readback.fence) continue;
+        if (glClientWaitSync(readback.fence, 0, 0) == GL_TIMEOUT_EXPIRED) continue;
+
+        glDeleteSync(readback.fence);
+        readback.fence = nullptr;
+
+        auto start = std::chrono::high_resolution_clock::now();
+
+        const size_t count = static_cast<size_t>(readback.width) * readback.height;
+        const void* mapped = glMapNamedBufferRange(readback.buffer, 0,
+                                                   static_cast<GLsizeiptr>(count * sizeof(uint32_t)), GL_MAP_READ_BIT);
+        if (!mapped) continue;
+
+        auto requests = TileFeedback::Analyze(static_cast<const uint32_t*>(mapped), count, file->GetLayout());
+        glUnmapNamedBuffer(readback.buffer);
+
+        requestTiles(requests);
+
+        stats.requestedTiles = requests.size();
+        stats.feedbackMilliseconds = std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - start).count();
+    }
+}
+
+void VirtualTexture::requestTiles(const std::vector<TileRequest>& requests) {
+    const auto& layout = file->GetLayout();
+    const bool crop = sparse;
+    const int border = file->GetBorder();
+    VirtualTextureFile* source = file.get();
+
+    for (const auto& request : requests) {
+        if (tileCache.IsResident(request.tile)) {
+            tileCache.Touch(request.tile, frame);
+            continue;
+        }
+
+        const uint32_t packed = request.tile.Pack();
+        if (pendingLoads.count(packed)) continue;
+        if (static_cast<int>(pendingLoads.size()) >= settings.maxPendingLoads) continue;
+
+        TileId tile = request.tile;
+        const int tileSize = layout.tileSize;
+        pendingLoads.emplace(packed, GetThreadPool().Submit([source, tile, crop, tileSize, border] {
+            auto texels = source->ReadTile(tile);
+            return crop ? CropBorder(texels, tileSize, border) : texels;
+        }));
+    }
+}
+
+void VirtualTexture::uploadTile(TileId tile, const std::vector<unsigned char>& texels) {
+    std::optional<TileId> evicted;
+    int slot = tileCache.Allocate(tile, frame, evicted);
+    if (slot < 0) return;
+
+    const auto& layout = file->GetLayout();
+
+    if (evicted) {
+        pageTable.Unmap(*evicted);
+        if (sparse) CommitTile(sparseTexture, *evicted, layout.tileSize, false);
+    }
+
+    const int slotX = slot % tileCache.GetSlotsX();
+    const int slotY = slot / tileCache.GetSlotsX();
+
+    if (sparse) {
+        CommitTile(sparseTexture, tile, layout.tileSize, true);
+        TextureLoader::Upload(sparseTexture, TextureType::Tex2D, tile.level, 0, layout.tileSize, layout.tileSize,
+                              TextureFormat::RGBA, TextureInternalFormat::RGBA8, texels.data(), texels.size(),
+                              tile.x * layout.tileSize, tile.y * layout.tileSize);
+    } else {
+        const int padded = file->GetPaddedTileSize();
+        TextureLoader::Upload(physicalTexture->id, TextureType::Tex2D, 0, 0, padded, padded,
+                              TextureFormat::RGBA, TextureInternalFormat::RGBA8, texels.data(), texels.size(),
+                              slotX * padded, slotY * padded);
+    }
+
+    pageTable.Map(tile, slotX, slotY);
+    ++stats.uploadedTiles;
+}
+
+void VirtualTexture::uploadCompletedTiles() {
+    int uploads = 0;
+    for (auto it = pendingLoads.begin(); it != pendingLoads.end() && uploads < settings.maxUploadsPerFrame;) {
+        if (it->second.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            ++it;
+            continue;
+        }
+
+        try {
+            uploadTile(TileId::Unpack(it->first), it->second.get());
+            ++uploads;
+        } catch (const std::exception& e) {
+            spdlog::error("Virtual texture tile load failed: {}", e.what());
+        }
+        it = pendingLoads.erase(it);
+    }
+}
+
+void VirtualTexture::Update() {
+    ++frame;
+
+    readFeedback();
+    uploadCompletedTiles();
+
+    if (pageTable.Resolve()) {
+        const auto& layout = file->GetLayout();
+        for (int level = 0; level < layout.levels; ++level) {
+            const auto& entries = pageTable.GetLevel(level);
+            TextureLoader::Upload(pageTableTexture->id, TextureType::Tex2D, level, 0,
+                                  layout.GetPagesX(level), layout.GetPagesY(level),
+                                  TextureFormat::RGBA, TextureInternalFormat::RGBA8,
+                                  entries.data(), entries.size() * sizeof(uint32_t));
+        }
+    }
+
+    const auto& cacheStats = tileCache.GetStats();
+    stats.residentTiles = tileCache.GetResidentCount();
+    stats.pendingLoads = pendingLoads.size();
+    stats.evictions = cacheStats.evictions;
+    stats.failedAllocations = cacheStats.failedAllocations;
+}
+
+void VirtualTexture::Bind(ShaderProgram& program, GLuint pageTableUnit, GLuint physicalUnit) const {
+    const auto& layout = file->GetLayout();
+
+    pageTableTexture->BindTextureForSampling(pageTableUnit);
+    if (sparse) {
+        glBindTextureUnit(physicalUnit, sparseTexture);
+        sparseSampler->Bind(physicalUnit);
+    } else {
+        physicalTexture->BindTextureForSampling(physicalUnit);
+    }
+
+    program.SetUniform1i("u_vtPageTable", static_cast<int>(pageTableUnit));
+    program.SetUniform1i("u_vtPhysical", static_cast<int>(physicalUnit));
+    program.SetUniformVec2("u_vtVirtualSize", glm::vec2(layout.width, layout.height));
+    program.SetUniform1f("u_vtTileSize", static_cast<float>(layout.tileSize));
+    program.SetUniform1i("u_vtLevels", layout.levels);
+    program.SetUniform1f("u_vtBorder", static_cast<float>(file->GetBorder()));
+    program.SetUniform1i("u_vtSparse", sparse ? 1 : 0);
+    if (!sparse) {
+        program.SetUniformVec2("u_vtPhysicalSize", glm::vec2(physicalTexture->width, physicalTexture->height));
+    }
+}
+
+void VirtualTexture::LogStats() const {
+    spdlog::info("Virtual texture: {} requested, {} resident, {} pending, {} uploaded, {} evictions, "
+                 "{} failed allocations, feedback {:.2f} ms",
+                 stats.requestedTiles, stats.residentTiles, stats.pendingLoads, stats.uploadedTiles,
+                 stats.evictions, stats.failedAllocations, stats.feedbackMilliseconds);
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <future>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <glad/glad.h>
+#include "TileCache.h"
+#include "VirtualTextureFile.h"
+#include "../Texture/Texture.h"
+#include "../Texture/Sampler.h"
+#include "../Shader/ShaderProgram.h"
+
+// Streams a tiled virtual texture from disk into a fixed physical tile cache.
+//
+// Each frame the scene is drawn once into a small feedback target that records which tile every pixel
+// needs. The result is read back asynchronously, turned into prioritized tile requests, and missing
+// tiles are read on the worker pool. Finished tiles are uploaded on the GL thread and the page table
+// texture maps every virtual tile to its physical slot or to the closest resident ancestor.
+//
+// With ARB_sparse_texture (and a tile size equal to the sparse page size) tiles are committed into one
+// sparse texture instead; the page table then only stores the finest resident level per tile.
+
+struct VirtualTextureSettings {
+    int cacheSlotsX = 32;           // physical cache size in tiles
+    int cacheSlotsY = 32;
+    int feedbackDivisor = 8;        // feedback target is the viewport divided by this
+    int maxUploadsPerFrame = 16;
+    int maxPendingLoads = 64;
+    float lodBias = 0.0f;
+    bool useSparseTexture = true;   // only used when the extension and page size allow it
+};
+
+struct VirtualTextureStats {
+    size_t requestedTiles = 0;      // unique tiles asked for by the last feedback
+    size_t residentTiles = 0;
+    size_t pendingLoads = 0;
+    size_t uploadedTiles = 0;
+    size_t evictions = 0;
+    size_t failedAllocations = 0;
+    double feedbackMilliseconds = 0.0;
+};
+
+class VirtualTexture {
+    public:
+        VirtualTexture(const std::string& path, const VirtualTextureSettings& settings = {});
+        ~VirtualTexture();
+
+        VirtualTexture(const VirtualTexture&) = delete;
+        VirtualTexture& operator=(const VirtualTexture&) = delete;
+
+        // Binds the feedback target and program; draw the geometry that samples this texture, setting
+        // u_modelMatrix on the returned program, then call EndFeedbackPass().
+        ShaderProgram& BeginFeedbackPass(int viewportWidth, int viewportHeight);
+        void EndFeedbackPass();
+
+        // Consumes finished feedback, issues tile loads, uploads completed tiles and the page table.
+        void Update();
+
+        // Binds the page table and tile storage and sets the u_vt* uniforms used by vt_sample.frag.glsl.
+        void Bind(ShaderProgram& program, GLuint pageTableUnit, GLuint physicalUnit) const;
+
+        bool IsSparse() const { return sparse; }
+        const VirtualTextureLayout& GetLayout() const { return file->GetLayout(); }
+        const VirtualTextureStats& GetStats() const { return stats; }
+        void LogStats() const;
+
+    private:
+        void createPhysicalStorage();
+        bool createSparseStorage();
+        void resizeFeedback(int width, int height);
+        void readFeedback();
+        void requestTiles(const std::vector<TileRequest>& requests);
+        void uploadCompletedTiles();
+        void uploadTile(TileId tile, const std::vector<unsigned char>& texels);
+        void loadCoarsestLevel();
+
+        std::unique_ptr<VirtualTextureFile> file;
+        VirtualTextureSettings settings;
+        VirtualTextureStats stats;
+
+        TileCache tileCache;
+        PageTable pageTable;
+        uint64_t frame = 0;
+
+        std::unique_ptr<Texture> pageTableTexture;
+        std::unique_ptr<Texture> physicalTexture;       // tile cache atlas, unused when sparse
+        GLuint sparseTexture = 0;
+        std::shared_ptr<const Sampler> sparseSampler;
+        bool sparse = false;
+
+        std::unique_ptr<ShaderProgram> feedbackProgram;
+        GLuint feedbackFramebuffer = 0;
+        GLuint feedbackColor = 0;
+        GLuint feedbackDepth = 0;
+        int feedbackWidth = 0;
+        int feedbackHeight = 0;
+        GLint previousFramebuffer = 0;
+        GLint previousViewport[4] = {};
+
+        // Readbacks are double-buffered so the CPU never waits on the frame it just submitted.
+        struct Readback {
+            GLuint buffer = 0;
+            GLsync fence = nullptr;
+            int width = 0;
+            int height = 0;
+        };
+        Readback readbacks[2];
+        int readbackIndex = 0;
+
+        std::unordered_map<uint32_t, std::future<std::vector<unsigned char>>> pendingLoads;
+};
+
+inline std::unique_ptr<VirtualTexture> CreateVirtualTexture(const std::string& path, const VirtualTextureSettings& settings = {}) {
+    return std::make_unique<VirtualTexture>(path, settings);
+}
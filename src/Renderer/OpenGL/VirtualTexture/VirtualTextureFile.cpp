@@ -0,0 +1,122 @@
+#include "VirtualTextureFile.h"
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <spdlog/spdlog.h>
+
+#include "../Texture/TextureLoader.h"
+#include "../Texture/TextureMips.h"
+
+VirtualTextureFile::VirtualTextureFile(const std::string& path)
+    : stream(path, std::ios::binary)
+{
+    if (!stream) throw std::runtime_error("Failed to open virtual texture: " + path);
+
+    stream.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!stream || std::memcmp(header.magic, "VTEX", 4) != 0 || header.version != 1 || header.channels != 4) {
+        throw std::runtime_error("Not a virtual texture file: " + path);
+    }
+
+    layout = VirtualTextureLayout::Create(header.width, header.height, header.tileSize);
+    if (static_cast<uint32_t>(layout.levels) != header.levels) {
+        throw std::runtime_error("Virtual texture level count does not match its size: " + path);
+    }
+}
+
+uint64_t VirtualTextureFile::tileOffset(TileId tile) const {
+    uint64_t index = 0;
+    for (int level = 0; level < tile.level; ++level) {
+        index += static_cast<uint64_t>(layout.GetPagesX(level)) * layout.GetPagesY(level);
+    }
+    index += static_cast<uint64_t>(tile.y) * layout.GetPagesX(tile.level) + tile.x;
+    return sizeof(VirtualTextureHeader) + index * GetTileBytes();
+}
+
+std::vector<unsigned char> VirtualTextureFile::ReadTile(TileId tile) {
+    std::vector<unsigned char> texels(GetTileBytes());
+
+    std::lock_guard<std::mutex> lock(streamMutex);
+    stream.seekg(static_cast<std::streamoff>(tileOffset(tile)));
+    stream.read(reinterpret_cast<char*>(texels.data()), static_cast<std::streamsize>(texels.size()));
+    if (!stream) {
+        stream.clear();
+        throw std::runtime_error("Failed to read virtual texture tile");
+    }
+    return texels;
+}
+
+void VirtualTextureFile::Write(const std::string& path, const unsigned char* rgba, int width, int height,
+                               int tileSize, int border) {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    VirtualTextureLayout layout = VirtualTextureLayout::Create(width, height, tileSize);
+
+    VirtualTextureHeader header;
+    header.width = width;
+    header.height = height;
+    header.tileSize = tileSize;
+    header.border = border;
+    header.levels = layout.levels;
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file) throw std::runtime_error("Failed to create virtual texture: " + path);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    MipSettings settings;
+    settings.maxLevels = layout.levels;
+    MipChain chain = MipGeneration::Generate(rgba, width, height, 4, settings);
+
+    const int padded = tileSize + 2 * border;
+    std::vector<unsigned char> tile(static_cast<size_t>(padded) * padded * 4);
+
+    for (int level = 0; level < layout.levels; ++level) {
+        const int levelWidth = width >> level;
+        const int levelHeight = height >> level;
+        const unsigned char* pixels = chain.levels[level].data();
+
+        for (int tileY = 0; tileY < layout.GetPagesY(level); ++tileY) {
+            for (int tileX = 0; tileX < layout.GetPagesX(level); ++tileX) {
+                // Borders wrap around the texture edge, matching GL_REPEAT addressing.
+                for (int y = 0; y < padded; ++y) {
+                    int sourceY = ((tileY * tileSize + y - border) % levelHeight + levelHeight) % levelHeight;
+                    for (int x = 0; x < padded; ++x) {
+                        int sourceX = ((tileX * tileSize + x - border) % levelWidth + levelWidth) % levelWidth;
+                        std::memcpy(&tile[(static_cast<size_t>(y) * padded + x) * 4],
+                                    &pixels[(static_cast<size_t>(sourceY) * levelWidth + sourceX) * 4], 4);
+                    }
+                }
+                file.write(reinterpret_cast<const char*>(tile.data()), static_cast<std::streamsize>(tile.size()));
+            }
+        }
+    }
+
+    if (!file) throw std::runtime_error("Failed to write virtual texture: " + path);
+
+    double milliseconds = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - start).count();
+    spdlog::info("Wrote virtual texture {} ({}x{}, {} levels, {} px tiles) in {:.1f} ms",
+                 path, width, height, layout.levels, tileSize, milliseconds);
+}
+
+void VirtualTextureFile::Convert(const std::string& imagePath, const std::string& path, int tileSize, int border) {
+    DecodedImage image = TextureLoader::Decode(imagePath, 4, true);
+    if (!image.Valid()) throw std::runtime_error("Failed to load texture: " + imagePath);
+    Write(path, image.pixels.data(), image.width, image.height, tileSize, border);
+}
+
+std::string VirtualTextureFile::ConvertIfOutdated(const std::string& path, int tileSize, int border) {
+    std::filesystem::path converted(path);
+    if (converted.extension() == ".vtex") return path;
+    converted.replace_extension(".vtex");
+
+    std::error_code error;
+    const auto imageTime = std::filesystem::last_write_time(path, error);
+    if (error) throw std::runtime_error("Failed to open texture: " + path);
+
+    const auto convertedTime = std::filesystem::last_write_time(converted, error);
+    if (error || convertedTime < imageTime) {
+        Convert(path, converted.string(), tileSize, border);
+    }
+    return converted.string();
+}
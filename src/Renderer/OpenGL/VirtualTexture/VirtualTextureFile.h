@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "TileCache.h"
+
+// Tiled on-disk format for virtual textures: a small header followed by every tile of every level,
+// finest level first and row-major inside a level. Tiles are RGBA8 with `border` texels copied from
+// their neighbours on each side so bilinear filtering in the physical cache never crosses into an
+// unrelated tile. All tiles have the same size, so a tile's offset is computed instead of stored.
+
+struct VirtualTextureHeader {
+    char magic[4] = {'V', 'T', 'E', 'X'};
+    uint32_t version = 1;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t tileSize = 0;
+    uint32_t border = 0;
+    uint32_t levels = 0;
+    uint32_t channels = 4;
+};
+
+class VirtualTextureFile {
+    public:
+        explicit VirtualTextureFile(const std::string& path);
+
+        // Builds the mip chain of `rgba` and writes it as tiles. Width and height must be powers of two.
+        static void Write(const std::string& path, const unsigned char* rgba, int width, int height,
+                          int tileSize = 128, int border = 4);
+        // Decodes an image file and writes it with Write().
+        static void Convert(const std::string& imagePath, const std::string& path, int tileSize = 128, int border = 4);
+        // Returns `path` if it is a .vtex file, otherwise the .vtex next to the image, converting it
+        // first when it is missing or older than the image.
+        static std::string ConvertIfOutdated(const std::string& path, int tileSize = 128, int border = 4);
+
+        // Thread-safe; returns (tileSize + 2 * border)^2 RGBA8 texels.
+        std::vector<unsigned char> ReadTile(TileId tile);
+
+        const VirtualTextureLayout& GetLayout() const { return layout; }
+        int GetBorder() const { return static_cast<int>(header.border); }
+        int GetPaddedTileSize() const { return layout.tileSize + 2 * GetBorder(); }
+        size_t GetTileBytes() const { return static_cast<size_t>(GetPaddedTileSize()) * GetPaddedTileSize() * 4; }
+
+    private:
+        uint64_t tileOffset(TileId tile) const;
+
+        VirtualTextureHeader header;
+        VirtualTextureLayout layout;
+        std::ifstream stream;
+        std::mutex streamMutex;
+};
+
+inline std::unique_ptr<VirtualTextureFile> OpenVirtualTextureFile(const std::string& path) {
+    return std::make_unique<VirtualTextureFile>(path);
+}
@@ -33,6 +33,9 @@ struct OpenGLSettings {
     GLenum blendSrc = GL_SRC_ALPHA;
     GLenum blendDst = GL_ONE_MINUS_SRC_ALPHA;
 
+    // Filters across cube map faces, so prefiltered environment mips have no seams
+    bool seamlessCubeMaps = true;
+
     void Apply() const {
         if (depthTest) {
             glEnable(GL_DEPTH_TEST);
@@ -54,6 +57,12 @@ struct OpenGLSettings {
         } else {
             glDisable(GL_BLEND);
         }
+
+        if (seamlessCubeMaps) {
+            glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+        } else {
+            glDisable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+        }
     }
 };
 
@@ -2,10 +2,7 @@
 
 layout(location = 0) in vec3 aPos;
 
-layout(std140, binding = 0) uniform CameraData {
-    mat4 view;
-    mat4 projection;
-};
+#include "include/frame.glsl"
 
 uniform float uTime;
 uniform sampler2D uTexture;
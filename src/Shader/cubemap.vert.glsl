@@ -1,10 +1,7 @@
 #version 460 core
 layout(location = 0) in vec3 aPos;
 
-layout(std140, binding = 0) uniform CameraData {
-    mat4 view;
-    mat4 projection;
-};
+#include "include/frame.glsl"
 
 out vec3 TexCoords;
 
@@ -0,0 +1,47 @@
+#version 460 core
+
+// Shades each visible pixel once from the G-buffer, with the same lights as the forward path.
+
+in vec2 texCoords;
+
+layout(location = 0) out vec4 FragColor;
+layout(location = 1) out vec4 Velocity;
+
+layout(binding = 0) uniform sampler2D u_gbufferAlbedo;
+layout(binding = 1) uniform sampler2D u_gbufferNormal;
+layout(binding = 2) uniform sampler2D u_gbufferMaterial;
+layout(binding = 3) uniform sampler2D u_gbufferEmissive;
+layout(binding = 4) uniform sampler2D u_gbufferVelocity;
+layout(binding = 5) uniform sampler2D u_gbufferDepth;
+
+#include "include/gbuffer.glsl"
+#include "include/lighting.glsl"
+#include "include/environment.glsl"
+#include "include/ambient_occlusion.glsl"
+
+void main() {
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    float depth = texelFetch(u_gbufferDepth, pixel, 0).r;
+    if (depth >= 1.0) discard;      // background keeps the clear color
+
+    vec4 albedoOcclusion = texelFetch(u_gbufferAlbedo, pixel, 0);
+    vec3 N = decodeNormal(texelFetch(u_gbufferNormal, pixel, 0).xy);
+    vec2 metallicRoughness = texelFetch(u_gbufferMaterial, pixel, 0).xy;
+    vec3 emissive = texelFetch(u_gbufferEmissive, pixel, 0).rgb;
+
+    vec4 world = inverseViewProjection * vec4(texCoords * 2.0 - 1.0, depth * 2.0 - 1.0, 1.0);
+    vec3 position = world.xyz / world.w;
+
+    vec3 V = normalize(cameraPosition.xyz - position);
+    vec3 Lo = evaluateSceneLights(position, gl_FragCoord.xy, N, V, albedoOcclusion.rgb,
+                                  metallicRoughness.x, metallicRoughness.y);
+
+    vec3 ambient = evaluateAmbient(N, V, albedoOcclusion.rgb, metallicRoughness.x, metallicRoughness.y,
+                                   albedoOcclusion.a * sampleAmbientOcclusion(gl_FragCoord.xy));
+
+    vec3 color = ambient + Lo + emissive;
+
+    // Linear HDR; exposure, tonemapping and gamma are applied by the post stack
+    FragColor = vec4(color, 1.0);
+    Velocity = vec4(texelFetch(u_gbufferVelocity, pixel, 0).xy, 0.0, 1.0);
+}
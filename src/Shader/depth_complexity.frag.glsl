@@ -0,0 +1,27 @@
+#version 460 core
+
+// Heat map of the fragment counts: black for none, blue for one, through green and yellow to red
+// at u_maxCount and beyond.
+
+in vec2 texCoords;
+
+layout(location = 0) out vec4 FragColor;
+layout(location = 1) out vec4 Velocity;     // a screen overlay does not move
+
+layout(binding = 0) uniform sampler2D u_counts;
+
+uniform float u_maxCount;
+
+void main() {
+    Velocity = vec4(0.0, 0.0, 0.0, 1.0);
+    float count = texelFetch(u_counts, ivec2(gl_FragCoord.xy), 0).r;
+    if (count < 0.5) {
+        FragColor = vec4(0.0, 0.0, 0.0, 1.0);
+        return;
+    }
+
+    const vec3 ramp[4] = vec3[](vec3(0.0, 0.2, 1.0), vec3(0.0, 1.0, 0.2), vec3(1.0, 1.0, 0.0), vec3(1.0, 0.0, 0.0));
+    float t = clamp((count - 1.0) / max(u_maxCount - 1.0, 1.0), 0.0, 1.0) * 3.0;
+    int segment = min(int(t), 2);
+    FragColor = vec4(mix(ramp[segment], ramp[segment + 1], t - float(segment)), 1.0);
+}
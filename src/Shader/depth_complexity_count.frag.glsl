@@ -0,0 +1,9 @@
+#version 460 core
+
+// Adds one per fragment that survives the depth test; additive blending accumulates the count.
+
+layout(location = 0) out float count;
+
+void main() {
+    count = 1.0;
+}
@@ -0,0 +1,18 @@
+#version 460 core
+
+// Depth prepass: reads the tightly packed position stream and has no fragment stage, so the
+// rasterizer only writes depth. The transform must match model.vert expression for expression;
+// together with `invariant` that makes the shaded pass reproduce these depths exactly for GL_EQUAL.
+
+layout (location = 0) in vec3 aPosition;
+
+#include "include/frame.glsl"
+
+uniform mat4 u_modelMatrix;
+
+invariant gl_Position;
+
+void main() {
+    vec4 worldPos = u_modelMatrix * vec4(aPosition, 1.0);
+    gl_Position = projection * view * worldPos;
+}
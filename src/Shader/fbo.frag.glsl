@@ -1,11 +0,0 @@
-#version 460 core 
-
-out vec4 FragColor;
-
-in vec2 texCoords;
-
-uniform sampler2D screenTexture;
-
-void main() {
-    FragColor = texture(screenTexture, texCoords);
-}
\ No newline at end of file
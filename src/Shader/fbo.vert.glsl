@@ -1,11 +0,0 @@
-#version 460 core 
-
-layout (location = 0) in vec2 aPos;
-layout (location = 1) in vec2 aTexCoords;
-
-out vec2 texCoords;
-
-void main() {
-    gl_Position = vec4(aPos, 1, 1);
-    texCoords = aTexCoords;
-}
\ No newline at end of file
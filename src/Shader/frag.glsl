@@ -1,11 +1,17 @@
 #version 460 core
 
 in vec2 TexCoord;
+in vec4 CurrentClip;
+in vec4 PreviousClip;
 
-out vec4 FragColor;
+layout(location = 0) out vec4 FragColor;
+layout(location = 1) out vec4 Velocity;
 
 uniform sampler2D uTexture;
 
+#include "include/velocity.glsl"
+
 void main() {
     FragColor = texture(uTexture, TexCoord);
+    Velocity = encodeVelocity(CurrentClip, PreviousClip);
 }
\ No newline at end of file
@@ -0,0 +1,32 @@
+#version 460 core
+
+// Material sampling only; lighting happens once per pixel in deferred_lighting.frag.
+
+in vec3 FragPos;
+in vec3 Normal;
+in vec2 TexCoords;
+in vec3 Tangent;
+in vec3 Bitangent;
+in mat3 TBN;
+in vec4 CurrentClip;
+in vec4 PreviousClip;
+
+layout(location = 0) out vec4 outAlbedo;
+layout(location = 1) out vec2 outNormal;
+layout(location = 2) out vec4 outMaterial;
+layout(location = 3) out vec3 outEmissive;
+layout(location = 4) out vec4 outVelocity;
+
+#include "include/material.glsl"
+#include "include/gbuffer.glsl"
+#include "include/velocity.glsl"
+
+void main() {
+    MaterialSample m = sampleMaterial();
+
+    outAlbedo = vec4(m.baseColor.rgb, m.occlusion);
+    outNormal = encodeNormal(m.normal);
+    outMaterial = vec4(m.metallic, m.roughness, 0.0, 0.0);
+    outEmissive = m.emissive;
+    outVelocity = encodeVelocity(CurrentClip, PreviousClip);
+}
@@ -0,0 +1,9 @@
+// Screen-space ambient occlusion computed by AmbientOcclusion before the opaque pass, at full render
+// resolution. With the effect off a 1x1 white texture is bound instead, so the lookup is always safe.
+
+layout(binding = 11) uniform sampler2D ambientOcclusionTexture;
+
+// Occlusion of the ambient light at window position `fragCoord`, 1 when unoccluded
+float sampleAmbientOcclusion(vec2 fragCoord) {
+    return textureLod(ambientOcclusionTexture, fragCoord / vec2(textureSize(ambientOcclusionTexture, 0)), 0.0).r;
+}
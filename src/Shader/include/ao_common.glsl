@@ -0,0 +1,27 @@
+// Shared by the ambient occlusion compute passes (AmbientOcclusion/AmbientOcclusion.h). Each pixel of
+// the reduced-resolution buffers holds one full-resolution depth sample from its downsample x
+// downsample block, and every pass agrees on which one through fullPixelOf(), so positions rebuilt
+// at low resolution line up with the full-resolution frame.
+
+#include "frame.glsl"
+
+uniform int u_downsample;
+
+// Full-resolution pixel a low-resolution pixel stands for
+ivec2 fullPixelOf(ivec2 lowPixel) {
+    return min(lowPixel * u_downsample + u_downsample / 2, ivec2(resolution) - 1);
+}
+
+// Positive view-space distance of a depth buffer value; 0 marks the background
+float linearizeDepth(float depth) {
+    if (depth >= 1.0) return 0.0;
+    return projection[3][2] / (depth * 2.0 - 1.0 + projection[2][2]);
+}
+
+// View-space position of full-resolution `pixelCenter` at `viewDepth`, with the jittered projection
+// the depth was rendered with
+vec3 viewPosition(vec2 pixelCenter, float viewDepth) {
+    vec2 ndc = pixelCenter / resolution * 2.0 - 1.0;
+    vec2 xy = (ndc + vec2(projection[2][0], projection[2][1])) * viewDepth / vec2(projection[0][0], projection[1][1]);
+    return vec3(xy, -viewDepth);
+}
@@ -0,0 +1,13 @@
+// Soft-knee bloom threshold, shared by the first bloom downsample and the composite in
+// post_process.comp, so the composite takes out of each pixel exactly the light the chain scattered.
+// A threshold of 0 scatters all light, the physically based setting. Values from Bloom::GetThresholdCurve().
+
+uniform vec4 u_bloomCurve;      // threshold, threshold - knee, 2 * knee, 0.25 / knee
+
+vec3 bloomPrefilter(vec3 color) {
+    float brightness = max(color.r, max(color.g, color.b));
+    float soft = clamp(brightness - u_bloomCurve.y, 0.0, u_bloomCurve.z);
+    soft = u_bloomCurve.w * soft * soft;
+    float contribution = max(soft, brightness - u_bloomCurve.x) / max(brightness, 1e-4);
+    return color * contribution;
+}
@@ -0,0 +1,53 @@
+// Clustered light lists written by cluster_assign.comp; see Lighting/ClusteredLighting.h.
+// The frustum is cut into clusterGrid.x * clusterGrid.y screen tiles and clusterGrid.z depth slices.
+
+layout(std140, binding = 1) uniform ClusterData {
+    uvec4 clusterGrid;          // tiles x, tiles y, depth slices, max lights per cluster
+    vec4 clusterDepth;          // near, far, slice scale, slice bias
+    vec2 clusterTileSize;       // pixels per tile
+    uint clusterLightCount;
+};
+
+struct Light {
+    vec4 positionRange;         // xyz world position, w range
+    vec4 colorIntensity;        // rgb color, w intensity
+    vec4 directionType;         // xyz spot direction, w 0 = point, 1 = spot
+    vec4 spotAngles;            // x cos(inner), y cos(outer)
+};
+
+layout(std430, binding = 0) readonly buffer ClusterLights {
+    Light lights[];
+};
+
+layout(std430, binding = 2) readonly buffer ClusterLightCounts {
+    uint clusterLightCounts[];
+};
+
+layout(std430, binding = 3) readonly buffer ClusterLightIndices {
+    uint clusterLightIndices[];
+};
+
+// Cluster containing a fragment, from its window position and positive view-space depth
+uint getClusterIndex(vec2 fragCoord, float viewDepth) {
+    uvec2 tile = min(uvec2(fragCoord / clusterTileSize), clusterGrid.xy - 1u);
+    uint slice = uint(clamp(log(viewDepth) * clusterDepth.z + clusterDepth.w, 0.0, float(clusterGrid.z - 1u)));
+    return tile.x + clusterGrid.x * (tile.y + clusterGrid.y * slice);
+}
+
+// Radiance arriving at `position` from `light` and the direction towards it
+vec3 getLightRadiance(Light light, vec3 position, out vec3 L) {
+    vec3 toLight = light.positionRange.xyz - position;
+    float distanceSquared = max(dot(toLight, toLight), 1e-4);
+    L = toLight * inversesqrt(distanceSquared);
+
+    // Inverse square falloff windowed to reach zero at the light's range
+    float ratio = distanceSquared / (light.positionRange.w * light.positionRange.w);
+    float window = clamp(1.0 - ratio * ratio, 0.0, 1.0);
+    float attenuation = window * window / distanceSquared;
+
+    if (light.directionType.w > 0.5) {
+        float cosine = dot(-L, light.directionType.xyz);
+        attenuation *= smoothstep(light.spotAngles.y, light.spotAngles.x, cosine);
+    }
+    return light.colorIntensity.rgb * light.colorIntensity.w * attenuation;
+}
@@ -0,0 +1,50 @@
+// Image-based ambient light from the sky, baked by EnvironmentLighting: diffuse from nine spherical
+// harmonics and specular from the split sum of a GGX-prefiltered cube map and a BRDF table. Layout
+// must match EnvironmentData in Lighting/EnvironmentLighting.h. Without an environment loaded the
+// flat ambientColor from FrameData is used instead.
+
+#include "frame.glsl"
+
+layout(std140, binding = 3) uniform EnvironmentData {
+    vec4 environmentIrradiance[9];      // rgb, cosine-convolved and divided by pi
+    vec4 environmentParams;             // x intensity, y last specular mip, z 1 when loaded
+};
+
+layout(binding = 9) uniform samplerCube environmentSpecular;
+layout(binding = 10) uniform sampler2D environmentBrdf;
+
+// Diffuse light a white Lambertian surface facing N reflects
+vec3 evaluateIrradiance(vec3 N) {
+    vec3 result = environmentIrradiance[0].rgb * 0.282095;
+    result += environmentIrradiance[1].rgb * 0.488603 * N.y;
+    result += environmentIrradiance[2].rgb * 0.488603 * N.z;
+    result += environmentIrradiance[3].rgb * 0.488603 * N.x;
+    result += environmentIrradiance[4].rgb * 1.092548 * N.x * N.y;
+    result += environmentIrradiance[5].rgb * 1.092548 * N.y * N.z;
+    result += environmentIrradiance[6].rgb * 0.315392 * (3.0 * N.z * N.z - 1.0);
+    result += environmentIrradiance[7].rgb * 1.092548 * N.x * N.z;
+    result += environmentIrradiance[8].rgb * 0.546274 * (N.x * N.x - N.y * N.y);
+    return max(result, vec3(0.0));
+}
+
+vec3 fresnelSchlickRoughness(float cosTheta, vec3 F0, float roughness) {
+    return F0 + (max(vec3(1.0 - roughness), F0) - F0) * pow(clamp(1.0 - cosTheta, 0.0, 1.0), 5.0);
+}
+
+vec3 evaluateAmbient(vec3 N, vec3 V, vec3 albedo, float metallic, float roughness, float occlusion) {
+    if (environmentParams.z == 0.0) return ambientColor.rgb * albedo * occlusion;
+
+    vec3 F0 = mix(vec3(0.04), albedo, metallic);
+    float NdotV = clamp(dot(N, V), 0.0, 1.0);
+    vec3 F = fresnelSchlickRoughness(NdotV, F0, roughness);
+
+    vec3 kD = (1.0 - F) * (1.0 - metallic);
+    vec3 diffuse = kD * albedo * evaluateIrradiance(N);
+
+    vec3 R = reflect(-V, N);
+    vec3 prefiltered = textureLod(environmentSpecular, R, roughness * environmentParams.y).rgb;
+    vec2 brdf = texture(environmentBrdf, vec2(NdotV, roughness)).rg;
+    vec3 specular = prefiltered * (F0 * brdf.x + brdf.y);
+
+    return (diffuse + specular) * occlusion * environmentParams.x;
+}
@@ -0,0 +1,19 @@
+// Per-frame globals shared by every program, uploaded once per frame by FrameUniforms at binding 0.
+// Layout must match FrameData in Buffer/FrameUniforms.h; programs are checked against it at startup.
+layout(std140, binding = 0) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    mat4 inverseView;
+    mat4 inverseProjection;
+    mat4 inverseViewProjection;
+    vec4 cameraPosition;        // xyz, w = 1
+    vec2 resolution;            // render target size in pixels
+    float time;                 // seconds since startup
+    float deltaTime;
+    vec4 lightDirection;        // xyz towards the scene, w = intensity
+    vec4 lightColor;            // rgb
+    vec4 ambientColor;          // rgb
+    mat4 unjitteredViewProjection;
+    mat4 previousViewProjection;        // last frame's, unjittered; for motion vectors
+};
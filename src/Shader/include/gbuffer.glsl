@@ -0,0 +1,22 @@
+// Thin G-buffer written by gbuffer.frag and read by deferred_lighting.frag (Deferred/GBuffer.h):
+//   0      RGBA8        albedo.rgb, occlusion
+//   1      RG16F        world-space normal, octahedral encoded
+//   2      RGBA8        metallic, roughness
+//   3      R11G11B10F   emissive
+//   4      RG16F        velocity, see velocity.glsl; copied to the scene target by the lighting pass
+//   depth  24 bit       world position is rebuilt from it with FrameData.inverseViewProjection
+
+vec2 signNotZero(vec2 v) {
+    return vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+}
+
+vec2 encodeNormal(vec3 n) {
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    return n.z >= 0.0 ? n.xy : (1.0 - abs(n.yx)) * signNotZero(n.xy);
+}
+
+vec3 decodeNormal(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0) n.xy = (1.0 - abs(n.yx)) * signNotZero(n.xy);
+    return normalize(n);
+}
@@ -0,0 +1,47 @@
+// Shared by the environment prefilter passes. Cube face directions match
+// Lighting/SphericalHarmonics.cpp, so GPU and CPU projections see the same texels.
+
+const float PI = 3.14159265359;
+
+// Unnormalized direction through face coordinates `uv` in [-1, 1], GL face order
+vec3 cubeFaceDirection(int face, vec2 uv) {
+    switch (face) {
+        case 0: return vec3(1.0, -uv.y, -uv.x);
+        case 1: return vec3(-1.0, -uv.y, uv.x);
+        case 2: return vec3(uv.x, 1.0, uv.y);
+        case 3: return vec3(uv.x, -1.0, -uv.y);
+        case 4: return vec3(uv.x, -uv.y, 1.0);
+        default: return vec3(-uv.x, -uv.y, -1.0);
+    }
+}
+
+// Face coordinates of the centre of `texel` on a face `size` texels wide
+vec2 cubeTexelCoordinates(ivec2 texel, int size) {
+    return (vec2(texel) + 0.5) / float(size) * 2.0 - 1.0;
+}
+
+vec2 hammersley(uint i, uint count) {
+    uint bits = bitfieldReverse(i);
+    return vec2(float(i) / float(count), float(bits) * 2.3283064365386963e-10);
+}
+
+float ggxDistribution(float NdotH, float roughness) {
+    float a = roughness * roughness;
+    float a2 = a * a;
+    float denom = NdotH * NdotH * (a2 - 1.0) + 1.0;
+    return a2 / (PI * denom * denom);
+}
+
+// Half vector around N distributed like the GGX lobe of `roughness`
+vec3 importanceSampleGGX(vec2 xi, vec3 N, float roughness) {
+    float a = roughness * roughness;
+    float phi = 2.0 * PI * xi.x;
+    float cosTheta = sqrt((1.0 - xi.y) / (1.0 + (a * a - 1.0) * xi.y));
+    float sinTheta = sqrt(1.0 - cosTheta * cosTheta);
+    vec3 H = vec3(cos(phi) * sinTheta, sin(phi) * sinTheta, cosTheta);
+
+    vec3 up = abs(N.z) < 0.999 ? vec3(0.0, 0.0, 1.0) : vec3(1.0, 0.0, 0.0);
+    vec3 tangent = normalize(cross(up, N));
+    vec3 bitangent = cross(N, tangent);
+    return normalize(tangent * H.x + bitangent * H.y + N * H.z);
+}
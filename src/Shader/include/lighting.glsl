@@ -0,0 +1,29 @@
+// Direct lighting shared by the forward and deferred paths: the sun from FrameData, shadowed by the
+// cascades in shadows.glsl, plus the clustered local lights of the cluster containing `fragCoord`.
+
+#include "frame.glsl"
+#include "clusters.glsl"
+#include "pbr.glsl"
+#include "shadows.glsl"
+
+vec3 evaluateSceneLights(vec3 position, vec2 fragCoord, vec3 N, vec3 V, vec3 albedo, float metallic, float roughness) {
+    vec3 F0 = vec3(0.04);
+    F0 = mix(F0, albedo, metallic);
+
+    float viewDepth = -(view * vec4(position, 1.0)).z;
+    float sunVisibility = sampleShadow(position, N, viewDepth);
+    vec3 Lo = evaluateLight(N, V, normalize(-lightDirection.xyz), lightColor.rgb * lightDirection.w * sunVisibility,
+                            albedo, metallic, roughness, F0);
+
+    // Only the lights binned into this fragment's cluster
+    uint cluster = getClusterIndex(fragCoord, viewDepth);
+    uint first = cluster * clusterGrid.w;
+    uint count = clusterLightCounts[cluster];
+    for (uint i = 0u; i < count; ++i) {
+        Light light = lights[clusterLightIndices[first + i]];
+        vec3 L;
+        vec3 radiance = getLightRadiance(light, position, L);
+        Lo += evaluateLight(N, V, L, radiance, albedo, metallic, roughness, F0);
+    }
+    return Lo;
+}
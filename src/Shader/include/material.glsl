@@ -0,0 +1,90 @@
+// Material parameters and texture sampling shared by the forward and G-buffer passes. The including
+// shader declares the TexCoords, Normal and TBN inputs from model.vert.
+
+// Material properties
+uniform vec4 u_baseColorFactor = vec4(1.0, 1.0, 1.0, 1.0);
+uniform float u_metallicFactor = 1.0;
+uniform float u_roughnessFactor = 1.0;
+uniform vec3 u_emissiveFactor = vec3(0.0);
+uniform float u_normalScale = 1.0;
+uniform float u_occlusionStrength = 1.0;
+
+// Textures
+uniform sampler2D u_baseColorTexture;
+uniform sampler2D u_metallicRoughnessTexture;
+uniform sampler2D u_normalTexture;
+uniform sampler2D u_emissiveTexture;
+uniform sampler2D u_occlusionTexture;
+
+// Atlas sub-rectangles (offset.xy, scale.zw), identity for standalone textures
+uniform vec4 u_baseColorTextureTransform = vec4(0.0, 0.0, 1.0, 1.0);
+uniform vec4 u_metallicRoughnessTextureTransform = vec4(0.0, 0.0, 1.0, 1.0);
+uniform vec4 u_normalTextureTransform = vec4(0.0, 0.0, 1.0, 1.0);
+uniform vec4 u_emissiveTextureTransform = vec4(0.0, 0.0, 1.0, 1.0);
+uniform vec4 u_occlusionTextureTransform = vec4(0.0, 0.0, 1.0, 1.0);
+
+// Texture availability flags
+#include "material_features.glsl"
+
+vec4 sampleMaterialTexture(sampler2D tex, vec4 uvTransform) {
+    if (uvTransform == vec4(0.0, 0.0, 1.0, 1.0)) {
+        return texture(tex, TexCoords);
+    }
+
+    // Repeat inside the atlas region; gradients come from the unwrapped UVs so mip selection is seam-free
+    vec2 uv = uvTransform.xy + fract(TexCoords) * uvTransform.zw;
+    return textureGrad(tex, uv, dFdx(TexCoords) * uvTransform.zw, dFdy(TexCoords) * uvTransform.zw);
+}
+
+vec3 getNormalFromMap() {
+    if (!hasNormalTexture) {
+        return normalize(Normal);
+    }
+    
+    // Z is rebuilt from XY so two-channel (BC5) normal maps work too
+    vec3 tangentNormal;
+    tangentNormal.xy = sampleMaterialTexture(u_normalTexture, u_normalTextureTransform).xy * 2.0 - 1.0;
+    tangentNormal.z = sqrt(max(1.0 - dot(tangentNormal.xy, tangentNormal.xy), 0.0));
+    tangentNormal.xy *= u_normalScale;
+    
+    return normalize(TBN * tangentNormal);
+}
+
+struct MaterialSample {
+    vec4 baseColor;
+    float metallic;
+    float roughness;
+    vec3 emissive;
+    float occlusion;
+    vec3 normal;            // world space
+};
+
+MaterialSample sampleMaterial() {
+    MaterialSample m;
+    m.baseColor = u_baseColorFactor;
+    if (hasBaseColorTexture) {
+        m.baseColor *= sampleMaterialTexture(u_baseColorTexture, u_baseColorTextureTransform);
+    }
+
+    m.metallic = u_metallicFactor;
+    m.roughness = u_roughnessFactor;
+    if (hasMetallicRoughnessTexture) {
+        vec3 mr = sampleMaterialTexture(u_metallicRoughnessTexture, u_metallicRoughnessTextureTransform).rgb;
+        m.metallic *= mr.b;
+        m.roughness *= mr.g;
+    }
+
+    m.emissive = u_emissiveFactor;
+    if (hasEmissiveTexture) {
+        m.emissive *= sampleMaterialTexture(u_emissiveTexture, u_emissiveTextureTransform).rgb;
+    }
+
+    m.occlusion = 1.0;
+    if (hasOcclusionTexture) {
+        m.occlusion = sampleMaterialTexture(u_occlusionTexture, u_occlusionTextureTransform).r;
+        m.occlusion = 1.0 + u_occlusionStrength * (m.occlusion - 1.0);
+    }
+
+    m.normal = getNormalFromMap();
+    return m;
+}
@@ -0,0 +1,37 @@
+// Material texture availability. Shader variants define HAS_* as 0 or 1 and the unused branches
+// compile away; without a define the flag falls back to the uniform Material sets at bind time.
+
+#ifdef HAS_BASE_COLOR_TEXTURE
+const bool hasBaseColorTexture = HAS_BASE_COLOR_TEXTURE != 0;
+#else
+uniform bool u_hasBaseColorTexture = false;
+#define hasBaseColorTexture u_hasBaseColorTexture
+#endif
+
+#ifdef HAS_METALLIC_ROUGHNESS_TEXTURE
+const bool hasMetallicRoughnessTexture = HAS_METALLIC_ROUGHNESS_TEXTURE != 0;
+#else
+uniform bool u_hasMetallicRoughnessTexture = false;
+#define hasMetallicRoughnessTexture u_hasMetallicRoughnessTexture
+#endif
+
+#ifdef HAS_NORMAL_TEXTURE
+const bool hasNormalTexture = HAS_NORMAL_TEXTURE != 0;
+#else
+uniform bool u_hasNormalTexture = false;
+#define hasNormalTexture u_hasNormalTexture
+#endif
+
+#ifdef HAS_EMISSIVE_TEXTURE
+const bool hasEmissiveTexture = HAS_EMISSIVE_TEXTURE != 0;
+#else
+uniform bool u_hasEmissiveTexture = false;
+#define hasEmissiveTexture u_hasEmissiveTexture
+#endif
+
+#ifdef HAS_OCCLUSION_TEXTURE
+const bool hasOcclusionTexture = HAS_OCCLUSION_TEXTURE != 0;
+#else
+uniform bool u_hasOcclusionTexture = false;
+#define hasOcclusionTexture u_hasOcclusionTexture
+#endif
@@ -0,0 +1,43 @@
+// Cascaded sun shadows, written by CascadedShadows. Layout must match ShadowData in
+// Shadows/CascadedShadows.h. The map is a depth array with one layer per cascade, sampled through a
+// comparison sampler so every tap is a hardware 2x2 PCF.
+
+#include "frame.glsl"
+
+layout(std140, binding = 2) uniform ShadowData {
+    mat4 cascadeViewProjection[4];
+    vec4 cascadeSplits;         // view distance each cascade ends at
+    vec4 cascadeTexelSize;      // world-space size of one shadow texel per cascade
+    vec4 shadowParams;          // x cascade count (0 = shadows off), y normal offset in texels, z depth bias
+};
+
+layout(binding = 8) uniform sampler2DArrayShadow shadowMap;
+
+// Light visibility in [0, 1] for a surface at `position` with normal `N`, `viewDepth` in front of the
+// camera. Receivers past the last cascade are lit.
+float sampleShadow(vec3 position, vec3 N, float viewDepth) {
+    int count = int(shadowParams.x);
+    if (count == 0 || viewDepth > cascadeSplits[count - 1]) return 1.0;
+
+    int cascade = 0;
+    while (cascade < count - 1 && viewDepth > cascadeSplits[cascade]) ++cascade;
+
+    // Normal offset grows at grazing angles, where the depth slope of a texel is largest
+    vec3 L = normalize(-lightDirection.xyz);
+    float NdotL = clamp(dot(N, L), 0.0, 1.0);
+    float slope = sqrt(1.0 - NdotL * NdotL);
+    vec3 offset = N * cascadeTexelSize[cascade] * shadowParams.y * slope;
+
+    vec3 coords = (cascadeViewProjection[cascade] * vec4(position + offset, 1.0)).xyz * 0.5 + 0.5;
+    float reference = coords.z - shadowParams.z;
+
+    // 3x3 taps of the bilinear comparison, a 4x4 texel tent in total
+    vec2 texel = 1.0 / vec2(textureSize(shadowMap, 0).xy);
+    float lit = 0.0;
+    for (int y = -1; y <= 1; ++y) {
+        for (int x = -1; x <= 1; ++x) {
+            lit += texture(shadowMap, vec4(coords.xy + vec2(x, y) * texel, float(cascade), reference));
+        }
+    }
+    return lit / 9.0;
+}
@@ -0,0 +1,9 @@
+// Motion vectors for temporal anti-aliasing: screen-space movement of a surface point since the last
+// frame, in UV units (current minus previous), from unjittered clip positions so the camera jitter
+// does not show up as motion. Written to color attachment 1 of the scene target.
+
+vec4 encodeVelocity(vec4 currentClip, vec4 previousClip) {
+    vec2 velocity = (currentClip.xy / currentClip.w - previousClip.xy / previousClip.w) * 0.5;
+    // Alpha 1 so the alpha blending left enabled for the color attachment passes it through unchanged
+    return vec4(velocity, 0.0, 1.0);
+}
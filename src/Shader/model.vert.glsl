@@ -7,13 +7,11 @@ layout (location = 3) in vec3 aTangent;
 layout (location = 4) in vec3 aBitangent;
 
 
-layout(std140, binding = 0) uniform CameraData {
-    mat4 view;
-    mat4 projection;
-};
+#include "include/frame.glsl"
 
 uniform mat3 u_normalMatrix;
 uniform mat4 u_modelMatrix;
+uniform mat4 u_previousModelMatrix;
 
 out vec3 FragPos;
 out vec3 Normal;
@@ -21,6 +19,10 @@ out vec2 TexCoords;
 out vec3 Tangent;
 out vec3 Bitangent;
 out mat3 TBN;
+out vec4 CurrentClip;
+out vec4 PreviousClip;
+
+invariant gl_Position;
 
 void main() {
     vec4 worldPos = u_modelMatrix * vec4(aPosition, 1.0);
@@ -35,4 +37,7 @@ void main() {
     TexCoords = aTexCoords;
     
     gl_Position = projection * view * worldPos;
-}
\ No newline at end of file
+
+    CurrentClip = unjitteredViewProjection * worldPos;
+    PreviousClip = previousViewProjection * (u_previousModelMatrix * vec4(aPosition, 1.0));
+}
@@ -0,0 +1,29 @@
+#version 460 core
+
+// Cascaded shadow pass: depth only, from the position stream. Each instance renders the mesh into
+// one cascade, the i-th set bit of u_layerMask, so a caster overlapping three cascades costs one draw.
+// With SHADOW_VERTEX_LAYER the layer is picked here and all cascades render into a layered attachment
+// in one go; without it the caller attaches one layer at a time and sets a single bit.
+
+#ifdef SHADOW_VERTEX_LAYER
+#extension GL_ARB_shader_viewport_layer_array : require
+#endif
+
+layout (location = 0) in vec3 aPosition;
+
+#include "include/shadows.glsl"
+
+uniform mat4 u_modelMatrix;
+uniform uint u_layerMask;
+uniform int u_layerBase;        // cascade stored in layer 0 of the attached texture
+
+void main() {
+    uint mask = u_layerMask;
+    for (int i = 0; i < gl_InstanceID; ++i) mask &= mask - 1u;
+    int cascade = findLSB(mask);
+
+    gl_Position = cascadeViewProjection[cascade] * (u_modelMatrix * vec4(aPosition, 1.0));
+#ifdef SHADOW_VERTEX_LAYER
+    gl_Layer = cascade - u_layerBase;
+#endif
+}
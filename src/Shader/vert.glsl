@@ -3,15 +3,16 @@
 layout(location = 0) in vec3 aPos;
 layout(location = 1) in vec2 aTexCoord;
 
-layout(std140, binding = 0) uniform CameraData {
-    mat4 view;
-    mat4 projection;
-};
+#include "include/frame.glsl"
 
 out vec2 TexCoord;
+out vec4 CurrentClip;
+out vec4 PreviousClip;
 
 void main()
 {
     TexCoord = aTexCoord;
     gl_Position = projection * view * vec4(aPos, 1.0);
+    CurrentClip = unjitteredViewProjection * vec4(aPos, 1.0);
+    PreviousClip = previousViewProjection * vec4(aPos, 1.0);
 }
\ No newline at end of file
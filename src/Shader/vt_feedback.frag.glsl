@@ -0,0 +1,26 @@
+#version 460 core
+
+in vec2 TexCoords;
+
+// Packed tile id + 1 per pixel, 0 where nothing using the virtual texture was drawn
+layout (location = 0) out uint FeedbackTile;
+
+uniform vec2 u_vtVirtualSize;
+uniform float u_vtTileSize;
+uniform int u_vtLevels;
+uniform float u_vtLodBias;
+
+void main() {
+    vec2 uv = fract(TexCoords);
+
+    // Derivatives of the unwrapped coordinates, so the seam at fract() does not spike the LOD
+    vec2 dx = dFdx(TexCoords) * u_vtVirtualSize;
+    vec2 dy = dFdy(TexCoords) * u_vtVirtualSize;
+    float lod = 0.5 * log2(max(dot(dx, dx), dot(dy, dy))) + u_vtLodBias;
+    int level = clamp(int(floor(lod)), 0, u_vtLevels - 1);
+
+    ivec2 pages = max(ivec2(u_vtVirtualSize / u_vtTileSize) >> level, ivec2(1));
+    ivec2 tile = min(ivec2(uv * vec2(pages)), pages - 1);
+
+    FeedbackTile = ((uint(level) << 24) | (uint(tile.y) << 12) | uint(tile.x)) + 1u;
+}
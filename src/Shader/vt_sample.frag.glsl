@@ -0,0 +1,65 @@
+#version 460 core
+
+in vec3 FragPos;
+in vec3 Normal;
+in vec2 TexCoords;
+in vec4 CurrentClip;
+in vec4 PreviousClip;
+
+layout(location = 0) out vec4 FragColor;
+layout(location = 1) out vec4 Velocity;
+
+// Page table: one RGBA8 texel per tile and level (slot x, slot y, resident level, valid)
+uniform sampler2D u_vtPageTable;
+// Tile cache atlas, or the sparse texture holding every level
+uniform sampler2D u_vtPhysical;
+
+uniform vec2 u_vtVirtualSize;
+uniform float u_vtTileSize;
+uniform int u_vtLevels;
+uniform float u_vtBorder;
+uniform vec2 u_vtPhysicalSize;
+uniform bool u_vtSparse = false;
+
+#include "include/frame.glsl"
+#include "include/velocity.glsl"
+
+ivec2 vtPages(int level) {
+    return max(ivec2(u_vtVirtualSize / u_vtTileSize) >> level, ivec2(1));
+}
+
+vec4 sampleVirtualTexture(vec2 coords) {
+    vec2 uv = fract(coords);
+
+    vec2 dx = dFdx(coords) * u_vtVirtualSize;
+    vec2 dy = dFdy(coords) * u_vtVirtualSize;
+    float lod = clamp(0.5 * log2(max(dot(dx, dx), dot(dy, dy))), 0.0, float(u_vtLevels - 1));
+    int level = int(floor(lod));
+
+    ivec2 pages = vtPages(level);
+    vec4 entry = texelFetch(u_vtPageTable, min(ivec2(uv * vec2(pages)), pages - 1), level) * 255.0;
+    if (entry.a == 0.0) {
+        return vec4(1.0, 0.0, 1.0, 1.0);
+    }
+
+    int residentLevel = int(entry.b + 0.5);
+
+    if (u_vtSparse) {
+        // Only the resident level is known to be committed; a fractional LOD would also blend the
+        // next coarser level, which may not be.
+        return textureLod(u_vtPhysical, uv, float(residentLevel));
+    }
+
+    float padded = u_vtTileSize + 2.0 * u_vtBorder;
+    vec2 within = fract(uv * vec2(vtPages(residentLevel)));
+    vec2 physicalUV = (floor(entry.rg + 0.5) * padded + u_vtBorder + within * u_vtTileSize) / u_vtPhysicalSize;
+    return textureLod(u_vtPhysical, physicalUV, 0.0);
+}
+
+void main() {
+    vec4 color = sampleVirtualTexture(TexCoords);
+
+    float diffuse = max(dot(normalize(Normal), normalize(-lightDirection.xyz)), 0.0);
+    FragColor = vec4(color.rgb * (0.2 + 0.8 * diffuse), color.a);
+    Velocity = encodeVelocity(CurrentClip, PreviousClip);
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <initializer_list>
+#include <string>
+#include <system_error>
+#include <vector>
+
+struct FileChunk {
+    const void* data;
+    size_t size;
+};
+
+// Writes the chunks back to back into `path`, creating its directory if needed. The bytes go to a
+// temporary name first and are renamed over `path` once complete, so a crash mid-write never leaves
+// a truncated file for a cache to read. Returns false if the file could not be written.
+inline bool WriteFileAtomic(const std::string& path, const std::vector<FileChunk>& chunks) {
+    std::error_code error;
+    const std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty()) std::filesystem::create_directories(parent, error);
+
+    const std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary);
+        if (!file) return false;
+        for (const FileChunk& chunk : chunks) {
+            file.write(static_cast<const char*>(chunk.data), static_cast<std::streamsize>(chunk.size));
+        }
+        if (!file) {
+            file.close();
+            std::filesystem::remove(temporary, error);
+            return false;
+        }
+    }
+
+    std::filesystem::rename(temporary, path, error);
+    if (error) {
+        std::filesystem::remove(temporary, error);
+        return false;
+    }
+    return true;
+}
+
+inline bool WriteFileAtomic(const std::string& path, std::initializer_list<FileChunk> chunks) {
+    return WriteFileAtomic(path, std::vector<FileChunk>(chunks));
+}
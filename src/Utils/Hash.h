@@ -0,0 +1,43 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// 64-bit FNV-1a variant that consumes 8 bytes per step; used for cache keys, not security.
+inline uint64_t HashBytes(const void* data, size_t size, uint64_t seed = 14695981039346656037ull) {
+    constexpr uint64_t prime = 1099511628211ull;
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    uint64_t hash = seed ^ (size * prime);
+
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, bytes + i, 8);
+        hash = (hash ^ word) * prime;
+        hash ^= hash >> 29;
+    }
+    for (; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * prime;
+    }
+
+    hash ^= hash >> 32;
+    return hash;
+}
+
+inline uint64_t HashString(const std::string& text, uint64_t seed = 14695981039346656037ull) {
+    return HashBytes(text.data(), text.size(), seed);
+}
+
+inline uint64_t HashCombine(uint64_t seed, uint64_t value) {
+    return seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+}
+
+inline std::string HashToString(uint64_t hash) {
+    static const char digits[] = "0123456789abcdef";
+    std::string text(16, '0');
+    for (int i = 15; i >= 0; --i) {
+        text[i] = digits[hash & 0xF];
+        hash >>= 4;
+    }
+    return text;
+}
@@ -0,0 +1,115 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Small worker pool for CPU-side asset work (decoding, mip generation, block compression).
+// Nothing submitted here may touch the GL context.
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned threadCount = std::max(2u, std::thread::hardware_concurrency()) - 1) {
+        for (unsigned i = 0; i < threadCount; ++i) {
+            workers.emplace_back([this] { WorkerLoop(); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        condition.notify_all();
+        for (auto& worker : workers) worker.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    template <typename F>
+    auto Submit(F&& task) -> std::future<decltype(task())> {
+        using Result = decltype(task());
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+        std::future<Result> future = packaged->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.emplace([packaged] { (*packaged)(); });
+        }
+        condition.notify_one();
+        return future;
+    }
+
+    // Runs body(i) for i in [0, count) and returns once every index is done.
+    // The calling thread takes part, so this is safe to call from inside a job.
+    void ParallelFor(size_t count, const std::function<void(size_t)>& body) {
+        if (count == 0) return;
+
+        struct State {
+            std::atomic<size_t> next{0};
+            size_t done = 0;
+            std::mutex mutex;
+            std::condition_variable finished;
+        };
+        auto state = std::make_shared<State>();
+
+        auto run = [state, count, &body] {
+            size_t completed = 0;
+            for (size_t i = state->next++; i < count; i = state->next++) {
+                body(i);
+                ++completed;
+            }
+            if (completed == 0) return;
+
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->done += completed;
+            if (state->done == count) state->finished.notify_all();
+        };
+
+        size_t helpers = std::min(count - 1, workers.size());
+        for (size_t i = 0; i < helpers; ++i) {
+            // Helpers that start after the range is exhausted return without touching body.
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.emplace(run);
+        }
+        condition.notify_all();
+
+        run();
+
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->finished.wait(lock, [&] { return state->done == count; });
+    }
+
+    size_t GetThreadCount() const { return workers.size(); }
+
+private:
+    void WorkerLoop() {
+        while (true) {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                condition.wait(lock, [this] { return stopping || !jobs.empty(); });
+                if (stopping && jobs.empty()) return;
+                job = std::move(jobs.front());
+                jobs.pop();
+            }
+            job();
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> jobs;
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool stopping = false;
+};
+
+inline ThreadPool& GetThreadPool() {
+    static ThreadPool pool;
+    return pool;
+}
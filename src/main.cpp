@@ -1,8 +1,10 @@
 #include <SDL3/SDL.h>
 #include <SDL3/SDL_timer.h>
 #include <glad/glad.h>
+#include <array>
 #include <iostream>
 #include <memory>
+#include <string>
 #include <spdlog/spdlog.h>
 
 #include "Utils/fpscounter.h"
@@ -55,21 +57,28 @@ int main(int argc, char* argv[]) {
         0.0f,  0.5f, 0.0f,  0.5f, 1.0f  
     };
 
-    auto vertPtr = CreateShader(ShaderStage::Vertex, "Shader/vert.glsl");
-    auto fragPtr = CreateShader(ShaderStage::Fragment, "Shader/frag.glsl");
-    auto programPtr = CreateShaderProgram({vertPtr.get(), fragPtr.get()});
+    // Every program is submitted up front; the driver compiles them while the scene loads.
+    auto shaderCompiler = CreateShaderCompiler();
+    auto triangleShaders = shaderCompiler->Submit({{ShaderStage::Vertex, "Shader/vert.glsl"},
+                                                   {ShaderStage::Fragment, "Shader/frag.glsl"}});
 
     auto vaoPtr = CreateVertexArray();
     vaoPtr->desc = VertexDesc;
     auto vboPtr = CreateBuffer(BufferType::Vertex, sizeof(vertices), vertices, BufferUsage::Static, 0);
     vaoPtr->ApplyLayout(vboPtr->id);
 
-    auto fboVert = CreateShader(ShaderStage::Vertex, "Shader/fbo.vert.glsl");
-    auto fboFrag = CreateShader(ShaderStage::Fragment, "Shader/fbo.frag.glsl");
-    auto fboProgram = CreateShaderProgram({fboVert.get(), fboFrag.get()});
-    auto FBO = CreateFramebuffer(*fboProgram);
+    auto FBO = CreateFramebuffer();
 
-    auto UBOcamera = CreateBuffer(BufferType::Uniform, sizeof(glm::mat4) * 2, nullptr, BufferUsage::Dynamic, 0);
+    // View, projection, camera, time and light for every shader, one upload per frame
+    auto frameUniforms = CreateFrameUniforms();
+    frameUniforms->SetLight(glm::vec3(-1.0f), glm::vec3(1.0f));
+
+    // Checks every program against the FrameData layout as it links, hot reloads included; the
+    // ones linked before this point are checked here
+    frameUniforms->ValidateAll();
+    ShaderProgram::SetLinkCallback([uniforms = frameUniforms.get()](const ShaderProgram& program) {
+        uniforms->Validate(program);
+    });
     
     bool running = true;
     Uint64 lastFrame = SDL_GetPerformanceCounter();
@@ -79,10 +88,163 @@ int main(int argc, char* argv[]) {
     initPerlin();
 
     auto model = CreateModel("Models/dark_souls_final.glb");
-    auto modelVertShader = CreateShader(ShaderStage::Vertex, "Shader/model.vert.glsl");
-    auto modelFragShader = CreateShader(ShaderStage::Fragment, "Shader/model.frag.glsl");
-    auto modelProgram = CreateShaderProgram({modelVertShader.get(), modelFragShader.get()});
-    model->SetShaderForAllMaterials(std::shared_ptr<ShaderProgram>(modelProgram.release()));
+    auto programPtr = shaderCompiler->Wait(triangleShaders);
+
+    // One model program per combination of material textures, so unused texture branches compile away
+    auto modelVariants = CreateShaderVariantCache({{ShaderStage::Vertex, "Shader/model.vert.glsl"},
+                                                   {ShaderStage::Fragment, "Shader/model.frag.glsl"}},
+                                                  GetMaterialFeatureDefines());
+    model->SetShaderVariantsForAllMaterials(*modelVariants);
+    GetProgramBinaryCache().LogStats();
+
+    // Local lights scattered through the model's bounds, binned per cluster every frame
+    auto clusteredLighting = CreateClusteredLighting();
+    {
+        std::vector<Light> lights(256);
+        glm::vec3 boundsMin = model->GetBoundingBoxMin();
+        glm::vec3 boundsSize = model->GetBoundingBoxSize();
+        for (size_t i = 0; i < lights.size(); ++i) {
+            glm::vec3 t = glm::fract(glm::vec3(0.7548776f, 0.5698403f, 0.4154115f) * static_cast<float>(i + 1));
+            lights[i].position = boundsMin + t * boundsSize;
+            lights[i].range = 0.15f * glm::length(boundsSize);
+            lights[i].color = glm::vec3(t.z, t.x, t.y);
+            lights[i].intensity = 2.0f;
+        }
+        clusteredLighting->SetLights(lights);
+    }
+
+    // Ambient light from the skybox: irradiance SH, prefiltered specular mips and a BRDF table, filtered
+    // on the GPU the first time and loaded from EnvironmentCache afterwards
+    initCube();
+    auto environmentLighting = CreateEnvironmentLighting();
+    environmentLighting->Load(*cubemapTexture);
+
+    // F3 toggles the depth prepass, F4 cycles the depth-complexity view (off, rasterized, shaded)
+    auto depthPrepass = CreateDepthPrepass();
+    auto depthComplexity = CreateDepthComplexity(s_CurrentWindow.width, s_CurrentWindow.height);
+    DepthComplexityView complexityView = DepthComplexityView::Off;
+    std::vector<MeshDrawItem> drawItems;
+
+    // Frame passes are declared every frame; the graph orders them, culls unused ones and inserts
+    // the memory barriers between them
+    auto renderGraph = CreateRenderGraph();
+    auto graphExecutor = CreateRenderGraphExecutor();
+
+    // Per-pass GPU cost, read back a few frames late so it never stalls; F6 logs it
+    auto gpuTimer = CreateGpuTimer();
+    graphExecutor->SetTimer(gpuTimer.get());
+
+    // HDR scene to window: exposure, tonemap, grading, FXAA and dither in one compute pass; F5 toggles FXAA
+    auto postProcessing = CreatePostProcessing();
+    postProcessing->SetLut(ColorGrading::CreateIdentityLut());
+
+    // Bloom from a half-resolution mip chain, composited by the post pass. F12 toggles it, Page Up/Down
+    // change its intensity and Home/End its threshold (0 scatters all light)
+    auto bloom = CreateBloom();
+
+    // The scene renders into a part of the window-sized target picked from the GPU frame time to hold
+    // an 8.3 ms budget, and the post pass upscales it; F7 toggles it
+    auto dynamicResolution = CreateDynamicResolutionController();
+    bool dynamicResolutionEnabled = true;
+
+    // Jittered camera accumulated over frames with motion vectors; F8 toggles it, F9 cycles its internal
+    // resolution (native, 75% and 50% per axis, upsampled by the resolve)
+    auto temporalAA = CreateTemporalAA();
+    bool temporalAAEnabled = true;
+    postProcessing->settings.fxaa = false;        // TAA already anti-aliases; F5 still layers FXAA on top
+
+    // Sun shadows from four cascades; the two distant ones are cached and only redrawn when the light or
+    // their static casters change. F10 toggles them
+    auto cascadedShadows = CreateCascadedShadows();
+
+    // GTAO from the depth buffer at half resolution, between laying depth and shading; each of its
+    // sub-passes shows up in the F6 timings. F11 cycles its preset (low, medium, high, ultra, off)
+    auto ambientOcclusion = CreateAmbientOcclusion(AmbientOcclusionQuality::Medium);
+    ambientOcclusion->SetTimer(gpuTimer.get());
+
+    // F2 switches opaque shading between forward and deferred at runtime
+    RenderPath renderPath = RenderPath::Forward;
+    auto deferredShading = CreateDeferredShading();
+    model->PrewarmShaderVariants(deferredShading->GetGBufferVariants());
+
+    // --virtual-texture <image or .vtex> streams that texture onto a ground plane under the model; an
+    // image is converted to a tiled .vtex next to it the first time and whenever it changes
+    std::unique_ptr<VirtualTexture> virtualTexture;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--virtual-texture" && i + 1 < argc) {
+            virtualTexture = CreateVirtualTexture(VirtualTextureFile::ConvertIfOutdated(argv[++i]));
+        }
+        if (std::string(argv[i]) == "--benchmark-lights") {
+            clusteredLighting->Benchmark({256, 1024, 4096, 16384}, camera.GetViewMatrix(), camera.GetProjectionMatrix(),
+                                         {s_CurrentWindow.width, s_CurrentWindow.height});
+        }
+        if (std::string(argv[i]) == "--benchmark-uploads") {
+            TextureLoader::Benchmark({128, 512, 1024, 2048, 4096});
+        }
+    }
+
+    struct GroundVertex {
+        glm::vec3 position;
+        glm::vec3 normal;
+        glm::vec2 texCoord;
+    };
+
+    std::unique_ptr<VertexArray> groundVao;
+    std::unique_ptr<Buffer> groundVbo;
+    std::unique_ptr<ShaderProgram> virtualTextureProgram;
+    if (virtualTexture) {
+        // One repeat of the virtual texture across a square four times the model's footprint
+        const glm::vec3 boundsMin = model->GetBoundingBoxMin();
+        const glm::vec3 boundsSize = model->GetBoundingBoxSize();
+        const glm::vec3 center = boundsMin + 0.5f * boundsSize;
+        const float extent = 2.0f * glm::max(boundsSize.x, boundsSize.z);
+        const float x0 = center.x - extent, x1 = center.x + extent;
+        const float z0 = center.z - extent, z1 = center.z + extent;
+        const glm::vec3 up(0.0f, 1.0f, 0.0f);
+        const GroundVertex ground[] = {
+            {{x0, boundsMin.y, z0}, up, {0.0f, 0.0f}}, {{x0, boundsMin.y, z1}, up, {0.0f, 1.0f}},
+            {{x1, boundsMin.y, z1}, up, {1.0f, 1.0f}}, {{x0, boundsMin.y, z0}, up, {0.0f, 0.0f}},
+            {{x1, boundsMin.y, z1}, up, {1.0f, 1.0f}}, {{x1, boundsMin.y, z0}, up, {1.0f, 0.0f}},
+        };
+
+        groundVao = CreateVertexArray();
+        groundVao->desc.stride = sizeof(GroundVertex);
+        groundVao->desc.attributes = {
+            {0, 3, GL_FLOAT, offsetof(GroundVertex, position), false},
+            {1, 3, GL_FLOAT, offsetof(GroundVertex, normal), false},
+            {2, 2, GL_FLOAT, offsetof(GroundVertex, texCoord), false}
+        };
+        groundVbo = CreateBuffer(BufferType::Vertex, sizeof(ground), ground, BufferUsage::Static, 0);
+        groundVao->ApplyLayout(groundVbo->id);
+
+        virtualTextureProgram = shaderCompiler->Wait(shaderCompiler->Submit({{ShaderStage::Vertex, "Shader/model.vert.glsl"},
+                                                                             {ShaderStage::Fragment, "Shader/vt_sample.frag.glsl"}}));
+    }
+    auto drawGround = [&](ShaderProgram& program) {
+        program.SetUniformMat4("u_modelMatrix", glm::mat4(1.0f));
+        program.SetUniformMat4("u_previousModelMatrix", glm::mat4(1.0f));
+        program.SetUniformMat3("u_normalMatrix", glm::mat3(1.0f));
+        groundVao->bind();
+        glDrawArrays(GL_TRIANGLES, 0, 6);
+    };
+
+    // Edits to shaders, textures or the model show up on the next frame
+    auto hotReloader = CreateHotReloader();
+    hotReloader->Watch("Shader");
+    hotReloader->Watch("Textures");
+    hotReloader->Watch("Models");
+    hotReloader->WatchFile("Models/dark_souls_final.glb", [&] {
+        auto reloaded = CreateModel("Models/dark_souls_final.glb");
+        reloaded->SetShaderVariantsForAllMaterials(*modelVariants);
+        // New material feature combinations compile now rather than on their first deferred draw
+        reloaded->PrewarmShaderVariants(deferredShading->GetGBufferVariants());
+        model = std::move(reloaded);
+        cascadedShadows->Invalidate();
+    });
+    // An edited sky face re-filters the environment; the cache key covers the face files, so the
+    // stale bake is never loaded again
+    hotReloader->OnTextureReloaded(cubemapTexture.get(), [&] { environmentLighting->Load(*cubemapTexture); });
 
     while (running) {
         Uint64 currentFrame = SDL_GetPerformanceCounter();
@@ -94,6 +256,73 @@ int main(int argc, char* argv[]) {
             if (e.type == SDL_EVENT_QUIT) running = false;
             if (e.type == SDL_EVENT_WINDOW_RESIZED)
                 glViewport(0, 0, s_CurrentWindow.width, s_CurrentWindow.height);
+            if (e.type == SDL_EVENT_KEY_DOWN && e.key.key == SDLK_F2) {
+                renderPath = renderPath == RenderPath::Forward ? RenderPath::Deferred : RenderPath::Forward;
+                spdlog::info("Render path: {}", renderPath == RenderPath::Forward ? "forward" : "deferred");
+            }
+            if (e.type == SDL_EVENT_KEY_DOWN && e.key.key == SDLK_F3) {
+                depthPrepass->enabled = !depthPrepass->enabled;
+                spdlog::info("Depth prepass: {}", depthPrepass->enabled ? "on" : "off");
+            }
+            if (e.type == SDL_EVENT_KEY_DOWN && e.key.key == SDLK_F4) {
+                complexityView = static_cast<DepthComplexityView>((static_cast<int>(complexityView) + 1) % 3);
+            }
+            if (e.type == SDL_EVENT_KEY_DOWN && e.key.key == SDLK_F5) {
+                postProcessing->settings.fxaa = !postProcessing->settings.fxaa;
+                spdlog::info("FXAA: {}", postProcessing->settings.fxaa ? "on" : "off");
+            }
+            if (e.type == SDL_EVENT_KEY_DOWN && e.key.key == SDLK_F6) {
+                gpuTimer->LogTimings();
+                spdlog::info("Render scale {:.2f}", dynamicResolutionEnabled ? dynamicResolution->GetScale() : 1.0f);
+                spdlog::info("Shadow cascades redrawn last frame: {}", cascadedShadows->GetRenderedCascadeCount());
+                if (virtualTexture) virtualTexture->LogStats();
+            }
+            if (e.type == SDL_EVENT_KEY_DOWN && e.key.key == SDLK_F8) {
+                temporalAAEnabled = !temporalAAEnabled;
+                temporalAA->Reset();
+                spdlog::info("Temporal AA: {}", temporalAAEnabled ? "on" : "off");
+            }
+            if (e.type == SDL_EVENT_KEY_DOWN && e.key.key == SDLK_F9) {
+                float& scale = temporalAA->settings.renderScale;
+                scale = scale > 0.9f ? 0.75f : scale > 0.6f ? 0.5f : 1.0f;
+                spdlog::info("Temporal AA internal resolution: {:.0f}%", scale * 100.0f);
+            }
+            if (e.type == SDL_EVENT_KEY_DOWN && e.key.key == SDLK_F10) {
+                cascadedShadows->settings.enabled = !cascadedShadows->settings.enabled;
+                spdlog::info("Shadows: {}", cascadedShadows->settings.enabled ? "on" : "off");
+            }
+            if (e.type == SDL_EVENT_KEY_DOWN && e.key.key == SDLK_F11) {
+                static const char* qualityNames[] = {"low", "medium", "high", "ultra"};
+                AmbientOcclusionSettings& settings = ambientOcclusion->settings;
+                if (!settings.enabled) {
+                    settings.enabled = true;
+                    ambientOcclusion->SetQuality(AmbientOcclusionQuality::Low);
+                } else if (ambientOcclusion->GetQuality() == AmbientOcclusionQuality::Ultra) {
+                    settings.enabled = false;
+                } else {
+                    ambientOcclusion->SetQuality(static_cast<AmbientOcclusionQuality>(static_cast<int>(ambientOcclusion->GetQuality()) + 1));
+                }
+                spdlog::info("Ambient occlusion: {}", settings.enabled ? qualityNames[static_cast<int>(ambientOcclusion->GetQuality())] : "off");
+            }
+            if (e.type == SDL_EVENT_KEY_DOWN && e.key.key == SDLK_F12) {
+                bloom->settings.enabled = !bloom->settings.enabled;
+                spdlog::info("Bloom: {}", bloom->settings.enabled ? "on" : "off");
+            }
+            if (e.type == SDL_EVENT_KEY_DOWN && (e.key.key == SDLK_PAGEUP || e.key.key == SDLK_PAGEDOWN)) {
+                float& intensity = bloom->settings.intensity;
+                intensity = glm::clamp(intensity + (e.key.key == SDLK_PAGEUP ? 0.01f : -0.01f), 0.0f, 1.0f);
+                spdlog::info("Bloom intensity {:.2f}", intensity);
+            }
+            if (e.type == SDL_EVENT_KEY_DOWN && (e.key.key == SDLK_HOME || e.key.key == SDLK_END)) {
+                float& threshold = bloom->settings.threshold;
+                threshold = glm::max(threshold + (e.key.key == SDLK_HOME ? 0.25f : -0.25f), 0.0f);
+                spdlog::info("Bloom threshold {:.2f}", threshold);
+            }
+            if (e.type == SDL_EVENT_KEY_DOWN && e.key.key == SDLK_F7) {
+                dynamicResolutionEnabled = !dynamicResolutionEnabled;
+                dynamicResolution->Reset();
+                spdlog::info("Dynamic resolution: {}", dynamicResolutionEnabled ? "on" : "off");
+            }
             if (e.type == SDL_EVENT_MOUSE_MOTION) {
                 mouse_callback(winPtr, &camera, e.motion.x, e.motion.y);
             }
@@ -101,18 +330,273 @@ int main(int argc, char* argv[]) {
 
         processInput(winPtr, &camera, deltaTime);
 
+        hotReloader->Update();
+        if (virtualTexture) virtualTexture->Update();
+        GetTextureCache().BeginFrame();
+        GetRenderTargetPool().BeginFrame();
+        if (gpuTimer->BeginFrame() && dynamicResolutionEnabled) {
+            dynamicResolution->Update(gpuTimer->GetLatestMilliseconds("Frame"));
+        }
+        const glm::ivec2 windowSize{s_CurrentWindow.width, s_CurrentWindow.height};
+        const glm::ivec2 internalSize = temporalAAEnabled
+            ? glm::max(glm::ivec2(glm::round(glm::vec2(windowSize) * temporalAA->settings.renderScale)), glm::ivec2(1))
+            : windowSize;
+        const glm::ivec2 renderSize = dynamicResolutionEnabled ? dynamicResolution->GetRenderSize(internalSize) : internalSize;
+
+        if (temporalAAEnabled) {
+            glm::vec2 jitter = temporalAA->NextJitter(renderSize, windowSize);
+            camera.SetJitter(2.0f * jitter / glm::vec2(renderSize));
+            temporalAA->Resize(windowSize);
+        } else {
+            camera.SetJitter(glm::vec2(0.0f));
+        }
+
         BeginFrame(glm::vec4{0.1f, 0.1f, 0.1f, 1.f});
 
+        FBO->GetTarget().SetViewport(renderSize);
         FBO->BindFramebuffer(FBO->id);
 
-        UBOcamera->UpdateBuffer(glm::value_ptr(camera.GetViewMatrix()), sizeof(glm::mat4));
-        UBOcamera->UpdateBuffer(glm::value_ptr(camera.GetProjectionMatrix()), sizeof(glm::mat4), sizeof(glm::mat4));
+        frameUniforms->SetCamera(camera, renderSize);
+        frameUniforms->SetTime(SDL_GetTicks() / 1000.0f, deltaTime);
+        frameUniforms->Upload();
+
+        drawItems.clear();
+        model->CollectDrawItems(drawItems, camera.GetViewMatrix());
+
+        renderGraph->Reset();
+        ambientOcclusion->settings.temporalNoise = temporalAAEnabled;
+        const bool occlusionEnabled = ambientOcclusion->settings.enabled;
+        const bool bloomEnabled = bloom->settings.enabled;
+        const bool deferred = renderPath == RenderPath::Deferred;
+
+        // Imported: what lives on across frames. Everything else is declared per frame and taken
+        // from the render target pool only between the first and the last pass using it
+        auto sceneColor = renderGraph->ImportTexture("Scene color", &FBO->GetColor());
+        auto sceneVelocity = renderGraph->ImportTexture("Scene velocity", &FBO->GetVelocity());
+        auto resolvedColor = renderGraph->ImportTexture("Resolved color", &temporalAA->GetOutput());
+        auto colorHistory = renderGraph->ImportTexture("Color history", &temporalAA->GetHistory());
+        auto sceneDepth = renderGraph->ImportTexture("Scene depth", FBO->GetTarget().GetDepth());
+        auto shadowMap = renderGraph->ImportTexture("Shadow map", &cascadedShadows->GetShadowMap());
+        auto lightList = renderGraph->ImportBuffer("Lights", &clusteredLighting->GetLightBuffer());
+        auto clusterCounts = renderGraph->ImportBuffer("Cluster counts", &clusteredLighting->GetCountBuffer());
+        auto clusterIndices = renderGraph->ImportBuffer("Cluster indices", &clusteredLighting->GetIndexBuffer());
+
+        // Transients are allocated at the scene target's size and drawn over the render size, so
+        // dynamic resolution never changes what the pool is asked for
+        const glm::ivec2 targetSize = FBO->GetTarget().GetSize();
+        auto displayColor = renderGraph->CreateTexture("Display color", {windowSize, PostProcessing::OutputFormat});
+
+        RenderGraphResource occlusion, occlusionViewDepth, occlusionBlur[2];
+        if (occlusionEnabled) {
+            const glm::ivec2 lowSize = ambientOcclusion->GetLowSize(targetSize);
+            occlusionViewDepth = renderGraph->CreateTexture("AO view depth",
+                {lowSize, AmbientOcclusion::ViewDepthFormat, 1, 1, TextureFilter::Nearest});
+            for (int i = 0; i < 2; ++i) {
+                occlusionBlur[i] = renderGraph->CreateTexture("AO occlusion " + std::to_string(i),
+                    {lowSize, AmbientOcclusion::OcclusionFormat, 1, 1, TextureFilter::Nearest});
+            }
+            occlusion = renderGraph->CreateTexture("Ambient occlusion",
+                {targetSize, AmbientOcclusion::OcclusionFormat, 1, 1, TextureFilter::Nearest});
+        }
+
+        RenderGraphResource bloomChain;
+        if (bloomEnabled) {
+            bloomChain = renderGraph->CreateTexture("Bloom chain",
+                {Bloom::GetChainSize(windowSize), Bloom::ChainFormat, 1, Bloom::MaxLevels});
+        }
+
+        std::array<RenderGraphResource, GBuffer::ColorCount> gbufferColors;
+        RenderGraphResource gbufferDepth;
+        if (deferred) {
+            const RenderTargetDesc layout = GBuffer::GetDesc();
+            const char* names[GBuffer::ColorCount] = {"G-buffer albedo", "G-buffer normal", "G-buffer material",
+                                                      "G-buffer emissive", "G-buffer velocity"};
+            for (size_t i = 0; i < GBuffer::ColorCount; ++i) {
+                gbufferColors[i] = renderGraph->CreateTexture(names[i], {targetSize, layout.colorFormats[i], 1, 1, layout.filter});
+            }
+            gbufferDepth = renderGraph->CreateTexture("G-buffer depth", {targetSize, *layout.depthFormat, 1, 1, layout.filter});
+        }
+        auto gbufferTextures = [&](RenderGraphContext& context) {
+            GBuffer::Textures textures;
+            for (size_t i = 0; i < GBuffer::ColorCount; ++i) textures.colors[i] = &context.GetTexture(gbufferColors[i]);
+            textures.depth = &context.GetTexture(gbufferDepth);
+            return textures;
+        };
+        auto writeGBuffer = [&](RenderGraphPassBuilder& pass) {
+            for (auto color : gbufferColors) pass.Write(color);
+            pass.Write(gbufferDepth, RenderGraphAccess::DepthAttachment);
+        };
+
+        renderGraph->AddPass("Light binning", [&](RenderGraphPassBuilder& pass) {
+            pass.Read(lightList, RenderGraphAccess::StorageRead);
+            pass.Write(clusterCounts, RenderGraphAccess::StorageWrite);
+            pass.Write(clusterIndices, RenderGraphAccess::StorageWrite);
+        }, [&](RenderGraphContext&) {
+            clusteredLighting->Update(camera.GetViewMatrix(), camera.GetUnjitteredProjectionMatrix(), renderSize);
+        });
+
+        renderGraph->AddPass("Shadows", [&](RenderGraphPassBuilder& pass) {
+            pass.Write(shadowMap, RenderGraphAccess::DepthAttachment);
+        }, [&](RenderGraphContext&) {
+            cascadedShadows->Render(drawItems, camera, glm::vec3(frameUniforms->data.lightDirection));
+        });
+
+        // Records which tiles the ground needs this frame; Update() reads it back a frame or two later
+        if (virtualTexture) {
+            renderGraph->AddPass("Virtual texture feedback", [&](RenderGraphPassBuilder& pass) {
+                pass.SetSideEffect();
+            }, [&](RenderGraphContext&) {
+                drawGround(virtualTexture->BeginFeedbackPass(renderSize.x, renderSize.y));
+                virtualTexture->EndFeedbackPass();
+            });
+        }
+
+        // Ambient occlusion needs depth, and in the deferred path the G-buffer normals, before anything
+        // is shaded, so with it on the opaque pass is split around it
+        if (occlusionEnabled) {
+            renderGraph->AddPass(deferred ? "G-buffer" : "Depth prepass", [&](RenderGraphPassBuilder& pass) {
+                if (deferred) {
+                    writeGBuffer(pass);
+                } else {
+                    pass.Write(sceneDepth, RenderGraphAccess::DepthAttachment);
+                }
+            }, [&](RenderGraphContext& context) {
+                if (deferred) {
+                    deferredShading->FillGBuffer(drawItems, *depthPrepass, gbufferTextures(context), FBO->GetTarget());
+                } else {
+                    FBO->GetTarget().Bind();
+                    depthPrepass->LayDepth(drawItems);
+                }
+            });
+
+            // The intermediates are only touched inside the pass, which orders its own sub-passes
+            renderGraph->AddPass("Ambient occlusion", [&](RenderGraphPassBuilder& pass) {
+                if (deferred) {
+                    pass.Read(gbufferColors[1], RenderGraphAccess::Sampled);
+                    pass.Read(gbufferDepth, RenderGraphAccess::Sampled);
+                } else {
+                    pass.Read(sceneDepth, RenderGraphAccess::Sampled);
+                }
+                pass.Write(occlusionViewDepth, RenderGraphAccess::ImageWrite);
+                pass.Write(occlusionBlur[0], RenderGraphAccess::ImageWrite);
+                pass.Write(occlusionBlur[1], RenderGraphAccess::ImageWrite);
+                pass.Write(occlusion, RenderGraphAccess::ImageWrite);
+            }, [&](RenderGraphContext& context) {
+                const AmbientOcclusionTargets targets{&context.GetTexture(occlusionViewDepth),
+                                                      {&context.GetTexture(occlusionBlur[0]), &context.GetTexture(occlusionBlur[1])},
+                                                      &context.GetTexture(occlusion)};
+                if (deferred) {
+                    ambientOcclusion->Render(context.GetTexture(gbufferDepth), &context.GetTexture(gbufferColors[1]),
+                                             renderSize, targets);
+                } else {
+                    ambientOcclusion->Render(*FBO->GetTarget().GetDepth(), nullptr, renderSize, targets);
+                }
+            });
+        }
+
+        renderGraph->AddPass("Opaque", [&](RenderGraphPassBuilder& pass) {
+            pass.Read(shadowMap, RenderGraphAccess::Sampled);
+            pass.Read(lightList, RenderGraphAccess::StorageRead);
+            pass.Read(clusterCounts, RenderGraphAccess::StorageRead);
+            pass.Read(clusterIndices, RenderGraphAccess::StorageRead);
+            if (occlusionEnabled) pass.Read(occlusion, RenderGraphAccess::Sampled);
+            if (deferred && occlusionEnabled) {
+                for (auto color : gbufferColors) pass.Read(color, RenderGraphAccess::Sampled);
+                pass.Read(gbufferDepth, RenderGraphAccess::Sampled);
+            } else if (deferred) {
+                writeGBuffer(pass);
+            }
+            pass.Write(sceneColor);
+            pass.Write(sceneVelocity);
+            pass.Write(sceneDepth, RenderGraphAccess::DepthAttachment);
+        }, [&](RenderGraphContext& context) {
+            FBO->GetTarget().Bind();
+            clusteredLighting->Bind();
+            cascadedShadows->Bind();
+            environmentLighting->Bind();
+            ambientOcclusion->Bind(occlusionEnabled ? &context.GetTexture(occlusion) : nullptr);
+            if (!occlusionEnabled) {
+                if (deferred) {
+                    deferredShading->Render(drawItems, *depthPrepass, gbufferTextures(context), FBO->GetTarget());
+                } else {
+                    depthPrepass->DrawOpaque(drawItems);
+                }
+            } else if (deferred) {
+                deferredShading->Light(gbufferTextures(context), FBO->GetTarget());
+            } else {
+                depthPrepass->DrawShaded(drawItems, nullptr, true);
+            }
+        });
+
+        renderGraph->AddPass("Overlays", [&](RenderGraphPassBuilder& pass) {
+            pass.Write(sceneColor);
+            pass.Write(sceneVelocity);
+            pass.Write(sceneDepth, RenderGraphAccess::DepthAttachment);
+        }, [&](RenderGraphContext&) {
+            vaoPtr->bind();
+            programPtr->useShaderProgram(); 
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+
+            if (virtualTexture) {
+                virtualTextureProgram->useShaderProgram();
+                virtualTexture->Bind(*virtualTextureProgram, 0, 1);
+                drawGround(*virtualTextureProgram);
+            }
+
+            depthComplexity->Render(drawItems, *depthPrepass, complexityView, FBO->GetTarget());
+        });
+
+        if (temporalAAEnabled) {
+            renderGraph->AddPass("Temporal AA", [&](RenderGraphPassBuilder& pass) {
+                pass.Read(sceneColor, RenderGraphAccess::Sampled);
+                pass.Read(sceneVelocity, RenderGraphAccess::Sampled);
+                pass.Read(sceneDepth, RenderGraphAccess::Sampled);
+                pass.Read(colorHistory, RenderGraphAccess::Sampled);
+                pass.Write(resolvedColor, RenderGraphAccess::ImageWrite);
+            }, [&](RenderGraphContext&) {
+                temporalAA->Resolve(FBO->GetColor(), FBO->GetVelocity(), *FBO->GetTarget().GetDepth(), renderSize,
+                                    windowSize, frameUniforms->data);
+            });
+        }
+
+        // Bloom reads what the post pass reads, so its area lines up with the scene it is composited into
+        if (bloomEnabled) {
+            renderGraph->AddPass("Bloom", [&](RenderGraphPassBuilder& pass) {
+                pass.Read(temporalAAEnabled ? resolvedColor : sceneColor, RenderGraphAccess::Sampled);
+                pass.Write(bloomChain, RenderGraphAccess::ImageWrite);
+            }, [&](RenderGraphContext& context) {
+                if (temporalAAEnabled) {
+                    bloom->Render(temporalAA->GetOutput(), context.GetTexture(bloomChain));
+                } else {
+                    bloom->Render(FBO->GetColor(), context.GetTexture(bloomChain), renderSize);
+                }
+            });
+        }
+
+        renderGraph->AddPass("Post processing", [&](RenderGraphPassBuilder& pass) {
+            pass.Read(temporalAAEnabled ? resolvedColor : sceneColor, RenderGraphAccess::Sampled);
+            if (bloomEnabled) pass.Read(bloomChain, RenderGraphAccess::Sampled);
+            pass.Write(displayColor, RenderGraphAccess::ImageWrite);
+        }, [&](RenderGraphContext& context) {
+            Texture* chain = bloomEnabled ? &context.GetTexture(bloomChain) : nullptr;
+            if (temporalAAEnabled) {
+                postProcessing->Apply(temporalAA->GetOutput(), context.GetTexture(displayColor), glm::ivec2(0),
+                                      bloom.get(), chain);
+            } else {
+                postProcessing->Apply(FBO->GetColor(), context.GetTexture(displayColor), renderSize, bloom.get(), chain);
+            }
+        });
 
-        vaoPtr->bind();
-        programPtr->useShaderProgram(); 
-        glDrawArrays(GL_TRIANGLES, 0, 3);
+        renderGraph->AddPass("Present", [&](RenderGraphPassBuilder& pass) {
+            pass.Read(displayColor, RenderGraphAccess::CopyRead);
+            pass.SetSideEffect();
+        }, [&](RenderGraphContext& context) {
+            postProcessing->Present(context.GetTexture(displayColor), 0);
+        });
 
-        model->Draw();
+        gpuTimer->Begin("Frame");
+        graphExecutor->Execute(*renderGraph);
+        gpuTimer->End("Frame");
 
         FBO->UnbindFramebuffer(FBO->id);
 
@@ -121,6 +605,10 @@ int main(int argc, char* argv[]) {
         fps_counter();
     }
 
+    TextureLoader::ReleaseStagingRing();
+    GetRenderTargetPool().LogStats();
+    GetRenderTargetPool().Clear();
+    GetSamplerCache().Clear();
     DestroyWindow(winPtr);
 
     return 0;
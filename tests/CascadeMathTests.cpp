@@ -0,0 +1,119 @@
+#include "TestFramework.h"
+#include "Renderer/OpenGL/Shadows/CascadeMath.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <glm/gtc/matrix_transform.hpp>
+
+using namespace CascadeMath;
+
+static void TestSplitEndpoints() {
+    for (float lambda : {0.0f, 0.3f, 0.75f, 1.0f}) {
+        auto splits = ComputeSplits(0.1f, 250.0f, 4, lambda);
+        CHECK(splits.size() == 5);
+        CHECK(splits.front() == 0.1f);
+        CHECK(splits.back() == 250.0f);
+        for (size_t i = 1; i < splits.size(); ++i) CHECK(splits[i] > splits[i - 1]);
+    }
+}
+
+static void TestSplitBlend() {
+    const float nearClip = 0.5f;
+    const float farClip = 200.0f;
+    const int count = 4;
+
+    auto uniform = ComputeSplits(nearClip, farClip, count, 0.0f);
+    auto logarithmic = ComputeSplits(nearClip, farClip, count, 1.0f);
+    auto blended = ComputeSplits(nearClip, farClip, count, 0.25f);
+
+    for (int i = 0; i <= count; ++i) {
+        const float t = static_cast<float>(i) / count;
+        CHECK_NEAR(uniform[i], nearClip + (farClip - nearClip) * t, 1e-3);
+        CHECK_NEAR(logarithmic[i], nearClip * std::pow(farClip / nearClip, t), 1e-3);
+        CHECK_NEAR(blended[i], 0.25f * logarithmic[i] + 0.75f * uniform[i], 1e-3);
+    }
+
+    // Logarithmic splits give the near cascades a much shorter range
+    CHECK(logarithmic[1] < uniform[1]);
+}
+
+static void TestSplitInvalidRange() {
+    bool threw = false;
+    try {
+        ComputeSplits(10.0f, 1.0f, 4, 0.5f);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    CHECK(threw);
+}
+
+static void TestFitSliceRotationInvariant() {
+    const float fovY = glm::radians(60.0f);
+    const float aspect = 16.0f / 9.0f;
+    const glm::vec3 eye(3.0f, 2.0f, -5.0f);
+    const glm::vec3 targets[] = {
+        {0.0f, 0.0f, 0.0f}, {10.0f, 2.0f, -5.0f}, {3.0f, -8.0f, 1.0f}, {-4.0f, 7.0f, -9.0f}
+    };
+
+    auto splits = ComputeSplits(0.1f, 150.0f, 4, 0.75f);
+    for (int c = 0; c < 4; ++c) {
+        const float sliceNear = splits[c];
+        const float sliceFar = splits[c + 1];
+        const float tanHalf = std::tan(fovY * 0.5f);
+
+        float reference = -1.0f;
+        for (const auto& target : targets) {
+            const glm::mat4 inverseView = glm::inverse(glm::lookAt(eye, target, glm::vec3(0.0f, 1.0f, 0.0f)));
+            Sphere sphere = FitSlice(inverseView, fovY, aspect, sliceNear, sliceFar);
+
+            // Turning the camera must not change the size, or the texel size would shimmer
+            if (reference < 0.0f) reference = sphere.radius;
+            CHECK(sphere.radius == reference);
+
+            // Every slice corner is inside
+            float worst = 0.0f;
+            for (float d : {sliceNear, sliceFar}) {
+                for (float sx : {-1.0f, 1.0f}) {
+                    for (float sy : {-1.0f, 1.0f}) {
+                        glm::vec3 corner(inverseView * glm::vec4(sx * d * tanHalf * aspect, sy * d * tanHalf, -d, 1.0f));
+                        worst = std::max(worst, glm::length(corner - sphere.center));
+                    }
+                }
+            }
+            CHECK(worst <= sphere.radius * 1.0001f);
+        }
+    }
+}
+
+static void TestSnapToTexel() {
+    const glm::mat4 rotation = GetLightRotation(glm::vec3(-0.3f, -1.0f, -0.2f));
+    const float radius = 37.5f;
+    const int resolution = 2048;
+    const float texel = 2.0f * radius / resolution;
+
+    const glm::vec3 centers[] = {
+        {0.0f, 0.0f, 0.0f}, {12.34f, -5.6f, 78.9f}, {-101.7f, 3.3f, -0.05f}, {0.013f, 999.0f, -250.5f}
+    };
+    for (const auto& center : centers) {
+        const glm::vec3 snapped = SnapToTexel(center, rotation, radius, resolution);
+        const glm::vec3 lightSpace = glm::vec3(rotation * glm::vec4(snapped, 1.0f));
+        const glm::vec3 original = glm::vec3(rotation * glm::vec4(center, 1.0f));
+
+        for (int axis = 0; axis < 2; ++axis) {
+            const float texels = lightSpace[axis] / texel;
+            CHECK_NEAR(texels, std::round(texels), 1e-2);
+            CHECK(std::abs(lightSpace[axis] - original[axis]) <= texel * 1.001f);
+        }
+        // Depth along the light is left alone
+        CHECK_NEAR(lightSpace.z, original.z, 1e-3);
+    }
+}
+
+int main() {
+    TestSplitEndpoints();
+    TestSplitBlend();
+    TestSplitInvalidRange();
+    TestFitSliceRotationInvariant();
+    TestSnapToTexel();
+    return TEST_MAIN_RESULT();
+}
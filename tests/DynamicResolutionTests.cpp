@@ -0,0 +1,127 @@
+#include "TestFramework.h"
+#include "Renderer/OpenGL/DynamicResolution/DynamicResolution.h"
+#include <algorithm>
+#include <functional>
+
+// Synthetic GPU frame time: a fixed part plus a part proportional to the pixel count
+struct Load {
+    double fixedMs;
+    double fullResolutionMs;
+
+    double At(float scale) const { return fixedMs + fullResolutionMs * scale * scale; }
+};
+
+struct Trace {
+    int changes = 0;
+    int lastChange = -1;
+    float minScale = 1e9f;
+    float maxScale = 0.0f;
+};
+
+// Runs `frames` frames with the load returned for each frame, feeding back the time at the scale
+// the controller chose
+static Trace Run(DynamicResolutionController& controller, int frames, const std::function<Load(int)>& load) {
+    Trace trace;
+    for (int frame = 0; frame < frames; ++frame) {
+        const float before = controller.GetScale();
+        const float after = controller.Update(load(frame).At(before));
+        if (after != before) {
+            ++trace.changes;
+            trace.lastChange = frame;
+        }
+        trace.minScale = std::min(trace.minScale, after);
+        trace.maxScale = std::max(trace.maxScale, after);
+    }
+    return trace;
+}
+
+static void TestSteadyState() {
+    // Comfortably under the headroom at full resolution: never moves
+    DynamicResolutionController light;
+    Trace trace = Run(light, 600, [](int) { return Load{1.0, 5.0}; });
+    CHECK(trace.changes == 0);
+    CHECK(light.GetScale() == 1.0f);
+
+    // Too heavy for full resolution: settles early, then holds within budget
+    DynamicResolutionController heavy;
+    trace = Run(heavy, 600, [](int) { return Load{1.0, 14.0}; });
+    const float settled = heavy.GetScale();
+    CHECK(settled < 1.0f);
+    CHECK(trace.lastChange < 100);
+    CHECK(Load{1.0, 14.0}.At(settled) <= heavy.GetSettings().budgetMs);
+
+    trace = Run(heavy, 600, [](int) { return Load{1.0, 14.0}; });
+    CHECK(trace.changes == 0);
+    CHECK(heavy.GetScale() == settled);
+}
+
+static void TestSpikeHysteresis() {
+    const Load normal{1.0, 5.0};
+    const Load spike{30.0, 5.0};
+
+    // One hitch is not a new load
+    DynamicResolutionController controller;
+    Trace trace = Run(controller, 300, [&](int frame) { return frame == 100 ? spike : normal; });
+    CHECK(trace.changes == 0);
+    CHECK(controller.GetScale() == 1.0f);
+
+    // Two in a row are, and the scale drops on the second without waiting for the average
+    controller.Reset();
+    trace = Run(controller, 102, [&](int frame) { return frame >= 100 ? spike : normal; });
+    CHECK(trace.changes == 1);
+    CHECK(trace.lastChange == 101);
+    const float dropped = controller.GetScale();
+    CHECK(dropped < 1.0f);
+
+    // Once the load is gone it climbs back no sooner than increaseDelay frames after the settle,
+    // and by at most maxIncrease per change
+    const auto& settings = controller.GetSettings();
+    float previous = dropped;
+    int firstIncrease = -1;
+    for (int frame = 0; frame < 400; ++frame) {
+        const float scale = controller.Update(normal.At(controller.GetScale()));
+        if (scale != previous) {
+            CHECK(scale > previous);
+            CHECK(scale - previous <= settings.maxIncrease + 1e-4f);
+            if (firstIncrease < 0) firstIncrease = frame;
+        }
+        previous = scale;
+    }
+    CHECK(firstIncrease >= settings.settleFrames + settings.increaseDelay - 1);
+    CHECK(controller.GetScale() == 1.0f);
+}
+
+static void TestScaleLimits() {
+    // An impossible load bottoms out at minScale and stays there
+    DynamicResolutionController controller;
+    Trace trace = Run(controller, 300, [](int) { return Load{20.0, 40.0}; });
+    CHECK(trace.minScale == controller.GetSettings().minScale);
+    CHECK(controller.GetScale() == controller.GetSettings().minScale);
+
+    // Custom limits are respected both ways, on the step grid
+    DynamicResolutionSettings settings;
+    settings.minScale = 0.6f;
+    settings.maxScale = 0.9f;
+    DynamicResolutionController limited(settings);
+    CHECK_NEAR(limited.GetScale(), 0.9f, 1e-6);
+
+    trace = Run(limited, 300, [](int) { return Load{0.5, 1.0}; });
+    CHECK(trace.maxScale <= 0.9f + 1e-6f);
+    trace = Run(limited, 300, [](int) { return Load{20.0, 40.0}; });
+    CHECK_NEAR(trace.minScale, 0.6f, 1e-6);
+    CHECK_NEAR(limited.GetScale(), 0.6f, 1e-6);
+
+    // Render size follows the scale and never collapses to nothing
+    CHECK(limited.GetRenderSize({1920, 1080}) == glm::ivec2(1152, 648));
+    CHECK(limited.GetRenderSize({1, 1}) == glm::ivec2(1, 1));
+
+    limited.Reset();
+    CHECK_NEAR(limited.GetScale(), 0.9f, 1e-6);
+}
+
+int main() {
+    TestSteadyState();
+    TestSpikeHysteresis();
+    TestScaleLimits();
+    return TEST_MAIN_RESULT();
+}
@@ -0,0 +1,230 @@
+#include "TestFramework.h"
+#include "Renderer/OpenGL/RenderGraph/RenderGraph.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Compile() is CPU only: imported resources are declared without GL objects and no pass runs.
+
+namespace {
+    const RenderGraph::ExecuteFunction Nothing = [](RenderGraphContext&) {};
+    const RenderGraphTextureDesc Half{{960, 540}, TextureInternalFormat::RGBA16F};
+
+    std::vector<std::string> OrderOf(const RenderGraph& graph) {
+        std::vector<std::string> names;
+        for (const auto& step : graph.GetCompiled().order) names.push_back(graph.GetPasses()[step.pass].name);
+        return names;
+    }
+
+    std::vector<std::string> CulledOf(const RenderGraph& graph) {
+        std::vector<std::string> names;
+        for (uint32_t pass : graph.GetCompiled().culledPasses) names.push_back(graph.GetPasses()[pass].name);
+        return names;
+    }
+
+    GLbitfield BarrierBefore(const RenderGraph& graph, const std::string& name) {
+        for (const auto& step : graph.GetCompiled().order) {
+            if (graph.GetPasses()[step.pass].name == name) return step.barrierBits;
+        }
+        return ~0u;
+    }
+}
+
+static void TestCulling() {
+    RenderGraph graph;
+    auto backbuffer = graph.ImportTexture("backbuffer", nullptr);
+    auto scene = graph.CreateTexture("scene", Half);
+    auto debug = graph.CreateTexture("debug", Half);
+    auto debugInput = graph.CreateTexture("debug input", Half);
+    auto readback = graph.CreateBuffer("readback", {256});
+
+    graph.AddPass("shade", [&](RenderGraphPassBuilder& pass) { pass.Write(scene); }, Nothing);
+    graph.AddPass("present", [&](RenderGraphPassBuilder& pass) { pass.Read(scene); pass.Write(backbuffer); }, Nothing);
+    // Feeds only the unused debug view, so it goes with it
+    graph.AddPass("debug prepare", [&](RenderGraphPassBuilder& pass) { pass.Write(debugInput); }, Nothing);
+    graph.AddPass("debug view", [&](RenderGraphPassBuilder& pass) {
+        pass.Read(debugInput);
+        pass.Read(scene);
+        pass.Write(debug);
+    }, Nothing);
+    // Writes a transient nobody reads, but is marked as observable
+    graph.AddPass("histogram", [&](RenderGraphPassBuilder& pass) {
+        pass.Read(scene);
+        pass.Write(readback, RenderGraphAccess::StorageWrite);
+        pass.SetSideEffect();
+    }, Nothing);
+
+    graph.Compile();
+    CHECK(OrderOf(graph) == std::vector<std::string>{"shade", "present", "histogram"});
+    CHECK(CulledOf(graph) == std::vector<std::string>{"debug prepare", "debug view"});
+
+    // Culled passes take no memory
+    CHECK(graph.GetCompiled().physical[debug.index] == -1);
+    CHECK(graph.GetCompiled().physical[debugInput.index] == -1);
+    CHECK(graph.GetCompiled().physical[scene.index] >= 0);
+}
+
+static void TestVersioning() {
+    RenderGraph graph;
+    auto output = graph.ImportTexture("output", nullptr);
+    auto history = graph.ImportTexture("history", nullptr);
+    auto color = graph.CreateTexture("color", Half);
+    auto mask = graph.CreateTexture("mask", Half);
+
+    // "resolve" reads the first version of color and a mask whose producer is declared after it;
+    // "overwrite" writes color's second version, which only "composite" reads
+    graph.AddPass("draw", [&](RenderGraphPassBuilder& pass) { pass.Write(color); }, Nothing);
+    graph.AddPass("resolve", [&](RenderGraphPassBuilder& pass) {
+        pass.Read(color);
+        pass.Read(mask);
+        pass.Write(history);
+    }, Nothing);
+    graph.AddPass("overwrite", [&](RenderGraphPassBuilder& pass) { pass.Write(color); }, Nothing);
+    graph.AddPass("mask", [&](RenderGraphPassBuilder& pass) { pass.Write(mask); }, Nothing);
+    graph.AddPass("composite", [&](RenderGraphPassBuilder& pass) { pass.Read(color); pass.Write(output); }, Nothing);
+
+    graph.Compile();
+    // Declaration order would run "overwrite" before "resolve" has read the old contents; the
+    // write-after-read edge holds it back until then
+    CHECK(OrderOf(graph) == std::vector<std::string>{"draw", "mask", "resolve", "overwrite", "composite"});
+    CHECK(CulledOf(graph).empty());
+
+    // Reading something nobody writes is an error for transients, fine for imports
+    RenderGraph unwritten;
+    auto orphan = unwritten.CreateTexture("orphan", Half);
+    auto imported = unwritten.ImportTexture("imported", nullptr);
+    unwritten.AddPass("read", [&](RenderGraphPassBuilder& pass) { pass.Read(imported); pass.SetSideEffect(); }, Nothing);
+    unwritten.Compile();
+    CHECK(OrderOf(unwritten) == std::vector<std::string>{"read"});
+
+    unwritten.AddPass("read orphan", [&](RenderGraphPassBuilder& pass) { pass.Read(orphan); pass.SetSideEffect(); }, Nothing);
+    bool threw = false;
+    try {
+        unwritten.Compile();
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    CHECK(threw);
+
+    // So is a cycle
+    RenderGraph cyclic;
+    auto x = cyclic.CreateTexture("x", Half);
+    auto y = cyclic.CreateTexture("y", Half);
+    cyclic.AddPass("p0", [&](RenderGraphPassBuilder& pass) { pass.Write(x); }, Nothing);
+    cyclic.AddPass("p1", [&](RenderGraphPassBuilder& pass) { pass.Read(y); pass.Write(x); pass.SetSideEffect(); }, Nothing);
+    cyclic.AddPass("p2", [&](RenderGraphPassBuilder& pass) { pass.Read(x); pass.Write(y); }, Nothing);
+    threw = false;
+    try {
+        cyclic.Compile();
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    CHECK(threw);
+}
+
+static void TestAliasing() {
+    RenderGraph graph;
+    auto output = graph.ImportTexture("output", nullptr);
+    auto a = graph.CreateTexture("a", Half);
+    auto b = graph.CreateTexture("b", Half);
+    auto c = graph.CreateTexture("c", Half);
+    auto full = graph.CreateTexture("full", {{1920, 1080}, TextureInternalFormat::RGBA16F});
+    auto small = graph.CreateBuffer("small", {1024});
+    auto large = graph.CreateBuffer("large", {4096});
+
+    // a [0, 1], b [1, 2], c [2, 3]: a and c never overlap and have the same description
+    graph.AddPass("p0", [&](RenderGraphPassBuilder& pass) {
+        pass.Write(a, RenderGraphAccess::ImageWrite);
+        pass.Write(small, RenderGraphAccess::StorageWrite);
+    }, Nothing);
+    graph.AddPass("p1", [&](RenderGraphPassBuilder& pass) {
+        pass.Read(a);
+        pass.Read(small, RenderGraphAccess::StorageRead);
+        pass.Write(b, RenderGraphAccess::ImageWrite);
+    }, Nothing);
+    graph.AddPass("p2", [&](RenderGraphPassBuilder& pass) {
+        pass.Read(b);
+        pass.Write(c, RenderGraphAccess::ImageWrite);
+        pass.Write(full, RenderGraphAccess::ImageWrite);
+        pass.Write(large, RenderGraphAccess::StorageWrite);
+    }, Nothing);
+    graph.AddPass("p3", [&](RenderGraphPassBuilder& pass) {
+        pass.Read(c);
+        pass.Read(full);
+        pass.Read(large, RenderGraphAccess::StorageRead);
+        pass.Write(output);
+    }, Nothing);
+
+    const auto& compiled = graph.Compile();
+    CHECK(compiled.lifetimes[a.index] == glm::ivec2(0, 1));
+    CHECK(compiled.lifetimes[b.index] == glm::ivec2(1, 2));
+    CHECK(compiled.lifetimes[c.index] == glm::ivec2(2, 3));
+
+    CHECK(compiled.physical[a.index] == compiled.physical[c.index]);
+    CHECK(compiled.physical[a.index] != compiled.physical[b.index]);
+    // A different description never shares, even when free
+    CHECK(compiled.physical[full.index] != compiled.physical[a.index]);
+    CHECK(compiled.physical[full.index] != compiled.physical[b.index]);
+    // Buffers share regardless of size and grow to the largest
+    CHECK(compiled.physical[small.index] == compiled.physical[large.index]);
+    CHECK(compiled.physicalResources[compiled.physical[large.index]].bufferSize == 4096);
+    CHECK(compiled.physical[output.index] == -1);
+
+    CHECK(compiled.physicalResources.size() == 4);
+    const size_t half = Half.GetMemorySize();
+    const size_t fullBytes = RenderGraphTextureDesc{{1920, 1080}, TextureInternalFormat::RGBA16F}.GetMemorySize();
+    CHECK(compiled.transientBytes == 3 * half + fullBytes + 1024 + 4096);
+    CHECK(compiled.aliasedBytes == 2 * half + fullBytes + 4096);
+}
+
+static void TestBarriers() {
+    RenderGraph graph;
+    auto output = graph.ImportTexture("output", nullptr);
+    auto image = graph.CreateTexture("image", Half);
+    auto target = graph.CreateTexture("target", Half);
+    auto arguments = graph.CreateBuffer("arguments", {64});
+    auto vertices = graph.CreateBuffer("vertices", {4096});
+
+    graph.AddPass("compute", [&](RenderGraphPassBuilder& pass) {
+        pass.Write(image, RenderGraphAccess::ImageWrite);
+        pass.Write(arguments, RenderGraphAccess::StorageWrite);
+        pass.Write(vertices, RenderGraphAccess::StorageWrite);
+    }, Nothing);
+    // Rendering is ordered by GL itself
+    graph.AddPass("raster", [&](RenderGraphPassBuilder& pass) { pass.Write(target); }, Nothing);
+    graph.AddPass("sample", [&](RenderGraphPassBuilder& pass) {
+        pass.Read(image);
+        pass.Read(target);
+        pass.Write(output);
+    }, Nothing);
+    // The fetch bit issued before "sample" already covers this read of the same write
+    graph.AddPass("sample again", [&](RenderGraphPassBuilder& pass) { pass.Read(image); pass.Write(output); }, Nothing);
+    graph.AddPass("draw indirect", [&](RenderGraphPassBuilder& pass) {
+        pass.Read(arguments, RenderGraphAccess::IndirectRead);
+        pass.Read(vertices, RenderGraphAccess::VertexRead);
+        pass.Write(output);
+    }, Nothing);
+    graph.AddPass("load", [&](RenderGraphPassBuilder& pass) {
+        pass.Read(image, RenderGraphAccess::ImageRead);
+        pass.Write(output);
+    }, Nothing);
+
+    const auto& compiled = graph.Compile();
+    CHECK(BarrierBefore(graph, "compute") == 0);
+    CHECK(BarrierBefore(graph, "raster") == 0);
+    CHECK(BarrierBefore(graph, "sample") == GL_TEXTURE_FETCH_BARRIER_BIT);
+    CHECK(BarrierBefore(graph, "sample again") == 0);
+    CHECK(BarrierBefore(graph, "draw indirect") ==
+          (GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_ELEMENT_ARRAY_BARRIER_BIT));
+    CHECK(BarrierBefore(graph, "load") == GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+    CHECK(compiled.barrierCount == 3);
+}
+
+int main() {
+    TestCulling();
+    TestVersioning();
+    TestAliasing();
+    TestBarriers();
+    return TEST_MAIN_RESULT();
+}
@@ -0,0 +1,177 @@
+#include "TestFramework.h"
+#include "Renderer/OpenGL/Framebuffer/RenderTargetPool.h"
+
+// Stands in for the GL device: fills in the description, size and byte count and counts calls,
+// so the pooling policy runs without a context.
+struct DeviceCounters {
+    int allocations = 0;
+    int frees = 0;
+    int Live() const { return allocations - frees; }
+};
+
+class CountingDevice : public RenderTargetDevice {
+    public:
+        explicit CountingDevice(DeviceCounters& counters) : counters(counters) {}
+
+        std::unique_ptr<RenderTargetAttachments> Allocate(const RenderTargetDesc& desc, glm::ivec2 size) override {
+            auto attachments = std::make_unique<RenderTargetAttachments>();
+            attachments->desc = desc;
+            attachments->size = size;
+            attachments->bytes = desc.GetMemorySize(size);
+            ++counters.allocations;
+            return attachments;
+        }
+
+        void Free(std::unique_ptr<RenderTargetAttachments> attachments) override {
+            if (attachments) ++counters.frees;
+        }
+
+    private:
+        DeviceCounters& counters;
+};
+
+static RenderTargetDesc ColorDesc(TextureInternalFormat format) {
+    RenderTargetDesc desc;
+    desc.colorFormats = {format};
+    return desc;
+}
+
+static void TestReuseMatchingDescriptors() {
+    DeviceCounters counters;
+    {
+        RenderTargetPool pool(std::make_unique<CountingDevice>(counters));
+        const RenderTargetDesc hdr = ColorDesc(TextureInternalFormat::RGBA16F);
+        RenderTargetDesc hdrDepth = hdr;
+        hdrDepth.depthFormat = TextureInternalFormat::Depth32F;
+
+        pool.BeginFrame();
+        auto first = pool.Acquire(hdr, {1280, 720});
+        RenderTargetAttachments* firstStorage = first.get();
+        pool.Release(std::move(first));
+
+        // Same description and size: the idle storage comes back
+        auto again = pool.Acquire(hdr, {1280, 720});
+        CHECK(again.get() == firstStorage);
+        CHECK(counters.allocations == 1);
+        CHECK(pool.GetStats().reuses == 1);
+
+        // A different size or description never matches it
+        auto otherSize = pool.Acquire(hdr, {640, 360});
+        auto otherDesc = pool.Acquire(hdrDepth, {1280, 720});
+        CHECK(counters.allocations == 3);
+        CHECK(pool.GetStats().reuses == 1);
+
+        pool.Release(std::move(again));
+        pool.Release(std::move(otherSize));
+        pool.Release(std::move(otherDesc));
+
+        // Transients released mid-frame are recycled by a later pass of the same frame
+        RenderTargetAttachments* transient = pool.AcquireTransient(hdr, {1280, 720});
+        pool.ReleaseTransient(transient);
+        CHECK(pool.AcquireTransient(hdr, {1280, 720}) == transient);
+        CHECK(counters.allocations == 3);
+    }
+    // The pool hands everything back to the device on destruction
+    CHECK(counters.Live() == 0);
+}
+
+static void TestIdleExpiry() {
+    DeviceCounters counters;
+    RenderTargetPool pool(std::make_unique<CountingDevice>(counters), 2);
+    const RenderTargetDesc desc = ColorDesc(TextureInternalFormat::RGBA8);
+
+    pool.BeginFrame();
+    pool.Release(pool.Acquire(desc, {256, 256}));
+    CHECK(counters.Live() == 1);
+
+    // Kept while unused for up to maxIdleFrames frames
+    pool.BeginFrame();
+    pool.BeginFrame();
+    CHECK(counters.Live() == 1);
+    CHECK(pool.GetStats().idleBytes == desc.GetMemorySize({256, 256}));
+
+    pool.BeginFrame();
+    CHECK(counters.Live() == 0);
+    CHECK(pool.GetStats().idleBytes == 0);
+    CHECK(pool.GetStats().allocatedBytes == 0);
+    CHECK(pool.GetStats().frees == 1);
+
+    // Using it again restarts the count
+    pool.Release(pool.Acquire(desc, {256, 256}));
+    pool.BeginFrame();
+    pool.BeginFrame();
+    pool.Release(pool.Acquire(desc, {256, 256}));
+    pool.BeginFrame();
+    pool.BeginFrame();
+    CHECK(counters.Live() == 1);
+    CHECK(counters.allocations == 2);
+}
+
+static void TestIdleBudgetEviction() {
+    DeviceCounters counters;
+    const RenderTargetDesc older = ColorDesc(TextureInternalFormat::RGBA8);
+    const RenderTargetDesc newer = ColorDesc(TextureInternalFormat::R11G11B10F);
+    const glm::ivec2 size(512, 512);
+    const size_t bytes = older.GetMemorySize(size);
+    CHECK(newer.GetMemorySize(size) == bytes);
+
+    // Room for one idle target, not two
+    RenderTargetPool pool(std::make_unique<CountingDevice>(counters), 100, bytes + bytes / 2);
+    pool.BeginFrame();
+    auto a = pool.Acquire(older, size);
+    auto b = pool.Acquire(newer, size);
+    pool.Release(std::move(a));
+    pool.Release(std::move(b));
+
+    // The oldest idle target goes first
+    CHECK(counters.Live() == 1);
+    CHECK(pool.GetStats().idleBytes == bytes);
+    auto reused = pool.Acquire(newer, size);
+    CHECK(pool.GetStats().reuses == 1);
+    auto reallocated = pool.Acquire(older, size);
+    CHECK(counters.allocations == 3);
+
+    // Lowering the budget evicts right away
+    pool.Release(std::move(reused));
+    pool.Release(std::move(reallocated));
+    pool.SetIdleBudget(0);
+    CHECK(counters.Live() == 0);
+    CHECK(pool.GetStats().idleBytes == 0);
+}
+
+static void TestPeakAndAverage() {
+    DeviceCounters counters;
+    // Idle targets are freed at the next frame, so each frame's total is what it used
+    RenderTargetPool pool(std::make_unique<CountingDevice>(counters), 0);
+    const RenderTargetDesc desc = ColorDesc(TextureInternalFormat::RGBA16F);
+    const glm::ivec2 size(800, 600);
+    const size_t bytes = desc.GetMemorySize(size);
+
+    pool.BeginFrame();
+    pool.AcquireTransient(desc, size);
+    pool.AcquireTransient(desc, size);
+    CHECK(pool.GetStats().allocatedBytes == 2 * bytes);
+
+    pool.BeginFrame();
+    CHECK(pool.GetStats().frames == 1);
+    CHECK_NEAR(pool.GetStats().averageBytes, 2.0 * bytes, 0.5);
+    CHECK(pool.GetStats().allocatedBytes == 0);
+
+    pool.AcquireTransient(desc, size);
+    pool.BeginFrame();
+    CHECK(pool.GetStats().frames == 2);
+    CHECK_NEAR(pool.GetStats().averageBytes, 1.5 * bytes, 0.5);
+
+    pool.BeginFrame();
+    CHECK(pool.GetStats().frames == 3);
+    CHECK_NEAR(pool.GetStats().averageBytes, 1.0 * bytes, 0.5);
+    CHECK(pool.GetStats().peakBytes == 2 * bytes);
+}
+
+int main() {
+    TestReuseMatchingDescriptors();
+    TestIdleExpiry();
+    TestIdleBudgetEviction();
+    TestPeakAndAverage();
+    return TEST_MAIN_RESULT();
+}
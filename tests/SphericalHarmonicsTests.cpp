@@ -0,0 +1,85 @@
+#include "TestFramework.h"
+#include "Renderer/OpenGL/Lighting/SphericalHarmonics.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace SphericalHarmonics;
+
+namespace {
+    constexpr float Pi = 3.14159265358979f;
+
+    struct TestCubemap {
+        std::array<std::vector<float>, 6> pixels;
+        CubemapFaces faces;
+
+        explicit TestCubemap(int size) {
+            faces.size = size;
+            for (int face = 0; face < 6; ++face) {
+                pixels[face].assign(static_cast<size_t>(size) * size * 4, 0.0f);
+                faces.faces[face] = pixels[face].data();
+            }
+        }
+    };
+}
+
+static void TestSimdMatchesScalar() {
+    // 30 is not a multiple of four, so the scalar tail of every row is covered too
+    for (int size : {32, 30, 7}) {
+        TestCubemap cubemap(size);
+        std::mt19937 rng(1234u + size);
+        std::uniform_real_distribution<float> radiance(0.0f, 8.0f);
+        for (auto& face : cubemap.pixels) {
+            for (float& value : face) value = radiance(rng);
+        }
+
+        const SH9Color simd = ProjectCubemap(cubemap.faces);
+        const SH9Color scalar = ProjectCubemapScalar(cubemap.faces);
+        for (int k = 0; k < 9; ++k) {
+            for (int channel = 0; channel < 3; ++channel) {
+                const float reference = scalar.coefficients[k][channel];
+                CHECK_NEAR(simd.coefficients[k][channel], reference, 1e-4f * std::max(1.0f, std::abs(reference)));
+            }
+        }
+    }
+}
+
+static void TestUniformSkyProjectsOntoDcOnly() {
+    const glm::vec3 radiance(1.0f, 0.5f, 2.0f);
+    TestCubemap cubemap(16);
+    for (auto& face : cubemap.pixels) {
+        for (size_t i = 0; i < face.size(); i += 4) {
+            face[i + 0] = radiance.r;
+            face[i + 1] = radiance.g;
+            face[i + 2] = radiance.b;
+            face[i + 3] = 1.0f;
+        }
+    }
+
+    // Y00 = 0.282095 integrated over 4 pi steradians
+    const float dc = 0.282095f * 4.0f * Pi;
+    CHECK_NEAR(dc, 3.5449, 1e-4);
+
+    for (const SH9Color& sh : {ProjectCubemap(cubemap.faces), ProjectCubemapScalar(cubemap.faces)}) {
+        for (int channel = 0; channel < 3; ++channel) {
+            CHECK_NEAR(sh.coefficients[0][channel], dc * radiance[channel], 1e-4);
+            for (int k = 1; k < 9; ++k) CHECK_NEAR(sh.coefficients[k][channel], 0.0, 1e-4);
+        }
+
+        // Reconstructs the constant in every direction, and a white furnace reflects all of it
+        for (const glm::vec3& direction : {glm::vec3(0, 1, 0), glm::vec3(0.6f, 0.0f, -0.8f), glm::vec3(0, 0, -1)}) {
+            const glm::vec3 value = Evaluate(sh, direction);
+            const glm::vec3 irradiance = Evaluate(ConvolveIrradiance(sh), direction);
+            for (int channel = 0; channel < 3; ++channel) {
+                CHECK_NEAR(value[channel], radiance[channel], 1e-4);
+                CHECK_NEAR(irradiance[channel], radiance[channel], 1e-4);
+            }
+        }
+    }
+}
+
+int main() {
+    TestSimdMatchesScalar();
+    TestUniformSkyProjectsOntoDcOnly();
+    return TEST_MAIN_RESULT();
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cmath>
+#include <cstdio>
+
+// Minimal checks for the CPU-only tests: every failed check is printed and counted, and
+// TEST_MAIN_RESULT() turns the count into the process exit code that ctest reads.
+
+namespace Test {
+    inline int& FailureCount() {
+        static int failures = 0;
+        return failures;
+    }
+
+    inline void Fail(const char* file, int line, const char* expression) {
+        std::printf("%s:%d: check failed: %s\n", file, line, expression);
+        ++FailureCount();
+    }
+
+    inline void FailNear(const char* file, int line, const char* expression, double actual, double expected, double tolerance) {
+        std::printf("%s:%d: check failed: %s (got %.9g, expected %.9g +- %.3g)\n",
+                    file, line, expression, actual, expected, tolerance);
+        ++FailureCount();
+    }
+}
+
+// Variadic so conditions with braces or template commas need no extra parentheses
+#define CHECK(...) \
+    do { if (!(__VA_ARGS__)) Test::Fail(__FILE__, __LINE__, #__VA_ARGS__); } while (0)
+
+#define CHECK_NEAR(actual, expected, tolerance) \
+    do { \
+        const double checkActual = static_cast<double>(actual); \
+        const double checkExpected = static_cast<double>(expected); \
+        if (!(std::abs(checkActual - checkExpected) <= static_cast<double>(tolerance))) \
+            Test::FailNear(__FILE__, __LINE__, #actual " == " #expected, checkActual, checkExpected, tolerance); \
+    } while (0)
+
+#define TEST_MAIN_RESULT() \
+    (Test::FailureCount() == 0 ? (std::printf("All checks passed\n"), 0) \
+                               : (std::printf("%d check(s) failed\n", Test::FailureCount()), 1))
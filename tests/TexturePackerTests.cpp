@@ -0,0 +1,163 @@
+#include "TestFramework.h"
+#include "Renderer/OpenGL/Texture/TexturePacker.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace {
+    struct SourceImage {
+        int width;
+        int height;
+        int channels;
+        bool repeat;
+        std::vector<unsigned char> pixels;
+    };
+
+    // Every texel encodes its image and position, so a misplaced or mis-extruded texel is visible
+    unsigned char TexelValue(int image, int x, int y, int channel) {
+        return static_cast<unsigned char>(image * 31 + x * 7 + y * 13 + channel * 3);
+    }
+
+    // The fixed input: mostly power-of-two sizes as in glTF material sets, some odd ones, a few
+    // single-channel masks and one image too large to pack
+    std::vector<SourceImage> MakeImages() {
+        std::mt19937 rng(42);
+        std::vector<SourceImage> images;
+        for (int i = 0; i < 120; ++i) {
+            SourceImage image;
+            image.width = 1 << (3 + rng() % 6);
+            image.height = 1 << (3 + rng() % 6);
+            if (i % 5 == 0) image.width = 17 + static_cast<int>(rng() % 90);
+            if (i % 7 == 0) image.height = 9 + static_cast<int>(rng() % 60);
+            image.channels = i % 11 == 0 ? 1 : 4;
+            image.repeat = i % 3 != 0;
+            images.push_back(image);
+        }
+        images.push_back({1024, 64, 4, true, {}});
+
+        for (size_t i = 0; i < images.size(); ++i) {
+            auto& image = images[i];
+            image.pixels.resize(static_cast<size_t>(image.width) * image.height * image.channels);
+            for (int y = 0; y < image.height; ++y) {
+                for (int x = 0; x < image.width; ++x) {
+                    for (int c = 0; c < image.channels; ++c) {
+                        image.pixels[(static_cast<size_t>(y) * image.width + x) * image.channels + c] =
+                            TexelValue(static_cast<int>(i), x, y, c);
+                    }
+                }
+            }
+        }
+        return images;
+    }
+
+    std::vector<int> AddAll(TexturePacker& packer, const std::vector<SourceImage>& images) {
+        std::vector<int> handles;
+        for (const auto& image : images) {
+            handles.push_back(packer.AddImage({image.width, image.height, image.channels, image.pixels.data(), image.repeat}));
+        }
+        return handles;
+    }
+
+    int Wrap(int coord, int size, bool repeat) {
+        return repeat ? ((coord % size) + size) % size : std::clamp(coord, 0, size - 1);
+    }
+}
+
+static void TestLayout() {
+    const auto images = MakeImages();
+    TexturePackerSettings settings;
+    settings.maxAtlasSize = 1024;
+    settings.maxImageSize = 256;
+    TexturePacker packer(settings);
+    const auto handles = AddAll(packer, images);
+    packer.Pack();
+
+    const auto& pages = packer.GetPages();
+    const int padding = settings.padding;
+    CHECK(packer.GetStats().imagesSubmitted == images.size());
+    CHECK(packer.GetStats().imagesPacked == images.size() - 1);
+    CHECK(packer.GetRegion(handles.back()).page == -1);
+
+    for (size_t a = 0; a < images.size(); ++a) {
+        const AtlasRegion& region = packer.GetRegion(handles[a]);
+        if (region.page < 0) continue;
+        const AtlasPage& page = pages[region.page];
+        const SourceImage& image = images[a];
+
+        CHECK(page.channels == image.channels);
+        CHECK(region.width == image.width && region.height == image.height);
+
+        // The padded rectangle fits the page and starts where every bleed-free level still has a texel edge
+        const int align = 1 << (page.mipLevels - 1);
+        CHECK(page.mipLevels >= 3);
+        CHECK(region.x >= padding && region.y >= padding);
+        CHECK(region.x + region.width + padding <= page.width);
+        CHECK(region.y + region.height + padding <= page.height);
+        CHECK((region.x - padding) % align == 0 && (region.y - padding) % align == 0);
+        CHECK_NEAR(region.uvTransform.x * page.width, region.x, 1e-3);
+        CHECK_NEAR(region.uvTransform.w * page.height, region.height, 1e-3);
+
+        // Padded rectangles never overlap, so borders never cover a neighbour
+        for (size_t b = a + 1; b < images.size(); ++b) {
+            const AtlasRegion& other = packer.GetRegion(handles[b]);
+            if (other.page != region.page) continue;
+            const bool apart = region.x + region.width + padding <= other.x - padding ||
+                               other.x + other.width + padding <= region.x - padding ||
+                               region.y + region.height + padding <= other.y - padding ||
+                               other.y + other.height + padding <= region.y - padding;
+            CHECK(apart);
+        }
+
+        // The image and its extruded border: wrapped for repeating images, clamped otherwise
+        int mismatches = 0;
+        for (int y = -padding; y < image.height + padding; ++y) {
+            for (int x = -padding; x < image.width + padding; ++x) {
+                const int sx = Wrap(x, image.width, image.repeat);
+                const int sy = Wrap(y, image.height, image.repeat);
+                const size_t offset = (static_cast<size_t>(region.y + y) * page.width + region.x + x) * page.channels;
+                for (int c = 0; c < image.channels; ++c) {
+                    if (page.pixels[offset + c] != TexelValue(static_cast<int>(a), sx, sy, c)) ++mismatches;
+                }
+            }
+        }
+        CHECK(mismatches == 0);
+    }
+
+    // One page per channel count is enough at this size. Occupancy measured 0.73 on this input;
+    // well below that means the skyline or the page sizing regressed
+    CHECK(pages.size() == 2);
+    CHECK(packer.GetStats().occupancy > 0.65);
+}
+
+static void TestDeterminism() {
+    const auto images = MakeImages();
+    TexturePacker first, second;
+    const auto firstHandles = AddAll(first, images);
+    const auto secondHandles = AddAll(second, images);
+    first.Pack();
+    second.Pack();
+
+    auto same = [&](const TexturePacker& a, const TexturePacker& b) {
+        if (a.GetPages().size() != b.GetPages().size()) return false;
+        for (size_t i = 0; i < firstHandles.size(); ++i) {
+            const AtlasRegion& ra = a.GetRegion(firstHandles[i]);
+            const AtlasRegion& rb = b.GetRegion(secondHandles[i]);
+            if (ra.page != rb.page || ra.x != rb.x || ra.y != rb.y) return false;
+        }
+        for (size_t p = 0; p < a.GetPages().size(); ++p) {
+            if (a.GetPages()[p].pixels != b.GetPages()[p].pixels) return false;
+        }
+        return true;
+    };
+    CHECK(same(first, second));
+
+    // Packing again gives the same result rather than adding to the previous one
+    second.Pack();
+    CHECK(same(first, second));
+}
+
+int main() {
+    TestLayout();
+    TestDeterminism();
+    return TEST_MAIN_RESULT();
+}
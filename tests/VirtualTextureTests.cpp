@@ -0,0 +1,192 @@
+#include "TestFramework.h"
+#include "Renderer/OpenGL/VirtualTexture/TileCache.h"
+#include <stdexcept>
+#include <vector>
+
+// Residency logic only: feedback analysis, slot eviction and page table fallbacks, driven the
+// same way VirtualTexture drives them but without a file or a GL context.
+
+namespace {
+    // 1024x512 in 128 texel tiles: 8x4, 4x2 and 2x1 tiles, the shorter side reaching one tile at level 2
+    const VirtualTextureLayout Layout = VirtualTextureLayout::Create(1024, 512, 128);
+
+    uint32_t Feedback(TileId tile) { return tile.Pack() + 1; }
+
+    const TileRequest* FindRequest(const std::vector<TileRequest>& requests, TileId tile) {
+        for (const auto& request : requests) {
+            if (request.tile == tile) return &request;
+        }
+        return nullptr;
+    }
+
+    // What the page table says is bound for `tile`: the level it was mapped at and the slot
+    struct Lookup {
+        bool mapped;
+        int level;
+        int slotX;
+        int slotY;
+    };
+
+    Lookup Resolve(const PageTable& pageTable, TileId tile) {
+        const uint32_t entry = pageTable.GetEntry(tile);
+        return {(entry >> 24) == 0xFF, static_cast<int>((entry >> 16) & 0xFF),
+                static_cast<int>(entry & 0xFF), static_cast<int>((entry >> 8) & 0xFF)};
+    }
+}
+
+static void TestLayoutAndIds() {
+    CHECK(Layout.levels == 3);
+    CHECK(Layout.GetPagesX(0) == 8 && Layout.GetPagesY(0) == 4);
+    CHECK(Layout.GetPagesX(2) == 2 && Layout.GetPagesY(2) == 1);
+
+    const TileId tile{2, 1, 0};
+    CHECK(TileId::Unpack(tile.Pack()) == tile);
+    CHECK(TileId::Unpack(TileId{0, 4095, 4095}.Pack()) == TileId{0, 4095, 4095});
+    CHECK(TileId{0, 5, 3}.Parent() == TileId{1, 2, 1});
+
+    bool threw = false;
+    try {
+        VirtualTextureLayout::Create(1000, 512, 128);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    CHECK(threw);
+}
+
+static void TestFeedbackAnalysis() {
+    // A close-up wants level 0 tiles, a distant patch level 1; runs of the same tile, empty
+    // texels and ids outside the texture are all in the mix
+    std::vector<uint32_t> texels;
+    for (int i = 0; i < 6; ++i) texels.push_back(Feedback({0, 5, 3}));
+    texels.push_back(0);
+    for (int i = 0; i < 3; ++i) texels.push_back(Feedback({0, 4, 2}));
+    texels.push_back(Feedback({0, 5, 3}));
+    for (int i = 0; i < 2; ++i) texels.push_back(Feedback({1, 0, 0}));
+    texels.push_back(Feedback({0, 8, 0}));    // x past the level's 8 tiles
+    texels.push_back(Feedback({3, 0, 0}));    // level past the coarsest
+    texels.push_back(0);
+
+    const auto requests = TileFeedback::Analyze(texels.data(), texels.size(), Layout);
+
+    // The finest tiles the feedback asked for, each ancestor once, and nothing else
+    CHECK(requests.size() == 6);
+    const TileRequest* close = FindRequest(requests, {0, 5, 3});
+    const TileRequest* neighbour = FindRequest(requests, {0, 4, 2});
+    const TileRequest* distant = FindRequest(requests, {1, 0, 0});
+    const TileRequest* parent = FindRequest(requests, {1, 2, 1});
+    CHECK(close && close->pixels == 7);
+    CHECK(neighbour && neighbour->pixels == 3);
+    CHECK(distant && distant->pixels == 2);
+    // Both level 0 tiles share the parent, which carries their total
+    CHECK(parent && parent->pixels == 10);
+    CHECK(FindRequest(requests, {2, 0, 0}) && FindRequest(requests, {2, 0, 0})->pixels == 2);
+    CHECK(FindRequest(requests, {2, 1, 0}) && FindRequest(requests, {2, 1, 0})->pixels == 10);
+    CHECK(!FindRequest(requests, {0, 8, 0}));
+
+    // Coarsest first so a fallback is always loading, then the busiest tile first within a level
+    for (size_t i = 1; i < requests.size(); ++i) {
+        const TileRequest& before = requests[i - 1];
+        const TileRequest& after = requests[i];
+        CHECK(before.tile.level > after.tile.level ||
+              (before.tile.level == after.tile.level && before.pixels >= after.pixels));
+    }
+    CHECK(requests.back().tile == TileId{0, 4, 2});
+
+    CHECK(TileFeedback::Analyze(texels.data(), 0, Layout).empty());
+}
+
+static void TestEvictionOrder() {
+    // Four slots is the whole page budget
+    TileCache cache(2, 2);
+    std::optional<TileId> evicted;
+    const TileId a{0, 0, 0}, b{0, 1, 0}, c{0, 2, 0}, d{0, 3, 0}, e{0, 4, 0}, f{0, 5, 0}, coarse{2, 0, 0};
+
+    CHECK(cache.Allocate(coarse, 1, evicted) >= 0 && !evicted);
+    cache.Pin(coarse);
+    CHECK(cache.Allocate(a, 1, evicted) >= 0 && !evicted);
+    CHECK(cache.Allocate(b, 2, evicted) >= 0 && !evicted);
+    CHECK(cache.Allocate(c, 3, evicted) >= 0 && !evicted);
+    CHECK(cache.GetResidentCount() == 4);
+
+    // a is used again, so b is now the oldest; the pinned coarse tile is older still but stays
+    cache.Touch(a, 4);
+    const int slotOfB = cache.Find(b);
+    CHECK(cache.Allocate(d, 5, evicted) == slotOfB);
+    CHECK(evicted && *evicted == b);
+    CHECK(!cache.IsResident(b));
+
+    CHECK(cache.Allocate(e, 6, evicted) >= 0);
+    CHECK(evicted && *evicted == c);
+    CHECK(cache.Allocate(f, 7, evicted) >= 0);
+    CHECK(evicted && *evicted == a);
+    CHECK(cache.IsResident(coarse));
+
+    // Allocating a resident tile keeps its slot and evicts nothing
+    const int slotOfD = cache.Find(d);
+    CHECK(cache.Allocate(d, 8, evicted) == slotOfD && !evicted);
+
+    // Everything else was used this frame: nothing to give up
+    cache.Touch(e, 8);
+    cache.Touch(f, 8);
+    CHECK(cache.Allocate(a, 8, evicted) == -1 && !evicted);
+    CHECK(cache.GetStats().failedAllocations == 1);
+    CHECK(cache.GetStats().evictions == 3);
+    CHECK(cache.GetResidentCount() == 4);
+}
+
+static void TestFallbackAfterEviction() {
+    TileCache cache(2, 1);
+    PageTable pageTable(Layout);
+    std::optional<TileId> evicted;
+    uint64_t frame = 0;
+
+    // Same sequence as VirtualTexture::uploadTile: allocate, unmap whatever lost its slot, map
+    auto load = [&](TileId tile) {
+        const int slot = cache.Allocate(tile, ++frame, evicted);
+        CHECK(slot >= 0);
+        if (evicted) pageTable.Unmap(*evicted);
+        pageTable.Map(tile, slot % cache.GetSlotsX(), slot / cache.GetSlotsX());
+        pageTable.Resolve();
+    };
+
+    const TileId fine{0, 5, 3};
+    const TileId parent = fine.Parent();
+    const TileId sibling{0, 4, 2};
+
+    // Nothing mapped yet
+    CHECK(!Resolve(pageTable, fine).mapped);
+
+    load(parent);
+    load(fine);
+    const Lookup own = Resolve(pageTable, fine);
+    CHECK(own.mapped && own.level == 0 && own.slotX == cache.Find(fine) % 2);
+    // A sibling that was never loaded already samples the parent
+    CHECK(Resolve(pageTable, sibling).mapped && Resolve(pageTable, sibling).level == 1);
+
+    // Keep the parent fresh, then load something else: the fine tile is evicted and its lookup
+    // falls back to the parent's slot
+    cache.Touch(parent, ++frame);
+    load({0, 0, 0});
+    CHECK(evicted && *evicted == fine);
+    const Lookup fallback = Resolve(pageTable, fine);
+    CHECK(fallback.mapped && fallback.level == 1);
+    CHECK(fallback.slotX == cache.Find(parent) % 2 && fallback.slotY == 0);
+
+    // Evicting the parent for a coarsest tile moves the lookup up once more
+    cache.Touch({0, 0, 0}, ++frame);
+    load({2, 1, 0});
+    CHECK(evicted && *evicted == parent);
+    const Lookup coarsest = Resolve(pageTable, fine);
+    CHECK(coarsest.mapped && coarsest.level == 2);
+
+    // Resolve only reports work when something changed
+    CHECK(!pageTable.Resolve());
+}
+
+int main() {
+    TestLayoutAndIds();
+    TestFeedbackAnalysis();
+    TestEvictionOrder();
+    TestFallbackAfterEviction();
+    return TEST_MAIN_RESULT();
+}